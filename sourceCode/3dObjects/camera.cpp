@@ -809,11 +809,15 @@ void CCamera::shiftCameraInCameraManipulationMode(const C3Vector& newLocalPos)
     if ((_cameraManipulationModePermissions&0x004)==0)
         tr.X(2)=0.0f;
     _transformation=oldLocal*tr;
+    localTransformationChanged();
 }
 void CCamera::rotateCameraInCameraManipulationMode(const C7Vector& newLocalConf)
 {
     if (_cameraManipulationModePermissions&0x008)
+    {
         _transformation=newLocalConf;
+        localTransformationChanged();
+    }
 }
 void CCamera::tiltCameraInCameraManipulationMode(float tiltAmount)
 {
@@ -824,6 +828,7 @@ void CCamera::tiltCameraInCameraManipulationMode(float tiltAmount)
         rot.buildZRotation(tiltAmount);
         oldLocal.M=oldLocal.M*rot;
         _transformation=oldLocal;
+        localTransformationChanged();
     }
 }
 
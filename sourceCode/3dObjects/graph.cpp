@@ -14,6 +14,8 @@
 #include "app.h"
 #include "graphRendering.h"
 
+#define GRAPH_HISTORY_CHUNK_SIZE 4096 // points read at once from the history
+
 CGraph::CGraph()
 {
     setObjectType(sim_object_graph_type);
@@ -34,6 +36,8 @@ CGraph::CGraph()
         times.push_back(0.0f);
 
     _initialValuesInitialized=false;
+    _recorder=NULL;
+    _recorderFailed=false;
 
     _localObjectSpecialProperty=0; // actually also renderable, but turned off by default!
     cyclic=true;
@@ -67,6 +71,7 @@ CGraph::~CGraph()
     for (int i=0;i<int(daten.size());i++)
         delete daten[i];
     daten.clear();
+    delete _recorder;
 
     removeAllStatics();
 }
@@ -350,8 +355,8 @@ void CGraph::addNextPoint(float time)
     int nextEntryPosition;
     if (numberOfPoints>=bufferSize)
     { // We reached the maximum of points
-        if (!cyclic)
-            return; // The buffer is not cyclic, we leave here
+        if ( (!cyclic)&&((!App::userSettings->graphRecorder)||_recorderFailed) )
+            return; // The buffer is not cyclic, we leave here. When recording, the buffer is always a sliding window
         else
         { // The buffer is cyclic
             nextEntryPosition=startingPoint;
@@ -380,6 +385,38 @@ void CGraph::addNextPoint(float time)
             daten[i]->setValueDirect(nextEntryPosition,time,nextEntryPosition==startingPoint,cyclic,range,times);
         daten[i]->clearUserData();
     }
+    if ( App::userSettings->graphRecorder&&(!_recorderFailed) )
+        _recordPoint(nextEntryPosition,time);
+}
+
+void CGraph::_recordPoint(int absIndex,float time)
+{ // The recorder restarts when streams are added, removed, or their derivative/integral mode changes
+    std::vector<int> signature;
+    std::vector<float> values;
+    std::vector<unsigned char> validFlags;
+    for (int i=0;i<int(daten.size());i++)
+    {
+        signature.push_back(daten[i]->getIdentifier());
+        signature.push_back(daten[i]->getDerivativeIntegralAndCumulative());
+        float v;
+        validFlags.push_back(daten[i]->getValueRaw(absIndex,v));
+        values.push_back(v);
+    }
+    if ( (_recorder!=NULL)&&(!_recorder->hasSignature(signature)) )
+    {
+        delete _recorder;
+        _recorder=NULL;
+    }
+    if (_recorder==NULL)
+        _recorder=new CGraphRecorder(signature,CGraphRecorder::getNewRecordingFilename(getID()),App::userSettings->graphRecorderCompression);
+    _recorder->addSample(time,values,validFlags);
+    if (!_recorder->isOperational())
+    { // e.g. disk full. We do not keep the history in memory
+        delete _recorder;
+        _recorder=NULL;
+        _recorderFailed=true;
+        App::addStatusbarMessage(IDSNS_GRAPH_RECORDING_STOPPED);
+    }
 }
 bool CGraph::getAbsIndexOfPosition(int pos,int& absIndex) const
 {   // Use this function to loop through all absolute indices until it returns false.
@@ -762,40 +799,51 @@ void CGraph::exportGraphData(VArchive &ar)
     ar << (unsigned char)13;
     ar << (unsigned char)10;
 
-    // Now the data:
-    int pos=0;
-    int absIndex;
-    while (getAbsIndexOfPosition(pos++,absIndex))
+    // Now the data, chunk by chunk (the recorded history can be very long):
+    int pointCount=getHistoryPointCount();
+    std::vector<float> t;
+    std::vector<std::vector<float> > values(daten.size());
+    std::vector<std::vector<unsigned char> > validFlags(daten.size());
+    for (int chunkStart=0;chunkStart<pointCount;chunkStart+=GRAPH_HISTORY_CHUNK_SIZE)
     {
-        float value=times[absIndex];
-        tmp=tt::FNb(0,value,6,false);
-        if (daten.size()!=0)
-            tmp+=",";
-        ar.writeString(tmp);
+        int chunkSize=SIM_MIN(GRAPH_HISTORY_CHUNK_SIZE,pointCount-chunkStart);
+        getHistoryTimes(chunkStart,chunkSize,t);
         for (int k=0;k<int(daten.size());k++)
+            getHistoryData(daten[k],chunkStart,chunkSize,values[k],validFlags[k]);
+        for (int i=0;i<chunkSize;i++)
         {
-            CGraphData* gr=daten[k];
-            bool cyclic;
-            float range;
-            CGraphingRoutines::getCyclicAndRangeValues(gr,cyclic,range);
-            bool dataIsValid=getData(gr,absIndex,value,cyclic,range,true);
-            if (dataIsValid)
-                tmp=tt::FNb(0,value,6,false);
-            else
-                tmp="Null";
-            if (k<(int(daten.size())-1))
+            tmp=tt::FNb(0,t[i],6,false);
+            if (daten.size()!=0)
                 tmp+=",";
             ar.writeString(tmp);
+            for (int k=0;k<int(daten.size());k++)
+            {
+                if (validFlags[k][i]!=0)
+                    tmp=tt::FNb(0,values[k][i],6,false);
+                else
+                    tmp="Null";
+                if (k<(int(daten.size())-1))
+                    tmp+=",";
+                ar.writeString(tmp);
+            }
+            ar << (unsigned char)13;
+            ar << (unsigned char)10;
         }
-        ar << (unsigned char)13;
-        ar << (unsigned char)10;
     }
     ar << (unsigned char)13;
     ar << (unsigned char)10;
 }
 
-bool CGraph::getGraphCurve(int graphType,int index,std::string& label,std::vector<float>& xVals,std::vector<float>& yVals,std::vector<float>& zVals,int& curveType,float col[3],float minMax[6]) const
-{
+bool CGraph::getGraphCurve(int graphType,int index,std::string& label,std::vector<float>& xVals,std::vector<float>& yVals,std::vector<float>& zVals,int& curveType,float col[3],float minMax[6],int firstPoint,int pointCount) const
+{ // firstPoint and pointCount select a range of points of the history (pointCount=-1 for all). Static curves are always returned entirely
+    int historyPointCount=getHistoryPointCount();
+    firstPoint=SIM_MAX(0,SIM_MIN(firstPoint,historyPointCount));
+    int lastPoint=historyPointCount;
+    if (pointCount>=0)
+        lastPoint=SIM_MIN(historyPointCount,firstPoint+pointCount);
+    std::vector<float> t;
+    std::vector<float> values[3];
+    std::vector<unsigned char> validFlags[3];
     if (graphType==0)
     { // time
         for (size_t ind=0;ind<daten.size();ind++)
@@ -814,37 +862,37 @@ bool CGraph::getGraphCurve(int graphType,int index,std::string& label,std::vecto
                     col[1]=gr->ambientColor[1];
                     col[2]=gr->ambientColor[2];
 
-                    int pos=0;
-                    int absIndex;
-                    while (getAbsIndexOfPosition(pos++,absIndex))
+                    for (int chunkStart=firstPoint;chunkStart<lastPoint;chunkStart+=GRAPH_HISTORY_CHUNK_SIZE)
                     {
-                        float xVal=times[absIndex];
-                        float yVal;
-                        bool cyclic;
-                        float range;
-                        CGraphingRoutines::getCyclicAndRangeValues(gr,cyclic,range);
-                        bool dataIsValid=getData(gr,absIndex,yVal,cyclic,range,true);
-                        if (dataIsValid)
+                        int chunkSize=SIM_MIN(GRAPH_HISTORY_CHUNK_SIZE,lastPoint-chunkStart);
+                        getHistoryTimes(chunkStart,chunkSize,t);
+                        getHistoryData(gr,chunkStart,chunkSize,values[0],validFlags[0]);
+                        for (int i=0;i<chunkSize;i++)
                         {
-                            xVals.push_back(xVal);
-                            yVals.push_back(yVal);
-                            if (xVals.size()==1)
-                            {
-                                minMax[0]=xVal;
-                                minMax[1]=xVal;
-                                minMax[2]=yVal;
-                                minMax[3]=yVal;
-                            }
-                            else
+                            if (validFlags[0][i]!=0)
                             {
-                                if (xVal<minMax[0])
+                                float xVal=t[i];
+                                float yVal=values[0][i];
+                                xVals.push_back(xVal);
+                                yVals.push_back(yVal);
+                                if (xVals.size()==1)
+                                {
                                     minMax[0]=xVal;
-                                if (xVal>minMax[1])
                                     minMax[1]=xVal;
-                                if (yVal<minMax[2])
                                     minMax[2]=yVal;
-                                if (yVal>minMax[3])
                                     minMax[3]=yVal;
+                                }
+                                else
+                                {
+                                    if (xVal<minMax[0])
+                                        minMax[0]=xVal;
+                                    if (xVal>minMax[1])
+                                        minMax[1]=xVal;
+                                    if (yVal<minMax[2])
+                                        minMax[2]=yVal;
+                                    if (yVal>minMax[3])
+                                        minMax[3]=yVal;
+                                }
                             }
                         }
                     }
@@ -910,17 +958,9 @@ bool CGraph::getGraphCurve(int graphType,int index,std::string& label,std::vecto
                     col[0]=it->curveColor.colors[0];
                     col[1]=it->curveColor.colors[1];
                     col[2]=it->curveColor.colors[2];
-                    int pos=0;
-                    int absIndex;
                     float val[3];
                     CGraphData* number1=getGraphData(it->data[0]);
                     CGraphData* number2=getGraphData(it->data[1]);
-                    bool cyclic1,cyclic2;
-                    float range1,range2;
-                    if (number1!=NULL)
-                        CGraphingRoutines::getCyclicAndRangeValues(number1,cyclic1,range1);
-                    if (number2!=NULL)
-                        CGraphingRoutines::getCyclicAndRangeValues(number2,cyclic2,range2);
                     label=it->getName()+" (x: ";
                     if (number1!=NULL)
                         label+=CGraphingRoutines::getDataUnit(number1)+") (y: ";
@@ -935,44 +975,54 @@ bool CGraph::getGraphCurve(int graphType,int index,std::string& label,std::vecto
                     else
                         curveType=1;
 
-                    while (getAbsIndexOfPosition(pos++,absIndex))
+                    for (int chunkStart=firstPoint;chunkStart<lastPoint;chunkStart+=GRAPH_HISTORY_CHUNK_SIZE)
                     {
-                        bool dataIsValid=true;
+                        int chunkSize=SIM_MIN(GRAPH_HISTORY_CHUNK_SIZE,lastPoint-chunkStart);
                         if (number1!=NULL)
-                        {
-                            if(!getData(number1,absIndex,val[0],cyclic1,range1,true))
-                                dataIsValid=false;
-                        }
-                        else
-                            val[0]=0.0;
+                            getHistoryData(number1,chunkStart,chunkSize,values[0],validFlags[0]);
                         if (number2!=NULL)
+                            getHistoryData(number2,chunkStart,chunkSize,values[1],validFlags[1]);
+                        for (int i=0;i<chunkSize;i++)
                         {
-                            if(!getData(number2,absIndex,val[1],cyclic2,range2,true))
-                                dataIsValid=false;
-                        }
-                        else
-                            val[1]=0.0;
-                        if (dataIsValid)
-                        {
-                            xVals.push_back(val[0]);
-                            yVals.push_back(val[1]);
-                            if (xVals.size()==1)
+                            bool dataIsValid=true;
+                            if (number1!=NULL)
+                            {
+                                val[0]=values[0][i];
+                                if (validFlags[0][i]==0)
+                                    dataIsValid=false;
+                            }
+                            else
+                                val[0]=0.0;
+                            if (number2!=NULL)
                             {
-                                minMax[0]=val[0];
-                                minMax[1]=val[0];
-                                minMax[2]=val[1];
-                                minMax[3]=val[1];
+                                val[1]=values[1][i];
+                                if (validFlags[1][i]==0)
+                                    dataIsValid=false;
                             }
                             else
+                                val[1]=0.0;
+                            if (dataIsValid)
                             {
-                                if (val[0]<minMax[0])
+                                xVals.push_back(val[0]);
+                                yVals.push_back(val[1]);
+                                if (xVals.size()==1)
+                                {
                                     minMax[0]=val[0];
-                                if (val[0]>minMax[1])
                                     minMax[1]=val[0];
-                                if (val[1]<minMax[2])
                                     minMax[2]=val[1];
-                                if (val[1]>minMax[3])
                                     minMax[3]=val[1];
+                                }
+                                else
+                                {
+                                    if (val[0]<minMax[0])
+                                        minMax[0]=val[0];
+                                    if (val[0]>minMax[1])
+                                        minMax[1]=val[0];
+                                    if (val[1]<minMax[2])
+                                        minMax[2]=val[1];
+                                    if (val[1]>minMax[3])
+                                        minMax[3]=val[1];
+                                }
                             }
                         }
                     }
@@ -1039,20 +1089,10 @@ bool CGraph::getGraphCurve(int graphType,int index,std::string& label,std::vecto
                     col[0]=it->curveColor.colors[0];
                     col[1]=it->curveColor.colors[1];
                     col[2]=it->curveColor.colors[2];
-                    int pos=0;
-                    int absIndex;
                     float val[3];
                     CGraphData* number1=getGraphData(it->data[0]);
                     CGraphData* number2=getGraphData(it->data[1]);
                     CGraphData* number3=getGraphData(it->data[2]);
-                    bool cyclic1,cyclic2,cyclic3;
-                    float range1,range2,range3;
-                    if (number1!=NULL)
-                        CGraphingRoutines::getCyclicAndRangeValues(number1,cyclic1,range1);
-                    if (number2!=NULL)
-                        CGraphingRoutines::getCyclicAndRangeValues(number2,cyclic2,range2);
-                    if (number3!=NULL)
-                        CGraphingRoutines::getCyclicAndRangeValues(number3,cyclic3,range3);
                     label=it->getName()+" (x: ";
                     if (number1!=NULL)
                         label+=CGraphingRoutines::getDataUnit(number1)+") (y: ";
@@ -1071,58 +1111,71 @@ bool CGraph::getGraphCurve(int graphType,int index,std::string& label,std::vecto
                     else
                         curveType=1;
 
-                    while (getAbsIndexOfPosition(pos++,absIndex))
+                    for (int chunkStart=firstPoint;chunkStart<lastPoint;chunkStart+=GRAPH_HISTORY_CHUNK_SIZE)
                     {
-                        bool dataIsValid=true;
+                        int chunkSize=SIM_MIN(GRAPH_HISTORY_CHUNK_SIZE,lastPoint-chunkStart);
                         if (number1!=NULL)
-                        {
-                            if(!getData(number1,absIndex,val[0],cyclic1,range1,true))
-                                dataIsValid=false;
-                        }
-                        else
-                            val[0]=0.0;
+                            getHistoryData(number1,chunkStart,chunkSize,values[0],validFlags[0]);
                         if (number2!=NULL)
-                        {
-                            if(!getData(number2,absIndex,val[1],cyclic2,range2,true))
-                                dataIsValid=false;
-                        }
-                        else
-                            val[1]=0.0;
+                            getHistoryData(number2,chunkStart,chunkSize,values[1],validFlags[1]);
                         if (number3!=NULL)
+                            getHistoryData(number3,chunkStart,chunkSize,values[2],validFlags[2]);
+                        for (int i=0;i<chunkSize;i++)
                         {
-                            if(!getData(number3,absIndex,val[2],cyclic3,range3,true))
-                                dataIsValid=false;
-                        }
-                        else
-                            val[2]=0.0;
-                        if (dataIsValid)
-                        {
-                            xVals.push_back(val[0]);
-                            yVals.push_back(val[1]);
-                            zVals.push_back(val[2]);
-                            if (xVals.size()==1)
+                            bool dataIsValid=true;
+                            if (number1!=NULL)
+                            {
+                                val[0]=values[0][i];
+                                if (validFlags[0][i]==0)
+                                    dataIsValid=false;
+                            }
+                            else
+                                val[0]=0.0;
+                            if (number2!=NULL)
+                            {
+                                val[1]=values[1][i];
+                                if (validFlags[1][i]==0)
+                                    dataIsValid=false;
+                            }
+                            else
+                                val[1]=0.0;
+                            if (number3!=NULL)
                             {
-                                minMax[0]=val[0];
-                                minMax[1]=val[0];
-                                minMax[2]=val[1];
-                                minMax[3]=val[1];
-                                minMax[4]=val[2];
-                                minMax[5]=val[2];
+                                val[2]=values[2][i];
+                                if (validFlags[2][i]==0)
+                                    dataIsValid=false;
                             }
                             else
+                                val[2]=0.0;
+                            if (dataIsValid)
                             {
-                                if (val[0]<minMax[0])
+                                xVals.push_back(val[0]);
+                                yVals.push_back(val[1]);
+                                zVals.push_back(val[2]);
+                                if (xVals.size()==1)
+                                {
                                     minMax[0]=val[0];
-                                if (val[0]>minMax[1])
                                     minMax[1]=val[0];
-                                if (val[1]<minMax[2])
                                     minMax[2]=val[1];
-                                if (val[1]>minMax[3])
                                     minMax[3]=val[1];
-                                if (val[2]<minMax[4])
                                     minMax[4]=val[2];
-                                if (val[2]>minMax[5])
                                     minMax[5]=val[2];
+                                }
+                                else
+                                {
+                                    if (val[0]<minMax[0])
+                                        minMax[0]=val[0];
+                                    if (val[0]>minMax[1])
+                                        minMax[1]=val[0];
+                                    if (val[1]<minMax[2])
+                                        minMax[2]=val[1];
+                                    if (val[1]>minMax[3])
+                                        minMax[3]=val[1];
+                                    if (val[2]<minMax[4])
+                                        minMax[4]=val[2];
+                                    if (val[2]>minMax[5])
+                                        minMax[5]=val[2];
+                                }
                             }
                         }
                     }
@@ -1727,8 +1780,97 @@ bool CGraph::getData(const CGraphData* it,int pos,float& outputValue,bool cyclic
     return(cumulativeValueCount>0);
 }
 
+bool CGraph::_isHistoryRecorded() const
+{ // After a restart, the recorder is used once it holds at least as many points as the buffer
+    return( (_recorder!=NULL)&&(_recorder->getSampleCount()>=numberOfPoints) );
+}
+
+int CGraph::getHistoryPointCount() const
+{ // Points of the complete history if recorded, otherwise of the buffer. Use with getHistoryTimes and getHistoryData
+    if (_isHistoryRecorded())
+        return(_recorder->getSampleCount());
+    return(numberOfPoints);
+}
+
+void CGraph::getHistoryTimes(int firstPos,int count,std::vector<float>& t) const
+{
+    if (_isHistoryRecorded())
+        _recorder->getTimes(firstPos,count,t);
+    else
+    {
+        t.resize(count);
+        for (int i=0;i<count;i++)
+        {
+            int absIndex;
+            if (getAbsIndexOfPosition(firstPos+i,absIndex))
+                t[i]=times[absIndex];
+            else
+                t[i]=0.0f;
+        }
+    }
+}
+
+void CGraph::getHistoryData(const CGraphData* it,int firstPos,int count,std::vector<float>& values,std::vector<unsigned char>& validFlags) const
+{ // Same values as getData (with unit conversion), for a range of positions
+    values.assign(count,0.0f);
+    validFlags.assign(count,0);
+    if (!_isHistoryRecorded())
+    {
+        bool cyclic;
+        float range;
+        CGraphingRoutines::getCyclicAndRangeValues(it,cyclic,range);
+        for (int i=0;i<count;i++)
+        {
+            int absIndex;
+            if (getAbsIndexOfPosition(firstPos+i,absIndex))
+                validFlags[i]=getData(it,absIndex,values[i],cyclic,range,true);
+        }
+        return;
+    }
+    int streamIndex=_recorder->getStreamIndex(it->getIdentifier());
+    if (streamIndex<0)
+        return;
+    // The moving average also needs the points before the range:
+    int movingAverageCount=it->getMovingAverageCount();
+    int preCount=SIM_MIN(movingAverageCount-1,firstPos);
+    std::vector<float> raw;
+    std::vector<unsigned char> rawValid;
+    _recorder->getValues(streamIndex,firstPos-preCount,count+preCount,raw,rawValid);
+    for (int i=0;i<int(raw.size());i++)
+    {
+        if (rawValid[i]!=0)
+        {
+            raw[i]=raw[i]*it->getZoomFactor()+it->getAddCoeff();
+            CGraphingRoutines::adjustDataToUserMetric(it,raw[i],it->getDerivativeIntegralAndCumulative());
+        }
+    }
+    for (int i=0;i<count;i++)
+    {
+        int pos=preCount+i;
+        if (rawValid[pos]==0)
+            continue;
+        if (firstPos+i<movingAverageCount-1)
+            continue; // not enough values from the first point
+        float cumulativeValue=0.0f;
+        int cumulativeValueCount=0;
+        for (int j=0;j<movingAverageCount;j++)
+        {
+            if (rawValid[pos-j]!=0)
+            {
+                cumulativeValue+=raw[pos-j];
+                cumulativeValueCount++;
+            }
+        }
+        values[i]=cumulativeValue/float(cumulativeValueCount);
+        validFlags[i]=1;
+    }
+}
+
 void CGraph::resetGraph()
 {
+    delete _recorder;
+    _recorder=NULL;
+    _recorderFailed=false;
     numberOfPoints=0;
     startingPoint=0;
     times.reserve(bufferSize);
@@ -4,6 +4,7 @@
 #include "3DObject.h"
 #include "graphData.h"
 #include "graphDataComb.h"
+#include "graphRecorder.h"
 #include "staticGraphCurve.h"
 #include "sView.h"
 #include "VPoint.h"
@@ -54,7 +55,7 @@ public:
     bool isPotentiallyCuttable() const;
 
     // Various
-    bool getGraphCurve(int graphType,int index,std::string& label,std::vector<float>& xVals,std::vector<float>& yVals,std::vector<float>& zVals,int& curveType,float col[3],float minMax[6]) const;
+    bool getGraphCurve(int graphType,int index,std::string& label,std::vector<float>& xVals,std::vector<float>& yVals,std::vector<float>& zVals,int& curveType,float col[3],float minMax[6],int firstPoint=0,int pointCount=-1) const;
     void curveToClipboard(int graphType,const std::string& curveName) const;
     void curveToStatic(int graphType,const std::string& curveName);
     void removeStaticCurve(int graphType,const std::string& curveName);
@@ -90,6 +91,9 @@ public:
     void setJustDrawCurves(bool justCurves);
     bool getJustDrawCurves() const;
     bool getData(const CGraphData* it,int pos,float& outputValue,bool cyclic,float range,bool doUnitConversion) const;
+    int getHistoryPointCount() const;
+    void getHistoryTimes(int firstPos,int count,std::vector<float>& t) const;
+    void getHistoryData(const CGraphData* it,int firstPos,int count,std::vector<float>& values,std::vector<unsigned char>& validFlags) const;
 
     void exportGraphData(VArchive &ar);
 
@@ -119,6 +123,8 @@ public:
 
 protected:
     CStaticGraphCurve* getStaticCurveFromName(int type,const std::string& name);
+    void _recordPoint(int absIndex,float time);
+    bool _isHistoryRecorded() const;
 
     // Variables which need to be serialized & copied
     CVisualParam color;
@@ -140,6 +146,8 @@ protected:
 
     bool _initialValuesInitialized;
     bool _initialExplicitHandling;
+    CGraphRecorder* _recorder; // complete history, not serialized nor copied
+    bool _recorderFailed; // the history could not be spilled: the buffer behaves as without recording, until the next reset
 
 
 #ifdef SIM_WITH_GUI
@@ -0,0 +1,374 @@
+#include "vrepMainHeader.h"
+#include "graphRecorder.h"
+#include "vVarious.h"
+#include "app.h"
+#include <boost/lexical_cast.hpp>
+#include <string.h>
+
+#define GRAPH_RECORDER_BLOCK_SIZE 4096 // samples per block
+
+VMutex CGraphRecorder::_filenameMutex;
+int CGraphRecorder::_filenameCounter=0;
+
+CGraphRecorder::CGraphRecorder(const std::vector<int>& streamSignature,const std::string& filename,bool compress)
+{
+    _streamSignature.assign(streamSignature.begin(),streamSignature.end());
+    _streamCount=int(_streamSignature.size()/2);
+    _compress=compress;
+    _filename=filename;
+    _fileSize=0;
+    _sampleCount=0;
+    _readFile=NULL;
+    _openTimes.reserve(GRAPH_RECORDER_BLOCK_SIZE);
+    _openValues.resize(_streamCount);
+    _openValidFlags.resize(_streamCount);
+    for (int i=0;i<_streamCount;i++)
+    {
+        _openValues[i].reserve(GRAPH_RECORDER_BLOCK_SIZE);
+        _openValidFlags[i].reserve(GRAPH_RECORDER_BLOCK_SIZE);
+    }
+    try
+    {
+        _file=new VFile(_filename,VFile::CREATE_WRITE|VFile::SHARE_DENY_NONE); // also creates the folder if needed
+    }
+    catch(VFILE_EXCEPTION_TYPE e)
+    { // the recorder is not operational
+        _file=NULL;
+    }
+}
+
+CGraphRecorder::~CGraphRecorder()
+{
+    _closeFiles();
+}
+
+void CGraphRecorder::_closeFiles()
+{
+    if (_readFile!=NULL)
+    {
+        _readFile->close();
+        delete _readFile;
+        _readFile=NULL;
+    }
+    if (_file!=NULL)
+    {
+        _file->close();
+        delete _file;
+        _file=NULL;
+        if (VFile::doesFileExist(_filename))
+            VFile::eraseFile(_filename);
+    }
+}
+
+std::string CGraphRecorder::getRecordingFolder()
+{
+    if (App::userSettings->graphRecorderFolder.length()!=0)
+    {
+        std::string retVal(App::userSettings->graphRecorderFolder);
+        VVarious::removePathFinalSlashOrBackslash(retVal);
+        return(retVal);
+    }
+    return(App::directories->executableDirectory+VREP_SLASH+"graphRecordings");
+}
+
+std::string CGraphRecorder::getNewRecordingFilename(int graphHandle)
+{ // The file is only a spill area for the current history, and is erased when the recorder is destroyed
+    _filenameMutex.lock_simple();
+    std::string retVal(getRecordingFolder()+VREP_SLASH+"graph"+boost::lexical_cast<std::string>(graphHandle)+"_");
+    retVal+=boost::lexical_cast<std::string>(_filenameCounter++)+"_"+boost::lexical_cast<std::string>(rand())+".vgr";
+    _filenameMutex.unlock_simple();
+    return(retVal);
+}
+
+bool CGraphRecorder::hasSignature(const std::vector<int>& streamSignature) const
+{
+    return(streamSignature==_streamSignature);
+}
+
+int CGraphRecorder::getStreamIndex(int streamIdentifier) const
+{ // returns -1 if the stream is not recorded
+    for (int i=0;i<_streamCount;i++)
+    {
+        if (_streamSignature[2*i+0]==streamIdentifier)
+            return(i);
+    }
+    return(-1);
+}
+
+int CGraphRecorder::getSampleCount() const
+{
+    return(_sampleCount);
+}
+
+quint64 CGraphRecorder::getSpilledByteCount() const
+{
+    return(_fileSize);
+}
+
+bool CGraphRecorder::isOperational() const
+{ // false if the file could not be created or written (e.g. disk full). Holding the history in memory instead
+  // would make memory usage grow without limit: the caller should discard the recorder
+    return(_file!=NULL);
+}
+
+void CGraphRecorder::addSample(float time,const std::vector<float>& values,const std::vector<unsigned char>& validFlags)
+{
+    if (_file==NULL)
+        return;
+    _openTimes.push_back(time);
+    for (int i=0;i<_streamCount;i++)
+    {
+        _openValues[i].push_back(values[i]);
+        _openValidFlags[i].push_back(validFlags[i]);
+    }
+    _sampleCount++;
+    if (int(_openTimes.size())>=GRAPH_RECORDER_BLOCK_SIZE)
+        _closeBlock();
+}
+
+void CGraphRecorder::getTimes(int firstSample,int sampleCount,std::vector<float>& times) const
+{
+    _readColumn(0,firstSample,sampleCount,times,NULL);
+}
+
+void CGraphRecorder::getValues(int streamIndex,int firstSample,int sampleCount,std::vector<float>& values,std::vector<unsigned char>& validFlags) const
+{
+    _readColumn(streamIndex+1,firstSample,sampleCount,values,&validFlags);
+}
+
+void CGraphRecorder::_closeBlock()
+{
+    SGraphRecorderBlock block;
+    block.firstSample=_sampleCount-int(_openTimes.size());
+    block.sampleCount=int(_openTimes.size());
+    block.fileOffset=0;
+    std::vector<unsigned char> data;
+    data.reserve(block.sampleCount*(_streamCount+1)*sizeof(float));
+    _appendColumn(_openTimes,NULL,_compress,data);
+    block.columnSizes.push_back(int(data.size()));
+    for (int i=0;i<_streamCount;i++)
+    {
+        size_t s=data.size();
+        _appendColumn(_openValues[i],&_openValidFlags[i],_compress,data);
+        block.columnSizes.push_back(int(data.size()-s));
+    }
+
+    bool spilled=false;
+    if (_file!=NULL)
+    {
+#ifdef SIM_WITHOUT_QT_AT_ALL
+        _file->getFile()->write((const char*)&data[0],data.size());
+        spilled=!_file->getFile()->fail();
+#else
+        spilled=(_file->getFile()->write((const char*)&data[0],data.size())==qint64(data.size()));
+#endif
+        spilled=spilled&&_file->flush(); // the data must be visible to readers
+    }
+    if (spilled)
+    {
+        block.fileOffset=_fileSize;
+        _fileSize+=data.size();
+        _blocks.push_back(block);
+    }
+    else
+    { // the file is not usable anymore (e.g. disk full): we drop everything
+        _closeFiles();
+        _blocks.clear();
+        _fileSize=0;
+        _sampleCount=0;
+    }
+
+    _openTimes.clear();
+    for (int i=0;i<_streamCount;i++)
+    {
+        _openValues[i].clear();
+        _openValidFlags[i].clear();
+    }
+}
+
+void CGraphRecorder::_readColumn(int column,int firstSample,int sampleCount,std::vector<float>& values,std::vector<unsigned char>* validFlags) const
+{ // Samples that are not available are returned as invalid (0.0)
+    values.assign(sampleCount,0.0f);
+    if (validFlags!=NULL)
+        validFlags->assign(sampleCount,0);
+    if ( (_file==NULL)||(firstSample<0)||(sampleCount<=0)||(firstSample+sampleCount>_sampleCount) )
+        return;
+
+    // Find the first block that overlaps the range:
+    int lo=0;
+    int hi=int(_blocks.size());
+    while (lo<hi)
+    {
+        int mid=(lo+hi)/2;
+        if (_blocks[mid].firstSample+_blocks[mid].sampleCount<=firstSample)
+            lo=mid+1;
+        else
+            hi=mid;
+    }
+
+    std::vector<float> blockValues;
+    std::vector<unsigned char> blockFlags;
+    std::vector<unsigned char> buffer;
+    for (int b=lo;b<int(_blocks.size());b++)
+    {
+        const SGraphRecorderBlock& block=_blocks[b];
+        if (block.firstSample>=firstSample+sampleCount)
+            break;
+        quint64 columnOffset=0;
+        for (int i=0;i<column;i++)
+            columnOffset+=block.columnSizes[i];
+        int columnSize=block.columnSizes[column];
+        const unsigned char* columnData=NULL;
+#ifndef SIM_WITHOUT_QT_AT_ALL
+        uchar* mapped=NULL;
+#endif
+        if (_readFile==NULL)
+        {
+            try
+            {
+                _readFile=new VFile(_filename,VFile::READ|VFile::SHARE_DENY_NONE);
+            }
+            catch(VFILE_EXCEPTION_TYPE e)
+            {
+                _readFile=NULL;
+            }
+        }
+        if (_readFile==NULL)
+            break;
+#ifndef SIM_WITHOUT_QT_AT_ALL
+        mapped=_readFile->getFile()->map(block.fileOffset+columnOffset,columnSize);
+        if (mapped!=NULL)
+            columnData=mapped;
+        else
+        {
+            buffer.resize(columnSize);
+            if ( _readFile->getFile()->seek(block.fileOffset+columnOffset)&&(_readFile->getFile()->read((char*)&buffer[0],columnSize)==qint64(columnSize)) )
+                columnData=&buffer[0];
+        }
+#else
+        buffer.resize(columnSize);
+        _readFile->getFile()->seekg(block.fileOffset+columnOffset,std::ios::beg);
+        _readFile->getFile()->read((char*)&buffer[0],columnSize);
+        if (!_readFile->getFile()->fail())
+            columnData=&buffer[0];
+        else
+            _readFile->getFile()->clear();
+#endif
+        if (columnData!=NULL)
+        {
+            blockValues.resize(block.sampleCount);
+            blockFlags.resize(block.sampleCount);
+            _decodeColumn(columnData,block.sampleCount,column!=0,_compress,&blockValues[0],&blockFlags[0]);
+            int s=SIM_MAX(firstSample,block.firstSample);
+            int e=SIM_MIN(firstSample+sampleCount,block.firstSample+block.sampleCount);
+            for (int i=s;i<e;i++)
+            {
+                values[i-firstSample]=blockValues[i-block.firstSample];
+                if (validFlags!=NULL)
+                    validFlags->at(i-firstSample)=blockFlags[i-block.firstSample];
+            }
+        }
+#ifndef SIM_WITHOUT_QT_AT_ALL
+        if (mapped!=NULL)
+            _readFile->getFile()->unmap(mapped);
+#endif
+    }
+
+    // Samples of the block currently being filled:
+    int openFirstSample=_sampleCount-int(_openTimes.size());
+    int s=SIM_MAX(firstSample,openFirstSample);
+    int e=firstSample+sampleCount;
+    for (int i=s;i<e;i++)
+    {
+        if (column==0)
+            values[i-firstSample]=_openTimes[i-openFirstSample];
+        else
+        {
+            values[i-firstSample]=_openValues[column-1][i-openFirstSample];
+            validFlags->at(i-firstSample)=_openValidFlags[column-1][i-openFirstSample];
+        }
+    }
+}
+
+void CGraphRecorder::_appendColumn(const std::vector<float>& values,const std::vector<unsigned char>* validFlags,bool compress,std::vector<unsigned char>& out)
+{ // Stream columns start with the valid flags, as a bit field. Values are either stored as is, or XORed with
+  // the previous value. In that case, we only store the bytes between the leading and trailing zero bytes, and a
+  // header byte with their counts: slowly changing or constant signals, and regular time steps shrink well
+    if (validFlags!=NULL)
+    {
+        size_t s=out.size();
+        out.resize(s+(values.size()+7)/8,0);
+        for (size_t i=0;i<values.size();i++)
+        {
+            if (validFlags->at(i)!=0)
+                out[s+i/8]|=(1<<(i&7));
+        }
+    }
+    unsigned int previous=0;
+    for (size_t i=0;i<values.size();i++)
+    {
+        unsigned int w;
+        memcpy(&w,&values[i],sizeof(w));
+        if (!compress)
+        {
+            for (int j=0;j<4;j++)
+                out.push_back((unsigned char)(w>>(8*j)));
+        }
+        else
+        {
+            unsigned int x=w^previous;
+            previous=w;
+            int leading=4;
+            int trailing=0;
+            if (x!=0)
+            {
+                leading=0;
+                while ((x>>(8*(3-leading)))==0)
+                    leading++;
+                while (((x>>(8*trailing))&255)==0)
+                    trailing++;
+            }
+            out.push_back((unsigned char)(leading|(trailing<<4)));
+            for (int j=trailing;j<4-leading;j++)
+                out.push_back((unsigned char)(x>>(8*j)));
+        }
+    }
+}
+
+void CGraphRecorder::_decodeColumn(const unsigned char* data,int sampleCount,bool hasValidFlags,bool compress,float* values,unsigned char* validFlags)
+{
+    if (hasValidFlags)
+    {
+        for (int i=0;i<sampleCount;i++)
+            validFlags[i]=(data[i/8]>>(i&7))&1;
+        data+=(sampleCount+7)/8;
+    }
+    else
+    {
+        for (int i=0;i<sampleCount;i++)
+            validFlags[i]=1;
+    }
+    unsigned int previous=0;
+    for (int i=0;i<sampleCount;i++)
+    {
+        unsigned int w=0;
+        if (!compress)
+        {
+            for (int j=0;j<4;j++)
+                w|=((unsigned int)data[j])<<(8*j);
+            data+=4;
+        }
+        else
+        {
+            int leading=data[0]&15;
+            int trailing=data[0]>>4;
+            data++;
+            unsigned int x=0;
+            for (int j=trailing;j<4-leading;j++)
+                x|=((unsigned int)(*data++))<<(8*j);
+            w=x^previous;
+            previous=w;
+        }
+        memcpy(values+i,&w,sizeof(w));
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "vrepMainHeader.h"
+#include "vFile.h"
+#include "vMutex.h"
+
+struct SGraphRecorderBlock
+{
+    int firstSample;
+    int sampleCount;
+    quint64 fileOffset;
+    std::vector<int> columnSizes; // in bytes. Column 0 holds the times, column i+1 the flags and values of stream i
+};
+
+// Records the complete history of a graph, in columnar blocks of fixed size. Closed blocks are
+// (optionally) compressed and appended to a binary file, so that memory usage stays constant.
+// Ranges of samples are read back block by block (via memory mapping when available). If the file
+// cannot be written, the recorder drops its data and is not operational anymore
+class CGraphRecorder
+{
+public:
+    CGraphRecorder(const std::vector<int>& streamSignature,const std::string& filename,bool compress);
+    virtual ~CGraphRecorder();
+
+    bool hasSignature(const std::vector<int>& streamSignature) const;
+    int getStreamIndex(int streamIdentifier) const;
+    void addSample(float time,const std::vector<float>& values,const std::vector<unsigned char>& validFlags);
+    int getSampleCount() const;
+    quint64 getSpilledByteCount() const;
+    bool isOperational() const;
+
+    void getTimes(int firstSample,int sampleCount,std::vector<float>& times) const;
+    void getValues(int streamIndex,int firstSample,int sampleCount,std::vector<float>& values,std::vector<unsigned char>& validFlags) const;
+
+    static std::string getRecordingFolder();
+    static std::string getNewRecordingFilename(int graphHandle);
+
+private:
+    void _readColumn(int column,int firstSample,int sampleCount,std::vector<float>& values,std::vector<unsigned char>* validFlags) const;
+    void _closeBlock();
+    void _closeFiles();
+    static void _appendColumn(const std::vector<float>& values,const std::vector<unsigned char>* validFlags,bool compress,std::vector<unsigned char>& out);
+    static void _decodeColumn(const unsigned char* data,int sampleCount,bool hasValidFlags,bool compress,float* values,unsigned char* validFlags);
+
+    std::vector<int> _streamSignature; // identifier and derivative/integral mode of each stream
+    int _streamCount;
+    bool _compress;
+    std::string _filename;
+    VFile* _file;
+    mutable VFile* _readFile; // opened with the first read, then kept open
+    quint64 _fileSize;
+    int _sampleCount;
+    std::vector<SGraphRecorderBlock> _blocks;
+
+    // The block currently being filled, column-wise:
+    std::vector<float> _openTimes;
+    std::vector<std::vector<float> > _openValues;
+    std::vector<std::vector<unsigned char> > _openValidFlags;
+
+    static VMutex _filenameMutex;
+    static int _filenameCounter;
+};
@@ -266,6 +266,7 @@ void CJoint::setHybridFunctionality(bool h)
         if (_jointType==sim_joint_revolute_subtype)
         {
             _screwPitch=0.0f;
+            localTransformationChanged();
 // REMOVED FOLLOWING ON 24/7/2015: causes problem when switching modes. The physics engine plugin will now not set limits if the range>=360
 //          _jointPositionRange=tt::getLimitedFloat(0.0f,piValTimes2_f,_jointPositionRange);
 //          setPosition(getPosition()); // to make sure it is within range (will also get/set velocity)
@@ -871,6 +872,7 @@ void CJoint::setDynamicMotorReflectedPosition_useOnlyFromDynamicPart(float rfp)
         // Turn count is taken care by the physics plugin.
 
         _jointPosition=rfp;
+        localTransformationChanged();
     }
     _rectifyDependentJoints(false);
 }
@@ -1000,6 +1002,7 @@ void CJoint::simulationEnded()
     {
         _jointPosition=_initialPosition;
         _sphericalTransformation=_initialSphericalJointTransformation;
+        localTransformationChanged();
 
         _dynamicMotorEnabled=_initialDynamicMotorEnabled;
         _dynamicMotorTargetVelocity=_initialDynamicMotorTargetVelocity;
@@ -1307,6 +1310,7 @@ void CJoint::setScrewPitch(float pitch)
         { // no pitch when in torque/force mode
             pitch=tt::getLimitedFloat(-10.0f,10.0f,pitch);
             _screwPitch=pitch;
+            localTransformationChanged();
             if (_screwPitch!=0.0f)
                 _jointHasHybridFunctionality=false;
         }
@@ -1385,6 +1389,7 @@ void CJoint::scaleObject(float scalingFactor)
     _diameter*=scalingFactor;
     _length*=scalingFactor;
     _screwPitch*=scalingFactor;
+    localTransformationChanged(); // joint value and screw pitch are part of the local transformation
     if (_jointType==sim_joint_prismatic_subtype)
     {
         _jointPosition*=scalingFactor;
@@ -1466,6 +1471,7 @@ void CJoint::scaleObjectNonIsometrically(float x,float y,float z)
     _diameter*=diam;
     _length*=z;
     _screwPitch*=z;
+    localTransformationChanged(); // joint value and screw pitch are part of the local transformation
     if (_jointType==sim_joint_prismatic_subtype)
     {
         _jointPosition*=z;
@@ -1841,6 +1847,7 @@ void CJoint::setPositionIsCyclic(bool isCyclic)
         if (getJointType()==sim_joint_revolute_subtype)
         {
             _screwPitch=0.0f;
+            localTransformationChanged();
             _jointMinPosition=-piValue_f;
             _jointPositionRange=piValTimes2_f;
             _positionIsCyclic=isCyclic;
@@ -2617,6 +2624,7 @@ void CJoint::setJointMode(int theMode,bool correctDynMotorTargetPositions/*=true
     {
         _jointHasHybridFunctionality=false;
         _screwPitch=0.0f;
+        localTransformationChanged();
 // REMOVED FOLLOWING ON 24/7/2015: causes problem when switching modes. The physics engine plugin will now not set limits if the range>=360
 //      if (_jointType==sim_joint_revolute_subtype)
 //          _jointPositionRange=tt::getLimitedFloat(0.0f,piValTimes2_f,_jointPositionRange); // new since 18/11/2012 (was forgotten)
@@ -2687,6 +2695,11 @@ float CJoint::getScrewPitch() const
 
 void CJoint::setSphericalTransformation(const C4Vector& tr)
 {
+    _setSphericalTransformation(tr,true);
+}
+
+void CJoint::_setSphericalTransformation(const C4Vector& tr,bool invalidateTransformationCache)
+{ // invalidateTransformationCache is false when the previous value is restored before any cumulative transformation is read
     C4Vector transf(tr);
     if (_jointPositionRange<piValue_f*0.99f)
     {
@@ -2700,7 +2713,12 @@ void CJoint::setSphericalTransformation(const C4Vector& tr)
             transf=rot*transf;
         }
     }
+    bool changed=false;
+    for (int i=0;i<4;i++)
+        changed|=(_sphericalTransformation(i)!=transf(i));
     _sphericalTransformation=transf;
+    if (changed&&invalidateTransformationCache)
+        localTransformationChanged();
 }
 
 C4Vector CJoint::getSphericalTransformation() const
@@ -2782,6 +2800,8 @@ void CJoint::setPosition(float parameter,bool useTempValues)
         else
             _jointPosition=linked+_dependencyJointFact;
     }
+    if (!useTempValues)
+        localTransformationChanged();
     _rectifyDependentJoints(useTempValues);
     setVelocity_DEPRECATED(getVelocity_DEPRECATED()); // To make sure velocity is within allowed range
 }
@@ -2922,18 +2942,18 @@ void CJoint::setTempParameterEx(float parameter,int index)
     if (_sphericalTransformation_eulerLockTempForIK==0)
     { // Spherical joint limitations are not activated in the IK algorithm (but if we come close to the limit, it might get activated in next pass!)
         C4Vector saved(_sphericalTransformation);
-        applyTempParametersEx();
+        _applyTempParametersEx(false);
         C4Vector tr(saved.getInverse()*_sphericalTransformation);
         C3Vector euler(tr.getEulerAngles());
         _sphericalTransformation_euler1TempForIK=euler(0);
         _sphericalTransformation_euler2TempForIK=euler(1);
         _sphericalTransformation_euler3TempForIK=euler(2);
-        _sphericalTransformation=saved;
+        _sphericalTransformation=saved; // unchanged: the transformation caches are still valid
     }
     else
     { // Spherical joint limitations are activated in the IK algorithm
         C4Vector saved(_sphericalTransformation);
-        applyTempParametersEx();
+        _applyTempParametersEx(false);
 
         C3X3Matrix m(_sphericalTransformation);
 
@@ -2965,17 +2985,22 @@ void CJoint::setTempParameterEx(float parameter,int index)
             _sphericalTransformation_euler2TempForIK=0.0f;
             _sphericalTransformation_euler3TempForIK=0.0f;
         }
-        _sphericalTransformation=saved;
+        _sphericalTransformation=saved; // unchanged: the transformation caches are still valid
     }
 }
 
 void CJoint::applyTempParametersEx()
+{
+    _applyTempParametersEx(true);
+}
+
+void CJoint::_applyTempParametersEx(bool invalidateTransformationCache)
 {
     if (_jointType==sim_joint_spherical_subtype)
     {
         C7Vector tr1(getLocalTransformationPart1(true));
         C7Vector tr2(getLocalTransformation(true));
-        setSphericalTransformation(tr1.Q.getInverse()*tr2.Q);
+        _setSphericalTransformation(tr1.Q.getInverse()*tr2.Q,invalidateTransformationCache);
     }
 }
 
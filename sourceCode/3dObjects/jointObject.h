@@ -302,6 +302,8 @@ public:
     float getMaxStepSize();
 
     void _rectifyDependentJoints(bool useTempValues);
+    void _applyTempParametersEx(bool invalidateTransformationCache);
+    void _setSphericalTransformation(const C4Vector& tr,bool invalidateTransformationCache);
 
     void setJointMode(int theMode,bool correctDynMotorTargetPositions=true);
     int getJointMode();
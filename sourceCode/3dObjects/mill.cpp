@@ -9,6 +9,7 @@
 #include "ttUtil.h"
 #include "easyLock.h"
 #include "app.h"
+#include "stepProfiler.h"
 #include "pluginContainer.h"
 #include "millRendering.h"
 
@@ -427,6 +428,7 @@ int CMill::handleMill(bool exceptExplicitHandling,float& milledSurface,float& mi
     if (!CPluginContainer::isMeshPluginAvailable())
         return(0);
 
+    CStepProfilerScope profilerScope(PROFILER_CATEGORY_MILL,_objectID);
     int stTime=VDateTime::getTimeInMs();
 
     // For now:
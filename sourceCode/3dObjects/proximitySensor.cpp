@@ -10,6 +10,7 @@
 #include "easyLock.h"
 #include "app.h"
 #include "pluginContainer.h"
+#include "stepProfiler.h"
 #include "proximitySensorRendering.h"
 
 CProxSensor::CProxSensor(int theType)
@@ -715,6 +716,7 @@ bool CProxSensor::handleSensor(bool exceptExplicitHandling,int& detectedObjectHa
 
     _sensorResultValid=true;
 
+    CStepProfilerScope profilerScope(PROFILER_CATEGORY_PROXIMITY_SENSOR,_objectID);
     int stTime=VDateTime::getTimeInMs();
 
     float treshhold=SIM_MAX_FLOAT;
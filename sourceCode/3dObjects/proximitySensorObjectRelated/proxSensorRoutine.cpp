@@ -4,8 +4,22 @@
 #include "pluginContainer.h"
 #include "app.h"
 #include "tt.h"
+#include "workerPool.h"
 
 SOcclusionCheckDat CProxSensorRoutine::_occlusionCheckDat;
+bool CProxSensorRoutine::_batchActive=false;
+bool CProxSensorRoutine::_batchRunsConcurrently=false;
+std::map<std::pair<int,int>,std::vector<C3DObject*> > CProxSensorRoutine::_batchDetectableGroups;
+
+struct SProxSensorHandlingTask
+{
+    const std::vector<CProxSensor*>* sensors;
+    const std::vector<int>* sensorIndices;
+    bool exceptExplicitHandling;
+    std::vector<char>* detected;
+    std::vector<int>* detectedObjectHandles;
+    std::vector<C3Vector>* detectedNormalVectors;
+};
 
 bool CProxSensorRoutine::detectEntity(int sensorID,int entityID,bool closestFeatureMode,bool angleLimitation,float maxAngle,C3Vector& detectedPt,float& dist,bool frontFace,bool backFace,int& detectedObject,float minThreshold,C3Vector& triNormal,bool overrideDetectableFlagIfNonCollection,bool checkOcclusions)
 { // entityID==-1 --> checks all objects in the scene
@@ -15,7 +29,8 @@ bool CProxSensorRoutine::detectEntity(int sensorID,int entityID,bool closestFeat
     C3DObject* object=App::ct->objCont->getObject(entityID);
     if (sensor==NULL)
         return(false); // should never happen!
-    App::ct->calcInfo->proximitySensorSimulationStart();
+    if (!_batchRunsConcurrently)
+        App::ct->calcInfo->proximitySensorSimulationStart(); // otherwise accounted for in handleSensors
     if (sensor->getRandomizedDetection())
     {
         if (sensor->getSensorType()!=sim_proximitysensor_ray_subtype)
@@ -40,21 +55,24 @@ bool CProxSensorRoutine::detectEntity(int sensorID,int entityID,bool closestFeat
     else
     {
         std::vector<C3DObject*> group;
-        if (entityID==-1)
-        { // Special group here (all detectable objects):
-            std::vector<C3DObject*> exception;
-            App::ct->objCont->getAllDetectableObjectsFromSceneExcept(&exception,group,sensor->getSensableType());
-        }
-        else
-        { // Regular group here:
-            App::ct->collections->getDetectableObjectsFromCollection(entityID,group,sensor->getSensableType());
-        }
+        _getDetectableGroup(sensor,entityID,group);
         if (group.size()!=0)
         {
             _orderGroupAccordingToApproxDistanceToSensingPoint(sensor,group);
             OCCLUSION_CHECK_CALLBACK occlusionCheckCallback=_prepareOcclusionCheck(sensor,group,frontFace,backFace,checkOcclusions);
+            bool cullWithBroadPhase=_batchActive&&CCollisionBroadPhase::isActive();
+            SBroadPhaseBox sensorBox;
+            if (cullWithBroadPhase)
+            {
+                C4X4Matrix sensorM;
+                C3Vector sensorHalfSize;
+                sensor->getSensingVolumeOBB(sensorM,sensorHalfSize);
+                CCollisionBroadPhase::getBox(sensorM,sensorHalfSize,sensorBox);
+            }
             for (size_t i=0;i<group.size();i++)
             {
+                if ( cullWithBroadPhase&&(!_mightSensorVolumeOverlapWithObject(sensorBox,group[i])) )
+                    continue; // _detectObject would not detect it either
                 int detectObjId=_detectObject(sensor,group[i],detectedPt,dist,triNormal,closestFeatureMode,angleLimitation,maxAngle,frontFace,backFace,minThreshold,occlusionCheckCallback);
                 returnValue|=(detectObjId>=0);
                 if (detectObjId>=0)
@@ -71,10 +89,149 @@ bool CProxSensorRoutine::detectEntity(int sensorID,int entityID,bool closestFeat
 
     if (returnValue)
         triNormal.normalize();
-    App::ct->calcInfo->proximitySensorSimulationEnd(returnValue);
+    if (!_batchRunsConcurrently)
+        App::ct->calcInfo->proximitySensorSimulationEnd(returnValue);
     return(returnValue);
 }
 
+void CProxSensorRoutine::handleSensors(const std::vector<CProxSensor*>& sensors,bool exceptExplicitHandling,std::vector<char>& detected,std::vector<int>& detectedObjectHandles,std::vector<C3Vector>& detectedNormalVectors)
+{ // Sensors share the scene culling (broad phase boxes and detectable groups). Sensors without
+  // randomized detection and without occlusion check can be handled concurrently by the worker threads
+    detected.assign(sensors.size(),0);
+    detectedObjectHandles.assign(sensors.size(),-1);
+    detectedNormalVectors.assign(sensors.size(),C3Vector::zeroVector);
+    bool releaseBroadPhase=false;
+    if (!CCollisionBroadPhase::isActive())
+        releaseBroadPhase=CCollisionBroadPhase::build(); // refused if another thread uses it
+    _batchActive=true;
+
+    bool concurrent=App::userSettings->parallelProximitySensing&&(CWorkerPool::getEffectiveWorkerCount()>0)&&App::ct->mainSettings->proximitySensorsEnabled&&CPluginContainer::isMeshPluginAvailable();
+    std::vector<int> concurrentSensors;
+    for (size_t i=0;i<sensors.size();i++)
+    {
+        if ( concurrent&&_canSensorBeHandledConcurrently(sensors[i])&&(!(exceptExplicitHandling&&sensors[i]->getExplicitHandling())) )
+            concurrentSensors.push_back(int(i));
+        else
+        { // randomized detection uses the global random generator: always handled here, in the original order
+            int detectedObj=-1;
+            C3Vector detectedSurf(C3Vector::zeroVector);
+            detected[i]=sensors[i]->handleSensor(exceptExplicitHandling,detectedObj,detectedSurf);
+            detectedObjectHandles[i]=detectedObj;
+            detectedNormalVectors[i]=detectedSurf;
+        }
+    }
+
+    if (concurrentSensors.size()>0)
+    {
+        // Everything that is lazily computed or cached is prepared here, before going concurrent:
+        for (size_t i=0;i<concurrentSensors.size();i++)
+            _prepareSensorForConcurrentHandling(sensors[concurrentSensors[i]]);
+
+        SProxSensorHandlingTask taskData;
+        taskData.sensors=&sensors;
+        taskData.sensorIndices=&concurrentSensors;
+        taskData.exceptExplicitHandling=exceptExplicitHandling;
+        taskData.detected=&detected;
+        taskData.detectedObjectHandles=&detectedObjectHandles;
+        taskData.detectedNormalVectors=&detectedNormalVectors;
+
+        App::ct->calcInfo->proximitySensorSimulationStart();
+        _batchRunsConcurrently=true;
+        CPluginContainer::mesh_setConcurrentAccess(true);
+        C3DObject::setCumulativeTransformationCacheFrozen(true);
+        CWorkerPool::executeTasks(_sensorHandlingTask,&taskData,int(concurrentSensors.size()));
+        C3DObject::setCumulativeTransformationCacheFrozen(false);
+        CPluginContainer::mesh_setConcurrentAccess(false);
+        _batchRunsConcurrently=false;
+        int detectCnt=0;
+        for (size_t i=0;i<concurrentSensors.size();i++)
+        {
+            if (detected[concurrentSensors[i]]!=0)
+                detectCnt++;
+        }
+        App::ct->calcInfo->proximitySensorSimulationEnd(int(concurrentSensors.size()),detectCnt);
+    }
+
+    _batchDetectableGroups.clear();
+    _batchActive=false;
+    if (releaseBroadPhase)
+        CCollisionBroadPhase::release();
+}
+
+bool CProxSensorRoutine::_canSensorBeHandledConcurrently(CProxSensor* sensor)
+{ // the occlusion check and the randomized rays rely on static or global data
+    if (sensor->getRandomizedDetection())
+        return(false);
+    if (sensor->getCheckOcclusions()&&sensor->getNormalCheck())
+        return(false);
+    return(true);
+}
+
+void CProxSensorRoutine::_prepareSensorForConcurrentHandling(CProxSensor* sensor)
+{
+    sensor->getCumulativeTransformation();
+    std::vector<C3DObject*> group;
+    C3DObject* object=App::ct->objCont->getObject(sensor->getSensableObject());
+    if (object!=NULL)
+        group.push_back(object);
+    else
+        _getDetectableGroup(sensor,sensor->getSensableObject(),group);
+    for (size_t i=0;i<group.size();i++)
+    {
+        C3DObject* obj=group[i];
+        obj->getCumulativeTransformation();
+        obj->getCumulativeObjectSpecialProperty();
+        if ( (obj->getObjectType()==sim_object_shape_type)&&_doesSensorVolumeOverlapWithObjectBoundingBox(sensor,obj) )
+            ((CShape*)obj)->initializeCalculationStructureIfNeeded();
+    }
+}
+
+void CProxSensorRoutine::_sensorHandlingTask(void* taskData,int taskIndex)
+{
+    SProxSensorHandlingTask* task=(SProxSensorHandlingTask*)taskData;
+    int index=task->sensorIndices->at(taskIndex);
+    int detectedObj=-1;
+    C3Vector detectedSurf(C3Vector::zeroVector);
+    bool detected=task->sensors->at(index)->handleSensor(task->exceptExplicitHandling,detectedObj,detectedSurf);
+    task->detected->at(index)=detected?1:0;
+    task->detectedObjectHandles->at(index)=detectedObj;
+    task->detectedNormalVectors->at(index)=detectedSurf;
+}
+
+void CProxSensorRoutine::_getDetectableGroup(const CProxSensor* sensor,int entityID,std::vector<C3DObject*>& group)
+{ // while handling several sensors, groups are collected only once per entity and sensable type
+    group.clear();
+    std::pair<int,int> key(entityID,sensor->getSensableType());
+    if (_batchActive)
+    {
+        std::map<std::pair<int,int>,std::vector<C3DObject*> >::iterator it=_batchDetectableGroups.find(key);
+        if (it!=_batchDetectableGroups.end())
+        {
+            group.assign(it->second.begin(),it->second.end());
+            return;
+        }
+    }
+    if (entityID==-1)
+    { // Special group here (all detectable objects):
+        std::vector<C3DObject*> exception;
+        App::ct->objCont->getAllDetectableObjectsFromSceneExcept(&exception,group,sensor->getSensableType());
+    }
+    else
+    { // Regular group here:
+        App::ct->collections->getDetectableObjectsFromCollection(entityID,group,sensor->getSensableType());
+    }
+    if (_batchActive&&(!_batchRunsConcurrently))
+        _batchDetectableGroups[key]=group;
+}
+
+bool CProxSensorRoutine::_mightSensorVolumeOverlapWithObject(const SBroadPhaseBox& sensorBox,C3DObject* obj)
+{ // conservative: true if obj is not known to the broad phase
+    SBroadPhaseBox objectBox;
+    if (!CCollisionBroadPhase::getObjectBox(obj,objectBox))
+        return(true);
+    return(CCollisionBroadPhase::areBoxesOverlapping(sensorBox,objectBox));
+}
+
 bool CProxSensorRoutine::detectPrimitive(int sensorID,float* vertexPointer,int itemType,int itemCount,
         bool closestFeatureMode,bool angleLimitation,float maxAngle,C3Vector& detectedPt,
         float& dist,bool frontFace,bool backFace,float minThreshold,C3Vector& triNormal)
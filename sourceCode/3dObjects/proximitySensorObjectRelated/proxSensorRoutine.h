@@ -5,6 +5,7 @@
 #include "proximitySensor.h"
 #include "octree.h"
 #include "pointCloud.h"
+#include "collisionBroadPhase.h"
 
 typedef bool (*OCCLUSION_CHECK_CALLBACK)(const float pt[3]);
 
@@ -27,10 +28,22 @@ public:
 
     static bool detectPrimitive(int sensorID,float* vertexPointer,int itemType,int itemCount,bool closestFeatureMode,bool angleLimitation,float maxAngle,C3Vector& detectedPt,float& dist,bool frontFace,bool backFace,float minThreshold,C3Vector& triNormal);
 
+    // Handles several sensors at once (same results as calling CProxSensor::handleSensor for each sensor in turn):
+    static void handleSensors(const std::vector<CProxSensor*>& sensors,bool exceptExplicitHandling,std::vector<char>& detected,std::vector<int>& detectedObjectHandles,std::vector<C3Vector>& detectedNormalVectors);
 
 private:
     static SOcclusionCheckDat _occlusionCheckDat;
 
+    // While handling several sensors at once:
+    static bool _batchActive;
+    static bool _batchRunsConcurrently;
+    static std::map<std::pair<int,int>,std::vector<C3DObject*> > _batchDetectableGroups; // (entity handle,sensable type) --> detectable objects
+    static bool _canSensorBeHandledConcurrently(CProxSensor* sensor);
+    static void _prepareSensorForConcurrentHandling(CProxSensor* sensor);
+    static void _sensorHandlingTask(void* taskData,int taskIndex);
+    static void _getDetectableGroup(const CProxSensor* sensor,int entityID,std::vector<C3DObject*>& group);
+    static bool _mightSensorVolumeOverlapWithObject(const SBroadPhaseBox& sensorBox,C3DObject* obj);
+
     static bool _checkForOcclusion(const float _detectedPt[3]);
 
     static int _detectDummy(CProxSensor* sensor,CDummy* dummy,C3Vector& detectedPt,float& dist,C3Vector& triNormalNotNormalized,bool closestFeatureMode,bool angleLimitation,float maxAngle,bool frontFace,bool backFace,float minThreshold,OCCLUSION_CHECK_CALLBACK occlusionCheckCallback);
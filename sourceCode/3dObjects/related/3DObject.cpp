@@ -28,6 +28,11 @@
 #endif
 
 int C3DObject::_modelPropertyValidityNumber=0;
+int C3DObject::_transformationValidityNumber=0;
+unsigned int C3DObject::_cumulativeTransformationCacheHits=0;
+unsigned int C3DObject::_cumulativeTransformationCacheMisses=0;
+bool C3DObject::_cumulativeTransformationCacheFrozen=false;
+bool C3DObject::_cumulativeTransformationCacheBypassed=false;
 
 C3DObject::C3DObject()
 {
@@ -35,6 +40,7 @@ C3DObject::C3DObject()
     _parentID=-1;
     _objectID=0;
     _transformation.setIdentity();
+    _cumulativeTransformationValidityNumber=-2;
     generateDnaString();
     _assemblingLocalTransformation.setIdentity();
     _assemblingLocalTransformationIsUsed=false;
@@ -562,6 +568,60 @@ void C3DObject::incrementModelPropertyValidityNumber()
     _modelPropertyValidityNumber++;
 }
 
+int C3DObject::getModelPropertyValidityNumber()
+{ // static
+    return(_modelPropertyValidityNumber);
+}
+
+void C3DObject::incrementTransformationValidityNumber()
+{ // static. Invalidates all cached cumulative transformations (e.g. when the hierarchy changed)
+    _transformationValidityNumber++;
+}
+
+void C3DObject::getCumulativeTransformationCacheStatistics(unsigned int& hits,unsigned int& misses)
+{ // static
+    hits=_cumulativeTransformationCacheHits;
+    misses=_cumulativeTransformationCacheMisses;
+}
+
+void C3DObject::resetCumulativeTransformationCacheStatistics()
+{ // static
+    _cumulativeTransformationCacheHits=0;
+    _cumulativeTransformationCacheMisses=0;
+}
+
+void C3DObject::setCumulativeTransformationCacheFrozen(bool frozen)
+{ // static. Set while worker threads run (e.g. concurrent collision checks): the cache (and its statistics)
+  // is then only read, never written. Cumulative transformations should be prepared before that
+    _cumulativeTransformationCacheFrozen=frozen;
+}
+
+void C3DObject::setCumulativeTransformationCacheBypassed(bool bypassed)
+{ // static. Set while worker threads run that modify transformations (i.e. concurrent IK groups): the cache is then
+  // neither read nor written. All cached values are invalidated when this is reset
+    _cumulativeTransformationCacheBypassed=bypassed;
+    if (!bypassed)
+        incrementTransformationValidityNumber();
+}
+
+void C3DObject::localTransformationChanged()
+{ // Call this each time the local transformation (or a joint value) changed. Invalidates the cached
+    // cumulative transformation of this object and of all its descendants
+    if (_cumulativeTransformationCacheFrozen||_cumulativeTransformationCacheBypassed)
+        return; // worker threads might be running: cache fields are not touched. See setCumulativeTransformationCacheBypassed
+    if ( (App::ct->objCont==NULL)||(App::ct->objCont->getObject(_objectID)!=this) )
+    { // object is not part of the scene (e.g. in the copy buffer): its child list might not be up-to-date
+        incrementTransformationValidityNumber();
+        return;
+    }
+    if (_cumulativeTransformationValidityNumber!=-1)
+    { // a descendant can only be valid if this object is valid too
+        _cumulativeTransformationValidityNumber=-1;
+        for (size_t i=0;i<childList.size();i++)
+            childList[i]->localTransformationChanged();
+    }
+}
+
 
 bool C3DObject::isObjectPartOfInvisibleModel()
 {
@@ -1473,10 +1533,14 @@ void C3DObject::simulationEndedMain()
                         // Inverted following 2 lines on 24/2/2012:
                         App::ct->objCont->makeObjectChildOf(this,oldParent);
                         _transformation=_initialLocalTransformationPart1;
+                        localTransformationChanged();
                     }
                 }
                 else
+                {
                     _transformation=_initialLocalTransformationPart1;
+                    localTransformationChanged();
+                }
             }
             _localModelProperty=_initialMainPropertyOverride;
             _initialConfigurationMemorized=false;
@@ -2323,7 +2387,13 @@ std::string C3DObject::getName() const
 }
 void C3DObject::setName(std::string newName)
 { 
-    _objectName=newName;
+    if (_objectName!=newName)
+    {
+        std::string previousName(_objectName);
+        _objectName=newName;
+        if ( (App::ct!=NULL)&&(App::ct->objCont!=NULL) )
+            App::ct->objCont->announceObjectNameChanged(this,previousName,false);
+    }
 }
 
 std::string C3DObject::getAltName() const
@@ -2332,7 +2402,13 @@ std::string C3DObject::getAltName() const
 }
 void C3DObject::setAltName(std::string newAltName)
 {
-    _objectAltName=newAltName;
+    if (_objectAltName!=newAltName)
+    {
+        std::string previousAltName(_objectAltName);
+        _objectAltName=newAltName;
+        if ( (App::ct!=NULL)&&(App::ct->objCont!=NULL) )
+            App::ct->objCont->announceObjectNameChanged(this,previousAltName,true);
+    }
 }
 std::string C3DObject::getDisplayName() const
 {
@@ -2589,10 +2665,40 @@ C7Vector C3DObject::getParentCumulativeTransformation_forDisplay(bool guiIsRende
 
 C7Vector C3DObject::getCumulativeTransformation(bool useTempValues) const
 { // useTempValues is false by default. This is used by the IK-routine
-    if (getParent()==NULL)
-        return(getLocalTransformation(useTempValues));
+    if (useTempValues)
+    { // IK temp values change at each IK pass and are not cached
+        if (getParent()==NULL)
+            return(getLocalTransformation(true));
+        else
+            return(getParentCumulativeTransformation(true)*getLocalTransformation(true));
+    }
+    if (_cumulativeTransformationCacheBypassed)
+    { // several threads might be here, and modify transformations: the cache cannot be trusted
+        if (getParent()==NULL)
+            return(getLocalTransformation(false));
+        return(getParent()->getCumulativeTransformation(false)*getLocalTransformation(false));
+    }
+    int vn=_transformationValidityNumber;
+    if (_cumulativeTransformationCacheFrozen)
+    { // several threads might be here: we do not write to the cache
+        if (vn==_cumulativeTransformationValidityNumber)
+            return(_cumulativeTransformation_cached);
+        if (getParent()==NULL)
+            return(getLocalTransformation(false));
+        return(getParent()->getCumulativeTransformation(false)*getLocalTransformation(false));
+    }
+    if (vn!=_cumulativeTransformationValidityNumber)
+    { // the cached value is not up-to-date
+        _cumulativeTransformationCacheMisses++;
+        if (getParent()==NULL)
+            _cumulativeTransformation_cached=getLocalTransformation(false);
+        else
+            _cumulativeTransformation_cached=getParent()->getCumulativeTransformation(false)*getLocalTransformation(false);
+        _cumulativeTransformationValidityNumber=vn;
+    }
     else
-        return(getParentCumulativeTransformation(useTempValues)*getLocalTransformation(useTempValues));
+        _cumulativeTransformationCacheHits++;
+    return(_cumulativeTransformation_cached);
 }
 C7Vector C3DObject::getCumulativeTransformation_forDisplay(bool guiIsRendering) const
 {
@@ -2743,30 +2849,36 @@ C7Vector C3DObject::getLocalTransformationPart1_forDisplay(bool guiIsRendering)
 void C3DObject::setLocalTransformation(const C7Vector& v)
 {
     _transformation=v;
+    localTransformationChanged();
 }
 
 void C3DObject::setLocalTransformation(const C4Vector& q)
 {
     _transformation.Q=q;
+    localTransformationChanged();
 }
 void C3DObject::setLocalTransformation(const C3Vector& x)
 {
     _transformation.X=x;
+    localTransformationChanged();
 }
 void C3DObject::setAbsoluteTransformation(const C7Vector& v)
 {
     C7Vector pInv(getParentCumulativeTransformation().getInverse());
     _transformation.setMultResult(pInv,v);
+    localTransformationChanged();
 }
 void C3DObject::setAbsoluteTransformation(const C4Vector& q)
 {
     C7Vector pInv(getParentCumulativeTransformation().getInverse());
     _transformation.Q=pInv.Q*q;
+    localTransformationChanged();
 }
 void C3DObject::setAbsoluteTransformation(const C3Vector& x)
 {
     C7Vector pInv(getParentCumulativeTransformation().getInverse());
     _transformation.X=pInv*x;
+    localTransformationChanged();
 }
 
 int C3DObject::getID() const
@@ -2803,6 +2915,7 @@ void C3DObject::setParent(C3DObject* newParent,bool actualizeInfo)
         return;
     EASYLOCK(_objectMutex);
     _parentObject=newParent;
+    incrementTransformationValidityNumber();
     if (actualizeInfo) 
         App::ct->objCont->actualizeObjectInformation();
 }
@@ -3379,6 +3492,7 @@ bool C3DObject::setLocalTransformationFromObjectRotationMode(const C4X4Matrix& c
         C4Vector pinv(getParentCumulativeTransformation().Q.getInverse());
         _transformation.Q=pinv*trq;
     }
+    localTransformationChanged();
     _objectManipulationMode_flaggedForGridOverlay=_objectManipulationModeAxisIndex+8;
     return(true);
 }
@@ -3616,6 +3730,7 @@ bool C3DObject::setLocalTransformationFromObjectTranslationMode(const C4X4Matrix
     C4X4Matrix m(getCumulativeTransformationPart1());
     m.X+=v;
     _transformation=getParentCumulativeTransformation().getInverse().getMatrix()*m;
+    localTransformationChanged();
     _objectManipulationMode_flaggedForGridOverlay=_objectManipulationModeAxisIndex+16;
     return(true);
 }
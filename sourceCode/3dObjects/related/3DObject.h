@@ -274,6 +274,13 @@ public:
     void setForceAlwaysVisible_tmp(bool force);
 
     static void incrementModelPropertyValidityNumber();
+    static int getModelPropertyValidityNumber();
+    static void incrementTransformationValidityNumber();
+    static void getCumulativeTransformationCacheStatistics(unsigned int& hits,unsigned int& misses);
+    static void resetCumulativeTransformationCacheStatistics();
+    static void setCumulativeTransformationCacheFrozen(bool frozen);
+    static void setCumulativeTransformationCacheBypassed(bool bypassed);
+    void localTransformationChanged();
 
 
     void getCumulativeTransformationMatrix(float m[4][4],bool useTempValues=false) const;
@@ -314,6 +321,11 @@ public:
 protected:
     int _dynamicSimulationIconCode;
     static int _modelPropertyValidityNumber;
+    static int _transformationValidityNumber;
+    static unsigned int _cumulativeTransformationCacheHits;
+    static unsigned int _cumulativeTransformationCacheMisses;
+    static bool _cumulativeTransformationCacheFrozen;
+    static bool _cumulativeTransformationCacheBypassed;
 
     bool _restoreToDefaultLights;
     bool _forceAlwaysVisible_tmp;
@@ -330,7 +342,9 @@ protected:
     std::string _dnaString;
     std::string _uniquePersistentIdString;
 
-    C7Vector _transformation; // Quaternion and position
+    C7Vector _transformation; // Quaternion and position. Call localTransformationChanged() after modifying it!
+    mutable C7Vector _cumulativeTransformation_cached; // not used when useTempValues is true (IK)
+    mutable int _cumulativeTransformationValidityNumber;
     int _objectID;
     std::string _objectName;
     std::string _objectAltName;
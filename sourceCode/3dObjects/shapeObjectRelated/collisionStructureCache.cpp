@@ -0,0 +1,195 @@
+#include "vrepMainHeader.h"
+#include "collisionStructureCache.h"
+#include "pluginContainer.h"
+#include "vFile.h"
+#include "vArchive.h"
+#include "app.h"
+#include "vDateTime.h"
+#include <boost/lexical_cast.hpp>
+#include <stdio.h>
+#include <string.h>
+
+#define COLLISION_STRUCTURE_CACHE_FORMAT_VERSION 1
+
+VMutex CCollisionStructureCache::_tempFileMutex;
+int CCollisionStructureCache::_tempFileCounter=0;
+std::string CCollisionStructureCache::_tempFileToken;
+
+void* CCollisionStructureCache::createCollisionInformationStructure(const std::vector<float>& cumulVertices,const std::vector<int>& cumulIndices,float maxTriSize,float edgeAngle,int maxTriCount)
+{ // Same as CPluginContainer::mesh_createCollisionInformationStructure, but goes through the cache if enabled
+    if ( (!App::userSettings->collisionStructureCache)||(CPluginContainer::currentMeshEngine==NULL) )
+        return(CPluginContainer::mesh_createCollisionInformationStructure(&cumulVertices[0],(int)cumulVertices.size(),&cumulIndices[0],(int)cumulIndices.size(),maxTriSize,edgeAngle,maxTriCount));
+
+    suint64 key,checkKey;
+    _getKeys(cumulVertices,cumulIndices,maxTriSize,edgeAngle,maxTriCount,key,checkKey);
+    std::string filename(_getEntryFilename(key));
+    std::vector<unsigned char> data;
+    if (_readEntry(filename,checkKey,(int)cumulVertices.size(),(int)cumulIndices.size(),data))
+    {
+        void* collInfo=CPluginContainer::mesh_getCollisionInformationStructureFromSerializationData(&data[0],&cumulVertices[0],(int)cumulVertices.size(),&cumulIndices[0],(int)cumulIndices.size());
+        if (collInfo!=NULL)
+            return(collInfo);
+    }
+
+    void* collInfo=CPluginContainer::mesh_createCollisionInformationStructure(&cumulVertices[0],(int)cumulVertices.size(),&cumulIndices[0],(int)cumulIndices.size(),maxTriSize,edgeAngle,maxTriCount);
+    if (collInfo!=NULL)
+    {
+        int dataSize;
+        unsigned char* collInfoData=CPluginContainer::mesh_getCollisionInformationStructureSerializationData(collInfo,dataSize);
+        if (collInfoData!=NULL)
+        {
+            _writeEntry(filename,checkKey,(int)cumulVertices.size(),(int)cumulIndices.size(),collInfoData,dataSize);
+            CPluginContainer::mesh_releaseBuffer(collInfoData);
+        }
+    }
+    return(collInfo);
+}
+
+void CCollisionStructureCache::prepareForConcurrentCalls()
+{ // The random part of the temporary file names is generated here, and not by a worker thread (rand is not thread-safe,
+  // and its sequence is shared with the simulation)
+    _tempFileMutex.lock_simple();
+    _getTempFileToken();
+    _tempFileMutex.unlock_simple();
+}
+
+std::string CCollisionStructureCache::_getTempFileToken()
+{ // _tempFileMutex must be locked
+    if (_tempFileToken.length()==0)
+        _tempFileToken=boost::lexical_cast<std::string>(rand())+boost::lexical_cast<std::string>(VDateTime::getTimeInMs());
+    return(_tempFileToken);
+}
+
+std::string CCollisionStructureCache::getCacheFolder()
+{
+    if (App::userSettings->collisionStructureCacheFolder.length()!=0)
+    {
+        std::string retVal(App::userSettings->collisionStructureCacheFolder);
+        VVarious::removePathFinalSlashOrBackslash(retVal);
+        return(retVal);
+    }
+    return(App::directories->executableDirectory+VREP_SLASH+"collisionStructureCache");
+}
+
+void CCollisionStructureCache::_getKeys(const std::vector<float>& cumulVertices,const std::vector<int>& cumulIndices,float maxTriSize,float edgeAngle,int maxTriCount,suint64& key,suint64& checkKey)
+{ // Two 64-bit FNV-1a hashes with different offset bases. The first one names the entry, the second one
+  // is stored in the entry and checked when reading. The mesh engine version is part of the keys, since
+  // the serialization data is specific to it
+    std::vector<unsigned int> words;
+    words.reserve(cumulVertices.size()+cumulIndices.size()+6);
+    words.push_back((unsigned int)cumulVertices.size());
+    words.push_back((unsigned int)cumulIndices.size());
+    for (size_t i=0;i<cumulVertices.size();i++)
+    {
+        unsigned int w=0;
+        if (cumulVertices[i]!=0.0f) // -0.0 and 0.0 are equal
+            memcpy(&w,&cumulVertices[i],sizeof(w));
+        words.push_back(w);
+    }
+    for (size_t i=0;i<cumulIndices.size();i++)
+        words.push_back((unsigned int)cumulIndices[i]);
+    unsigned int w;
+    memcpy(&w,&maxTriSize,sizeof(w));
+    words.push_back(w);
+    memcpy(&w,&edgeAngle,sizeof(w));
+    words.push_back(w);
+    words.push_back((unsigned int)maxTriCount);
+    words.push_back((unsigned int)CPluginContainer::currentMeshEngine->extendedVersionInt);
+
+    std::string engine(CPluginContainer::currentMeshEngine->name+" "+CPluginContainer::currentMeshEngine->buildDateString+" ");
+    engine+=boost::lexical_cast<std::string>(int(CPluginContainer::currentMeshEngine->pluginVersion));
+
+    key=14695981039346656037ULL;
+    checkKey=0x84222325cbf29ce4ULL;
+    for (size_t i=0;i<engine.length();i++)
+    {
+        key=(key^(unsigned char)engine[i])*1099511628211ULL;
+        checkKey=(checkKey^(unsigned char)engine[i])*1099511628211ULL;
+    }
+    for (size_t i=0;i<words.size();i++)
+    {
+        key=(key^words[i])*1099511628211ULL;
+        checkKey=(checkKey^(words[i]^0x5bd1e995))*1099511628211ULL;
+    }
+}
+
+std::string CCollisionStructureCache::_getEntryFilename(suint64 key)
+{
+    static const char hexDigits[]="0123456789abcdef";
+    std::string name;
+    for (int i=15;i>=0;i--)
+        name+=hexDigits[(key>>(4*i))&15];
+    return(getCacheFolder()+VREP_SLASH+name+".coi");
+}
+
+bool CCollisionStructureCache::_readEntry(const std::string& filename,suint64 checkKey,int vertexCount,int indexCount,std::vector<unsigned char>& data)
+{ // Returns false if the entry does not exist or does not match
+    if (!VFile::doesFileExist(filename))
+        return(false);
+    bool retVal=false;
+    try
+    {
+        VFile file(filename,VFile::READ|VFile::SHARE_DENY_NONE);
+        VArchive ar(&file,VArchive::LOAD);
+        quint64 fileLength=file.getLength();
+        if (fileLength>28)
+        {
+            char tag[4];
+            for (int i=0;i<4;i++)
+                ar >> tag[i];
+            int version,vCnt,iCnt,dataSize;
+            unsigned int checkKeyLow,checkKeyHigh;
+            ar >> version >> checkKeyLow >> checkKeyHigh >> vCnt >> iCnt >> dataSize;
+            suint64 k=(suint64(checkKeyHigh)<<32)|suint64(checkKeyLow);
+            if ( (strncmp(tag,"VCOI",4)==0)&&(version==COLLISION_STRUCTURE_CACHE_FORMAT_VERSION)&&(k==checkKey)&&(vCnt==vertexCount)&&(iCnt==indexCount)&&(dataSize>0)&&(quint64(dataSize)<=fileLength-28) )
+            {
+                data.resize(dataSize);
+                for (int i=0;i<dataSize;i++)
+                    ar >> data[i];
+                retVal=true;
+            }
+        }
+        ar.close();
+        file.close();
+    }
+    catch(VFILE_EXCEPTION_TYPE e)
+    { // the cache is an optimization only: we silently compute the structure
+        retVal=false;
+    }
+    return(retVal);
+}
+
+void CCollisionStructureCache::_writeEntry(const std::string& filename,suint64 checkKey,int vertexCount,int indexCount,const unsigned char* data,int dataSize)
+{ // We write to a temporary file first, then rename it. Readers (also from other V-REP instances) never see a partial entry
+    _tempFileMutex.lock_simple();
+    std::string tempFilename(filename+"."+boost::lexical_cast<std::string>(_tempFileCounter++)+"_"+_getTempFileToken()+".tmp");
+    _tempFileMutex.unlock_simple();
+    bool written=false;
+    try
+    {
+        VFile file(tempFilename,VFile::CREATE_WRITE|VFile::SHARE_EXCLUSIVE); // also creates the cache folder if needed
+        VArchive ar(&file,VArchive::STORE);
+        const char tag[]="VCOI";
+        for (int i=0;i<4;i++)
+            ar << tag[i];
+        ar << int(COLLISION_STRUCTURE_CACHE_FORMAT_VERSION);
+        ar << (unsigned int)(checkKey&0xffffffff) << (unsigned int)(checkKey>>32);
+        ar << vertexCount << indexCount << dataSize;
+        for (int i=0;i<dataSize;i++)
+            ar << data[i];
+        ar.close();
+        file.close();
+        written=true;
+    }
+    catch(VFILE_EXCEPTION_TYPE e)
+    {
+        written=false;
+    }
+    if (written)
+    {
+        if (rename(tempFilename.c_str(),filename.c_str())!=0)
+            VFile::eraseFile(tempFilename); // e.g. another instance wrote the same entry in the mean time
+    }
+    else if (VFile::doesFileExist(tempFilename))
+        VFile::eraseFile(tempFilename);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "vrepMainHeader.h"
+#include "vMutex.h"
+
+// Keeps the serialization data of computed collision structures (OBB trees) in a cache folder.
+// Entries are addressed by the content of the cumulative mesh and the calculation parameters, so
+// that they can be shared by all scenes, and by several V-REP instances.
+// FULLY STATIC CLASS
+class CCollisionStructureCache
+{
+public:
+    static void* createCollisionInformationStructure(const std::vector<float>& cumulVertices,const std::vector<int>& cumulIndices,float maxTriSize,float edgeAngle,int maxTriCount);
+    static std::string getCacheFolder();
+    static void prepareForConcurrentCalls(); // call from the launching thread, before worker threads create structures
+
+private:
+    static void _getKeys(const std::vector<float>& cumulVertices,const std::vector<int>& cumulIndices,float maxTriSize,float edgeAngle,int maxTriCount,suint64& key,suint64& checkKey);
+    static std::string _getEntryFilename(suint64 key);
+    static bool _readEntry(const std::string& filename,suint64 checkKey,int vertexCount,int indexCount,std::vector<unsigned char>& data);
+    static void _writeEntry(const std::string& filename,suint64 checkKey,int vertexCount,int indexCount,const unsigned char* data,int dataSize);
+
+    static std::string _getTempFileToken();
+
+    static VMutex _tempFileMutex;
+    static int _tempFileCounter;
+    static std::string _tempFileToken; // random part of temporary file names, generated once
+};
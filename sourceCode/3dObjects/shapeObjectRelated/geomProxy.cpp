@@ -6,6 +6,7 @@
 #include "meshManip.h"
 #include "algos.h"
 #include "pluginContainer.h"
+#include "collisionStructureCache.h"
 #include "app.h"
 
 CGeomProxy::CGeomProxy()
@@ -191,16 +192,19 @@ void CGeomProxy::initializeCalculationStructureIfNeeded()
 {
     C_API_FUNCTION_DEBUG;
     if ((collInfo==NULL)&&(geomInfo!=NULL))
-    {
-        std::vector<float> wvert;
-        std::vector<int> wind;
-        geomInfo->getCumulativeMeshes(wvert,&wind,NULL);
-        float maxTriSize=App::ct->environment->getCalculationMaxTriangleSize();
-        float minTriSize=(SIM_MAX(SIM_MAX(_boundingBoxHalfSizes(0),_boundingBoxHalfSizes(1)),_boundingBoxHalfSizes(2)))*2.0f*App::ct->environment->getCalculationMinRelTriangleSize();
-        if (maxTriSize<minTriSize)
-            maxTriSize=minTriSize;
-        collInfo=CPluginContainer::mesh_createCollisionInformationStructure(&wvert[0],(int)wvert.size(),&wind[0],(int)wind.size(),maxTriSize,geomInfo->getEdgeThresholdAngle(),App::userSettings->triCountInOBB);
-    }
+        collInfo=computeCalculationStructure();
+}
+
+void* CGeomProxy::computeCalculationStructure()
+{ // Does not modify this object, and can be called from several threads at the same time (for different objects)
+    std::vector<float> wvert;
+    std::vector<int> wind;
+    geomInfo->getCumulativeMeshes(wvert,&wind,NULL);
+    float maxTriSize=App::ct->environment->getCalculationMaxTriangleSize();
+    float minTriSize=(SIM_MAX(SIM_MAX(_boundingBoxHalfSizes(0),_boundingBoxHalfSizes(1)),_boundingBoxHalfSizes(2)))*2.0f*App::ct->environment->getCalculationMinRelTriangleSize();
+    if (maxTriSize<minTriSize)
+        maxTriSize=minTriSize;
+    return(CCollisionStructureCache::createCollisionInformationStructure(wvert,wind,maxTriSize,geomInfo->getEdgeThresholdAngle(),App::userSettings->triCountInOBB));
 }
 
 bool CGeomProxy::isCollisionInformationInitialized()
@@ -22,6 +22,7 @@ public:
     C3Vector getBoundingBoxHalfSizes();
     void invertFrontBack();
     void initializeCalculationStructureIfNeeded();
+    void* computeCalculationStructure();
     bool isCollisionInformationInitialized();
     void computeBoundingBox();
     void scale(float xVal,float yVal,float zVal);
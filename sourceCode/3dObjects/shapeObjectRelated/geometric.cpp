@@ -8,6 +8,8 @@
 #include "meshManip.h"
 #include "ttUtil.h"
 #include "app.h"
+#include "v_repStrings.h"
+#include <string.h>
 #include "pluginContainer.h"
 #include "shapeRendering.h"
 
@@ -20,6 +22,14 @@ std::vector<std::vector<float>*> CGeometric::_tempVertices;
 std::vector<std::vector<int>*> CGeometric::_tempIndices;
 std::vector<std::vector<float>*> CGeometric::_tempNormals;
 std::vector<std::vector<unsigned char>*> CGeometric::_tempEdges;
+std::multimap<suint64,int> CGeometric::_tempVerticesHashes;
+std::multimap<suint64,int> CGeometric::_tempIndicesHashes;
+std::multimap<suint64,int> CGeometric::_tempNormalsHashes;
+std::multimap<suint64,int> CGeometric::_tempEdgesHashes;
+int CGeometric::_tempBufferRequestCount=0;
+int CGeometric::_tempBufferDuplicateCount=0;
+double CGeometric::_tempBufferDuplicateSizeInBytes=0.0;
+std::string CGeometric::_lastTempBufferStatistics;
 
 CGeometric::CGeometric()
 {
@@ -44,6 +54,10 @@ CGeometric::CGeometric()
     _normalBufferId=-1;
     _edgeBufferId=-1;
 
+    _undoVertexBufferId=-1;
+    _undoIndexBufferId=-1;
+    _undoNormalsBufferId=-1;
+
     _edgeWidth_DEPRERCATED=1;
     _visibleEdges=false;
     _hideEdgeBorders=false;
@@ -310,6 +324,10 @@ CGeometric* CGeometric::copyYourself()
     increaseNormalBufferRefCnt(_normalBufferId);
     increaseEdgeBufferRefCnt(_edgeBufferId);
 
+    newIt->_undoVertexBufferId=_undoVertexBufferId;
+    newIt->_undoIndexBufferId=_undoIndexBufferId;
+    newIt->_undoNormalsBufferId=_undoNormalsBufferId;
+
     if (_textureProperty!=NULL)
         newIt->_textureProperty=_textureProperty->copyYourself();
 
@@ -375,6 +393,10 @@ void CGeometric::scale(float xVal,float yVal,float zVal)
     _vertexBufferId=-1;
     _normalBufferId=-1;
     _edgeBufferId=-1;
+
+    _undoVertexBufferId=-1;
+    _undoIndexBufferId=-1;
+    _undoNormalsBufferId=-1;
 }
 
 void CGeometric::setMeshDataDirect(const std::vector<float>& vertices,const std::vector<int>& indices,const std::vector<float>& normals,const std::vector<unsigned char>& edges)
@@ -392,6 +414,10 @@ void CGeometric::setMeshDataDirect(const std::vector<float>& vertices,const std:
     _vertexBufferId=-1;
     _normalBufferId=-1;
     _edgeBufferId=-1;
+
+    _undoVertexBufferId=-1;
+    _undoIndexBufferId=-1;
+    _undoNormalsBufferId=-1;
 }
 
 void CGeometric::setMesh(const std::vector<float>& vertices,const std::vector<int>& indices,const std::vector<float>* normals,const C7Vector& transformation)
@@ -416,6 +442,10 @@ void CGeometric::setMesh(const std::vector<float>& vertices,const std::vector<in
     _vertexBufferId=-1;
     _normalBufferId=-1;
     _edgeBufferId=-1;
+
+    _undoVertexBufferId=-1;
+    _undoIndexBufferId=-1;
+    _undoNormalsBufferId=-1;
 }
 
 void CGeometric::setPurePrimitiveType(int theType,float xOrDiameter,float y,float zOrHeight)
@@ -777,6 +807,7 @@ void CGeometric::setHeightfieldDiamonds(int d)
                 _indices[6*i+5]=_indices[6*i+0];
             }
         }
+        _undoIndexBufferId=-1;
     }
 }
 
@@ -1059,6 +1090,9 @@ void CGeometric::flipFaces()
 
     _normalBufferId=-1;
     _vertexBufferId=-1;
+
+    _undoIndexBufferId=-1;
+    _undoNormalsBufferId=-1;
 }
 
 void CGeometric::actualizeGouraudShadingAndVisibleEdges()
@@ -1144,6 +1178,7 @@ void CGeometric::_recomputeNormals()
     decreaseNormalBufferRefCnt(_normalBufferId);
 
     _normalBufferId=-1;
+    _undoNormalsBufferId=-1;
 }
 
 void CGeometric::_computeVisibleEdges()
@@ -1272,23 +1307,89 @@ void CGeometric::clearTempVerticesIndicesNormalsAndEdges()
     for (int i=0;i<int(_tempEdges.size());i++)
         delete _tempEdges[i];
     _tempEdges.clear();
+
+    _tempVerticesHashes.clear();
+    _tempIndicesHashes.clear();
+    _tempNormalsHashes.clear();
+    _tempEdgesHashes.clear();
+
+    _tempBufferRequestCount=0;
+    _tempBufferDuplicateCount=0;
+    _tempBufferDuplicateSizeInBytes=0.0;
 }
 
-void CGeometric::prepareVerticesIndicesNormalsAndEdgesForSerialization()
-{ // function has virtual/non-virtual counterpart!
-    _tempVerticesIndexForSerialization=getBufferIndexOfVertices(_vertices);
-    if (_tempVerticesIndexForSerialization==-1)
-        _tempVerticesIndexForSerialization=addVerticesToBufferAndReturnIndex(_vertices);
+std::string CGeometric::getLastTempBufferStatistics()
+{
+    return(_lastTempBufferStatistics);
+}
 
-    _tempIndicesIndexForSerialization=getBufferIndexOfIndices(_indices);
-    if (_tempIndicesIndexForSerialization==-1)
-        _tempIndicesIndexForSerialization=addIndicesToBufferAndReturnIndex(_indices);
+void CGeometric::_addToTempBufferStatistics(int bufferIndex,size_t sizeInBytes)
+{ // bufferIndex is -1 if the buffer was not yet present
+    _tempBufferRequestCount++;
+    if (bufferIndex!=-1)
+    {
+        _tempBufferDuplicateCount++;
+        _tempBufferDuplicateSizeInBytes+=double(sizeInBytes);
+    }
+}
 
-    _tempNormalsIndexForSerialization=getBufferIndexOfNormals(_normals);
-    if (_tempNormalsIndexForSerialization==-1)
-        _tempNormalsIndexForSerialization=addNormalsToBufferAndReturnIndex(_normals);
+suint64 CGeometric::_getTempBufferHash(const std::vector<float>& buff)
+{ // 64-bit FNV-1a on 32-bit words
+    suint64 retVal=14695981039346656037ULL^suint64(buff.size());
+    for (size_t i=0;i<buff.size();i++)
+    {
+        unsigned int w=0;
+        if (buff[i]!=0.0f) // -0.0 and 0.0 are equal, and need the same hash
+            memcpy(&w,&buff[i],sizeof(w));
+        retVal=(retVal^w)*1099511628211ULL;
+    }
+    return(retVal);
+}
+
+suint64 CGeometric::_getTempBufferHash(const std::vector<int>& buff)
+{ // 64-bit FNV-1a on 32-bit words
+    suint64 retVal=14695981039346656037ULL^suint64(buff.size());
+    for (size_t i=0;i<buff.size();i++)
+        retVal=(retVal^(unsigned int)buff[i])*1099511628211ULL;
+    return(retVal);
+}
+
+suint64 CGeometric::_getTempBufferHash(const std::vector<unsigned char>& buff)
+{ // 64-bit FNV-1a
+    suint64 retVal=14695981039346656037ULL^suint64(buff.size());
+    for (size_t i=0;i<buff.size();i++)
+        retVal=(retVal^buff[i])*1099511628211ULL;
+    return(retVal);
+}
+
+void CGeometric::prepareVerticesIndicesNormalsAndEdgesForSerialization()
+{ // function has virtual/non-virtual counterpart!
+    if (App::ct->undoBufferContainer->isUndoSavingOrRestoringUnderWay())
+    { // undo/redo serialization: vertices, indices and normals are in the undo buffer arrays (see serialize)
+        _tempVerticesIndexForSerialization=-1;
+        _tempIndicesIndexForSerialization=-1;
+        _tempNormalsIndexForSerialization=-1;
+    }
+    else
+    {
+        _tempVerticesIndexForSerialization=getBufferIndexOfVertices(_vertices);
+        _addToTempBufferStatistics(_tempVerticesIndexForSerialization,_vertices.size()*sizeof(float));
+        if (_tempVerticesIndexForSerialization==-1)
+            _tempVerticesIndexForSerialization=addVerticesToBufferAndReturnIndex(_vertices);
+
+        _tempIndicesIndexForSerialization=getBufferIndexOfIndices(_indices);
+        _addToTempBufferStatistics(_tempIndicesIndexForSerialization,_indices.size()*sizeof(int));
+        if (_tempIndicesIndexForSerialization==-1)
+            _tempIndicesIndexForSerialization=addIndicesToBufferAndReturnIndex(_indices);
+
+        _tempNormalsIndexForSerialization=getBufferIndexOfNormals(_normals);
+        _addToTempBufferStatistics(_tempNormalsIndexForSerialization,_normals.size()*sizeof(float));
+        if (_tempNormalsIndexForSerialization==-1)
+            _tempNormalsIndexForSerialization=addNormalsToBufferAndReturnIndex(_normals);
+    }
 
     _tempEdgesIndexForSerialization=getBufferIndexOfEdges(_edges);
+    _addToTempBufferStatistics(_tempEdgesIndexForSerialization,_edges.size());
     if (_tempEdgesIndexForSerialization==-1)
         _tempEdgesIndexForSerialization=addEdgesToBufferAndReturnIndex(_edges);
 }
@@ -1297,6 +1398,14 @@ void CGeometric::serializeTempVerticesIndicesNormalsAndEdges(CSer& ar)
 {
     if (ar.isStoring())
     {       // Storing
+        _lastTempBufferStatistics.clear();
+        if (_tempBufferDuplicateCount>0)
+        { // only reported if duplicates were found
+            _lastTempBufferStatistics=IDSNS_MESH_DATA_DUPLICATES_NOT_STORED;
+            _lastTempBufferStatistics+=" "+tt::FNb(_tempBufferDuplicateCount)+"/"+tt::FNb(_tempBufferRequestCount)+" (";
+            _lastTempBufferStatistics+=tt::FNb(0,float(_tempBufferDuplicateSizeInBytes/1048576.0),2,false)+" MB).";
+        }
+
         for (int c=0;c<int(_tempVertices.size());c++)
         {
             ar.storeDataName("Ver");
@@ -1456,8 +1565,10 @@ void CGeometric::serializeTempVerticesIndicesNormalsAndEdges(CSer& ar)
 int CGeometric::getBufferIndexOfVertices(const std::vector<float>& vert)
 {
     int vertl=(int)vert.size();
-    for (int i=0;i<int(_tempVertices.size());i++)
+    std::pair<std::multimap<suint64,int>::iterator,std::multimap<suint64,int>::iterator> range=_tempVerticesHashes.equal_range(_getTempBufferHash(vert));
+    for (std::multimap<suint64,int>::iterator it=range.first;it!=range.second;it++)
     {
+        int i=it->second;
         if (int(_tempVertices[i]->size())==vertl)
         { // might be same!
             bool same=true;
@@ -1482,6 +1593,7 @@ int CGeometric::addVerticesToBufferAndReturnIndex(const std::vector<float>& vert
     std::vector<float>* nvert=new std::vector<float>;
     nvert->assign(vert.begin(),vert.end());
     _tempVertices.push_back(nvert);
+    _tempVerticesHashes.insert(std::make_pair(_getTempBufferHash(vert),(int)_tempVertices.size()-1));
     return((int)_tempVertices.size()-1);
 }
 
@@ -1495,8 +1607,10 @@ void CGeometric::getVerticesFromBufferBasedOnIndex(int index,std::vector<float>&
 int CGeometric::getBufferIndexOfIndices(const std::vector<int>& ind)
 {
     int indl=(int)ind.size();
-    for (int i=0;i<int(_tempIndices.size());i++)
+    std::pair<std::multimap<suint64,int>::iterator,std::multimap<suint64,int>::iterator> range=_tempIndicesHashes.equal_range(_getTempBufferHash(ind));
+    for (std::multimap<suint64,int>::iterator it=range.first;it!=range.second;it++)
     {
+        int i=it->second;
         if (int(_tempIndices[i]->size())==indl)
         { // might be same!
             bool same=true;
@@ -1521,6 +1635,7 @@ int CGeometric::addIndicesToBufferAndReturnIndex(const std::vector<int>& ind)
     std::vector<int>* nind=new std::vector<int>;
     nind->assign(ind.begin(),ind.end());
     _tempIndices.push_back(nind);
+    _tempIndicesHashes.insert(std::make_pair(_getTempBufferHash(ind),(int)_tempIndices.size()-1));
     return((int)_tempIndices.size()-1);
 }
 
@@ -1532,8 +1647,10 @@ void CGeometric::getIndicesFromBufferBasedOnIndex(int index,std::vector<int>& in
 int CGeometric::getBufferIndexOfNormals(const std::vector<float>& norm)
 {
     int norml=(int)norm.size();
-    for (int i=0;i<int(_tempNormals.size());i++)
+    std::pair<std::multimap<suint64,int>::iterator,std::multimap<suint64,int>::iterator> range=_tempNormalsHashes.equal_range(_getTempBufferHash(norm));
+    for (std::multimap<suint64,int>::iterator it=range.first;it!=range.second;it++)
     {
+        int i=it->second;
         if (int(_tempNormals[i]->size())==norml)
         { // might be same!
             bool same=true;
@@ -1558,6 +1675,7 @@ int CGeometric::addNormalsToBufferAndReturnIndex(const std::vector<float>& norm)
     std::vector<float>* nnorm=new std::vector<float>;
     nnorm->assign(norm.begin(),norm.end());
     _tempNormals.push_back(nnorm);
+    _tempNormalsHashes.insert(std::make_pair(_getTempBufferHash(norm),(int)_tempNormals.size()-1));
     return((int)_tempNormals.size()-1);
 }
 
@@ -1569,8 +1687,10 @@ void CGeometric::getNormalsFromBufferBasedOnIndex(int index,std::vector<float>&
 int CGeometric::getBufferIndexOfEdges(const std::vector<unsigned char>& edges)
 {
     int edgesl=(int)edges.size();
-    for (int i=0;i<int(_tempEdges.size());i++)
+    std::pair<std::multimap<suint64,int>::iterator,std::multimap<suint64,int>::iterator> range=_tempEdgesHashes.equal_range(_getTempBufferHash(edges));
+    for (std::multimap<suint64,int>::iterator it=range.first;it!=range.second;it++)
     {
+        int i=it->second;
         if (int(_tempEdges[i]->size())==edgesl)
         { // might be same!
             bool same=true;
@@ -1595,6 +1715,7 @@ int CGeometric::addEdgesToBufferAndReturnIndex(const std::vector<unsigned char>&
     std::vector<unsigned char>* nedges=new std::vector<unsigned char>;
     nedges->assign(edges.begin(),edges.end());
     _tempEdges.push_back(nedges);
+    _tempEdgesHashes.insert(std::make_pair(_getTempBufferHash(edges),(int)_tempEdges.size()-1));
     return((int)_tempEdges.size()-1);
 }
 
@@ -1628,16 +1749,26 @@ void CGeometric::serialize(CSer& ar)
 
         if (App::ct->undoBufferContainer->isUndoSavingOrRestoringUnderWay())
         { // undo/redo serialization:
+            // Mesh data that didn't change since the last undo point is not compared nor copied again:
+            CUndoBufferArrays& arrays=App::ct->undoBufferContainer->undoBufferArrays;
+            int bufferId=App::ct->undoBufferContainer->getNextBufferId();
+            if ( (_undoVertexBufferId==-1)||(!arrays.addDependency(_undoVertexBufferId,bufferId)) )
+                _undoVertexBufferId=arrays.addVertexBuffer(_vertices,bufferId);
+            if ( (_undoIndexBufferId==-1)||(!arrays.addDependency(_undoIndexBufferId,bufferId)) )
+                _undoIndexBufferId=arrays.addIndexBuffer(_indices,bufferId);
+            if ( (_undoNormalsBufferId==-1)||(!arrays.addDependency(_undoNormalsBufferId,bufferId)) )
+                _undoNormalsBufferId=arrays.addNormalsBuffer(_normals,bufferId);
+
             ar.storeDataName("Ver");
-            ar << App::ct->undoBufferContainer->undoBufferArrays.addVertexBuffer(_vertices,App::ct->undoBufferContainer->getNextBufferId());
+            ar << _undoVertexBufferId;
             ar.flush();
 
             ar.storeDataName("Ind");
-            ar << App::ct->undoBufferContainer->undoBufferArrays.addIndexBuffer(_indices,App::ct->undoBufferContainer->getNextBufferId());
+            ar << _undoIndexBufferId;
             ar.flush();
 
             ar.storeDataName("Nor");
-            ar << App::ct->undoBufferContainer->undoBufferArrays.addNormalsBuffer(_normals,App::ct->undoBufferContainer->getNextBufferId());
+            ar << _undoNormalsBufferId;
             ar.flush();
         }
         else
@@ -1747,6 +1878,7 @@ void CGeometric::serialize(CSer& ar)
                         int id;
                         ar >> id;
                         App::ct->undoBufferContainer->undoBufferArrays.getVertexBuffer(id,_vertices);
+                        _undoVertexBufferId=id;
                     }
                     if (theName.compare("Ind")==0)
                     {
@@ -1755,6 +1887,7 @@ void CGeometric::serialize(CSer& ar)
                         int id;
                         ar >> id;
                         App::ct->undoBufferContainer->undoBufferArrays.getIndexBuffer(id,_indices);
+                        _undoIndexBufferId=id;
                     }
                     if (theName.compare("Nor")==0)
                     {
@@ -1763,6 +1896,7 @@ void CGeometric::serialize(CSer& ar)
                         int id;
                         ar >> id;
                         App::ct->undoBufferContainer->undoBufferArrays.getNormalsBuffer(id,_normals);
+                        _undoNormalsBufferId=id;
                     }
                 }
                 else
@@ -1973,9 +2107,9 @@ void CGeometric::display_colorCoded(CGeomProxy* geomData,int objectId,int displa
 void CGeometric::displayForCutting(CGeomProxy* geomData,int displayAttrib,CVisualParam* collisionColor,const float normalVectorForPointsAndLines[3])
 { // function has virtual/non-virtual counterpart!
     C_API_FUNCTION_DEBUG;
-    CPluginContainer::mesh_lockUnlock(true); // to avoid accessing invalid data! Do not forget to unlock!!
+    CPluginContainer::mesh_lockUnlock(geomData->collInfo,true); // to avoid accessing invalid data! Do not forget to unlock!!
     displayGeometricForCutting(this,geomData,displayAttrib,collisionColor,normalVectorForPointsAndLines);
-    CPluginContainer::mesh_lockUnlock(false);
+    CPluginContainer::mesh_lockUnlock(geomData->collInfo,false);
 }
 
 void CGeometric::displayGhost(CGeomProxy* geomData,int displayAttrib,bool originalColors,bool backfaceCulling,float transparency,const float* newColors)
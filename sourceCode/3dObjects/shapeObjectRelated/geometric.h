@@ -114,6 +114,7 @@ public:
     static int getBufferIndexOfEdges(const std::vector<unsigned char>& edges);
     static int addEdgesToBufferAndReturnIndex(const std::vector<unsigned char>& edges);
     static void getEdgesFromBufferBasedOnIndex(int index,std::vector<unsigned char>& edges);
+    static std::string getLastTempBufferStatistics(); // duplicate statistics of the last serialization, or empty
 
 
     CVisualParam color;
@@ -133,6 +134,10 @@ protected:
 
     static void _savePackedIntegers(CSer& ar,const std::vector<int>& data);
     static void _loadPackedIntegers(CSer& ar,std::vector<int>& data);
+    static suint64 _getTempBufferHash(const std::vector<float>& buff);
+    static suint64 _getTempBufferHash(const std::vector<int>& buff);
+    static suint64 _getTempBufferHash(const std::vector<unsigned char>& buff);
+    static void _addToTempBufferStatistics(int bufferIndex,size_t sizeInBytes);
 
     std::vector<float> _vertices;
     std::vector<int> _indices;
@@ -168,6 +173,11 @@ protected:
     int _normalBufferId;
     int _edgeBufferId;
 
+    // Ids of the mesh data in the undo buffer arrays. -1 when the data changed since the last undo point (i.e. dirty):
+    int _undoVertexBufferId;
+    int _undoIndexBufferId;
+    int _undoNormalsBufferId;
+
     unsigned int _extRendererObjectId;
     unsigned int _extRendererObject_lastMeshId;
     unsigned int _extRendererObject_lastTextureId;
@@ -189,6 +199,15 @@ protected:
     static std::vector<std::vector<int>*> _tempIndices;
     static std::vector<std::vector<float>*> _tempNormals;
     static std::vector<std::vector<unsigned char>*> _tempEdges;
+    // Content hash --> index in above buffers. Only equal hashes are compared element by element:
+    static std::multimap<suint64,int> _tempVerticesHashes;
+    static std::multimap<suint64,int> _tempIndicesHashes;
+    static std::multimap<suint64,int> _tempNormalsHashes;
+    static std::multimap<suint64,int> _tempEdgesHashes;
+    static int _tempBufferRequestCount;
+    static int _tempBufferDuplicateCount;
+    static double _tempBufferDuplicateSizeInBytes;
+    static std::string _lastTempBufferStatistics;
 
 #ifdef SIM_WITH_GUI
 public:
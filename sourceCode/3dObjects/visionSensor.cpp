@@ -10,6 +10,7 @@
 #include "sceneObjectOperations.h"
 #include "v_repStrings.h"
 #include <boost/lexical_cast.hpp>
+#include <string.h>
 #include "vDateTime.h"
 #include "vVarious.h"
 #include "ttUtil.h"
@@ -17,6 +18,7 @@
 #include "easyLock.h"
 #include "app.h"
 #include "pluginContainer.h"
+#include "stepProfiler.h"
 #include "visionSensorRendering.h"
 #ifdef SIM_WITH_OPENGL
 #include "rendering.h"
@@ -84,105 +86,120 @@ float* CVisionSensor::readPortionOfImage(int posX,int posY,int sizeX,int sizeY,i
         buff=new float[sizeX*sizeY*3];
     else
         buff=new float[sizeX*sizeY];
-    int p=0;
+    readPortionOfImage(posX,posY,sizeX,sizeY,rgbGreyOrDepth,buff);
+    return(buff);
+}
+
+bool CVisionSensor::readPortionOfImage(int posX,int posY,int sizeX,int sizeY,int rgbGreyOrDepth,float* buffer) const
+{ // Same as above, but fills a buffer provided by the caller (sizeX*sizeY*3 values for RGB, sizeX*sizeY otherwise)
+    if ( (posX<0)||(posY<0)||(sizeX<1)||(sizeY<1)||(posX+sizeX>_resolutionX)||(posY+sizeY>_resolutionY) )
+        return(false);
+    const float* table=CImageProcess::getByteToFloatTable();
+    float* buff=buffer;
     for (int j=posY;j<posY+sizeY;j++)
     {
-        for (int i=posX;i<posX+sizeX;i++)
+        if (rgbGreyOrDepth==0)
+        { // RGB
+            CImageProcess::charImageToFloatImage(sizeX*3,_rgbBuffer+3*(j*_resolutionX+posX),buff);
+            buff+=sizeX*3;
+        }
+        else
         {
-            if (rgbGreyOrDepth==0)
-            { // RGB
-                buff[3*p+0]=float(_rgbBuffer[3*(j*_resolutionX+i)+0])/255.0f;
-                buff[3*p+1]=float(_rgbBuffer[3*(j*_resolutionX+i)+1])/255.0f;
-                buff[3*p+2]=float(_rgbBuffer[3*(j*_resolutionX+i)+2])/255.0f;
-            }
-            else
-            {
-                if (rgbGreyOrDepth==1)
-                { // Greyscale
-                    buff[p]=float(_rgbBuffer[3*(j*_resolutionX+i)+0])/255.0f;
-                    buff[p]+=float(_rgbBuffer[3*(j*_resolutionX+i)+1])/255.0f;
-                    buff[p]+=float(_rgbBuffer[3*(j*_resolutionX+i)+2])/255.0f;
-                    buff[p]/=3.0f;
+            if (rgbGreyOrDepth==1)
+            { // Greyscale
+                const unsigned char* row=_rgbBuffer+3*(j*_resolutionX+posX);
+                for (int i=0;i<sizeX;i++)
+                {
+                    float v=table[row[3*i+0]];
+                    v+=table[row[3*i+1]];
+                    v+=table[row[3*i+2]];
+                    buff[i]=v/3.0f;
                 }
-                else
-                    buff[p]=_depthBuffer[j*_resolutionX+i];
             }
-            p++;
+            else
+                memcpy(buff,_depthBuffer+j*_resolutionX+posX,sizeX*sizeof(float));
+            buff+=sizeX;
         }
     }
-    return(buff);
+    return(true);
 }
 
 unsigned char* CVisionSensor::readPortionOfCharImage(int posX,int posY,int sizeX,int sizeY,float cutoffRgba,bool imgIsGreyScale)
 {
     if ( (posX<0)||(posY<0)||(sizeX<1)||(sizeY<1)||(posX+sizeX>_resolutionX)||(posY+sizeY>_resolutionY) )
         return(NULL);
-    unsigned char* buff=NULL;
-    if (cutoffRgba==0.0f)
+    int valuesPerPixel=3;
+    if (imgIsGreyScale)
+        valuesPerPixel=1;
+    if (cutoffRgba!=0.0f)
+        valuesPerPixel++;
+    unsigned char* buff=new unsigned char[sizeX*sizeY*valuesPerPixel];
+    readPortionOfCharImage(posX,posY,sizeX,sizeY,cutoffRgba,imgIsGreyScale,buff);
+    return(buff);
+}
+
+bool CVisionSensor::readPortionOfCharImage(int posX,int posY,int sizeX,int sizeY,float cutoffRgba,bool imgIsGreyScale,unsigned char* buffer) const
+{ // Same as above, but fills a buffer provided by the caller. With a cutoff value, an alpha channel is appended to each pixel
+    if ( (posX<0)||(posY<0)||(sizeX<1)||(sizeY<1)||(posX+sizeX>_resolutionX)||(posY+sizeY>_resolutionY) )
+        return(false);
+    unsigned char* buff=buffer;
+    for (int j=posY;j<posY+sizeY;j++)
     {
-        if (imgIsGreyScale)
-            buff=new unsigned char[sizeX*sizeY];
-        else
-            buff=new unsigned char[sizeX*sizeY*3];
-        int p=0;
-        for (int j=posY;j<posY+sizeY;j++)
+        const unsigned char* row=_rgbBuffer+3*(j*_resolutionX+posX);
+        const float* depthRow=_depthBuffer+j*_resolutionX+posX;
+        if (cutoffRgba==0.0f)
         {
-            for (int i=posX;i<posX+sizeX;i++)
+            if (imgIsGreyScale)
             {
-                if (imgIsGreyScale)
-                {
-                    unsigned int v=_rgbBuffer[3*(j*_resolutionX+i)+0];
-                    v+=_rgbBuffer[3*(j*_resolutionX+i)+1];
-                    v+=_rgbBuffer[3*(j*_resolutionX+i)+2];
-                    buff[p]=(unsigned char)(v/3);
-                }
-                else
+                for (int i=0;i<sizeX;i++)
                 {
-                    buff[3*p+0]=_rgbBuffer[3*(j*_resolutionX+i)+0];
-                    buff[3*p+1]=_rgbBuffer[3*(j*_resolutionX+i)+1];
-                    buff[3*p+2]=_rgbBuffer[3*(j*_resolutionX+i)+2];
+                    unsigned int v=row[3*i+0];
+                    v+=row[3*i+1];
+                    v+=row[3*i+2];
+                    buff[i]=(unsigned char)(v/3);
                 }
-                p++;
+                buff+=sizeX;
+            }
+            else
+            {
+                memcpy(buff,row,sizeX*3);
+                buff+=sizeX*3;
             }
         }
-    }
-    else
-    {
-        if (imgIsGreyScale)
-            buff=new unsigned char[sizeX*sizeY*2];
         else
-            buff=new unsigned char[sizeX*sizeY*4];
-        int p=0;
-        for (int j=posY;j<posY+sizeY;j++)
         {
-            for (int i=posX;i<posX+sizeX;i++)
+            if (imgIsGreyScale)
             {
-                if (imgIsGreyScale)
+                for (int i=0;i<sizeX;i++)
                 {
-                    unsigned int v=_rgbBuffer[3*(j*_resolutionX+i)+0];
-                    v+=_rgbBuffer[3*(j*_resolutionX+i)+1];
-                    v+=_rgbBuffer[3*(j*_resolutionX+i)+2];
-                    buff[2*p+0]=(unsigned char)(v/3);
-                    if (_depthBuffer[j*_resolutionX+i]>cutoffRgba)
-                        buff[2*p+1]=0;
+                    unsigned int v=row[3*i+0];
+                    v+=row[3*i+1];
+                    v+=row[3*i+2];
+                    buff[2*i+0]=(unsigned char)(v/3);
+                    if (depthRow[i]>cutoffRgba)
+                        buff[2*i+1]=0;
                     else
-                        buff[2*p+1]=255;
+                        buff[2*i+1]=255;
                 }
-                else
+                buff+=sizeX*2;
+            }
+            else
+            {
+                for (int i=0;i<sizeX;i++)
                 {
-                    buff[4*p+0]=_rgbBuffer[3*(j*_resolutionX+i)+0];
-                    buff[4*p+1]=_rgbBuffer[3*(j*_resolutionX+i)+1];
-                    buff[4*p+2]=_rgbBuffer[3*(j*_resolutionX+i)+2];
-                    if (_depthBuffer[j*_resolutionX+i]>cutoffRgba)
-                        buff[4*p+3]=0;
+                    buff[4*i+0]=row[3*i+0];
+                    buff[4*i+1]=row[3*i+1];
+                    buff[4*i+2]=row[3*i+2];
+                    if (depthRow[i]>cutoffRgba)
+                        buff[4*i+3]=0;
                     else
-                        buff[4*p+3]=255;
+                        buff[4*i+3]=255;
                 }
-                p++;
+                buff+=sizeX*4;
             }
         }
     }
-    return(buff);
+    return(true);
 }
 
 bool CVisionSensor::getFullBoundingBox(C3Vector& minV,C3Vector& maxV) const
@@ -293,6 +310,12 @@ void CVisionSensor::commonInit()
     _contextFboAndTexture=NULL;
 #endif
 
+    _asyncReadbackAllowed=false;
+    _readbackPending=false;
+    _readbackViaUiThread=false;
+    _asyncReadbackCheckState=0;
+    _handlingStarted=false;
+    _handlingDuration=0;
     _rgbBuffer=NULL;
     _previousRgbBuffer=NULL;
     _depthBuffer=NULL;
@@ -651,6 +674,10 @@ void CVisionSensor::resetSensor()
     }
     if (!_useExternalImage) // condition added on 2010/12/21
         _clearBuffers();
+#ifdef SIM_WITH_OPENGL
+    if ( (_contextFboAndTexture!=NULL)&&(_contextFboAndTexture->pixelReadback!=NULL) )
+        _contextFboAndTexture->pixelReadback->discardPendingReadbacks();
+#endif
 }
 
 bool CVisionSensor::setExternalImage(const float* img,bool imgIsGreyScale)
@@ -717,8 +744,19 @@ bool CVisionSensor::setExternalCharImage(const unsigned char* img,bool imgIsGrey
 }
 
 bool CVisionSensor::handleSensor()
-{
+{ // Single sensor. Several sensors should rather all be started, then all be finished
+    startSensorHandling(App::userSettings->visionSensorsAsyncReadback);
+    return(finishSensorHandling());
+}
+
+void CVisionSensor::startSensorHandling(bool asyncReadback)
+{ // Renders the image. With asyncReadback, the transfer of the image is only started, and finishSensorHandling fetches
+  // the image rendered during previous handling. This way, all sensors can be rendered before any image is waited for
     FUNCTION_DEBUG;
+    CStepProfilerScope profilerScope(PROFILER_CATEGORY_VISION_SENSOR,_objectID);
+    _handlingStarted=false;
+    _handlingDuration=0;
+    _readbackPending=false;
     sensorAuxiliaryResult.clear();
     sensorResult.sensorWasTriggered=false;
     sensorResult.sensorResultIsValid=false;
@@ -732,16 +770,40 @@ bool CVisionSensor::handleSensor()
         sensorResult.sensorDataDepth[i]=0.0f;
     }
     if (!App::ct->mainSettings->visionSensorsEnabled)
-        return(false);
+        return;
     if (_useExternalImage) // those 2 lines added on 2010/12/12
-        return(false);
+        return;
     int stTime=VDateTime::getTimeInMs();
+    _asyncReadbackAllowed=asyncReadback; // not for checkSensor & co, which need the image immediately
     detectEntity(_detectableEntityID,_detectableEntityID==-1,false,false,false,false);
+    _asyncReadbackAllowed=false;
+    _handlingStarted=true;
+    _handlingDuration=VDateTime::getTimeDiffInMs(stTime);
+}
+
+bool CVisionSensor::finishSensorHandling()
+{ // Fetches the image if its readback is still pending, applies the filters, and updates the texture
+    FUNCTION_DEBUG;
+    if (!_handlingStarted)
+        return(false);
+    _handlingStarted=false;
+    CStepProfilerScope profilerScope(PROFILER_CATEGORY_VISION_SENSOR,_objectID);
+    int stTime=VDateTime::getTimeInMs();
+    if (_readbackPending)
+    {
+        App::ct->calcInfo->visionSensorSimulationStart();
+        bool detected;
+        if (_readbackViaUiThread)
+            detected=fetchVisionSensorReadback_executedViaUiThread();
+        else
+            detected=_fetchPendingReadback();
+        App::ct->calcInfo->visionSensorSimulationEnd(detected);
+    }
 #ifdef SIM_WITH_OPENGL
     if (_contextFboAndTexture!=NULL)
         _contextFboAndTexture->textureObject->setImage(false,false,true,_rgbBuffer); // Update the texture
 #endif
-    sensorResult.calcTimeInMs=VDateTime::getTimeDiffInMs(stTime);
+    sensorResult.calcTimeInMs=_handlingDuration+VDateTime::getTimeDiffInMs(stTime);
     return(sensorResult.sensorWasTriggered);
 }
 
@@ -913,13 +975,19 @@ bool CVisionSensor::detectEntity(int entityID,bool detectAll,bool dontSwapImageB
     bool noAuxThread=VThread::isCurrentThreadTheUiThread()||VThread::isCurrentThreadTheMainSimulationThread();
     bool offscreen=(App::userSettings->offscreenContextType<1);
 
+    _readbackViaUiThread=false;
     if ( ui || ((noAuxThread&&offscreen)&&(!onlyGuiThread)) )
         returnValue=detectEntity2(entityID,detectAll,dontSwapImageBuffers,entityIsModelAndRenderAllVisibleModelAlsoNonRenderableObjects,hideEdgesIfModel,overrideRenderableFlagsForNonCollections);
     else
+    {
+        _readbackViaUiThread=true; // a pending readback will also have to be fetched in the UI thread
         returnValue=detectVisionSensorEntity_executedViaUiThread(entityID,detectAll,dontSwapImageBuffers,entityIsModelAndRenderAllVisibleModelAlsoNonRenderableObjects,hideEdgesIfModel,overrideRenderableFlagsForNonCollections);
+    }
 
-
-    App::ct->calcInfo->visionSensorSimulationEnd(returnValue);
+    if (_readbackPending)
+        App::ct->calcInfo->visionSensorReadbackStarted(); // counted once fetched
+    else
+        App::ct->calcInfo->visionSensorSimulationEnd(returnValue);
     return(returnValue);
 }
 
@@ -956,26 +1024,34 @@ bool CVisionSensor::detectEntity2(int entityID,bool detectAll,bool dontSwapImage
             swapImageBuffers();
         if (!_useExternalImage)
         {
-            if (!_ignoreRGBInfo)
+            bool depthRead=false;
+            if (_asyncReadbackAllowed)
             {
-                glPixelStorei(GL_PACK_ALIGNMENT,1);
-                glReadPixels(0,0,_resolutionX,_resolutionY,GL_RGB,GL_UNSIGNED_BYTE,_rgbBuffer);
-                glPixelStorei(GL_PACK_ALIGNMENT,4); // important to restore! Really?
+                if (_contextFboAndTexture->pixelReadback==NULL)
+                    _contextFboAndTexture->pixelReadback=new CPixelReadback(_resolutionX,_resolutionY);
+            }
+            if (_asyncReadbackAllowed&&_contextFboAndTexture->pixelReadback->isAvailable())
+            { // We only start the transfer of the image just rendered. finishSensorHandling fetches the image rendered during
+              // previous handling: images have a latency of one handling (after a reset, the first handling returns the cleared image)
+                _contextFboAndTexture->pixelReadback->startReadback(!_ignoreRGBInfo,!_ignoreDepthInfo,App::userSettings->visionSensorsAsyncReadbackCheck);
+                _readbackPending=true;
             }
-            if (!_ignoreDepthInfo)
+            else
             {
-                glReadPixels(0,0,_resolutionX,_resolutionY,GL_DEPTH_COMPONENT,GL_FLOAT,_depthBuffer);
-                // Convert this depth info into values corresponding to linear depths (if perspective mode):
-                if (_perspectiveOperation)
+                if (!_ignoreRGBInfo)
                 {
-                    float farMinusNear= _farClippingPlane-_nearClippingPlane;
-                    float farDivFarMinusNear=_farClippingPlane/farMinusNear;
-                    float nearTimesFar=_nearClippingPlane*_farClippingPlane;
-                    int v=_resolutionX*_resolutionY;
-                    for (int i=0;i<v;i++)
-                        _depthBuffer[i]=((nearTimesFar/(farMinusNear*(farDivFarMinusNear-_depthBuffer[i])))-_nearClippingPlane)/farMinusNear;
+                    glPixelStorei(GL_PACK_ALIGNMENT,1);
+                    glReadPixels(0,0,_resolutionX,_resolutionY,GL_RGB,GL_UNSIGNED_BYTE,_rgbBuffer);
+                    glPixelStorei(GL_PACK_ALIGNMENT,4); // important to restore! Really?
+                }
+                if (!_ignoreDepthInfo)
+                {
+                    glReadPixels(0,0,_resolutionX,_resolutionY,GL_DEPTH_COMPONENT,GL_FLOAT,_depthBuffer);
+                    depthRead=true;
                 }
             }
+            if (depthRead)
+                _linearizeDepthBuffer();
         }
 
         if (App::userSettings->useGlFinish_visionSensors) // false by default!
@@ -991,12 +1067,59 @@ bool CVisionSensor::detectEntity2(int entityID,bool detectAll,bool dontSwapImage
     else
         _extRenderer_retrieveImage();
 
+    if (_readbackPending)
+        return(false); // finishSensorHandling fetches the image and applies the filters
+
     returnValue=_computeDefaultReturnValuesAndApplyFilters(); // this might overwrite the default return values
     sensorResult.sensorWasTriggered=returnValue;
 
     return(returnValue);
 }
 
+bool CVisionSensor::_fetchPendingReadback()
+{ // Fetches the image whose transfer was started during previous handling, then applies the filters. Executed in
+  // the thread that rendered the image
+    FUNCTION_DEBUG;
+    _readbackPending=false;
+#ifdef SIM_WITH_OPENGL
+    if ( (_contextFboAndTexture!=NULL)&&(_contextFboAndTexture->pixelReadback!=NULL)&&_contextFboAndTexture->offscreenContext->makeCurrent() )
+    {
+        bool rgbRead,depthRead;
+        int comparisonResult;
+        _contextFboAndTexture->pixelReadback->fetchPreviousReadback(_rgbBuffer,_depthBuffer,rgbRead,depthRead,comparisonResult);
+        _contextFboAndTexture->offscreenContext->doneCurrent();
+        if (depthRead)
+            _linearizeDepthBuffer();
+        if ( (comparisonResult==1)&&(_asyncReadbackCheckState==0) )
+        { // reported once
+            _asyncReadbackCheckState=1;
+            App::addStatusbarMessage("Vision sensor '"+getObjectName()+"': asynchronous and synchronous readbacks are identical.");
+        }
+        if ( (comparisonResult==0)&&(_asyncReadbackCheckState!=2) )
+        { // reported once
+            _asyncReadbackCheckState=2;
+            App::addStatusbarMessage("Vision sensor '"+getObjectName()+"': asynchronous and synchronous readbacks DIFFER.");
+        }
+    }
+#endif
+    bool returnValue=_computeDefaultReturnValuesAndApplyFilters(); // this might overwrite the default return values
+    sensorResult.sensorWasTriggered=returnValue;
+    return(returnValue);
+}
+
+void CVisionSensor::_linearizeDepthBuffer()
+{ // Convert the depth info into values corresponding to linear depths (if perspective mode):
+    if (_perspectiveOperation)
+    {
+        float farMinusNear= _farClippingPlane-_nearClippingPlane;
+        float farDivFarMinusNear=_farClippingPlane/farMinusNear;
+        float nearTimesFar=_nearClippingPlane*_farClippingPlane;
+        int v=_resolutionX*_resolutionY;
+        for (int i=0;i<v;i++)
+            _depthBuffer[i]=((nearTimesFar/(farMinusNear*(farDivFarMinusNear-_depthBuffer[i])))-_nearClippingPlane)/farMinusNear;
+    }
+}
+
 void CVisionSensor::_extRenderer_prepareView(int extRendererIndex)
 {   // Set-up the resolution, clear color, camera properties and camera pose:
     CPluginContainer::selectExtRenderer(extRendererIndex);
@@ -2152,6 +2275,14 @@ bool CVisionSensor::_computeDefaultReturnValuesAndApplyFilters()
             applyFilter=false; // since this represents the identity filter
     }
 
+    if ( applyFilter&&_composedFilter->canProcessCharImages() )
+    { // 8-bit pipeline: the image is never widened to float
+        bool trigg;
+        const unsigned char* outputImage=_composedFilter->processAndTriggerChar(_resolutionX,_resolutionY,_rgbBuffer,trigg);
+        memcpy(_rgbBuffer,outputImage,_resolutionX*_resolutionY*3);
+        return(trigg);
+    }
+
     if (applyFilter)
     {
         float* outputImage=CImageProcess::createRGBImage(_resolutionX,_resolutionY);
@@ -2160,8 +2291,7 @@ bool CVisionSensor::_computeDefaultReturnValuesAndApplyFilters()
             outputDepthBuffer=CImageProcess::createIntensityImage(_resolutionX,_resolutionY);
         int s=_resolutionX*_resolutionY*3;
         float* imageBuffer=new float[s];
-        for (int i=0;i<s;i++)
-            imageBuffer[i]=float(_rgbBuffer[i])/255.0f;
+        CImageProcess::charImageToFloatImage(s,_rgbBuffer,imageBuffer);
         bool trigg=_composedFilter->processAndTrigger(this,_resolutionX,_resolutionY,imageBuffer,_depthBuffer,outputImage,outputDepthBuffer,sensorAuxiliaryResult);
         delete[] imageBuffer;
         for (int i=0;i<s;i++)
@@ -2443,6 +2573,27 @@ bool CVisionSensor::detectVisionSensorEntity_executedViaUiThread(int entityID,bo
     return(retVal);
 }
 
+bool CVisionSensor::fetchVisionSensorReadback_executedViaUiThread()
+{
+    FUNCTION_DEBUG;
+    bool retVal=false;
+    if (VThread::isCurrentThreadTheUiThread())
+    { // we are in the UI thread. We execute the command now:
+        retVal=_fetchPendingReadback();
+    }
+    else
+    { // We are NOT in the UI thread. We execute the command via the UI thread:
+        SUIThreadCommand cmdIn;
+        SUIThreadCommand cmdOut;
+        cmdIn.cmdId=FETCH_VISION_SENSOR_READBACK_UITHREADCMD;
+        cmdIn.objectParams.push_back(this);
+        App::uiThread->executeCommandViaUiThread(&cmdIn,&cmdOut);
+        if (cmdOut.boolParams.size()>0)
+            retVal=cmdOut.boolParams[0];
+    }
+    return(retVal);
+}
+
 void CVisionSensor::display(CViewableBase* renderingObject,int displayAttrib)
 {
     FUNCTION_INSIDE_DEBUG("CVisionSensor::display");
@@ -83,6 +83,8 @@ public:
     bool getShowVolumeWhenDetecting();
     void resetSensor();
     bool handleSensor();
+    void startSensorHandling(bool asyncReadback);
+    bool finishSensorHandling();
     bool checkSensor(int entityID,bool overrideRenderableFlagsForNonCollections);
     float* checkSensorEx(int entityID,bool imageBuffer,bool entityIsModelAndRenderAllVisibleModelAlsoNonRenderableObjects,bool hideEdgesIfModel,bool overrideRenderableFlagsForNonCollections);
     bool setExternalImage(const float* img,bool imgIsGreyScale);
@@ -110,6 +112,7 @@ public:
     int getDetectableEntityID();
 
     bool detectVisionSensorEntity_executedViaUiThread(int entityID,bool detectAll,bool dontSwapImageBuffers,bool entityIsModelAndRenderAllVisibleModelAlsoNonRenderableObjects,bool hideEdgesIfModel,bool overrideRenderableFlagsForNonCollections);
+    bool fetchVisionSensorReadback_executedViaUiThread();
     bool detectEntity(int entityID,bool detectAll,bool dontSwapImageBuffers,bool entityIsModelAndRenderAllVisibleModelAlsoNonRenderableObjects,bool hideEdgesIfModel,bool overrideRenderableFlagsForNonCollections);
     bool detectEntity2(int entityID,bool detectAll,bool dontSwapImageBuffers,bool entityIsModelAndRenderAllVisibleModelAlsoNonRenderableObjects,bool hideEdgesIfModel,bool overrideRenderableFlagsForNonCollections);
     void renderForDetection(int entityID,bool detectAll,bool entityIsModelAndRenderAllVisibleModelAlsoNonRenderableObjects,bool hideEdgesIfModel,bool overrideRenderableFlagsForNonCollections,const std::vector<int>& activeMirrors);
@@ -126,6 +129,8 @@ public:
 
     float* readPortionOfImage(int posX,int posY,int sizeX,int sizeY,int rgbGreyOrDepth);
     unsigned char* readPortionOfCharImage(int posX,int posY,int sizeX,int sizeY,float cutoffRgba,bool imgIsGreyScale);
+    bool readPortionOfImage(int posX,int posY,int sizeX,int sizeY,int rgbGreyOrDepth,float* buffer) const;
+    bool readPortionOfCharImage(int posX,int posY,int sizeX,int sizeY,float cutoffRgba,bool imgIsGreyScale,unsigned char* buffer) const;
 
     void setUseEnvironmentBackgroundColor(bool s);
     bool getUseEnvironmentBackgroundColor();
@@ -147,6 +152,8 @@ protected:
     void _clearBuffers();
 
     bool _computeDefaultReturnValuesAndApplyFilters();
+    bool _fetchPendingReadback();
+    void _linearizeDepthBuffer();
 
     C3DObject* _getInfoOfWhatNeedsToBeRendered(int entityID,bool detectAll,int rendAttrib,bool entityIsModelAndRenderAllVisibleModelAlsoNonRenderableObjects,bool overrideRenderableFlagsForNonCollections,std::vector<C3DObject*>& toRender);
 
@@ -155,6 +162,12 @@ protected:
     void _extRenderer_prepareMirrors();
     void _extRenderer_retrieveImage();
 
+    bool _asyncReadbackAllowed;
+    bool _readbackPending; // an asynchronous readback was started, the filters did not run yet
+    bool _readbackViaUiThread; // the readback was started in the UI thread, and must be fetched there
+    int _asyncReadbackCheckState; // 0=nothing reported, 1=identical images reported, 2=differing images reported
+    bool _handlingStarted;
+    int _handlingDuration;
     unsigned char* _rgbBuffer;
     unsigned char* _previousRgbBuffer;
     float* _depthBuffer;
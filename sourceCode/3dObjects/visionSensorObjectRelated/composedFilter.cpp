@@ -3,12 +3,18 @@
 #include "composedFilter.h"
 #include "visionSensor.h"
 #include "v_repConst.h"
+#include "imageProcess.h"
+#include <string.h>
 
 CComposedFilter::CComposedFilter()
 {
     buffer1=NULL;
     buffer2=NULL;
     workImage=NULL;
+    charBuffer1=NULL;
+    charBuffer2=NULL;
+    charWorkImage=NULL;
+    charOutputImage=NULL;
 }
 
 CComposedFilter::~CComposedFilter()
@@ -160,6 +166,14 @@ void CComposedFilter::removeBuffers()
     buffer2=NULL;
     delete[] workImage;
     workImage=NULL;
+    delete[] charBuffer1;
+    charBuffer1=NULL;
+    delete[] charBuffer2;
+    charBuffer2=NULL;
+    delete[] charWorkImage;
+    charWorkImage=NULL;
+    delete[] charOutputImage;
+    charOutputImage=NULL;
 }
 
 bool CComposedFilter::includesDepthBufferModification()
@@ -176,6 +190,8 @@ bool CComposedFilter::includesDepthBufferModification()
 bool CComposedFilter::processAndTrigger(CVisionSensor* sensor,int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* outputDepthBuffer,std::vector<std::vector<float> >& returnData)
 {
     bool retVal=false;
+    if (charWorkImage!=NULL)
+        _convertBuffersToFloat(sizeX*sizeY*3);
     if (workImage==NULL)
     {
         int s=sizeX*sizeY*3;
@@ -204,6 +220,82 @@ bool CComposedFilter::processAndTrigger(CVisionSensor* sensor,int sizeX,int size
     return(retVal);
 }
 
+bool CComposedFilter::canProcessCharImages()
+{
+    for (size_t i=0;i<_allSimpleFilters.size();i++)
+    {
+        if (!_allSimpleFilters[i]->canProcessCharImages())
+            return(false);
+    }
+    return(true);
+}
+
+const unsigned char* CComposedFilter::processAndTriggerChar(int sizeX,int sizeY,const unsigned char* inputImage,bool& triggered)
+{ // Call only if canProcessCharImages() is true. Returns the output image, valid until the next call
+    triggered=false;
+    int s=sizeX*sizeY*3;
+    if (workImage!=NULL)
+        _convertBuffersToChar(s);
+    if (charWorkImage==NULL)
+    {
+        charBuffer1=new unsigned char[s];
+        charBuffer2=new unsigned char[s];
+        charWorkImage=new unsigned char[s];
+        charOutputImage=new unsigned char[s];
+        memset(charBuffer1,0,s);
+        memset(charBuffer2,0,s);
+        memset(charWorkImage,0,s);
+        memset(charOutputImage,0,s);
+    }
+    drawingContainer.removeAllObjects();
+    for (size_t i=0;i<_allSimpleFilters.size();i++)
+    {
+        if (_allSimpleFilters[i]->processAndTriggerChar(sizeX,sizeY,inputImage,charOutputImage,charWorkImage,charBuffer1,charBuffer2))
+            triggered=true;
+    }
+    return(charOutputImage);
+}
+
+void CComposedFilter::_convertBuffersToChar(int valueCount)
+{ // The filter was changed during simulation: keep the content of the persistent buffers
+    charBuffer1=new unsigned char[valueCount];
+    charBuffer2=new unsigned char[valueCount];
+    charWorkImage=new unsigned char[valueCount];
+    charOutputImage=new unsigned char[valueCount];
+    memset(charOutputImage,0,valueCount);
+    float* src[3]={buffer1,buffer2,workImage};
+    unsigned char* dst[3]={charBuffer1,charBuffer2,charWorkImage};
+    for (int j=0;j<3;j++)
+    {
+        for (int i=0;i<valueCount;i++)
+            dst[j][i]=(unsigned char)(SIM_MAX(0.0f,SIM_MIN(1.0f,src[j][i]))*255.1f);
+    }
+    delete[] buffer1;
+    buffer1=NULL;
+    delete[] buffer2;
+    buffer2=NULL;
+    delete[] workImage;
+    workImage=NULL;
+}
+
+void CComposedFilter::_convertBuffersToFloat(int valueCount)
+{ // The filter was changed during simulation: keep the content of the persistent buffers
+    buffer1=new float[valueCount];
+    buffer2=new float[valueCount];
+    workImage=new float[valueCount];
+    CImageProcess::charImageToFloatImage(valueCount,charBuffer1,buffer1);
+    CImageProcess::charImageToFloatImage(valueCount,charBuffer2,buffer2);
+    CImageProcess::charImageToFloatImage(valueCount,charWorkImage,workImage);
+    delete[] charBuffer1;
+    charBuffer1=NULL;
+    delete[] charBuffer2;
+    charBuffer2=NULL;
+    delete[] charWorkImage;
+    charWorkImage=NULL;
+    delete[] charOutputImage;
+    charOutputImage=NULL;
+}
+
 void CComposedFilter::displayOverlay(int c0[2],int c1[2])
 {
     drawingContainer.render(c0,c1);
@@ -24,6 +24,8 @@ public:
     void removeSimpleFilter(int index);
     bool moveSimpleFilter(int index,bool up);
     bool processAndTrigger(CVisionSensor* sensor,int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* outputDepthBuffer,std::vector<std::vector<float> >& returnData);
+    bool canProcessCharImages();
+    const unsigned char* processAndTriggerChar(int sizeX,int sizeY,const unsigned char* inputImage,bool& triggered);
     bool includesDepthBufferModification();
     void initializeInitialValues(bool simulationIsRunning);
     void simulationEnded();
@@ -37,4 +39,12 @@ protected:
     float* buffer1;
     float* buffer2;
     float* workImage;
+
+    // 8-bit buffers, used instead of above ones when all components can work on 8-bit values:
+    unsigned char* charBuffer1;
+    unsigned char* charBuffer2;
+    unsigned char* charWorkImage;
+    unsigned char* charOutputImage;
+    void _convertBuffersToChar(int valueCount);
+    void _convertBuffersToFloat(int valueCount);
 };
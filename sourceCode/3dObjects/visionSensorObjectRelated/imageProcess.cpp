@@ -2,6 +2,32 @@
 #include "vrepMainHeader.h"
 #include "imageProcess.h"
 #include "mathDefines.h"
+#include "workerPool.h"
+#include "app.h"
+
+#if defined(__SSE__)||defined(_M_X64)||(defined(_M_IX86_FP)&&(_M_IX86_FP>=1))
+    #define IMAGE_PROCESS_SSE
+    #include <xmmintrin.h>
+#endif
+
+#define IMAGE_PROCESS_MIN_PARALLEL_PIXELS 16384 // smaller images are processed by the calling thread only
+
+bool CImageProcess::_optimizationsEnabled=true;
+float CImageProcess::_byteToFloatTable[256];
+bool CImageProcess::_byteToFloatTableInitialized=CImageProcess::_initializeByteToFloatTable(); // before any thread can use it
+
+#ifdef IMAGE_PROCESS_SSE
+static inline __m128 loadRgb_sse(const float* p)
+{ // r,g,b,0. Does not read past the pixel
+    return(_mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(),(const __m64*)p),_mm_load_ss(p+2)));
+}
+
+static inline void storeRgb_sse(float* p,__m128 v)
+{
+    _mm_storel_pi((__m64*)p,v);
+    _mm_store_ss(p+2,_mm_movehl_ps(v,v));
+}
+#endif
 
 CImageProcess::CImageProcess()
 {
@@ -11,6 +37,58 @@ CImageProcess::~CImageProcess()
 {
 }
 
+void CImageProcess::setOptimizationsEnabled(bool e)
+{ // disabled, the original (serial, scalar) implementations are used. For benchmarks
+    _optimizationsEnabled=e;
+}
+
+bool CImageProcess::getOptimizationsEnabled()
+{
+    return(_optimizationsEnabled);
+}
+
+bool CImageProcess::_initializeByteToFloatTable()
+{ // Entry i is float(i)/255.0f, i.e. exactly the value of the per-pixel division
+    for (int i=0;i<256;i++)
+        _byteToFloatTable[i]=float(i)/255.0f;
+    return(true);
+}
+
+const float* CImageProcess::getByteToFloatTable()
+{
+    return(_byteToFloatTable);
+}
+
+void CImageProcess::charImageToFloatImage(int valueCount,const unsigned char* charImage,float* floatImage)
+{
+    const float* table=getByteToFloatTable();
+    for (int i=0;i<valueCount;i++)
+        floatImage[i]=table[charImage[i]];
+}
+
+void CImageProcess::processRows(int resX,int resY,IMAGE_ROWS_FUNCTION function,void* data)
+{ // Calls function for all rows. If enabled, rows are split into tiles that are distributed to the worker threads
+    int workerCount=CWorkerPool::getEffectiveWorkerCount();
+    if ( (!_optimizationsEnabled)||(!App::userSettings->parallelImageProcessing)||(workerCount==0)||(resX*resY<IMAGE_PROCESS_MIN_PARALLEL_PIXELS) )
+    {
+        function(data,0,resY);
+        return;
+    }
+    SImageProcessRowTiles tiles;
+    tiles.function=function;
+    tiles.data=data;
+    tiles.resY=resY;
+    tiles.tileRowCount=SIM_MAX(8,resY/(4*(workerCount+1))); // a few tiles per thread, for load balancing
+    CWorkerPool::executeTasks(_rowTileTask,&tiles,(resY+tiles.tileRowCount-1)/tiles.tileRowCount);
+}
+
+void CImageProcess::_rowTileTask(void* taskData,int taskIndex)
+{
+    SImageProcessRowTiles* tiles=(SImageProcessRowTiles*)taskData;
+    int rowStart=taskIndex*tiles->tileRowCount;
+    tiles->function(tiles->data,rowStart,SIM_MIN(rowStart+tiles->tileRowCount,tiles->resY));
+}
+
 float* CImageProcess::createRGBImage(int resX,int resY)
 {
     float* retVal=new float[resX*resY*3];
@@ -72,78 +150,137 @@ void CImageProcess::intensityImageToRGBImage(int resX,int resY,float* rgbImage,f
 
 void CImageProcess::filter3x3RgbImage(int resX,int resY,float* rgbIn,float* rgbOut,float m[9])
 { // m is specified line after line
-    float w,cnt;
-    int x,y,tmp;
-    for (int i=0;i<resX;i++)
+    if (_optimizationsEnabled)
     {
-        for (int j=0;j<resY;j++)
+        SImageProcessRows rows;
+        rows.resX=resX;
+        rows.resY=resY;
+        rows.imageIn=rgbIn;
+        rows.imageOut=rgbOut;
+        rows.matrix=m;
+        rows.matrixHalfSize=1;
+        processRows(resX,resY,_filterRgbRows,&rows);
+    }
+    else
+    {
+        for (int i=0;i<resX;i++)
         {
-            float rgbCumul[3]={0.0f,0.0f,0.0f};
-            cnt=0.0f;
-            for (int k=-1;k<2;k++)
-            {
-                x=i+k;
-                if ((x>=0)&&(x<resX))
-                {
-                    for (int l=-1;l<2;l++)
-                    {
-                        y=j+l;
-                        if ((y>=0)&&(y<resY))
-                        {
-                            w=m[k+1+(l+1)*3];
-                            tmp=3*(x+y*resX);
-                            rgbCumul[0]+=rgbIn[tmp+0]*w;
-                            rgbCumul[1]+=rgbIn[tmp+1]*w;
-                            rgbCumul[2]+=rgbIn[tmp+2]*w;
-                            cnt+=1.0f;
-                        }
-                    }
-                }
-            }
-            tmp=3*(i+j*resX);
-            cnt/=9.0f;
-            rgbOut[tmp+0]=rgbCumul[0]/cnt;
-            rgbOut[tmp+1]=rgbCumul[1]/cnt;
-            rgbOut[tmp+2]=rgbCumul[2]/cnt;
+            for (int j=0;j<resY;j++)
+                _filterRgbPixel(resX,resY,rgbIn,rgbOut,m,1,i,j);
         }
     }
 }
 
 void CImageProcess::filter5x5RgbImage(int resX,int resY,float* rgbIn,float* rgbOut,float m[25])
 { // m is specified line after line
+    if (_optimizationsEnabled)
+    {
+        SImageProcessRows rows;
+        rows.resX=resX;
+        rows.resY=resY;
+        rows.imageIn=rgbIn;
+        rows.imageOut=rgbOut;
+        rows.matrix=m;
+        rows.matrixHalfSize=2;
+        processRows(resX,resY,_filterRgbRows,&rows);
+    }
+    else
+    {
+        for (int i=0;i<resX;i++)
+        {
+            for (int j=0;j<resY;j++)
+                _filterRgbPixel(resX,resY,rgbIn,rgbOut,m,2,i,j);
+        }
+    }
+}
+
+void CImageProcess::_filterRgbPixel(int resX,int resY,const float* rgbIn,float* rgbOut,const float* m,int halfSize,int i,int j)
+{ // m is specified line after line. Pixels outside of the image are ignored and the result is scaled accordingly
+    int n=2*halfSize+1;
     float w,cnt;
     int x,y,tmp;
-    for (int i=0;i<resX;i++)
+    float rgbCumul[3]={0.0f,0.0f,0.0f};
+    cnt=0.0f;
+    for (int k=-halfSize;k<=halfSize;k++)
     {
-        for (int j=0;j<resY;j++)
+        x=i+k;
+        if ((x>=0)&&(x<resX))
         {
+            for (int l=-halfSize;l<=halfSize;l++)
+            {
+                y=j+l;
+                if ((y>=0)&&(y<resY))
+                {
+                    w=m[k+halfSize+(l+halfSize)*n];
+                    tmp=3*(x+y*resX);
+                    rgbCumul[0]+=rgbIn[tmp+0]*w;
+                    rgbCumul[1]+=rgbIn[tmp+1]*w;
+                    rgbCumul[2]+=rgbIn[tmp+2]*w;
+                    cnt+=1.0f;
+                }
+            }
+        }
+    }
+    tmp=3*(i+j*resX);
+    cnt/=float(n*n);
+    rgbOut[tmp+0]=rgbCumul[0]/cnt;
+    rgbOut[tmp+1]=rgbCumul[1]/cnt;
+    rgbOut[tmp+2]=rgbCumul[2]/cnt;
+}
+
+void CImageProcess::_filterRgbRows(void* data,int rowStart,int rowEnd)
+{ // Same results as _filterRgbPixel: inside of the border, all weights apply (no scaling) and we sum in the same order
+    SImageProcessRows* rows=(SImageProcessRows*)data;
+    int resX=rows->resX;
+    int h=rows->matrixHalfSize;
+    int n=2*h+1;
+    for (int j=rowStart;j<rowEnd;j++)
+    {
+        if ( (j<h)||(j>=rows->resY-h)||(resX<=2*h) )
+        { // border row
+            for (int i=0;i<resX;i++)
+                _filterRgbPixel(resX,rows->resY,rows->imageIn,rows->imageOut,rows->matrix,h,i,j);
+            continue;
+        }
+        for (int i=0;i<h;i++)
+        {
+            _filterRgbPixel(resX,rows->resY,rows->imageIn,rows->imageOut,rows->matrix,h,i,j);
+            _filterRgbPixel(resX,rows->resY,rows->imageIn,rows->imageOut,rows->matrix,h,resX-1-i,j);
+        }
+        for (int i=h;i<resX-h;i++)
+        {
+#ifdef IMAGE_PROCESS_SSE
+            __m128 rgbCumul=_mm_setzero_ps();
+            for (int k=-h;k<=h;k++)
+            {
+                const float* pixel=rows->imageIn+3*(i+k+(j-h)*resX);
+                const float* w=rows->matrix+k+h;
+                for (int l=0;l<n;l++)
+                {
+                    rgbCumul=_mm_add_ps(rgbCumul,_mm_mul_ps(loadRgb_sse(pixel),_mm_set1_ps(w[l*n])));
+                    pixel+=3*resX;
+                }
+            }
+            storeRgb_sse(rows->imageOut+3*(i+j*resX),rgbCumul);
+#else
             float rgbCumul[3]={0.0f,0.0f,0.0f};
-            cnt=0.0f;
-            for (int k=-2;k<3;k++)
+            for (int k=-h;k<=h;k++)
             {
-                x=i+k;
-                if ((x>=0)&&(x<resX))
+                const float* pixel=rows->imageIn+3*(i+k+(j-h)*resX);
+                const float* w=rows->matrix+k+h;
+                for (int l=0;l<n;l++)
                 {
-                    for (int l=-2;l<3;l++)
-                    {
-                        y=j+l;
-                        if ((y>=0)&&(y<resY))
-                        {
-                            w=m[k+2+(l+2)*5];
-                            tmp=3*(x+y*resX);
-                            rgbCumul[0]+=rgbIn[tmp+0]*w;
-                            rgbCumul[1]+=rgbIn[tmp+1]*w;
-                            rgbCumul[2]+=rgbIn[tmp+2]*w;
-                            cnt+=1.0f;
-                        }
-                    }
+                    rgbCumul[0]+=pixel[0]*w[l*n];
+                    rgbCumul[1]+=pixel[1]*w[l*n];
+                    rgbCumul[2]+=pixel[2]*w[l*n];
+                    pixel+=3*resX;
                 }
             }
-            tmp=3*(i+j*resX);
-            cnt/=25.0f;
-            rgbOut[tmp+0]=rgbCumul[0]/cnt;
-            rgbOut[tmp+1]=rgbCumul[1]/cnt;
-            rgbOut[tmp+2]=rgbCumul[2]/cnt;
+            float* out=rows->imageOut+3*(i+j*resX);
+            out[0]=rgbCumul[0];
+            out[1]=rgbCumul[1];
+            out[2]=rgbCumul[2];
+#endif
         }
     }
 }
@@ -151,7 +288,17 @@ void CImageProcess::filter5x5RgbImage(int resX,int resY,float* rgbIn,float* rgbO
 void CImageProcess::clampRgbImage(int resX,int resY,float* rgbImage,float lowClamp,float highClamp)
 {
     int s=resX*resY*3;
-    for (int i=0;i<s;i++)
+    int i=0;
+#ifdef IMAGE_PROCESS_SSE
+    if (_optimizationsEnabled)
+    {
+        __m128 low=_mm_set1_ps(lowClamp);
+        __m128 high=_mm_set1_ps(highClamp);
+        for (;i+4<=s;i+=4)
+            _mm_storeu_ps(rgbImage+i,_mm_min_ps(high,_mm_max_ps(low,_mm_loadu_ps(rgbImage+i))));
+    }
+#endif
+    for (;i<s;i++)
     {
         if (rgbImage[i]<lowClamp)
             rgbImage[i]=lowClamp;
@@ -165,74 +312,201 @@ void CImageProcess::clampRgbImage(int resX,int resY,float* rgbImage,float lowCla
 
 void CImageProcess::getEdges(int resX,int resY,float* imageSource,float* imageDest)
 {
+    if ( (resX<=0)||(resY<=0) )
+        return;
     float maxV=0.0f;
-    for (int i=0;i<resX;i++)
+    if (_optimizationsEnabled)
     {
+        std::vector<float> rowMaxValues(resY,0.0f);
+        SImageProcessRows rows;
+        rows.resX=resX;
+        rows.resY=resY;
+        rows.imageIn=imageSource;
+        rows.imageOut=imageDest;
+        rows.rowMaxValues=&rowMaxValues[0];
+        processRows(resX,resY,_getEdgesRows,&rows);
         for (int j=0;j<resY;j++)
         {
-            float gx=0.0f;
-            float gy=0.0f;
-            int gxc=0;
-            int gyc=0;
-
-            if ( (i>0)&&(i<resX-1) )
-            { // Here we do the x-direction
-                if (j>0)
-                {
-                    gx+=3.0f*imageSource[(i-1)+(j-1)*resX];
-                    gx-=3.0f*imageSource[(i+1)+(j-1)*resX];
-                    gxc++;
-                }
-                gx+=10.0f*imageSource[(i-1)+(j+0)*resX];
-                gx-=10.0f*imageSource[(i+1)+(j+0)*resX];
-                gxc++;
-                if (j<resY-1)
-                {
-                    gx+=3.0f*imageSource[(i-1)+(j+1)*resX];
-                    gx-=3.0f*imageSource[(i+1)+(j+1)*resX];
-                    gxc++;
-                }
-            }
-
-            if ( (j>0)&&(j<resY-1) )
-            { // Here we do the y-direction
-                if (i>0)
-                {
-                    gy+=3.0f*imageSource[(i-1)+(j-1)*resX];
-                    gy-=3.0f*imageSource[(i-1)+(j+1)*resX];
-                    gyc++;
-                }
-                gy+=10.0f*imageSource[(i+0)+(j-1)*resX];
-                gy-=10.0f*imageSource[(i+0)+(j+1)*resX];
-                gyc++;
-                if (i<resX-1)
-                {
-                    gy+=3.0f*imageSource[(i+1)+(j-1)*resX];
-                    gy-=3.0f*imageSource[(i+1)+(j+1)*resX];
-                    gyc++;
-                }
+            if (rowMaxValues[j]>maxV)
+                maxV=rowMaxValues[j];
+        }
+    }
+    else
+    {
+        for (int i=0;i<resX;i++)
+        {
+            for (int j=0;j<resY;j++)
+            {
+                float g=_getEdgePixel(resX,resY,imageSource,i,j);
+                imageDest[i+j*resX]=g;
+                if (g>maxV)
+                    maxV=g;
             }
-
-            if (gxc==0)
-                gx=0.0f;
-            if (gyc==0)
-                gy=0.0f;
-            float g=sqrtf(gx*gx+gy*gy);
-            imageDest[i+j*resX]=g;
-            if (g>maxV)
-                maxV=g;
         }
     }
     if (maxV!=0.0f)
         scaleIntensity(resX,resY,imageDest,1.0f/maxV,false);
 }
 
+float CImageProcess::_getEdgePixel(int resX,int resY,const float* imageSource,int i,int j)
+{
+    float gx=0.0f;
+    float gy=0.0f;
+    int gxc=0;
+    int gyc=0;
+
+    if ( (i>0)&&(i<resX-1) )
+    { // Here we do the x-direction
+        if (j>0)
+        {
+            gx+=3.0f*imageSource[(i-1)+(j-1)*resX];
+            gx-=3.0f*imageSource[(i+1)+(j-1)*resX];
+            gxc++;
+        }
+        gx+=10.0f*imageSource[(i-1)+(j+0)*resX];
+        gx-=10.0f*imageSource[(i+1)+(j+0)*resX];
+        gxc++;
+        if (j<resY-1)
+        {
+            gx+=3.0f*imageSource[(i-1)+(j+1)*resX];
+            gx-=3.0f*imageSource[(i+1)+(j+1)*resX];
+            gxc++;
+        }
+    }
+
+    if ( (j>0)&&(j<resY-1) )
+    { // Here we do the y-direction
+        if (i>0)
+        {
+            gy+=3.0f*imageSource[(i-1)+(j-1)*resX];
+            gy-=3.0f*imageSource[(i-1)+(j+1)*resX];
+            gyc++;
+        }
+        gy+=10.0f*imageSource[(i+0)+(j-1)*resX];
+        gy-=10.0f*imageSource[(i+0)+(j+1)*resX];
+        gyc++;
+        if (i<resX-1)
+        {
+            gy+=3.0f*imageSource[(i+1)+(j-1)*resX];
+            gy-=3.0f*imageSource[(i+1)+(j+1)*resX];
+            gyc++;
+        }
+    }
+
+    if (gxc==0)
+        gx=0.0f;
+    if (gyc==0)
+        gy=0.0f;
+    return(sqrtf(gx*gx+gy*gy));
+}
+
+void CImageProcess::_getEdgesRows(void* data,int rowStart,int rowEnd)
+{ // Same results as _getEdgePixel: inside of the border, we apply the same operations in the same order
+    SImageProcessRows* rows=(SImageProcessRows*)data;
+    int resX=rows->resX;
+    for (int j=rowStart;j<rowEnd;j++)
+    {
+        float* dest=rows->imageOut+j*resX;
+        float maxV=0.0f;
+        if ( (j==0)||(j==rows->resY-1)||(resX<3) )
+        { // border row
+            for (int i=0;i<resX;i++)
+            {
+                dest[i]=_getEdgePixel(resX,rows->resY,rows->imageIn,i,j);
+                if (dest[i]>maxV)
+                    maxV=dest[i];
+            }
+            rows->rowMaxValues[j]=maxV;
+            continue;
+        }
+        const float* up=rows->imageIn+(j-1)*resX;
+        const float* mid=rows->imageIn+j*resX;
+        const float* down=rows->imageIn+(j+1)*resX;
+        dest[0]=_getEdgePixel(resX,rows->resY,rows->imageIn,0,j);
+        dest[resX-1]=_getEdgePixel(resX,rows->resY,rows->imageIn,resX-1,j);
+        maxV=SIM_MAX(dest[0],maxV);
+        maxV=SIM_MAX(dest[resX-1],maxV);
+        int i=1;
+#ifdef IMAGE_PROCESS_SSE
+        __m128 three=_mm_set1_ps(3.0f);
+        __m128 ten=_mm_set1_ps(10.0f);
+        __m128 maxValues=_mm_setzero_ps();
+        for (;i+4<=resX-1;i+=4)
+        { // 4 pixels at a time
+            __m128 gx=_mm_setzero_ps();
+            gx=_mm_add_ps(gx,_mm_mul_ps(three,_mm_loadu_ps(up+i-1)));
+            gx=_mm_sub_ps(gx,_mm_mul_ps(three,_mm_loadu_ps(up+i+1)));
+            gx=_mm_add_ps(gx,_mm_mul_ps(ten,_mm_loadu_ps(mid+i-1)));
+            gx=_mm_sub_ps(gx,_mm_mul_ps(ten,_mm_loadu_ps(mid+i+1)));
+            gx=_mm_add_ps(gx,_mm_mul_ps(three,_mm_loadu_ps(down+i-1)));
+            gx=_mm_sub_ps(gx,_mm_mul_ps(three,_mm_loadu_ps(down+i+1)));
+            __m128 gy=_mm_setzero_ps();
+            gy=_mm_add_ps(gy,_mm_mul_ps(three,_mm_loadu_ps(up+i-1)));
+            gy=_mm_sub_ps(gy,_mm_mul_ps(three,_mm_loadu_ps(down+i-1)));
+            gy=_mm_add_ps(gy,_mm_mul_ps(ten,_mm_loadu_ps(up+i)));
+            gy=_mm_sub_ps(gy,_mm_mul_ps(ten,_mm_loadu_ps(down+i)));
+            gy=_mm_add_ps(gy,_mm_mul_ps(three,_mm_loadu_ps(up+i+1)));
+            gy=_mm_sub_ps(gy,_mm_mul_ps(three,_mm_loadu_ps(down+i+1)));
+            __m128 g=_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(gx,gx),_mm_mul_ps(gy,gy)));
+            _mm_storeu_ps(dest+i,g);
+            maxValues=_mm_max_ps(g,maxValues); // keeps maxValues if g is NaN, like the scalar version
+        }
+        float m[4];
+        _mm_storeu_ps(m,maxValues);
+        for (int k=0;k<4;k++)
+        {
+            if (m[k]>maxV)
+                maxV=m[k];
+        }
+#endif
+        for (;i<resX-1;i++)
+        {
+            float gx=0.0f;
+            gx+=3.0f*up[i-1];
+            gx-=3.0f*up[i+1];
+            gx+=10.0f*mid[i-1];
+            gx-=10.0f*mid[i+1];
+            gx+=3.0f*down[i-1];
+            gx-=3.0f*down[i+1];
+            float gy=0.0f;
+            gy+=3.0f*up[i-1];
+            gy-=3.0f*down[i-1];
+            gy+=10.0f*up[i];
+            gy-=10.0f*down[i];
+            gy+=3.0f*up[i+1];
+            gy-=3.0f*down[i+1];
+            dest[i]=sqrtf(gx*gx+gy*gy);
+            if (dest[i]>maxV)
+                maxV=dest[i];
+        }
+        rows->rowMaxValues[j]=maxV;
+    }
+}
+
 void CImageProcess::scaleIntensity(int resX,int resY,float* image,float scaleFactor,bool clampToMax)
 {
     int v=resX*resY;
+    int i=0;
+#ifdef IMAGE_PROCESS_SSE
+    if (_optimizationsEnabled)
+    {
+        __m128 f=_mm_set1_ps(scaleFactor);
+        __m128 one=_mm_set1_ps(1.0f);
+        if (clampToMax)
+        {
+            for (;i+4<=v;i+=4)
+                _mm_storeu_ps(image+i,_mm_min_ps(one,_mm_mul_ps(_mm_loadu_ps(image+i),f)));
+        }
+        else
+        {
+            for (;i+4<=v;i+=4)
+                _mm_storeu_ps(image+i,_mm_mul_ps(_mm_loadu_ps(image+i),f));
+        }
+    }
+#endif
     if (clampToMax)
     {
-        for (int i=0;i<v;i++)
+        for (;i<v;i++)
         {
             image[i]*=scaleFactor;
             if (image[i]>1.0f)
@@ -241,7 +515,7 @@ void CImageProcess::scaleIntensity(int resX,int resY,float* image,float scaleFac
     }
     else
     {
-        for (int i=0;i<v;i++)
+        for (;i<v;i++)
             image[i]*=scaleFactor;
     }
 }
@@ -249,9 +523,35 @@ void CImageProcess::scaleIntensity(int resX,int resY,float* image,float scaleFac
 void CImageProcess::scaleRGB(int resX,int resY,float* image,float redFactor,float greenFactor,float blueFactor,bool clampToMax)
 {
     int v=resX*resY;
+    int i=0;
+#ifdef IMAGE_PROCESS_SSE
+    if (_optimizationsEnabled)
+    { // 4 pixels (i.e. 12 values) at a time
+        __m128 f0=_mm_setr_ps(redFactor,greenFactor,blueFactor,redFactor);
+        __m128 f1=_mm_setr_ps(greenFactor,blueFactor,redFactor,greenFactor);
+        __m128 f2=_mm_setr_ps(blueFactor,redFactor,greenFactor,blueFactor);
+        __m128 one=_mm_set1_ps(1.0f);
+        for (;i+4<=v;i+=4)
+        {
+            float* p=image+3*i;
+            __m128 a=_mm_mul_ps(_mm_loadu_ps(p+0),f0);
+            __m128 b=_mm_mul_ps(_mm_loadu_ps(p+4),f1);
+            __m128 c=_mm_mul_ps(_mm_loadu_ps(p+8),f2);
+            if (clampToMax)
+            {
+                a=_mm_min_ps(one,a);
+                b=_mm_min_ps(one,b);
+                c=_mm_min_ps(one,c);
+            }
+            _mm_storeu_ps(p+0,a);
+            _mm_storeu_ps(p+4,b);
+            _mm_storeu_ps(p+8,c);
+        }
+    }
+#endif
     if (clampToMax)
     {
-        for (int i=0;i<v;i++)
+        for (;i<v;i++)
         {
             image[3*i+0]*=redFactor;
             if (image[3*i+0]>1.0f)
@@ -266,7 +566,7 @@ void CImageProcess::scaleRGB(int resX,int resY,float* image,float redFactor,floa
     }
     else
     {
-        for (int i=0;i<v;i++)
+        for (;i<v;i++)
         {
             image[3*i+0]*=redFactor;
             image[3*i+1]*=greenFactor;
@@ -346,81 +646,144 @@ void CImageProcess::boxBlurIntensity(int resX,int resY,float* imageSource,float*
 
 void CImageProcess::boxBlurRGB(int resX,int resY,float* imageSource,float* imageDest)
 {
-    for (int i=0;i<resX;i++)
+    if (_optimizationsEnabled)
     {
-        for (int j=0;j<resY;j++)
+        SImageProcessRows rows;
+        rows.resX=resX;
+        rows.resY=resY;
+        rows.imageIn=imageSource;
+        rows.imageOut=imageDest;
+        processRows(resX,resY,_boxBlurRgbRows,&rows);
+    }
+    else
+    {
+        for (int i=0;i<resX;i++)
         {
-            float gRed=0.0f;
-            float gGreen=0.0f;
-            float gBlue=0.0f;
-            int gxc=0;
-            if (i>0)
-            {
-                if (j>0)
-                {
-                    gRed+=imageSource[3*((i-1)+(j-1)*resX)+0];
-                    gGreen+=imageSource[3*((i-1)+(j-1)*resX)+1];
-                    gBlue+=imageSource[3*((i-1)+(j-1)*resX)+2];
-                    gxc++;
-                }
-                gRed+=imageSource[3*((i-1)+(j+0)*resX)+0];
-                gGreen+=imageSource[3*((i-1)+(j+0)*resX)+1];
-                gBlue+=imageSource[3*((i-1)+(j+0)*resX)+2];
-                gxc++;
-                if (j<resY-1)
-                {
-                    gRed+=imageSource[3*((i-1)+(j+1)*resX)+0];
-                    gGreen+=imageSource[3*((i-1)+(j+1)*resX)+1];
-                    gBlue+=imageSource[3*((i-1)+(j+1)*resX)+2];
-                    gxc++;
-                }
-            }
-            if (j>0)
-            {
-                gRed+=imageSource[3*((i+0)+(j-1)*resX)+0];
-                gGreen+=imageSource[3*((i+0)+(j-1)*resX)+1];
-                gBlue+=imageSource[3*((i+0)+(j-1)*resX)+2];
-                gxc++;
-            }
-            gRed+=imageSource[3*((i+0)+(j+0)*resX)+0];
-            gGreen+=imageSource[3*((i+0)+(j+0)*resX)+1];
-            gBlue+=imageSource[3*((i+0)+(j+0)*resX)+2];
+            for (int j=0;j<resY;j++)
+                _boxBlurRgbPixel(resX,resY,imageSource,imageDest,i,j);
+        }
+    }
+}
+
+void CImageProcess::_boxBlurRgbPixel(int resX,int resY,const float* imageSource,float* imageDest,int i,int j)
+{
+    float gRed=0.0f;
+    float gGreen=0.0f;
+    float gBlue=0.0f;
+    int gxc=0;
+    if (i>0)
+    {
+        if (j>0)
+        {
+            gRed+=imageSource[3*((i-1)+(j-1)*resX)+0];
+            gGreen+=imageSource[3*((i-1)+(j-1)*resX)+1];
+            gBlue+=imageSource[3*((i-1)+(j-1)*resX)+2];
             gxc++;
-            if (j<resY-1)
+        }
+        gRed+=imageSource[3*((i-1)+(j+0)*resX)+0];
+        gGreen+=imageSource[3*((i-1)+(j+0)*resX)+1];
+        gBlue+=imageSource[3*((i-1)+(j+0)*resX)+2];
+        gxc++;
+        if (j<resY-1)
+        {
+            gRed+=imageSource[3*((i-1)+(j+1)*resX)+0];
+            gGreen+=imageSource[3*((i-1)+(j+1)*resX)+1];
+            gBlue+=imageSource[3*((i-1)+(j+1)*resX)+2];
+            gxc++;
+        }
+    }
+    if (j>0)
+    {
+        gRed+=imageSource[3*((i+0)+(j-1)*resX)+0];
+        gGreen+=imageSource[3*((i+0)+(j-1)*resX)+1];
+        gBlue+=imageSource[3*((i+0)+(j-1)*resX)+2];
+        gxc++;
+    }
+    gRed+=imageSource[3*((i+0)+(j+0)*resX)+0];
+    gGreen+=imageSource[3*((i+0)+(j+0)*resX)+1];
+    gBlue+=imageSource[3*((i+0)+(j+0)*resX)+2];
+    gxc++;
+    if (j<resY-1)
+    {
+        gRed+=imageSource[3*((i+0)+(j+1)*resX)+0];
+        gGreen+=imageSource[3*((i+0)+(j+1)*resX)+1];
+        gBlue+=imageSource[3*((i+0)+(j+1)*resX)+2];
+        gxc++;
+    }
+
+    if (i<resX-1)
+    {
+        if (j>0)
+        {
+            gRed+=imageSource[3*((i+1)+(j-1)*resX)+0];
+            gGreen+=imageSource[3*((i+1)+(j-1)*resX)+1];
+            gBlue+=imageSource[3*((i+1)+(j-1)*resX)+2];
+            gxc++;
+        }
+        gRed+=imageSource[3*((i+1)+(j+0)*resX)+0];
+        gGreen+=imageSource[3*((i+1)+(j+0)*resX)+1];
+        gBlue+=imageSource[3*((i+1)+(j+0)*resX)+2];
+        gxc++;
+        if (j<resY-1)
+        {
+            gRed+=imageSource[3*((i+1)+(j+1)*resX)+0];
+            gGreen+=imageSource[3*((i+1)+(j+1)*resX)+1];
+            gBlue+=imageSource[3*((i+1)+(j+1)*resX)+2];
+            gxc++;
+        }
+    }
+    gRed/=float(gxc);
+    gGreen/=float(gxc);
+    gBlue/=float(gxc);
+    imageDest[3*(i+j*resX)+0]=gRed;
+    imageDest[3*(i+j*resX)+1]=gGreen;
+    imageDest[3*(i+j*resX)+2]=gBlue;
+}
+
+void CImageProcess::_boxBlurRgbRows(void* data,int rowStart,int rowEnd)
+{ // Same results as _boxBlurRgbPixel: inside of the border, we sum in the same order
+    SImageProcessRows* rows=(SImageProcessRows*)data;
+    int resX=rows->resX;
+    for (int j=rowStart;j<rowEnd;j++)
+    {
+        if ( (j==0)||(j==rows->resY-1)||(resX<3) )
+        { // border row
+            for (int i=0;i<resX;i++)
+                _boxBlurRgbPixel(resX,rows->resY,rows->imageIn,rows->imageOut,i,j);
+            continue;
+        }
+        _boxBlurRgbPixel(resX,rows->resY,rows->imageIn,rows->imageOut,0,j);
+        _boxBlurRgbPixel(resX,rows->resY,rows->imageIn,rows->imageOut,resX-1,j);
+        for (int i=1;i<resX-1;i++)
+        {
+#ifdef IMAGE_PROCESS_SSE
+            __m128 rgb=_mm_setzero_ps();
+            for (int k=-1;k<2;k++)
             {
-                gRed+=imageSource[3*((i+0)+(j+1)*resX)+0];
-                gGreen+=imageSource[3*((i+0)+(j+1)*resX)+1];
-                gBlue+=imageSource[3*((i+0)+(j+1)*resX)+2];
-                gxc++;
+                const float* pixel=rows->imageIn+3*((i+k)+(j-1)*resX);
+                rgb=_mm_add_ps(rgb,loadRgb_sse(pixel));
+                rgb=_mm_add_ps(rgb,loadRgb_sse(pixel+3*resX));
+                rgb=_mm_add_ps(rgb,loadRgb_sse(pixel+6*resX));
             }
-
-            if (i<resX-1)
+            storeRgb_sse(rows->imageOut+3*(i+j*resX),_mm_div_ps(rgb,_mm_set1_ps(9.0f)));
+#else
+            float rgb[3]={0.0f,0.0f,0.0f};
+            for (int k=-1;k<2;k++)
             {
-                if (j>0)
+                const float* pixel=rows->imageIn+3*((i+k)+(j-1)*resX);
+                for (int l=0;l<3;l++)
                 {
-                    gRed+=imageSource[3*((i+1)+(j-1)*resX)+0];
-                    gGreen+=imageSource[3*((i+1)+(j-1)*resX)+1];
-                    gBlue+=imageSource[3*((i+1)+(j-1)*resX)+2];
-                    gxc++;
-                }
-                gRed+=imageSource[3*((i+1)+(j+0)*resX)+0];
-                gGreen+=imageSource[3*((i+1)+(j+0)*resX)+1];
-                gBlue+=imageSource[3*((i+1)+(j+0)*resX)+2];
-                gxc++;
-                if (j<resY-1)
-                {
-                    gRed+=imageSource[3*((i+1)+(j+1)*resX)+0];
-                    gGreen+=imageSource[3*((i+1)+(j+1)*resX)+1];
-                    gBlue+=imageSource[3*((i+1)+(j+1)*resX)+2];
-                    gxc++;
+                    rgb[0]+=pixel[0];
+                    rgb[1]+=pixel[1];
+                    rgb[2]+=pixel[2];
+                    pixel+=3*resX;
                 }
             }
-            gRed/=float(gxc);
-            gGreen/=float(gxc);
-            gBlue/=float(gxc);
-            imageDest[3*(i+j*resX)+0]=gRed;
-            imageDest[3*(i+j*resX)+1]=gGreen;
-            imageDest[3*(i+j*resX)+2]=gBlue;
+            float* out=rows->imageOut+3*(i+j*resX);
+            out[0]=rgb[0]/9.0f;
+            out[1]=rgb[1]/9.0f;
+            out[2]=rgb[2]/9.0f;
+#endif
         }
     }
 }
@@ -1,9 +1,36 @@
 
 #pragma once
 
+#include <vector>
+
+typedef void (*IMAGE_ROWS_FUNCTION)(void* data,int rowStart,int rowEnd);
+
+struct SImageProcessRows
+{
+    int resX;
+    int resY;
+    const float* imageIn;
+    float* imageOut;
+    const float* matrix;
+    int matrixHalfSize;
+    float* rowMaxValues;
+};
+
+struct SImageProcessRowTiles
+{
+    IMAGE_ROWS_FUNCTION function;
+    void* data;
+    int resY;
+    int tileRowCount;
+};
+
 class CImageProcess  
 {
 public:
+    static void processRows(int resX,int resY,IMAGE_ROWS_FUNCTION function,void* data);
+    static void setOptimizationsEnabled(bool e);
+    static bool getOptimizationsEnabled();
+
     CImageProcess();
     virtual ~CImageProcess();
     static float* createRGBImage(int resX,int resY);
@@ -20,6 +47,9 @@ public:
 
     static void deleteImage(float* image);
 
+    static const float* getByteToFloatTable();
+    static void charImageToFloatImage(int valueCount,const unsigned char* charImage,float* floatImage);
+
     static void rgbImageToIntensityImage(int resX,int resY,float* rgbImage,float* intensImage);
     static void intensityImageToRGBImage(int resX,int resY,float* rgbImage,float* intensImage);
 
@@ -48,4 +78,20 @@ public:
     static void predef_getThickEdgesRGB(int resX,int resY,float* image);
     static void predef_getThinEdgeOverlayRGB(int resX,int resY,float* image);
     static void predef_invertRGB(int resX,int resY,float* image);
+
+private:
+    static void _filterRgbPixel(int resX,int resY,const float* rgbIn,float* rgbOut,const float* m,int halfSize,int i,int j);
+    static float _getEdgePixel(int resX,int resY,const float* imageSource,int i,int j);
+    static void _boxBlurRgbPixel(int resX,int resY,const float* imageSource,float* imageDest,int i,int j);
+
+    static void _filterRgbRows(void* data,int rowStart,int rowEnd);
+    static void _getEdgesRows(void* data,int rowStart,int rowEnd);
+    static void _boxBlurRgbRows(void* data,int rowStart,int rowEnd);
+    static void _rowTileTask(void* taskData,int taskIndex);
+
+    static bool _initializeByteToFloatTable();
+
+    static bool _optimizationsEnabled;
+    static float _byteToFloatTable[256];
+    static bool _byteToFloatTableInitialized;
 };
@@ -0,0 +1,147 @@
+#include "vrepMainHeader.h"
+#include "funcDebug.h"
+#include "pixelReadback.h"
+#include "oGL.h"
+#include <string.h>
+
+CPixelReadback::CPixelReadback(int resX,int resY)
+{
+    FUNCTION_DEBUG;
+    _resX=resX;
+    _resY=resY;
+    _nextIndex=0;
+    _available=true;
+    for (int i=0;i<2;i++)
+    {
+        _rgbPending[i]=false;
+        _depthPending[i]=false;
+        _rgbBuffers[i]=_createBuffer(resX*resY*3);
+        _depthBuffers[i]=_createBuffer(resX*resY*sizeof(float));
+        if ( (_rgbBuffers[i]==NULL)||(_depthBuffers[i]==NULL) )
+            _available=false; // e.g. no pixel buffer object support. The caller will read synchronously
+    }
+}
+
+CPixelReadback::~CPixelReadback()
+{
+    FUNCTION_DEBUG;
+    for (int i=0;i<2;i++)
+    {
+        delete _rgbBuffers[i];
+        delete _depthBuffers[i];
+    }
+}
+
+bool CPixelReadback::isAvailable() const
+{
+    return(_available);
+}
+
+QGLBuffer* CPixelReadback::_createBuffer(int size)
+{
+    QGLBuffer* buffer=new QGLBuffer(QGLBuffer::PixelPackBuffer);
+    buffer->setUsagePattern(QGLBuffer::StreamRead);
+    if ( (!buffer->create())||(!buffer->bind()) )
+    {
+        delete buffer;
+        return(NULL);
+    }
+    buffer->allocate(size);
+    buffer->release();
+    return(buffer);
+}
+
+void CPixelReadback::startReadback(bool rgb,bool depth,bool alsoReadSynchronously)
+{ // Queues the transfer of the framebuffer content into the pixel buffer objects. Returns without waiting
+  // (unless alsoReadSynchronously is true)
+    FUNCTION_DEBUG;
+    int ind=_nextIndex;
+    _rgbPending[ind]=false;
+    _depthPending[ind]=false;
+    _syncRgb[ind].clear();
+    _syncDepth[ind].clear();
+    if (alsoReadSynchronously)
+    {
+        if (rgb)
+        {
+            _syncRgb[ind].resize(_resX*_resY*3);
+            glPixelStorei(GL_PACK_ALIGNMENT,1);
+            glReadPixels(0,0,_resX,_resY,GL_RGB,GL_UNSIGNED_BYTE,&_syncRgb[ind][0]);
+            glPixelStorei(GL_PACK_ALIGNMENT,4);
+        }
+        if (depth)
+        {
+            _syncDepth[ind].resize(_resX*_resY);
+            glReadPixels(0,0,_resX,_resY,GL_DEPTH_COMPONENT,GL_FLOAT,&_syncDepth[ind][0]);
+        }
+    }
+    if (rgb&&_rgbBuffers[ind]->bind())
+    {
+        glPixelStorei(GL_PACK_ALIGNMENT,1);
+        glReadPixels(0,0,_resX,_resY,GL_RGB,GL_UNSIGNED_BYTE,(GLvoid*)0);
+        glPixelStorei(GL_PACK_ALIGNMENT,4);
+        _rgbBuffers[ind]->release();
+        _rgbPending[ind]=true;
+    }
+    if (depth&&_depthBuffers[ind]->bind())
+    {
+        glReadPixels(0,0,_resX,_resY,GL_DEPTH_COMPONENT,GL_FLOAT,(GLvoid*)0);
+        _depthBuffers[ind]->release();
+        _depthPending[ind]=true;
+    }
+    _nextIndex=1-ind;
+}
+
+void CPixelReadback::fetchPreviousReadback(unsigned char* rgbBuffer,float* depthBuffer,bool& rgbFetched,bool& depthFetched,int& comparisonResult)
+{ // Copies the transfer started by the previous startReadback call (not the last one!). That transfer had a complete
+  // simulation step to finish, so that mapping the buffer normally does not stall
+    FUNCTION_DEBUG;
+    int ind=_nextIndex;
+    rgbFetched=false;
+    depthFetched=false;
+    comparisonResult=-1;
+    if (_rgbPending[ind])
+        rgbFetched=_fetchBuffer(_rgbBuffers[ind],rgbBuffer,_resX*_resY*3);
+    if (_depthPending[ind])
+        depthFetched=_fetchBuffer(_depthBuffers[ind],depthBuffer,_resX*_resY*sizeof(float));
+    if ( (rgbFetched&&(_syncRgb[ind].size()>0))||(depthFetched&&(_syncDepth[ind].size()>0)) )
+    {
+        comparisonResult=1;
+        if ( rgbFetched&&(_syncRgb[ind].size()>0)&&(memcmp(&_syncRgb[ind][0],rgbBuffer,_resX*_resY*3)!=0) )
+            comparisonResult=0;
+        if ( depthFetched&&(_syncDepth[ind].size()>0)&&(memcmp(&_syncDepth[ind][0],depthBuffer,_resX*_resY*sizeof(float))!=0) )
+            comparisonResult=0;
+    }
+    _rgbPending[ind]=false;
+    _depthPending[ind]=false;
+    _syncRgb[ind].clear();
+    _syncDepth[ind].clear();
+}
+
+void CPixelReadback::discardPendingReadbacks()
+{ // e.g. when the sensor is reset: the next fetch will not return an image from before the reset
+    for (int i=0;i<2;i++)
+    {
+        _rgbPending[i]=false;
+        _depthPending[i]=false;
+        _syncRgb[i].clear();
+        _syncDepth[i].clear();
+    }
+}
+
+bool CPixelReadback::_fetchBuffer(QGLBuffer* buffer,void* dest,int size)
+{
+    bool retVal=false;
+    if (buffer->bind())
+    {
+        void* data=buffer->map(QGLBuffer::ReadOnly);
+        if (data!=NULL)
+        {
+            memcpy(dest,data,size);
+            buffer->unmap();
+            retVal=true;
+        }
+        buffer->release();
+    }
+    return(retVal);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "vrepMainHeader.h"
+#include <QGLBuffer>
+#include <vector>
+
+// Reads back the color and depth of the bound framebuffer via two pairs of pixel buffer objects.
+// The transfer of the image rendered during handling N is started at handling N, and fetched at
+// handling N+1, so that the calling thread never waits for the rendering in progress.
+// Optionally, the same image is also read synchronously, and compared with the asynchronously read one
+// when it is fetched (e.g. to verify a driver or a software GL implementation, in headless mode).
+// All functions, except discardPendingReadbacks, require the sensor's GL context to be current
+class CPixelReadback
+{
+public:
+    CPixelReadback(int resX,int resY);
+    virtual ~CPixelReadback();
+
+    bool isAvailable() const;
+    void startReadback(bool rgb,bool depth,bool alsoReadSynchronously);
+    void fetchPreviousReadback(unsigned char* rgbBuffer,float* depthBuffer,bool& rgbFetched,bool& depthFetched,int& comparisonResult); // comparisonResult: -1=not compared, 0=images differ, 1=identical
+    void discardPendingReadbacks();
+
+protected:
+    QGLBuffer* _createBuffer(int size);
+    bool _fetchBuffer(QGLBuffer* buffer,void* dest,int size);
+
+    int _resX;
+    int _resY;
+    bool _available;
+    QGLBuffer* _rgbBuffers[2];
+    QGLBuffer* _depthBuffers[2];
+    bool _rgbPending[2];
+    bool _depthPending[2];
+    std::vector<unsigned char> _syncRgb[2]; // empty if not read synchronously
+    std::vector<float> _syncDepth[2];
+    int _nextIndex;
+};
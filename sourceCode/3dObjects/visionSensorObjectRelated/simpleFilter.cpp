@@ -8,7 +8,10 @@
 #include "v_repStrings.h"
 #include "MyMath.h"
 #include "visionSensor.h"
+#include "vDateTime.h"
+#include "app.h"
 #include <boost/lexical_cast.hpp>
+#include <string.h>
 
 std::vector<SExternalFilterInfo> CSimpleFilter::_externalFilters;
 
@@ -897,6 +900,121 @@ bool CSimpleFilter::processAndTrigger(CVisionSensor* sensor,int sizeX,int sizeY,
     return(false); // shouldn't happen!!
 }
 
+bool CSimpleFilter::canProcessCharImages()
+{ // Components that only move, flip, or saturate-add/subtract RGB values give, after the final
+  // quantization, exactly the same result when working on the 8-bit values directly
+    if (!_enabled)
+        return(true);
+    if ( (_filterType==sim_filtercomponent_originalimage)||(_filterType==sim_filtercomponent_tooutput) )
+        return(true);
+    if ( (_filterType==sim_filtercomponent_tobuffer1)||(_filterType==sim_filtercomponent_tobuffer2) )
+        return(true);
+    if ( (_filterType==sim_filtercomponent_frombuffer1)||(_filterType==sim_filtercomponent_frombuffer2) )
+        return(true);
+    if ( (_filterType==sim_filtercomponent_swapwithbuffer1)||(_filterType==sim_filtercomponent_swapbuffers) )
+        return(true);
+    if ( (_filterType==sim_filtercomponent_addtobuffer1)||(_filterType==sim_filtercomponent_subtractfrombuffer1) )
+        return(true);
+    if ( (_filterType==sim_filtercomponent_addbuffer1)||(_filterType==sim_filtercomponent_subtractbuffer1) )
+        return(true);
+    if ( (_filterType==sim_filtercomponent_horizontalflip)||(_filterType==sim_filtercomponent_verticalflip) )
+        return(true);
+    return(false);
+}
+
+bool CSimpleFilter::processAndTriggerChar(int sizeX,int sizeY,const unsigned char* inputImage,unsigned char* outputImage,unsigned char* workImage,unsigned char* buffer1,unsigned char* buffer2)
+{ // 8-bit counterpart of processAndTrigger, for the components accepted by canProcessCharImages
+    if (!_enabled)
+        return(false);
+    int s=sizeX*sizeY*3;
+    if (_filterType==sim_filtercomponent_originalimage)
+        memcpy(workImage,inputImage,s);
+    if (_filterType==sim_filtercomponent_tooutput)
+        memcpy(outputImage,workImage,s);
+    if (_filterType==sim_filtercomponent_tobuffer1)
+        memcpy(buffer1,workImage,s);
+    if (_filterType==sim_filtercomponent_tobuffer2)
+        memcpy(buffer2,workImage,s);
+    if (_filterType==sim_filtercomponent_frombuffer1)
+        memcpy(workImage,buffer1,s);
+    if (_filterType==sim_filtercomponent_frombuffer2)
+        memcpy(workImage,buffer2,s);
+    if ( (_filterType==sim_filtercomponent_swapwithbuffer1)||(_filterType==sim_filtercomponent_swapbuffers) )
+    {
+        unsigned char* a=buffer1;
+        unsigned char* b=workImage;
+        if (_filterType==sim_filtercomponent_swapbuffers)
+            b=buffer2;
+        for (int i=0;i<s;i++)
+        {
+            unsigned char tmp=a[i];
+            a[i]=b[i];
+            b[i]=tmp;
+        }
+    }
+    if ( (_filterType==sim_filtercomponent_addtobuffer1)||(_filterType==sim_filtercomponent_addbuffer1) )
+    {
+        unsigned char* dest=workImage;
+        const unsigned char* src=buffer1;
+        if (_filterType==sim_filtercomponent_addtobuffer1)
+        {
+            dest=buffer1;
+            src=workImage;
+        }
+        for (int i=0;i<s;i++)
+        {
+            unsigned int v=dest[i]+src[i];
+            if (v>255)
+                v=255;
+            dest[i]=(unsigned char)v;
+        }
+    }
+    if ( (_filterType==sim_filtercomponent_subtractfrombuffer1)||(_filterType==sim_filtercomponent_subtractbuffer1) )
+    {
+        unsigned char* dest=workImage;
+        const unsigned char* src=buffer1;
+        if (_filterType==sim_filtercomponent_subtractfrombuffer1)
+        {
+            dest=buffer1;
+            src=workImage;
+        }
+        for (int i=0;i<s;i++)
+        {
+            if (dest[i]>src[i])
+                dest[i]-=src[i];
+            else
+                dest[i]=0;
+        }
+    }
+    if ( (_filterType==sim_filtercomponent_horizontalflip)||(_filterType==sim_filtercomponent_verticalflip) )
+    {
+        int iMax=sizeX/2;
+        int jMax=sizeY;
+        if (_filterType==sim_filtercomponent_verticalflip)
+        {
+            iMax=sizeX;
+            jMax=sizeY/2;
+        }
+        for (int i=0;i<iMax;i++)
+        {
+            for (int j=0;j<jMax;j++)
+            {
+                int a=3*(i+j*sizeX);
+                int b=3*((sizeX-1-i)+j*sizeX);
+                if (_filterType==sim_filtercomponent_verticalflip)
+                    b=3*(i+(sizeY-1-j)*sizeX);
+                for (int k=0;k<3;k++)
+                {
+                    unsigned char tmp=workImage[a+k];
+                    workImage[a+k]=workImage[b+k];
+                    workImage[b+k]=tmp;
+                }
+            }
+        }
+    }
+    return(false); // none of those components triggers
+}
+
 bool CSimpleFilter::processAndTrigger_originalImage(int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* workImage,std::vector<float>& returnData,float* buffer1,float* buffer2,CDrawingContainer2D& drawingContainer)
 {
     int s=sizeX*sizeY*3;
@@ -1138,23 +1256,37 @@ bool CSimpleFilter::processAndTrigger_colorSegmentation(int sizeX,int sizeY,cons
 
 bool CSimpleFilter::processAndTrigger_intensityScale(int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* workImage,std::vector<float>& returnData,float* buffer1,float* buffer2,CDrawingContainer2D& drawingContainer)
 {
-    float b=_floatParameters[0];
-    float a=_floatParameters[1]-b;
+    SSimpleFilterRows rows;
+    rows.filter=this;
+    rows.sizeX=sizeX;
+    rows.sizeY=sizeY;
+    rows.workImage=workImage;
+    CImageProcess::processRows(sizeX,sizeY,_intensityScaleRows,&rows);
+    return(false);
+}
+
+void CSimpleFilter::_intensityScaleRows(void* data,int rowStart,int rowEnd)
+{
+    SSimpleFilterRows* rows=(SSimpleFilterRows*)data;
+    CSimpleFilter* f=rows->filter;
+    float* workImage=rows->workImage;
+    float b=f->_floatParameters[0];
+    float a=f->_floatParameters[1]-b;
     // intensity first transformed like: intensity=a*intensity+b
-    int s=sizeX*sizeY;
+    int mode=f->_intParameters[0];
     float intensity;
     float col[3];
-    for (int i=0;i<s;i++)
+    for (int i=rowStart*rows->sizeX;i<rowEnd*rows->sizeX;i++)
     {
         intensity=(workImage[3*i+0]+workImage[3*i+1]+workImage[3*i+2])/3.0f;
         intensity=a*intensity+b;
-        if (_intParameters[0]==0)
+        if (mode==0)
         { // grey scale
             workImage[3*i+0]=intensity;
             workImage[3*i+1]=intensity;
             workImage[3*i+2]=intensity;
         }
-        if (_intParameters[0]==1)
+        if (mode==1)
         { // intensity scale
             tt::getColorFromIntensity(intensity,0,col);
             workImage[3*i+0]=col[0];
@@ -1162,21 +1294,35 @@ bool CSimpleFilter::processAndTrigger_intensityScale(int sizeX,int sizeY,const f
             workImage[3*i+2]=col[2];
         }
     }
-    return(false);
 }
 
 bool CSimpleFilter::processAndTrigger_keepOrRemoveColors(int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* workImage,std::vector<float>& returnData,float* buffer1,float* buffer2,CDrawingContainer2D& drawingContainer)
 {
-    int s=sizeX*sizeY;
+    SSimpleFilterRows rows;
+    rows.filter=this;
+    rows.sizeX=sizeX;
+    rows.sizeY=sizeY;
+    rows.workImage=workImage;
+    rows.buffer1=buffer1;
+    CImageProcess::processRows(sizeX,sizeY,_keepOrRemoveColorsRows,&rows);
+    return(false);
+}
+
+void CSimpleFilter::_keepOrRemoveColorsRows(void* data,int rowStart,int rowEnd)
+{
+    SSimpleFilterRows* rows=(SSimpleFilterRows*)data;
+    CSimpleFilter* f=rows->filter;
+    float* workImage=rows->workImage;
+    float* buffer1=rows->buffer1;
     float col[3];
     float rgb[3];
-    float lowTol[3]={_floatParameters[0]-_floatParameters[3],_floatParameters[1]-_floatParameters[4],_floatParameters[2]-_floatParameters[5]};
-    float upTol[3]={_floatParameters[0]+_floatParameters[3],_floatParameters[1]+_floatParameters[4],_floatParameters[2]+_floatParameters[5]};
+    float lowTol[3]={f->_floatParameters[0]-f->_floatParameters[3],f->_floatParameters[1]-f->_floatParameters[4],f->_floatParameters[2]-f->_floatParameters[5]};
+    float upTol[3]={f->_floatParameters[0]+f->_floatParameters[3],f->_floatParameters[1]+f->_floatParameters[4],f->_floatParameters[2]+f->_floatParameters[5]};
     float lowTolUpHue=1.0f+lowTol[0];
     float upTolLowHue=upTol[0]-1.0f;
-    for (int i=0;i<s;i++)
+    for (int i=rowStart*rows->sizeX;i<rowEnd*rows->sizeX;i++)
     {
-        if (_byteParameters[0]&2)
+        if (f->_byteParameters[0]&2)
         { // rgb dimension
             col[0]=workImage[3*i+0];
             col[1]=workImage[3*i+1];
@@ -1190,7 +1336,7 @@ bool CSimpleFilter::processAndTrigger_keepOrRemoveColors(int sizeX,int sizeY,con
             tt::rgbToHsl(rgb,col);
         }
         bool outOfTol;
-        if (_byteParameters[0]&2)
+        if (f->_byteParameters[0]&2)
         { // rgb dimension
             outOfTol=((col[0]>upTol[0])||
                 (col[0]<lowTol[0])||
@@ -1213,9 +1359,9 @@ bool CSimpleFilter::processAndTrigger_keepOrRemoveColors(int sizeX,int sizeY,con
 
         if (outOfTol)
         {
-            if (_byteParameters[0]&1)
+            if (f->_byteParameters[0]&1)
             { // color not within tolerance, we remove it
-                if (_byteParameters[0]&4)
+                if (f->_byteParameters[0]&4)
                 { // we copy the removed part to buffer 1
                     buffer1[3*i+0]=workImage[3*i+0];
                     buffer1[3*i+1]=workImage[3*i+1];
@@ -1227,7 +1373,7 @@ bool CSimpleFilter::processAndTrigger_keepOrRemoveColors(int sizeX,int sizeY,con
             }
             else
             { // color within tolerance
-                if (_byteParameters[0]&4)
+                if (f->_byteParameters[0]&4)
                 { // we mark as black in buffer 1 the parts not removed
                     buffer1[3*i+0]=0.0f;
                     buffer1[3*i+1]=0.0f;
@@ -1237,9 +1383,9 @@ bool CSimpleFilter::processAndTrigger_keepOrRemoveColors(int sizeX,int sizeY,con
         }
         else
         {
-            if ((_byteParameters[0]&1)==0)
+            if ((f->_byteParameters[0]&1)==0)
             { // color not within tolerance, we remove it
-                if (_byteParameters[0]&4)
+                if (f->_byteParameters[0]&4)
                 { // we copy the removed part to buffer 1
                     buffer1[3*i+0]=workImage[3*i+0];
                     buffer1[3*i+1]=workImage[3*i+1];
@@ -1251,7 +1397,7 @@ bool CSimpleFilter::processAndTrigger_keepOrRemoveColors(int sizeX,int sizeY,con
             }
             else
             { // color within tolerance
-                if (_byteParameters[0]&4)
+                if (f->_byteParameters[0]&4)
                 { // we mark as black in buffer 1 the parts not removed
                     buffer1[3*i+0]=0.0f;
                     buffer1[3*i+1]=0.0f;
@@ -1260,7 +1406,6 @@ bool CSimpleFilter::processAndTrigger_keepOrRemoveColors(int sizeX,int sizeY,con
             }
         }
     }
-    return(false);
 }
 bool CSimpleFilter::processAndTrigger_scaleAndOffsetColors(int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* workImage,std::vector<float>& returnData,float* buffer1,float* buffer2,CDrawingContainer2D& drawingContainer)
 {
@@ -1323,26 +1468,22 @@ bool CSimpleFilter::processAndTrigger_binary(int sizeX,int sizeY,const float* in
     float cmy=0.0f;
     float angle=0.0f;
     float roundness=1.0f;
+    SSimpleFilterRows rows;
+    rows.filter=this;
+    rows.sizeX=sizeX;
+    rows.sizeY=sizeY;
+    rows.workImage=workImage;
+    CImageProcess::processRows(sizeX,sizeY,_binaryRows,&rows);
     for (int i=0;i<sizeX;i++)
-    {
+    { // same summation order as before, results stay the same
         for (int j=0;j<sizeY;j++)
         {
-            float intensity=(workImage[3*(i+j*sizeX)+0]+workImage[3*(i+j*sizeX)+1]+workImage[3*(i+j*sizeX)+2])/3.0f;
-            if (intensity>=_floatParameters[0])
+            if (workImage[3*(i+j*sizeX)+0]!=0.0f)
             { // Binary 1
-                workImage[3*(i+j*sizeX)+0]=1.0f;
-                workImage[3*(i+j*sizeX)+1]=1.0f;
-                workImage[3*(i+j*sizeX)+2]=1.0f;
                 area+=1.0f;
                 cmx+=float(i);
                 cmy+=float(j);
             }
-            else
-            { // Binary 0
-                workImage[3*(i+j*sizeX)+0]=0.0f;
-                workImage[3*(i+j*sizeX)+1]=0.0f;
-                workImage[3*(i+j*sizeX)+2]=0.0f;
-            }
         }
     }
     proportion=area/float(sizeX*sizeY);
@@ -1438,6 +1579,23 @@ bool CSimpleFilter::processAndTrigger_binary(int sizeX,int sizeY,const float* in
     return(false); // we don't trigger
 }
 
+void CSimpleFilter::_binaryRows(void* data,int rowStart,int rowEnd)
+{
+    SSimpleFilterRows* rows=(SSimpleFilterRows*)data;
+    float* workImage=rows->workImage;
+    float threshold=rows->filter->_floatParameters[0];
+    for (int i=rowStart*rows->sizeX;i<rowEnd*rows->sizeX;i++)
+    {
+        float intensity=(workImage[3*i+0]+workImage[3*i+1]+workImage[3*i+2])/3.0f;
+        float v=0.0f; // Binary 0
+        if (intensity>=threshold)
+            v=1.0f; // Binary 1
+        workImage[3*i+0]=v;
+        workImage[3*i+1]=v;
+        workImage[3*i+2]=v;
+    }
+}
+
 
 bool CSimpleFilter::processAndTrigger_blobExtraction(int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* workImage,std::vector<float>& returnData,float* buffer1,float* buffer2,CDrawingContainer2D& drawingContainer)
 {
@@ -1768,11 +1926,25 @@ bool CSimpleFilter::processAndTrigger_edge(int sizeX,int sizeY,const float* inpu
     float* im2=CImageProcess::createRGBImage(sizeX,sizeY);
     CImageProcess::filter3x3RgbImage(sizeX,sizeY,workImage,im2,m);
     CImageProcess::copyRGBImage(sizeX,sizeY,im2,workImage);
-    int s=sizeX*sizeY;
-    for (int i=0;i<s;i++)
+    SSimpleFilterRows rows;
+    rows.filter=this;
+    rows.sizeX=sizeX;
+    rows.sizeY=sizeY;
+    rows.workImage=workImage;
+    CImageProcess::processRows(sizeX,sizeY,_edgeRows,&rows);
+    CImageProcess::deleteImage(im2);
+    return(false);
+}
+
+void CSimpleFilter::_edgeRows(void* data,int rowStart,int rowEnd)
+{
+    SSimpleFilterRows* rows=(SSimpleFilterRows*)data;
+    float* workImage=rows->workImage;
+    float threshold=rows->filter->_floatParameters[0];
+    for (int i=rowStart*rows->sizeX;i<rowEnd*rows->sizeX;i++)
     {
         float intens=(workImage[3*i+0]+workImage[3*i+1]+workImage[3*i+2])/3.0f;
-        if (intens>_floatParameters[0])
+        if (intens>threshold)
         {
             workImage[3*i+0]=1.0f;
             workImage[3*i+1]=1.0f;
@@ -1785,8 +1957,6 @@ bool CSimpleFilter::processAndTrigger_edge(int sizeX,int sizeY,const float* inpu
             workImage[3*i+2]=0.0f;
         }
     }
-    CImageProcess::deleteImage(im2);
-    return(false);
 }
 
 
@@ -2011,29 +2181,55 @@ bool CSimpleFilter::processAndTrigger_resize(int sizeX,int sizeY,const float* in
     float* im=CImageProcess::createRGBImage(sizeX,sizeY);
     CImageProcess::copyRGBImage(sizeX,sizeY,workImage,im);
     float* cntIm=CImageProcess::createIntensityImage(sizeX,sizeY);
-    int s=sizeX*sizeY;
-    for (int i=0;i<s;i++)
+    float centerX=float(sizeX)/2.0f;
+    std::vector<int> columnMap(sizeX+1); // source column of each column, or -1
+    for (int i=0;i<sizeX;i++)
+    {
+        float dx=(float(i)+0.5f-centerX)/_floatParameters[0];
+        columnMap[i]=int(centerX+dx);
+        if ((columnMap[i]<0)||(columnMap[i]>=sizeX))
+            columnMap[i]=-1;
+    }
+    SSimpleFilterRows rows;
+    rows.filter=this;
+    rows.sizeX=sizeX;
+    rows.sizeY=sizeY;
+    rows.workImage=workImage;
+    rows.image=im;
+    rows.countImage=cntIm;
+    rows.columnMap=&columnMap[0];
+    CImageProcess::processRows(sizeX,sizeY,_resizeRows,&rows);
+    CImageProcess::deleteImage(cntIm);
+    CImageProcess::deleteImage(im);
+    return(false);
+}
+
+void CSimpleFilter::_resizeRows(void* data,int rowStart,int rowEnd)
+{
+    SSimpleFilterRows* rows=(SSimpleFilterRows*)data;
+    int sizeX=rows->sizeX;
+    int sizeY=rows->sizeY;
+    float* workImage=rows->workImage;
+    const float* im=rows->image;
+    float* cntIm=rows->countImage;
+    for (int i=rowStart*sizeX;i<rowEnd*sizeX;i++)
     {
         cntIm[i]=0.0f;
         workImage[3*i+0]=0.0f;
         workImage[3*i+1]=0.0f;
         workImage[3*i+2]=0.0f;
     }
-    float centerX=float(sizeX)/2.0f;
     float centerY=float(sizeY)/2.0f;
-    float dx,dy;
-    int npx,npy;
-    for (int i=0;i<sizeX;i++)
+    for (int j=rowStart;j<rowEnd;j++)
     {
-        dx=(float(i)+0.5f-centerX)/_floatParameters[0];
-        npx=int(centerX+dx);    
-        if ((npx>=0)&&(npx<sizeX))
+        float dy=(float(j)+0.5f-centerY)/rows->filter->_floatParameters[1];
+        int npy=int(centerY+dy);
+        if ((npy>=0)&&(npy<sizeY))
         {
-            for (int j=0;j<sizeY;j++)
+            for (int i=0;i<sizeX;i++)
             {
-                dy=(float(j)+0.5f-centerY)/_floatParameters[1];
-                npy=int(centerY+dy);    
-                if ((npy>=0)&&(npy<sizeY))
+                int npx=rows->columnMap[i];
+                if (npx>=0)
                 {
                     workImage[3*(i+j*sizeX)+0]+=im[3*(npx+npy*sizeX)+0];
                     workImage[3*(i+j*sizeX)+1]+=im[3*(npx+npy*sizeX)+1];
@@ -2043,7 +2239,7 @@ bool CSimpleFilter::processAndTrigger_resize(int sizeX,int sizeY,const float* in
             }
         }
     }
-    for (int i=0;i<s;i++)
+    for (int i=rowStart*sizeX;i<rowEnd*sizeX;i++)
     {
         if (cntIm[i]>0.1f)
         {
@@ -2052,17 +2248,31 @@ bool CSimpleFilter::processAndTrigger_resize(int sizeX,int sizeY,const float* in
             workImage[3*i+2]/=cntIm[i];
         }
     }
-    CImageProcess::deleteImage(cntIm);
-    CImageProcess::deleteImage(im);
-    return(false);
 }
 
 bool CSimpleFilter::processAndTrigger_rotate(int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* workImage,std::vector<float>& returnData,float* buffer1,float* buffer2,CDrawingContainer2D& drawingContainer)
 {
     float* im=CImageProcess::createRGBImage(sizeX,sizeY);
     CImageProcess::copyRGBImage(sizeX,sizeY,workImage,im);
-    int ss=sizeX*sizeY*3;
-    for (int i=0;i<ss;i++)
+    SSimpleFilterRows rows;
+    rows.filter=this;
+    rows.sizeX=sizeX;
+    rows.sizeY=sizeY;
+    rows.workImage=workImage;
+    rows.image=im;
+    CImageProcess::processRows(sizeX,sizeY,_rotateRows,&rows);
+    CImageProcess::deleteImage(im);
+    return(false);
+}
+
+void CSimpleFilter::_rotateRows(void* data,int rowStart,int rowEnd)
+{
+    SSimpleFilterRows* rows=(SSimpleFilterRows*)data;
+    int sizeX=rows->sizeX;
+    int sizeY=rows->sizeY;
+    float* workImage=rows->workImage;
+    const float* im=rows->image;
+    for (int i=3*rowStart*sizeX;i<3*rowEnd*sizeX;i++)
         workImage[i]=0.0f;
     float centerX=float(sizeX)/2.0f;
     float centerY=float(sizeY)/2.0f;
@@ -2072,20 +2282,20 @@ bool CSimpleFilter::processAndTrigger_rotate(int sizeX,int sizeY,const float* in
     float dxp1;
     float dyp0;
     float dyp1;
-    float c=cos(-_floatParameters[0]);
-    float s=sin(-_floatParameters[0]);
-    for (int i=0;i<sizeX;i++)
+    float c=cos(-rows->filter->_floatParameters[0]);
+    float s=sin(-rows->filter->_floatParameters[0]);
+    for (int j=rowStart;j<rowEnd;j++)
     {
-        dx=float(i)+0.5f-centerX;
-        dxp0=dx*c;
-        dyp0=dx*s;
-        for (int j=0;j<sizeY;j++)
+        dy=float(j)+0.5f-centerY;
+        dxp1=-dy*s;
+        dyp1=dy*c;
+        for (int i=0;i<sizeX;i++)
         {
-            dy=float(j)+0.5f-centerY;
-            dxp1=-dy*s;
-            dyp1=dy*c;
+            dx=float(i)+0.5f-centerX;
+            dxp0=dx*c;
+            dyp0=dx*s;
             npx=int(centerX+dxp0+dxp1);
-            npy=int(centerY+dyp0+dyp1); 
+            npy=int(centerY+dyp0+dyp1);
             if ((npy>=0)&&(npy<sizeY)&&(npx>=0)&&(npx<sizeX))
             {
                 workImage[3*(i+j*sizeX)+0]+=im[3*(npx+npy*sizeX)+0];
@@ -2094,8 +2304,6 @@ bool CSimpleFilter::processAndTrigger_rotate(int sizeX,int sizeY,const float* in
             }
         }
     }
-    CImageProcess::deleteImage(im);
-    return(false);
 }
 
 bool CSimpleFilter::processAndTrigger_3x3filter(int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* workImage,std::vector<float>& returnData,float* buffer1,float* buffer2,CDrawingContainer2D& drawingContainer)
@@ -2479,3 +2687,56 @@ bool CSimpleFilter::processAndTrigger_velodyne(CVisionSensor* sensor,int sizeX,i
 
     return(false); // we don't trigger
 }
+
+void CSimpleFilter::runBenchmark()
+{ // Times the components that have optimized implementations, with and without optimizations. Enabled via the user settings
+    const int resolutions[2][2]={{640,480},{1920,1080}};
+    const int filterTypes[9]={sim_filtercomponent_3x3filter,sim_filtercomponent_5x5filter,sim_filtercomponent_sharpen,sim_filtercomponent_edge,sim_filtercomponent_intensityscale,sim_filtercomponent_binary,sim_filtercomponent_keeporremovecolors,sim_filtercomponent_resize,sim_filtercomponent_rotate};
+    const int passes=5;
+    for (int r=0;r<2;r++)
+    {
+        int sizeX=resolutions[r][0];
+        int sizeY=resolutions[r][1];
+        int s=sizeX*sizeY*3;
+        std::vector<float> image(s);
+        unsigned int seed=1;
+        for (int i=0;i<s;i++)
+        { // same image each time
+            seed=seed*1103515245+12345;
+            image[i]=float((seed>>16)&0x7fff)/32767.0f;
+        }
+        std::vector<float> workImage(s);
+        std::vector<float> buffer1(s,0.0f);
+        std::vector<float> buffer2(s,0.0f);
+        for (int f=0;f<9;f++)
+        {
+            CSimpleFilter filter;
+            filter.setFilterType(filterTypes[f]);
+            suint64 durations[2];
+            std::vector<float> results[2];
+            for (int opt=0;opt<2;opt++)
+            {
+                CImageProcess::setOptimizationsEnabled(opt==1);
+                suint64 startTime=VDateTime::getTimeInUs();
+                for (int p=0;p<passes;p++)
+                {
+                    workImage.assign(image.begin(),image.end());
+                    std::vector<float> returnData;
+                    CDrawingContainer2D drawingContainer;
+                    filter.processAndTrigger(NULL,sizeX,sizeY,&image[0],NULL,NULL,NULL,&workImage[0],returnData,&buffer1[0],&buffer2[0],drawingContainer);
+                }
+                durations[opt]=(VDateTime::getTimeInUs()-startTime)/passes;
+                results[opt]=workImage;
+            }
+            std::string txt("Filter benchmark, ");
+            txt+=boost::lexical_cast<std::string>(sizeX)+"x"+boost::lexical_cast<std::string>(sizeY)+", "+getSpecificFilterString(filterTypes[f])+": ";
+            txt+=tt::FNb(0,float(durations[0])/1000.0f,2,false)+" ms --> "+tt::FNb(0,float(durations[1])/1000.0f,2,false)+" ms";
+            if (durations[1]>0)
+                txt+=" ("+tt::FNb(0,float(durations[0])/float(durations[1]),1,false)+"x)";
+            if (results[0]!=results[1])
+                txt+=", RESULTS DIFFER";
+            App::addStatusbarMessage(txt);
+        }
+    }
+    CImageProcess::setOptimizationsEnabled(true);
+}
@@ -13,6 +13,19 @@ struct SExternalFilterInfo
 };
 
 class CVisionSensor; // forward declaration
+class CSimpleFilter;
+
+struct SSimpleFilterRows
+{
+    CSimpleFilter* filter;
+    int sizeX;
+    int sizeY;
+    float* workImage;
+    float* buffer1;
+    const float* image;
+    float* countImage;
+    const int* columnMap;
+};
 
 class CSimpleFilter
 {
@@ -29,6 +42,8 @@ public:
     void setCustomFilterInfo(int header,int id);
     void getCustomFilterInfo(int& header,int& id);
     bool processAndTrigger(CVisionSensor* sensor,int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* outputDepthBuffer,float* workImage,std::vector<float>& returnData,float* buffer1,float* buffer2,CDrawingContainer2D& drawingContainer);
+    bool canProcessCharImages();
+    bool processAndTriggerChar(int sizeX,int sizeY,const unsigned char* inputImage,unsigned char* outputImage,unsigned char* workImage,unsigned char* buffer1,unsigned char* buffer2);
     static int getAvailableFilter(int filterTypeIndex);
     static std::string getSpecificFilterString(int filterType);
     std::string getFilterString();
@@ -43,6 +58,7 @@ public:
     void setCustomFilterParameters(const std::vector<unsigned char>& params);
 
     static void readAllExternalFilters();
+    static void runBenchmark();
 
 protected:
     static int _getFilterTypeAndNameFromHeaderAndID(int header,int id,std::string& name);
@@ -90,6 +106,13 @@ protected:
     bool processAndTrigger_pixelChange(int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* workImage,std::vector<float>& returnData,float* buffer1,float* buffer2,CDrawingContainer2D& drawingContainer);
     bool processAndTrigger_velodyne(CVisionSensor* sensor,int sizeX,int sizeY,const float* inputImage,const float* inputDepth,float* outputImage,float* workImage,std::vector<float>& returnData,float* buffer1,float* buffer2,CDrawingContainer2D& drawingContainer);
 
+    static void _intensityScaleRows(void* data,int rowStart,int rowEnd);
+    static void _keepOrRemoveColorsRows(void* data,int rowStart,int rowEnd);
+    static void _binaryRows(void* data,int rowStart,int rowEnd);
+    static void _edgeRows(void* data,int rowStart,int rowEnd);
+    static void _resizeRows(void* data,int rowStart,int rowEnd);
+    static void _rotateRows(void* data,int rowStart,int rowEnd);
+
     // Variables which need to be serialized & copied 
     bool _enabled;
     int _filterType;
@@ -21,6 +21,8 @@ CVisionSensorGlStuff::CVisionSensorGlStuff(int resX,int resY,int offscreenType,b
     // 3. We need a texture object:
     textureObject=new CTextureObject(resX,resY);
 
+    pixelReadback=NULL;
+
 //  CGlShader* a=new CGlShader();
 
     offscreenContext->doneCurrent();
@@ -30,6 +32,7 @@ CVisionSensorGlStuff::~CVisionSensorGlStuff()
 {
     FUNCTION_DEBUG;
     offscreenContext->makeCurrent();
+    delete pixelReadback;
     delete textureObject;
     delete frameBufferObject;
     offscreenContext->doneCurrent();
@@ -4,6 +4,7 @@
 #include "offscreenGlContext.h"
 #include "frameBufferObject.h"
 #include "textureObject.h"
+#include "pixelReadback.h"
 
 class CVisionSensorGlStuff : public QObject
 {
@@ -22,6 +23,7 @@ public:
     COffscreenGlContext* offscreenContext;
     CFrameBufferObject* frameBufferObject;
     CTextureObject* textureObject;
+    CPixelReadback* pixelReadback; // created on first asynchronous readback
 protected:
     bool _destroyOffscreenContext;
 };
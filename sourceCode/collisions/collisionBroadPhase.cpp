@@ -0,0 +1,210 @@
+
+#include "vrepMainHeader.h"
+#include "collisionBroadPhase.h"
+#include "shape.h"
+#include "octree.h"
+#include "pointCloud.h"
+#include "app.h"
+#include "workerPool.h"
+#include <algorithm>
+#include <float.h>
+
+VMutex CCollisionBroadPhase::_mutex;
+bool CCollisionBroadPhase::_active=false;
+VTHREAD_ID_TYPE CCollisionBroadPhase::_ownerThreadId=VTHREAD_ID_DEAD;
+std::vector<SBroadPhaseBox> CCollisionBroadPhase::_boxes;
+std::map<int,int> CCollisionBroadPhase::_boxIndices;
+
+bool CCollisionBroadPhase::build()
+{
+    _mutex.lock_simple();
+    bool inUse=(!VThread::areThreadIDsSame(_ownerThreadId,VTHREAD_ID_DEAD));
+    if (!inUse)
+        _ownerThreadId=VThread::getCurrentThreadId();
+    _mutex.unlock_simple();
+    if (inUse)
+        return(false);
+
+    _boxes.clear();
+    _boxIndices.clear();
+    std::vector<int>* lists[4]={&App::ct->objCont->shapeList,&App::ct->objCont->octreeList,&App::ct->objCont->pointCloudList,&App::ct->objCont->dummyList};
+    for (size_t l=0;l<4;l++)
+    {
+        for (size_t i=0;i<lists[l]->size();i++)
+        {
+            C3DObject* obj=App::ct->objCont->getObject(lists[l]->at(i));
+            SBroadPhaseBox box;
+            if ( (obj!=NULL)&&_computeBox(obj,box) )
+            {
+                _boxIndices[obj->getID()]=int(_boxes.size());
+                _boxes.push_back(box);
+            }
+        }
+    }
+    _mutex.lock_simple();
+    _active=true;
+    _mutex.unlock_simple();
+    return(true);
+}
+
+void CCollisionBroadPhase::release()
+{ // the owner's tasks are all done at this point
+    _boxes.clear();
+    _boxIndices.clear();
+    _mutex.lock_simple();
+    _active=false;
+    _ownerThreadId=VTHREAD_ID_DEAD;
+    _mutex.unlock_simple();
+}
+
+bool CCollisionBroadPhase::isActive()
+{
+    _mutex.lock_simple();
+    bool retVal=_active&&CWorkerPool::isCurrentThreadWorkingFor(_ownerThreadId);
+    _mutex.unlock_simple();
+    return(retVal);
+}
+
+bool CCollisionBroadPhase::mightObjectsOverlap(C3DObject* obj1,C3DObject* obj2)
+{ // Returns true if the broad phase is not active, or if obj1 and obj2 are not known to it
+    if (!isActive())
+        return(true);
+    SBroadPhaseBox box1,box2;
+    if ( (!_getObjectBox(obj1,box1))||(!_getObjectBox(obj2,box2)) )
+        return(true);
+    return(areBoxesOverlapping(box1,box2));
+}
+
+void CCollisionBroadPhase::getCandidatePairs(const std::vector<C3DObject*>& group1,const std::vector<C3DObject*>& group2,std::vector<int>& pairs)
+{ // 'pairs' receives index pairs (index in group1, index in group2) of objects that might overlap,
+  // ordered as a group1/group2 double loop would visit them. If the broad phase is not active, all pairs are returned
+    pairs.clear();
+    if (!isActive())
+    {
+        for (size_t i=0;i<group1.size();i++)
+        {
+            for (size_t j=0;j<group2.size();j++)
+            {
+                pairs.push_back(int(i));
+                pairs.push_back(int(j));
+            }
+        }
+        return;
+    }
+
+    // Sort and sweep along the x-axis. Entries below group1.size() are from group1, the others from group2:
+    size_t cnt1=group1.size();
+    std::vector<SBroadPhaseBox> boxes(cnt1+group2.size());
+    std::vector<std::pair<float,int> > sweepOrder(boxes.size());
+    for (size_t i=0;i<boxes.size();i++)
+    {
+        C3DObject* obj=(i<cnt1)?group1[i]:group2[i-cnt1];
+        if (!_getObjectBox(obj,boxes[i]))
+        { // unknown object: it overlaps everything
+            for (size_t k=0;k<3;k++)
+            {
+                boxes[i].minV[k]=-FLT_MAX;
+                boxes[i].maxV[k]=FLT_MAX;
+            }
+        }
+        sweepOrder[i]=std::make_pair(boxes[i].minV[0],int(i));
+    }
+    std::sort(sweepOrder.begin(),sweepOrder.end());
+
+    std::vector<int> activeEntries[2];
+    std::vector<std::pair<int,int> > foundPairs;
+    for (size_t i=0;i<sweepOrder.size();i++)
+    {
+        int entry=sweepOrder[i].second;
+        const SBroadPhaseBox& box=boxes[entry];
+        bool fromGroup1=(size_t(entry)<cnt1);
+        std::vector<int>& others=activeEntries[fromGroup1?1:0];
+        size_t stillActiveCnt=0;
+        for (size_t j=0;j<others.size();j++)
+        {
+            const SBroadPhaseBox& otherBox=boxes[others[j]];
+            if (otherBox.maxV[0]>=box.minV[0])
+            { // the other box is still active
+                others[stillActiveCnt++]=others[j];
+                if (areBoxesOverlapping(box,otherBox))
+                {
+                    if (fromGroup1)
+                        foundPairs.push_back(std::make_pair(entry,others[j]-int(cnt1)));
+                    else
+                        foundPairs.push_back(std::make_pair(others[j],entry-int(cnt1)));
+                }
+            }
+        }
+        others.resize(stillActiveCnt);
+        activeEntries[fromGroup1?0:1].push_back(entry);
+    }
+
+    std::sort(foundPairs.begin(),foundPairs.end());
+    for (size_t i=0;i<foundPairs.size();i++)
+    {
+        pairs.push_back(foundPairs[i].first);
+        pairs.push_back(foundPairs[i].second);
+    }
+}
+
+bool CCollisionBroadPhase::_computeBox(C3DObject* obj,SBroadPhaseBox& box)
+{ // same boxes as in CCollisionRoutine::_areObjectBoundingBoxesOverlapping, but world-aligned
+    C4X4Matrix m;
+    C3Vector halfSizes;
+    if (obj->getObjectType()==sim_object_shape_type)
+    {
+        halfSizes=((CShape*)obj)->geomData->getBoundingBoxHalfSizes();
+        m=obj->getCumulativeTransformation().getMatrix();
+    }
+    else if (obj->getObjectType()==sim_object_dummy_type)
+    {
+        halfSizes=C3Vector(0.0001f,0.0001f,0.0001f);
+        m=obj->getCumulativeTransformation().getMatrix();
+    }
+    else if (obj->getObjectType()==sim_object_octree_type)
+        ((COctree*)obj)->getMatrixAndHalfSizeOfBoundingBox(m,halfSizes);
+    else if (obj->getObjectType()==sim_object_pointcloud_type)
+        ((CPointCloud*)obj)->getMatrixAndHalfSizeOfBoundingBox(m,halfSizes);
+    else
+        return(false);
+    getBox(m,halfSizes,box);
+    return(true);
+}
+
+void CCollisionBroadPhase::getBox(const C4X4Matrix& m,const C3Vector& halfSizes,SBroadPhaseBox& box)
+{ // world-aligned box enclosing the oriented box m/halfSizes
+    // A small margin, so that we never reject what the narrow phase would detect:
+    float margin=0.0001f+0.01f*std::max<float>(halfSizes(0),std::max<float>(halfSizes(1),halfSizes(2)));
+    for (size_t i=0;i<3;i++)
+    {
+        float ext=fabs(m.M(i,0))*halfSizes(0)+fabs(m.M(i,1))*halfSizes(1)+fabs(m.M(i,2))*halfSizes(2)+margin;
+        box.minV[i]=m.X(i)-ext;
+        box.maxV[i]=m.X(i)+ext;
+    }
+}
+
+bool CCollisionBroadPhase::getObjectBox(C3DObject* obj,SBroadPhaseBox& box)
+{ // Returns false if the broad phase is not active for the current thread, or if obj is not known to it
+    if (!isActive())
+        return(false);
+    return(_getObjectBox(obj,box));
+}
+
+bool CCollisionBroadPhase::_getObjectBox(C3DObject* obj,SBroadPhaseBox& box)
+{
+    std::map<int,int>::iterator it=_boxIndices.find(obj->getID());
+    if (it==_boxIndices.end())
+        return(false);
+    box=_boxes[it->second];
+    return(true);
+}
+
+bool CCollisionBroadPhase::areBoxesOverlapping(const SBroadPhaseBox& box1,const SBroadPhaseBox& box2)
+{
+    for (size_t i=0;i<3;i++)
+    {
+        if ( (box1.maxV[i]<box2.minV[i])||(box2.maxV[i]<box1.minV[i]) )
+            return(false);
+    }
+    return(true);
+}
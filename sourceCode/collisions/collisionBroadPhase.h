@@ -0,0 +1,42 @@
+#pragma once
+
+#include "3DObject.h"
+#include "vMutex.h"
+#include <vector>
+#include <map>
+
+struct SBroadPhaseBox
+{
+    float minV[3];
+    float maxV[3];
+};
+
+//FULLY STATIC CLASS
+class CCollisionBroadPhase
+{
+public:
+    // World-space axis aligned boxes of all shapes, octrees, point clouds and dummies in the scene.
+    // Built once before all registered collisions are handled, and valid until release() is called.
+    // Only the thread that built it (and the workers executing its tasks) use it. Another thread's build
+    // is refused while it is in use: that thread then simply runs without broad phase
+    static bool build(); // returns false if the broad phase is already in use
+    static void release(); // only call if build returned true
+    static bool isActive(); // for the current thread
+
+    static bool mightObjectsOverlap(C3DObject* obj1,C3DObject* obj2);
+    static void getCandidatePairs(const std::vector<C3DObject*>& group1,const std::vector<C3DObject*>& group2,std::vector<int>& pairs);
+
+    static bool getObjectBox(C3DObject* obj,SBroadPhaseBox& box);
+    static void getBox(const C4X4Matrix& m,const C3Vector& halfSizes,SBroadPhaseBox& box);
+    static bool areBoxesOverlapping(const SBroadPhaseBox& box1,const SBroadPhaseBox& box2);
+
+private:
+    static bool _computeBox(C3DObject* obj,SBroadPhaseBox& box);
+    static bool _getObjectBox(C3DObject* obj,SBroadPhaseBox& box);
+
+    static VMutex _mutex; // protects _active and _ownerThreadId
+    static bool _active;
+    static VTHREAD_ID_TYPE _ownerThreadId;
+    static std::vector<SBroadPhaseBox> _boxes;
+    static std::map<int,int> _boxIndices; // object handle --> index in _boxes
+};
@@ -1,9 +1,22 @@
 
 #include "vrepMainHeader.h"
 #include "collisionRoutine.h"
+#include "collisionBroadPhase.h"
 #include "distanceRoutine.h"
 #include "pluginContainer.h"
+#include "workerPool.h"
 #include "app.h"
+#include <set>
+
+struct SObjectPairCollisionTask
+{
+    C3DObject* object1;
+    C3DObject* object2;
+    bool skip;
+    bool withIntersections;
+    bool result;
+    std::vector<float> intersections;
+};
 
 //---------------------------- GENERAL COLLISION QUERIES ---------------------------
 
@@ -142,6 +155,8 @@ bool CCollisionRoutine::_doesShapeCollideWithShape(CShape* shape1,CShape* shape2
         return(false);
     if ( ( (shape2->getCumulativeObjectSpecialProperty()&sim_objectspecialproperty_collidable)==0 )&&(!overrideShape2CollidableFlag) )
         return(false);
+    if (!CCollisionBroadPhase::mightObjectsOverlap(shape1,shape2))
+        return(false);
 
     // Before building collision nodes, check if the shape's bounding boxes collide (new since 9/7/2014):
     if ( (!shape1->isCollisionInformationInitialized())||(!shape2->isCollisionInformationInitialized()) )
@@ -196,53 +211,159 @@ bool CCollisionRoutine::_doesGroupCollideWithShape(const std::vector<C3DObject*>
 bool CCollisionRoutine::_doesGroupCollideWithGroup(const std::vector<C3DObject*>& group1,const std::vector<C3DObject*>& group2,std::vector<float>* intersections,int collidingGroupObjects[2])
 {   // if intersections is different from NULL we check for all collisions and
     // append intersection segments to the vector.
+    // Pairs rejected by the broad phase cannot collide. The others come in the order of a group1/group2 double loop:
+    std::vector<int> candidates;
+    CCollisionBroadPhase::getCandidatePairs(group1,group2,candidates);
+    std::vector<C3DObject*> objPairs; // Object pairs we need to check
+    std::set<std::pair<C3DObject*,C3DObject*> > checkedPairs;
+    for (size_t i=0;i<candidates.size()/2;i++)
+    {
+        C3DObject* obj1=group1[candidates[2*i+0]];
+        C3DObject* obj2=group2[candidates[2*i+1]];
+        if (obj1!=obj2)
+        { // never check an object against itself
+            // Never check twice the same pair:
+            if (checkedPairs.find(std::make_pair(obj2,obj1))==checkedPairs.end())
+            {
+                checkedPairs.insert(std::make_pair(obj1,obj2));
+                objPairs.push_back(obj1);
+                objPairs.push_back(obj2);
+            }
+        }
+    }
+    return(_doesAnyObjectPairCollide(objPairs,intersections,collidingGroupObjects));
+}
+
+bool CCollisionRoutine::_doesAnyObjectPairCollide(const std::vector<C3DObject*>& objPairs,std::vector<float>* intersections,int collidingGroupObjects[2])
+{   // if intersections is different from NULL we check for all collisions and
+    // append intersection segments to the vector.
+    if ( App::userSettings->parallelCollisionChecking&&(objPairs.size()>2)&&(CWorkerPool::getEffectiveWorkerCount()>0) )
+        return(_doesAnyObjectPairCollide_parallel(objPairs,intersections,collidingGroupObjects));
     bool returnValue=false;
-    std::vector<C3DObject*> checkedPairs;
-    for (size_t i=0;i<group1.size();i++)
+    for (size_t i=0;i<objPairs.size()/2;i++)
     {
-        for (size_t j=0;j<group2.size();j++)
+        C3DObject* obj1=objPairs[2*i+0];
+        C3DObject* obj2=objPairs[2*i+1];
+        bool doIt=(!returnValue);
+        if ( (!doIt)&&(intersections!=NULL) )
+        { // we still might have to do it if we have shape-shape colldetection (for the contour)
+            doIt=(obj1->getObjectType()==sim_object_shape_type)&&(obj2->getObjectType()==sim_object_shape_type);
+        }
+        if (doIt)
         {
-            if (group1[i]!=group2[j])
-            { // never check an object against itself
-                // Never check twice the same pair:
-                bool present=false;
-                for (size_t k=0;k<checkedPairs.size()/2;k++)
-                {
-                    if ((group2[j]==checkedPairs[2*k+0])&&(group1[i]==checkedPairs[2*k+1]))
-                    {
-                        present=true;
-                        break;
-                    }
-                }
-                if (!present)
-                {
-                    checkedPairs.push_back(group1[i]);
-                    checkedPairs.push_back(group2[j]);
+            if (_doesObjectCollideWithObject(obj1,obj2,true,true,intersections))
+            {
+                collidingGroupObjects[0]=obj1->getID();
+                collidingGroupObjects[1]=obj2->getID();
+                if (intersections==NULL)
+                    return(true);
+                returnValue=true;
+            }
+        }
+    }
+    return(returnValue);
+}
 
-                    bool doIt=(!returnValue);
-                    if ( (!doIt)&&(intersections!=NULL) )
-                    { // we still might have to do it if we have shape-shape colldetection (for the contour)
-                        doIt=(group1[i]->getObjectType()==sim_object_shape_type)&&(group2[j]->getObjectType()==sim_object_shape_type);
-                    }
+bool CCollisionRoutine::_doesAnyObjectPairCollide_parallel(const std::vector<C3DObject*>& objPairs,std::vector<float>* intersections,int collidingGroupObjects[2])
+{   // Same result as the sequential version: all pairs are checked concurrently, then the
+    // results are merged in the sequential order
+    std::vector<SObjectPairCollisionTask> tasks(objPairs.size()/2);
+    for (size_t i=0;i<tasks.size();i++)
+    {
+        tasks[i].object1=objPairs[2*i+0];
+        tasks[i].object2=objPairs[2*i+1];
+        tasks[i].withIntersections=(intersections!=NULL);
+        tasks[i].result=false;
+        // Cached values and calculation structures are built here, not in the worker threads:
+        tasks[i].skip=!_prepareObjectPairForConcurrentCheck(tasks[i].object1,tasks[i].object2);
+    }
+    CPluginContainer::mesh_setConcurrentAccess(true); // the mesh engine is called from several threads: geometries are locked
+    C3DObject::setCumulativeTransformationCacheFrozen(true);
+    CWorkerPool::executeTasks(_objectPairCollisionTask,&tasks[0],int(tasks.size()));
+    C3DObject::setCumulativeTransformationCacheFrozen(false);
+    CPluginContainer::mesh_setConcurrentAccess(false);
 
-                    if (doIt)
-                    {
-                        if (_doesObjectCollideWithObject(group1[i],group2[j],true,true,intersections))
-                        {
-                            collidingGroupObjects[0]=group1[i]->getID();
-                            collidingGroupObjects[1]=group2[j]->getID();
-                            if (intersections==NULL)
-                                return(true);
-                            returnValue=true;
-                        }
-                    }
-                }
-            }
+    bool returnValue=false;
+    for (size_t i=0;i<tasks.size();i++)
+    {
+        C3DObject* obj1=tasks[i].object1;
+        C3DObject* obj2=tasks[i].object2;
+        bool doIt=(!returnValue);
+        if ( (!doIt)&&(intersections!=NULL) )
+            doIt=(obj1->getObjectType()==sim_object_shape_type)&&(obj2->getObjectType()==sim_object_shape_type);
+        if (doIt&&tasks[i].result)
+        {
+            collidingGroupObjects[0]=obj1->getID();
+            collidingGroupObjects[1]=obj2->getID();
+            if (intersections==NULL)
+                return(true);
+            intersections->insert(intersections->end(),tasks[i].intersections.begin(),tasks[i].intersections.end());
+            returnValue=true;
         }
     }
     return(returnValue);
 }
 
+bool CCollisionRoutine::_prepareObjectPairForConcurrentCheck(C3DObject* obj1,C3DObject* obj2)
+{ // Returns false if the pair cannot collide. Otherwise everything _doesObjectCollideWithObject
+  // would lazily compute or build (with override flags set) is prepared here
+    obj1->getCumulativeTransformation();
+    obj2->getCumulativeTransformation();
+    obj1->getCumulativeObjectSpecialProperty();
+    obj2->getCumulativeObjectSpecialProperty();
+    if (!CCollisionBroadPhase::mightObjectsOverlap(obj1,obj2))
+        return(false);
+    CShape* shape1=NULL;
+    CShape* shape2=NULL;
+    if (obj1->getObjectType()==sim_object_shape_type)
+        shape1=(CShape*)obj1;
+    if (obj2->getObjectType()==sim_object_shape_type)
+        shape2=(CShape*)obj2;
+    if ( (shape1!=NULL)&&(shape2!=NULL) )
+    {
+        if (shape1==shape2)
+            return(false);
+        if ( (!shape1->isCollisionInformationInitialized())||(!shape2->isCollisionInformationInitialized()) )
+        {
+            if (!CPluginContainer::mesh_getBoxBoxCollision(shape1->getCumulativeTransformation().getMatrix(),shape1->geomData->getBoundingBoxHalfSizes(),shape2->getCumulativeTransformation().getMatrix(),shape2->geomData->getBoundingBoxHalfSizes()))
+                return(false);
+        }
+        shape1->initializeCalculationStructureIfNeeded();
+        shape2->initializeCalculationStructureIfNeeded();
+        return(true);
+    }
+    COctree* octree=NULL;
+    if (obj1->getObjectType()==sim_object_octree_type)
+        octree=(COctree*)obj1;
+    if (obj2->getObjectType()==sim_object_octree_type)
+        octree=(COctree*)obj2;
+    CShape* shape=(shape1!=NULL)?shape1:shape2;
+    if ( (octree!=NULL)&&(shape!=NULL) )
+    {
+        if (octree->getOctreeInfo()==NULL)
+            return(false);
+        if (!shape->isCollisionInformationInitialized())
+        {
+            if (!_areObjectBoundingBoxesOverlapping(octree,shape))
+                return(false);
+        }
+        shape->initializeCalculationStructureIfNeeded();
+    }
+    return(true);
+}
+
+void CCollisionRoutine::_objectPairCollisionTask(void* taskData,int taskIndex)
+{ // called from the worker pool
+    SObjectPairCollisionTask* task=((SObjectPairCollisionTask*)taskData)+taskIndex;
+    if (!task->skip)
+    {
+        std::vector<float>* intersections=NULL;
+        if (task->withIntersections)
+            intersections=&task->intersections;
+        task->result=_doesObjectCollideWithObject(task->object1,task->object2,true,true,intersections);
+    }
+}
+
 bool CCollisionRoutine::_areObjectBoundingBoxesOverlapping(C3DObject* obj1,C3DObject* obj2)
 {
     C3DObject* objs[2]={obj1,obj2};
@@ -277,6 +398,8 @@ bool CCollisionRoutine::_doesOctreeCollideWithShape(COctree* octree,CShape* shap
         return(false);
     if ( ( (shape->getCumulativeObjectSpecialProperty()&sim_objectspecialproperty_collidable)==0 )&&(!overrideShapeCollidableFlag) )
         return(false);
+    if (!CCollisionBroadPhase::mightObjectsOverlap(octree,shape))
+        return(false);
 
     // Before building collision nodes, check if the shape's bounding boxes collide (new since 9/7/2014):
     if (!shape->isCollisionInformationInitialized())
@@ -303,6 +426,8 @@ bool CCollisionRoutine::_doesOctreeCollideWithOctree(COctree* octree1,COctree* o
         return(false);
     if ( ( (octree2->getCumulativeObjectSpecialProperty()&sim_objectspecialproperty_collidable)==0 )&&(!overrideOctree2CollidableFlag) )
         return(false);
+    if (!CCollisionBroadPhase::mightObjectsOverlap(octree1,octree2))
+        return(false);
     if (!_areObjectBoundingBoxesOverlapping(octree1,octree2))
         return(false);
     return(CPluginContainer::mesh_checkOctreeCollisionWithOctree(octree1->getOctreeInfo(),octree1->getCumulativeTransformation().getMatrix(),octree2->getOctreeInfo(),octree2->getCumulativeTransformation().getMatrix()));
@@ -318,6 +443,8 @@ bool CCollisionRoutine::_doesOctreeCollideWithPointCloud(COctree* octree,CPointC
         return(false);
     if ( ( (pointCloud->getCumulativeObjectSpecialProperty()&sim_objectspecialproperty_collidable)==0 )&&(!overridePointCloudCollidableFlag) )
         return(false);
+    if (!CCollisionBroadPhase::mightObjectsOverlap(octree,pointCloud))
+        return(false);
 
     if (!_areObjectBoundingBoxesOverlapping(octree,pointCloud))
         return(false);
@@ -333,6 +460,8 @@ bool CCollisionRoutine::_doesOctreeCollideWithDummy(COctree* octree,CDummy* dumm
         return(false);
     if ( ( (dummy->getCumulativeObjectSpecialProperty()&sim_objectspecialproperty_collidable)==0 )&&(!overrideDummyCollidableFlag) )
         return(false);
+    if (!CCollisionBroadPhase::mightObjectsOverlap(octree,dummy))
+        return(false);
 
     return(CPluginContainer::mesh_checkOctreeCollisionWithSinglePoint(octree->getOctreeInfo(),octree->getCumulativeTransformation().getMatrix(),dummy->getCumulativeTransformation().X,NULL,NULL));
 }
@@ -450,64 +579,32 @@ bool CCollisionRoutine::_doesGroupCollideWithItself(const std::vector<C3DObject*
 {   // if intersections is different from NULL we check for all collisions and
     // append intersection segments to the vector.
 
+    // Pairs rejected by the broad phase cannot collide. The others come in the order of a double loop:
+    std::vector<int> candidates;
+    CCollisionBroadPhase::getCandidatePairs(group,group,candidates);
     std::vector<C3DObject*> objPairs; // Object pairs we need to check
-    for (size_t i=0;i<group.size();i++)
+    std::set<std::pair<C3DObject*,C3DObject*> > presentPairs;
+    for (size_t i=0;i<candidates.size()/2;i++)
     {
-        C3DObject* obj1=group[i];
-        int csci1=obj1->getCollectionSelfCollisionIndicator();
-        for (size_t j=0;j<group.size();j++)
-        {
-            C3DObject* obj2=group[j];
+        C3DObject* obj1=group[candidates[2*i+0]];
+        C3DObject* obj2=group[candidates[2*i+1]];
+        if (obj1!=obj2)
+        { // We never check an object against itself!
+            int csci1=obj1->getCollectionSelfCollisionIndicator();
             int csci2=obj2->getCollectionSelfCollisionIndicator();
-            if (obj1!=obj2)
-            { // We never check an object against itself!
-                if (abs(csci1-csci2)!=1)
-                { // the collection self collision indicators differences is not 1
-                    // We now check if these partners are already present in objPairs
-                    bool absent=true;
-                    for (size_t k=0;k<objPairs.size()/2;k++)
-                    {
-                        if ( ( (objPairs[2*k+0]==obj1)&&(objPairs[2*k+1]==obj2) ) || ( (objPairs[2*k+0]==obj2)&&(objPairs[2*k+1]==obj1) ) )
-                        {
-                            absent=false;
-                            break;
-                        }
-                    }
-                    if (absent)
-                    {
-                        objPairs.push_back(obj1);
-                        objPairs.push_back(obj2);
-                    }
+            if (abs(csci1-csci2)!=1)
+            { // the collection self collision indicators differences is not 1
+                // We now check if these partners are already present in objPairs
+                if ( (presentPairs.find(std::make_pair(obj1,obj2))==presentPairs.end())&&(presentPairs.find(std::make_pair(obj2,obj1))==presentPairs.end()) )
+                {
+                    presentPairs.insert(std::make_pair(obj1,obj2));
+                    objPairs.push_back(obj1);
+                    objPairs.push_back(obj2);
                 }
             }
         }
     }
 
     // Here we check all objects from the two groups against each other
-    bool returnValue=false;
-    for (size_t i=0;i<objPairs.size()/2;i++)
-    {
-        C3DObject* obj1=objPairs[2*i+0];
-        C3DObject* obj2=objPairs[2*i+1];
-        if (obj1!=NULL) // to take into account a removed pair
-        {
-            bool doIt=(!returnValue);
-            if ( (!doIt)&&(intersections!=NULL) )
-            { // we still might have to do it if we have shape-shape colldetection (for the contour)
-                doIt=(obj1->getObjectType()==sim_object_shape_type)&&(obj2->getObjectType()==sim_object_shape_type);
-            }
-            if (doIt)
-            {
-                if (_doesObjectCollideWithObject(obj1,obj2,true,true,intersections))
-                {
-                    collidingGroupObjects[0]=obj1->getID();
-                    collidingGroupObjects[1]=obj2->getID();
-                    if (intersections==NULL)
-                        return(true);
-                    returnValue=true;
-                }
-            }
-        }
-    }
-    return(returnValue);
+    return(_doesAnyObjectPairCollide(objPairs,intersections,collidingGroupObjects));
 }
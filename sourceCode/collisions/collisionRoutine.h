@@ -32,6 +32,10 @@ private:
 
     static bool _doesGroupCollideWithItself(const std::vector<C3DObject*>& group,std::vector<float>* intersections,int collidingGroupObjects[2]);
     static bool _doesGroupCollideWithGroup(const std::vector<C3DObject*>& group1,const std::vector<C3DObject*>& group2,std::vector<float>* intersections,int collidingGroupObjects[2]);
+    static bool _doesAnyObjectPairCollide(const std::vector<C3DObject*>& objPairs,std::vector<float>* intersections,int collidingGroupObjects[2]);
+    static bool _doesAnyObjectPairCollide_parallel(const std::vector<C3DObject*>& objPairs,std::vector<float>* intersections,int collidingGroupObjects[2]);
+    static bool _prepareObjectPairForConcurrentCheck(C3DObject* obj1,C3DObject* obj2);
+    static void _objectPairCollisionTask(void* taskData,int taskIndex);
 
     static bool _areObjectBoundingBoxesOverlapping(C3DObject* obj1,C3DObject* obj2);
 };
@@ -10,6 +10,7 @@
 #include "v_repStrings.h"
 #include "vDateTime.h"
 #include "pluginContainer.h"
+#include "stepProfiler.h"
 #include "collisionContourRendering.h"
 
 CRegCollision::CRegCollision(int obj1ID,int obj2ID,std::string objName,int objID)
@@ -337,6 +338,7 @@ bool CRegCollision::handleCollision()
         return(false);
     if (!CPluginContainer::isMeshPluginAvailable())
         return(false);
+    CStepProfilerScope profilerScope(PROFILER_CATEGORY_COLLISION,getObjectID());
     int stT=VDateTime::getTimeInMs();
     if (detectAllCollisions)
     {
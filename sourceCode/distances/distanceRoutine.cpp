@@ -4,11 +4,25 @@
 #include "pluginContainer.h"
 #include "tt.h"
 #include "app.h"
+#include "regDist.h"
+#include "workerPool.h"
+#include <set>
+
+#define DISTANCE_EXTENDED_CACHE_SIZE 1000
+
+struct SDistanceHandlingTask
+{
+    const std::vector<CRegDist*>* distanceObjects;
+    const std::vector<int>* order;
+    std::vector<float>* distances;
+};
 
 bool CDistanceRoutine::_distanceCachingOff=false;
-std::vector<SExtCache> CDistanceRoutine::_extendedCacheBuffer;
+VTHREAD_ID_TYPE CDistanceRoutine::_batchThreadId=VTHREAD_ID_DEAD;
+VMutex CDistanceRoutine::_cacheMutex;
+boost::unordered_map<int,long long int> CDistanceRoutine::_extendedCacheBuffer;
 int CDistanceRoutine::_nextExtendedCacheId=1;
-std::vector<SMovementCoherency> CDistanceRoutine::_objectCoherency;
+boost::unordered_map<std::pair<int,int>,SMovementCoherency> CDistanceRoutine::_objectCoherency;
 
 bool CDistanceRoutine::getDistanceCachingEnabled()
 {
@@ -22,23 +36,25 @@ void CDistanceRoutine::setDistanceCachingEnabled(bool e)
 
 long long int CDistanceRoutine::getExtendedCacheValue(int id)
 {
-    for (size_t i=0;i<_extendedCacheBuffer.size();i++)
-    {
-        if (_extendedCacheBuffer[i].id==id)
-            return(_extendedCacheBuffer[i].cache);
-    }
-    return(0);
+    long long int retVal=0;
+    _cacheMutex.lock_simple();
+    boost::unordered_map<int,long long int>::iterator it=_extendedCacheBuffer.find(id);
+    if (it!=_extendedCacheBuffer.end())
+        retVal=it->second;
+    _cacheMutex.unlock_simple();
+    return(retVal);
 }
 
 int CDistanceRoutine::insertExtendedCacheValue(long long int value)
 {
-    if (_extendedCacheBuffer.size()>100)
-        _extendedCacheBuffer.pop_back();
-    SExtCache c;
-    c.id=_nextExtendedCacheId;
-    c.cache=value;
-    _extendedCacheBuffer.insert(_extendedCacheBuffer.begin(),c);
-    return(_nextExtendedCacheId++);
+    _cacheMutex.lock_simple();
+    // Ids are consecutive and only the oldest entry is ever removed, so the oldest id is known:
+    if (_extendedCacheBuffer.size()>=DISTANCE_EXTENDED_CACHE_SIZE)
+        _extendedCacheBuffer.erase(_nextExtendedCacheId-int(_extendedCacheBuffer.size()));
+    int retVal=_nextExtendedCacheId++;
+    _extendedCacheBuffer[retVal]=value;
+    _cacheMutex.unlock_simple();
+    return(retVal);
 }
 
 bool CDistanceRoutine::getOctreesHaveCoherentMovement(COctree* octree1,COctree* octree2)
@@ -50,31 +66,122 @@ bool CDistanceRoutine::getOctreesHaveCoherentMovement(COctree* octree1,COctree*
     octree2->getMatrixAndHalfSizeOfBoundingBox(m2,hs2);
     C7Vector tr1(m1);
     C7Vector tr2(m2);
-    for (size_t i=0;i<_objectCoherency.size();i++)
+    _cacheMutex.lock_simple();
+    std::pair<int,int> key(octree1->getID(),octree2->getID());
+    boost::unordered_map<std::pair<int,int>,SMovementCoherency>::iterator it=_objectCoherency.find(key);
+    if (it!=_objectCoherency.end())
     {
-        if ( (_objectCoherency[i].object1Id==octree1->getID())&&(_objectCoherency[i].object2Id==octree2->getID()) )
-        {
-            float s1=0.2*sqrt(pow(hs1(0),2.0)+pow(hs1(1),2.0)+pow(hs1(2),2.0));
-            float s2=0.2*sqrt(pow(hs2(0),2.0)+pow(hs2(1),2.0)+pow(hs2(2),2.0));
-            if ( ((tr1.X-_objectCoherency[i].object1Tr.X).getLength()<s1)&&((tr2.X-_objectCoherency[i].object2Tr.X).getLength()<s2) )
-            { // we have positional coherency
-                C4Vector q1(tr1.Q.getInverse()*tr2.Q);
-                C4Vector q2(_objectCoherency[i].object1Tr.Q.getInverse()*_objectCoherency[i].object2Tr.Q);
-                retVal=q1.getAngleBetweenQuaternions(q2)<20.0f*piValue_f/180.0f; // this is angular coherency
-            }
-            _objectCoherency.erase(_objectCoherency.begin()+i);
-            break;
+        float s1=0.2*sqrt(pow(hs1(0),2.0)+pow(hs1(1),2.0)+pow(hs1(2),2.0));
+        float s2=0.2*sqrt(pow(hs2(0),2.0)+pow(hs2(1),2.0)+pow(hs2(2),2.0));
+        if ( ((tr1.X-it->second.object1Tr.X).getLength()<s1)&&((tr2.X-it->second.object2Tr.X).getLength()<s2) )
+        { // we have positional coherency
+            C4Vector q1(tr1.Q.getInverse()*tr2.Q);
+            C4Vector q2(it->second.object1Tr.Q.getInverse()*it->second.object2Tr.Q);
+            retVal=q1.getAngleBetweenQuaternions(q2)<20.0f*piValue_f/180.0f; // this is angular coherency
         }
     }
-    SMovementCoherency co;
-    co.object1Id=octree1->getID();
-    co.object2Id=octree2->getID();
+    SMovementCoherency& co=_objectCoherency[key];
     co.object1Tr=tr1;
     co.object2Tr=tr2;
-    _objectCoherency.push_back(co);
+    _cacheMutex.unlock_simple();
     return(retVal);
 }
 
+void CDistanceRoutine::handleDistances(const std::vector<CRegDist*>& distanceObjects,std::vector<float>& distances)
+{ // Handles several registered distance objects. With the parallelDistanceCalculation setting, they are
+  // distributed to the worker threads, the most expensive ones (during last handling) first
+    distances.assign(distanceObjects.size(),-1.0f);
+    bool concurrent=App::userSettings->parallelDistanceCalculation&&(distanceObjects.size()>1)&&(CWorkerPool::getEffectiveWorkerCount()>0)&&App::ct->mainSettings->distanceCalculationEnabled&&CPluginContainer::isMeshPluginAvailable();
+    if (!concurrent)
+    {
+        for (size_t i=0;i<distanceObjects.size();i++)
+            distances[i]=distanceObjects[i]->handleDistance();
+        return;
+    }
+
+    std::vector<float> previousTimes;
+    std::vector<int> order;
+    for (size_t i=0;i<distanceObjects.size();i++)
+    {
+        previousTimes.push_back(-distanceObjects[i]->getCalculationTime());
+        order.push_back(int(i));
+    }
+    tt::orderAscending(previousTimes,order);
+
+    // Everything that is lazily computed or built is prepared here, before going concurrent:
+    for (size_t i=0;i<distanceObjects.size();i++)
+        _prepareDistanceObjectForConcurrentHandling(distanceObjects[i]);
+
+    SDistanceHandlingTask taskData;
+    taskData.distanceObjects=&distanceObjects;
+    taskData.order=&order;
+    taskData.distances=&distances;
+
+    App::ct->calcInfo->distanceCalculationStart();
+    _cacheMutex.lock_simple();
+    _batchThreadId=VThread::getCurrentThreadId();
+    _cacheMutex.unlock_simple();
+    CPluginContainer::mesh_setConcurrentAccess(true);
+    C3DObject::setCumulativeTransformationCacheFrozen(true);
+    CWorkerPool::executeTasks(_distanceHandlingTask,&taskData,int(order.size()));
+    C3DObject::setCumulativeTransformationCacheFrozen(false);
+    CPluginContainer::mesh_setConcurrentAccess(false);
+    _cacheMutex.lock_simple();
+    _batchThreadId=VTHREAD_ID_DEAD;
+    _cacheMutex.unlock_simple();
+    App::ct->calcInfo->distanceCalculationEnd(int(order.size()));
+}
+
+bool CDistanceRoutine::_isCurrentThreadInConcurrentBatch()
+{ // true for the thread that runs handleDistances concurrently and for its workers, false for any other thread
+    _cacheMutex.lock_simple();
+    VTHREAD_ID_TYPE batchThreadId=_batchThreadId;
+    _cacheMutex.unlock_simple();
+    if (VThread::areThreadIDsSame(batchThreadId,VTHREAD_ID_DEAD))
+        return(false);
+    return(CWorkerPool::isCurrentThreadWorkingFor(batchThreadId));
+}
+
+void CDistanceRoutine::_distanceHandlingTask(void* taskData,int taskIndex)
+{
+    SDistanceHandlingTask* task=(SDistanceHandlingTask*)taskData;
+    int index=task->order->at(taskIndex);
+    task->distances->at(index)=task->distanceObjects->at(index)->handleDistance();
+}
+
+void CDistanceRoutine::_getMeasurableObjects(int entityID,int otherEntityID,std::vector<C3DObject*>& objects)
+{ // same objects as getDistanceBetweenEntitiesIfSmaller would use (without override flags)
+    C3DObject* object=App::ct->objCont->getObject(entityID);
+    if (object!=NULL)
+    {
+        if ((object->getCumulativeObjectSpecialProperty()&sim_objectspecialproperty_measurable)!=0)
+            objects.push_back(object);
+    }
+    else if (entityID!=-1)
+        App::ct->collections->getMeasurableObjectsFromCollection(entityID,objects);
+    else
+    {
+        std::vector<C3DObject*> exception;
+        _getMeasurableObjects(otherEntityID,-2,exception);
+        App::ct->objCont->getAllMeasurableObjectsFromSceneExcept(&exception,objects);
+    }
+}
+
+void CDistanceRoutine::_prepareDistanceObjectForConcurrentHandling(CRegDist* distanceObject)
+{ // Calculation structures of all involved shapes are built here (once): the worker threads
+  // cannot build them, since several distance objects may share a shape
+    std::vector<C3DObject*> objects;
+    _getMeasurableObjects(distanceObject->getObject1ID(),distanceObject->getObject2ID(),objects);
+    _getMeasurableObjects(distanceObject->getObject2ID(),distanceObject->getObject1ID(),objects);
+    for (size_t i=0;i<objects.size();i++)
+    {
+        C3DObject* obj=objects[i];
+        obj->getCumulativeTransformation();
+        obj->getCumulativeObjectSpecialProperty();
+        if (obj->getObjectType()==sim_object_shape_type)
+            ((CShape*)obj)->initializeCalculationStructureIfNeeded();
+    }
+}
 
 //---------------------------- GENERAL DISTANCE QUERIES ---------------------------
 bool CDistanceRoutine::getDistanceBetweenEntitiesIfSmaller(int entity1ID,int entity2ID,float& dist,float ray[7],int cache1[2],int cache2[2],bool overrideMeasurableFlagIfNonCollection1,bool overrideMeasurableFlagIfNonCollection2)
@@ -100,7 +207,9 @@ bool CDistanceRoutine::getDistanceBetweenEntitiesIfSmaller(int entity1ID,int ent
             return(false);
     }
 
-    App::ct->calcInfo->distanceCalculationStart();
+    bool inConcurrentBatch=_isCurrentThreadInConcurrentBatch(); // the batch does the profiling
+    if (!inConcurrentBatch)
+        App::ct->calcInfo->distanceCalculationStart();
     if (object1!=NULL)
     { // We have an object against...
         if (object2!=NULL)
@@ -184,7 +293,8 @@ bool CDistanceRoutine::getDistanceBetweenEntitiesIfSmaller(int entity1ID,int ent
             }
         }
     }
-    App::ct->calcInfo->distanceCalculationEnd();
+    if (!inConcurrentBatch)
+        App::ct->calcInfo->distanceCalculationEnd();
     return(returnValue);
 }
 
@@ -746,12 +856,17 @@ bool CDistanceRoutine::_getPointCloudPointCloudDistanceIfSmaller(CPointCloud* po
 bool CDistanceRoutine::_getObjectPairsDistanceIfSmaller(const std::vector<C3DObject*>& unorderedPairs,float& dist,float ray[7],int cache1[2],int cache2[2],bool overrideMeasurableFlagObject1,bool overrideMeasurableFlagObject2)
 {
     std::vector<C3DObject*> pairs(unorderedPairs);
-    float approxDist=_orderPairsAccordingToApproxBoundingBoxDistance(pairs);
+    std::vector<float> approxDistances;
+    float approxDist=_orderPairsAccordingToApproxBoundingBoxDistance(pairs,&approxDistances);
     if (approxDist>=dist)
         return(false);
     bool retVal=false;
     for (size_t i=0;i<pairs.size()/2;i++)
+    {
+        if (approxDistances[i]>=dist)
+            break; // pairs are ordered: the remaining pairs cannot be closer either
         retVal|=_getObjectObjectDistanceIfSmaller(pairs[2*i+0],pairs[2*i+1],dist,ray,cache1,cache2,overrideMeasurableFlagObject1,overrideMeasurableFlagObject2);
+    }
 
     return(retVal);
 }
@@ -833,6 +948,7 @@ void CDistanceRoutine::_generateValidPairsFromGroupObject(const std::vector<C3DO
 
 void CDistanceRoutine::_generateValidPairsFromGroupGroup(const std::vector<C3DObject*>& group1,const std::vector<C3DObject*>& group2,std::vector<C3DObject*>& pairs,bool collectionSelfDistanceCheck)
 {
+    std::set<std::pair<C3DObject*,C3DObject*> > addedPairs;
     for (size_t i=0;i<group1.size();i++)
     {
         C3DObject* obj1=group1[i];
@@ -846,17 +962,9 @@ void CDistanceRoutine::_generateValidPairsFromGroupGroup(const std::vector<C3DOb
                 if ( (abs(csci1-csci2)!=1)||(!collectionSelfDistanceCheck) )
                 { // the collection self collision indicators differences is not 1
                     // We now check if these partners are already present in objPairs
-                    bool absent=true;
-                    for (size_t k=0;k<pairs.size()/2;k++)
-                    {
-                        if ( (pairs[2*k+0]==obj2)&&(pairs[2*k+1]==obj1) )
-                        {
-                            absent=false;
-                            break;
-                        }
-                    }
-                    if (absent)
+                    if (addedPairs.find(std::make_pair(obj2,obj1))==addedPairs.end())
                     {
+                        addedPairs.insert(std::make_pair(obj1,obj2));
                         pairs.push_back(obj1);
                         pairs.push_back(obj2);
                     }
@@ -866,8 +974,8 @@ void CDistanceRoutine::_generateValidPairsFromGroupGroup(const std::vector<C3DOb
     }
 }
 
-float CDistanceRoutine::_orderPairsAccordingToApproxBoundingBoxDistance(std::vector<C3DObject*>& pairs)
-{ // returns the smallest approx box-box distance
+float CDistanceRoutine::_orderPairsAccordingToApproxBoundingBoxDistance(std::vector<C3DObject*>& pairs,std::vector<float>* orderedDistances/*=NULL*/)
+{ // returns the smallest approx box-box distance. orderedDistances receives the approx. distance of each ordered pair
     float retVal=0;
     std::vector<float> distances;
     std::vector<int> indexes;
@@ -881,6 +989,8 @@ float CDistanceRoutine::_orderPairsAccordingToApproxBoundingBoxDistance(std::vec
     }
 
     tt::orderAscending(distances,indexes);
+    if (orderedDistances!=NULL)
+        orderedDistances[0]=distances;
 
     std::vector<C3DObject*> _pairs(pairs);
     for (size_t i=0;i<indexes.size();i++)
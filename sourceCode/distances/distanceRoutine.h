@@ -2,19 +2,17 @@
 #pragma once
 
 #include "shape.h"
-
-struct SExtCache {
-    int id;
-    long long int cache;
-};
+#include "vMutex.h"
+#include "vThread.h"
+#include <boost/unordered_map.hpp>
 
 struct SMovementCoherency {
-    int object1Id;
-    int object2Id;
     C7Vector object1Tr;
     C7Vector object2Tr;
 };
 
+class CRegDist;
+
 class COctree;
 class CPointCloud;
 
@@ -27,6 +25,8 @@ public:
 
     static bool getDistanceBetweenEntitiesIfSmaller(int entity1ID,int entity2ID,float& dist,float ray[7],int cache1[2],int cache2[2],bool overrideMeasurableFlagIfNonCollection1,bool overrideMeasurableFlagIfNonCollection2);
 
+    static void handleDistances(const std::vector<CRegDist*>& distanceObjects,std::vector<float>& distances);
+
     static bool getDistanceCachingEnabled();
     static void setDistanceCachingEnabled(bool e);
 
@@ -56,7 +56,11 @@ private:
     static void _generateValidPairsFromObjectGroup(C3DObject* obj,const std::vector<C3DObject*>& group,std::vector<C3DObject*>& pairs);
     static void _generateValidPairsFromGroupObject(const std::vector<C3DObject*>& group,C3DObject* obj,std::vector<C3DObject*>& pairs);
     static void _generateValidPairsFromGroupGroup(const std::vector<C3DObject*>& group1,const std::vector<C3DObject*>& group2,std::vector<C3DObject*>& pairs,bool collectionSelfDistanceCheck);
-    static float _orderPairsAccordingToApproxBoundingBoxDistance(std::vector<C3DObject*>& pairs);
+    static float _orderPairsAccordingToApproxBoundingBoxDistance(std::vector<C3DObject*>& pairs,std::vector<float>* orderedDistances=NULL);
+    static void _getMeasurableObjects(int entityID,int otherEntityID,std::vector<C3DObject*>& objects);
+    static void _prepareDistanceObjectForConcurrentHandling(CRegDist* distanceObject);
+    static void _distanceHandlingTask(void* taskData,int taskIndex);
+    static bool _isCurrentThreadInConcurrentBatch();
     static bool _getCachedDistanceShapeShapeIfSmaller(CShape* shape1,CShape* shape2,float& dist,float ray[7],int cache1[2],int cache2[2],bool overrideMeasurableFlagObject1,bool overrideMeasurableFlagObject2,bool& cachedPairWasProcessed);
     static bool _getCachedDistanceShapeDummyIfSmaller(CShape* shape,CDummy* dummy,float& dist,float ray[7],int cache1[2],int cache2[2],bool overrideMeasurableFlagObject1,bool overrideMeasurableFlagObject2,bool& cachedPairWasProcessed);
     static bool _getCachedDistanceDummyShapeIfSmaller(CDummy* dummy,CShape* shape,float& dist,float ray[7],int cache1[2],int cache2[2],bool overrideMeasurableFlagObject1,bool overrideMeasurableFlagObject2,bool& cachedPairWasProcessed);
@@ -79,7 +83,9 @@ private:
     static int insertExtendedCacheValue(long long int value);
     static bool getOctreesHaveCoherentMovement(COctree* octree1,COctree* octree2);
     static bool _distanceCachingOff;
-    static std::vector<SExtCache> _extendedCacheBuffer;
+    static VMutex _cacheMutex; // protects the 4 variables below
+    static VTHREAD_ID_TYPE _batchThreadId; // thread running a concurrent handleDistances, VTHREAD_ID_DEAD otherwise
+    static boost::unordered_map<int,long long int> _extendedCacheBuffer; // id --> cache value. Ids are consecutive
     static int _nextExtendedCacheId;
-    static std::vector<SMovementCoherency> _objectCoherency;
+    static boost::unordered_map<std::pair<int,int>,SMovementCoherency> _objectCoherency; // (octree1 id,octree2 id) --> last transformations
 };
@@ -11,6 +11,7 @@
 #include "v_repStrings.h"
 #include "vDateTime.h"
 #include "pluginContainer.h"
+#include "stepProfiler.h"
 #include "distanceRendering.h"
 
 CRegDist::CRegDist(int obj1ID,int obj2ID,std::string objName,int objID)
@@ -248,6 +249,7 @@ float CRegDist::handleDistance()
         return(-1.0);
     if (!CPluginContainer::isMeshPluginAvailable())
         return(-1.0);
+    CStepProfilerScope profilerScope(PROFILER_CATEGORY_DISTANCE,getObjectID());
     int stTime=VDateTime::getTimeInMs();
     _distance=SIM_MAX_FLOAT;
     if (treshholdActive)
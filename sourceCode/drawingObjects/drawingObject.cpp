@@ -49,6 +49,21 @@ std::vector<float>* CDrawingObject::getDataPtr()
     return(&_data);
 }
 
+int CDrawingObject::getDataGeneration() const
+{
+    return(_dataGeneration);
+}
+
+quint64 CDrawingObject::getAddedItemCount() const
+{
+    return(_addedItemCount);
+}
+
+SDrawingObjectBuffer* CDrawingObject::getBufferPtr()
+{
+    return(&_buffer);
+}
+
 CDrawingObject::CDrawingObject(int theObjectType,float size,float duplicateTolerance,int sceneObjID,int maxItemCount,bool createdFromScript)
 {
     _persistent=false;
@@ -75,6 +90,13 @@ CDrawingObject::CDrawingObject(int theObjectType,float size,float duplicateToler
     maxItemCount=tt::getLimitedInt(1,10000000,maxItemCount);
     _maxItemCount=maxItemCount;
     _startItem=0;
+    _dataGeneration=0;
+    _addedItemCount=0;
+    _buffer.ringBufferId=-1;
+    _buffer.itemCapacity=0;
+    _buffer.floatsPerSlot=-1;
+    _buffer.dataGeneration=-1;
+    _buffer.uploadedItemCount=0;
     int tmp=theObjectType&0x001f;
     if (theObjectType&sim_drawing_vertexcolors)
     {
@@ -109,6 +131,7 @@ CDrawingObject::CDrawingObject(int theObjectType,float size,float duplicateToler
 
 CDrawingObject::~CDrawingObject()
 {
+    decreaseRingBufferRefCnt(_buffer.ringBufferId);
 }
 
 int CDrawingObject::getObjectType() const
@@ -133,6 +156,7 @@ int CDrawingObject::getObjectID() const
 
 void CDrawingObject::adjustForFrameChange(const C7Vector& preCorrection)
 {
+    _dataGeneration++;
     for (int i=0;i<int(_data.size())/floatsPerItem;i++)
     {
         for (int j=0;j<verticesPerItem;j++)
@@ -153,6 +177,7 @@ void CDrawingObject::adjustForFrameChange(const C7Vector& preCorrection)
 
 void CDrawingObject::adjustForScaling(float xScale,float yScale,float zScale)
 {
+    _dataGeneration++;
     float avgScaling=(xScale+yScale+zScale)/3.0f;
     int tmp=_objectType&0x001f;
     if ((tmp!=sim_drawing_points)&&(tmp!=sim_drawing_lines))
@@ -190,20 +215,10 @@ bool CDrawingObject::addItem(const float* itemData)
     {
         _data.clear();
         _startItem=0;
+        _dataGeneration++;
+        _addedItemCount=0;
         return(false);
     }
-    int newPos=_startItem;
-    if (int(_data.size())/floatsPerItem>=_maxItemCount)
-    { // the buffer is full
-        if (_objectType&sim_drawing_cyclic)
-        {
-            _startItem++;
-            if (_startItem>=_maxItemCount)
-                _startItem=0;
-        }
-        else
-            return(false); // saturated
-    }
 
     C7Vector trInv;
     trInv.setIdentity();
@@ -228,6 +243,20 @@ bool CDrawingObject::addItem(const float* itemData)
         }
     }
 
+    // Only advance the cyclic buffer once the item is accepted: item i has to stay in slot i%_maxItemCount
+    int newPos=_startItem;
+    if (int(_data.size())/floatsPerItem>=_maxItemCount)
+    { // the buffer is full
+        if (_objectType&sim_drawing_cyclic)
+        {
+            _startItem++;
+            if (_startItem>=_maxItemCount)
+                _startItem=0;
+        }
+        else
+            return(false); // saturated
+    }
+
     if (int(_data.size())/floatsPerItem<_maxItemCount)
     { // The buffer is not yet full!
         newPos=int(_data.size())/floatsPerItem;
@@ -260,6 +289,7 @@ bool CDrawingObject::addItem(const float* itemData)
         for (int i=0;i<otherFloatsPerItem;i++)
             _data[newPos*floatsPerItem+off+i]=itemData[off+i];
     }
+    _addedItemCount++;
     return(true);
 }
 
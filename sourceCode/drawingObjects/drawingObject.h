@@ -5,6 +5,16 @@
 #include "4X4Matrix.h"
 #include "vMutex.h"
 
+struct SDrawingObjectBuffer
+{ // Copy of the items that is maintained by the rendering code
+    int ringBufferId; // interleaved vertices, -1 if not yet built
+    int itemCapacity;
+    int floatsPerSlot; // layout of the uploaded items, -1 if nothing was uploaded yet
+    int dataGeneration;
+    quint64 uploadedItemCount;
+    std::vector<float> instanceData; // cube, disc and sphere points that are drawn separately: a transformation matrix (and a color) per item
+};
+
 class CDrawingObject  
 {
 public:
@@ -34,6 +44,9 @@ public:
     int getStartItem() const;
 
     std::vector<float>* getDataPtr();
+    int getDataGeneration() const;
+    quint64 getAddedItemCount() const;
+    SDrawingObjectBuffer* getBufferPtr();
 
     CVisualParam color;
 
@@ -66,4 +79,7 @@ protected:
     VMutex _objectMutex;
 
     std::vector<float> _data;
+    int _dataGeneration; // incremented when existing items are modified or removed
+    quint64 _addedItemCount; // since the last modification. Item i is in slot i%_maxItemCount
+    SDrawingObjectBuffer _buffer;
 };
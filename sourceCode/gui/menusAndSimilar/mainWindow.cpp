@@ -18,6 +18,7 @@
 #include "gV.h"
 #include "tt.h"
 #include "app.h"
+#include "stepProfiler.h"
 #include "pluginContainer.h"
 #include "auxLibVideo.h"
 #include "vVarious.h"
@@ -647,6 +648,7 @@ void CMainWindow::uiThread_renderScene(bool bufferMainDisplayStateVariables)
 void CMainWindow::uiThread_renderScene_noLock(bool bufferMainDisplayStateVariables)
 {
     FUNCTION_DEBUG;
+    CStepProfilerScope profilerScope(PROFILER_CATEGORY_RENDERING,-1);
     App::ct->calcInfo->clearRenderingTime();
     App::ct->calcInfo->renderingStart();
     if (bufferMainDisplayStateVariables)
@@ -853,6 +855,8 @@ int CMainWindow::_renderOpenGlContent_callFromRenderingThreadOnly()
             _prepareSceneThumbnailCmd.cmdId=-1;
         }
 
+        runDrawingObjectBenchmark_ifNeeded(); // first real paint: the main window exists
+
         if (!_hasStereo)
             oglSurface->render(_currentCursor,_mouseButtonsState,mp,NULL);
         else
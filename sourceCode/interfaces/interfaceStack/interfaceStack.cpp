@@ -213,14 +213,29 @@ CInterfaceStackTable* CInterfaceStack::_generateTableArrayFromLuaStack(luaWrap_l
 { // there must be a table at the given index.
     CInterfaceStackTable* table=new CInterfaceStackTable();
     int arraySize=int(luaWrap_lua_objlen(L,index));
+    std::vector<double> numbers; // as long as we only have numbers, we store them contiguously
+    bool onlyNumbers=true;
     for (int i=0;i<arraySize;i++)
     {
         // Push the element i+1 of the table to the top of Lua's stack:
         luaWrap_lua_rawgeti(L,index,i+1);
-        CInterfaceStackObject* obj=_generateObjectFromLuaStack(L,-1,visitedTables);
+        if ( onlyNumbers&&(luaWrap_lua_stype(L,-1)==STACK_OBJECT_NUMBER) )
+            numbers.push_back(luaWrap_lua_tonumber(L,-1));
+        else
+        {
+            if (onlyNumbers)
+            { // first item that is not a number
+                onlyNumbers=false;
+                if (numbers.size()>0)
+                    table->setDoubleArray(&numbers[0],(int)numbers.size());
+            }
+            CInterfaceStackObject* obj=_generateObjectFromLuaStack(L,-1,visitedTables);
+            table->appendArrayObject(obj);
+        }
         luaWrap_lua_pop(L,1); // we pop one element from the stack;
-        table->appendArrayObject(obj);
     }
+    if ( onlyNumbers&&(numbers.size()>0) )
+        table->setDoubleArray(&numbers[0],(int)numbers.size());
     return(table);
 }
 
@@ -342,7 +357,27 @@ void CInterfaceStack::_pushOntoLuaStack(luaWrap_lua_State* L,CInterfaceStackObje
     {
         luaWrap_lua_newtable(L);
         CInterfaceStackTable* table=(CInterfaceStackTable*)obj;
-        if (table->isTableArray())
+        int packedCnt=0;
+        const double* packed=table->getDoubleArrayPtr(packedCnt);
+        if (packed!=NULL)
+        { // numbers stored contiguously
+            for (int i=0;i<packedCnt;i++)
+            {
+                luaWrap_lua_pushnumber(L,packed[i]);
+                luaWrap_lua_rawseti(L,-2,i+1);
+            }
+        }
+        else if (table->getArrayStorage()!=STACK_ARRAY_OBJECTS)
+        { // numbers stored contiguously, but not as doubles
+            std::vector<double> v(table->getArraySize());
+            table->getDoubleArray(&v[0],(int)v.size()); // avoids creating the item objects
+            for (size_t i=0;i<v.size();i++)
+            {
+                luaWrap_lua_pushnumber(L,v[i]);
+                luaWrap_lua_rawseti(L,-2,int(i)+1);
+            }
+        }
+        else if (table->isTableArray())
         { // array-type table
             for (int i=0;i<table->getArraySize();i++)
             {
@@ -434,6 +469,46 @@ bool CInterfaceStack::getStackDoubleArray(double* array,int count) const
     return(table->getDoubleArray(array,count));
 }
 
+const unsigned char* CInterfaceStack::getStackUCharArrayPtr(int& count) const
+{ // Returns NULL if the top item is not a table that stores its items contiguously in that format
+    if (_stackObjects.size()==0)
+        return(NULL);
+    CInterfaceStackObject* obj=_stackObjects[_stackObjects.size()-1];
+    if (obj->getObjectType()!=STACK_OBJECT_TABLE)
+        return(NULL);
+    return(((CInterfaceStackTable*)obj)->getUCharArrayPtr(count));
+}
+
+const int* CInterfaceStack::getStackIntArrayPtr(int& count) const
+{ // Returns NULL if the top item is not a table that stores its items contiguously in that format
+    if (_stackObjects.size()==0)
+        return(NULL);
+    CInterfaceStackObject* obj=_stackObjects[_stackObjects.size()-1];
+    if (obj->getObjectType()!=STACK_OBJECT_TABLE)
+        return(NULL);
+    return(((CInterfaceStackTable*)obj)->getIntArrayPtr(count));
+}
+
+const float* CInterfaceStack::getStackFloatArrayPtr(int& count) const
+{ // Returns NULL if the top item is not a table that stores its items contiguously in that format
+    if (_stackObjects.size()==0)
+        return(NULL);
+    CInterfaceStackObject* obj=_stackObjects[_stackObjects.size()-1];
+    if (obj->getObjectType()!=STACK_OBJECT_TABLE)
+        return(NULL);
+    return(((CInterfaceStackTable*)obj)->getFloatArrayPtr(count));
+}
+
+const double* CInterfaceStack::getStackDoubleArrayPtr(int& count) const
+{ // Returns NULL if the top item is not a table that stores its items contiguously in that format
+    if (_stackObjects.size()==0)
+        return(NULL);
+    CInterfaceStackObject* obj=_stackObjects[_stackObjects.size()-1];
+    if (obj->getObjectType()!=STACK_OBJECT_TABLE)
+        return(NULL);
+    return(((CInterfaceStackTable*)obj)->getDoubleArrayPtr(count));
+}
+
 bool CInterfaceStack::getStackMapFloatArray(const std::string& fieldName,float* array,int count) const
 {
     const CInterfaceStackObject* obj=getStackMapObject(fieldName);
@@ -48,6 +48,10 @@ public:
     bool getStackIntArray(int* array,int count) const;
     bool getStackFloatArray(float* array,int count) const;
     bool getStackDoubleArray(double* array,int count) const;
+    const unsigned char* getStackUCharArrayPtr(int& count) const;
+    const int* getStackIntArrayPtr(int& count) const;
+    const float* getStackFloatArrayPtr(int& count) const;
+    const double* getStackDoubleArrayPtr(int& count) const;
     bool unfoldStackTable();
     CInterfaceStackObject* getStackMapObject(const std::string& fieldName) const;
     bool getStackMapBoolValue(const std::string& fieldName,bool& val) const;
@@ -6,18 +6,114 @@
 #include "interfaceStackString.h"
 #include "interfaceStackTable.h"
 #include <algorithm> // std::sort, etc.
+#include <string.h>
+
+template<class TSrc,class TDst>
+static void _copyArray(const std::vector<TSrc>& src,TDst* dst,size_t cnt)
+{
+    for (size_t i=0;i<cnt;i++)
+        dst[i]=(TDst)src[i];
+}
 
 CInterfaceStackTable::CInterfaceStackTable()
 {
     _objectType=STACK_OBJECT_TABLE;
     _isTableArray=true;
     _isCircularRef=false;
+    _arrayStorage=STACK_ARRAY_OBJECTS;
 }
 
 CInterfaceStackTable::~CInterfaceStackTable()
+{
+    _clearArrays();
+}
+
+void CInterfaceStackTable::_clearArrays()
 {
     for (size_t i=0;i<_tableObjects.size();i++)
         delete _tableObjects[i];
+    _tableObjects.clear();
+    _ucharArray.clear();
+    _intArray.clear();
+    _floatArray.clear();
+    _doubleArray.clear();
+    _arrayStorage=STACK_ARRAY_OBJECTS;
+}
+
+int CInterfaceStackTable::getArrayStorage() const
+{
+    return(_arrayStorage);
+}
+
+int CInterfaceStackTable::_getPackedArraySize() const
+{
+    if (_arrayStorage==STACK_ARRAY_UCHARS)
+        return((int)_ucharArray.size());
+    if (_arrayStorage==STACK_ARRAY_INTS)
+        return((int)_intArray.size());
+    if (_arrayStorage==STACK_ARRAY_FLOATS)
+        return((int)_floatArray.size());
+    if (_arrayStorage==STACK_ARRAY_DOUBLES)
+        return((int)_doubleArray.size());
+    return(0);
+}
+
+double CInterfaceStackTable::_getPackedArrayValue(int ind) const
+{
+    if (_arrayStorage==STACK_ARRAY_UCHARS)
+        return((double)_ucharArray[ind]);
+    if (_arrayStorage==STACK_ARRAY_INTS)
+        return((double)_intArray[ind]);
+    if (_arrayStorage==STACK_ARRAY_FLOATS)
+        return((double)_floatArray[ind]);
+    return(_doubleArray[ind]);
+}
+
+void CInterfaceStackTable::_unpackArray() const
+{ // converts the contiguous representation to one number object per item
+    if (_arrayStorage==STACK_ARRAY_OBJECTS)
+        return;
+    int cnt=_getPackedArraySize();
+    _tableObjects.reserve(cnt);
+    for (int i=0;i<cnt;i++)
+        _tableObjects.push_back(new CInterfaceStackNumber(_getPackedArrayValue(i)));
+    _ucharArray.clear();
+    _intArray.clear();
+    _floatArray.clear();
+    _doubleArray.clear();
+    _arrayStorage=STACK_ARRAY_OBJECTS;
+}
+
+const unsigned char* CInterfaceStackTable::getUCharArrayPtr(int& count) const
+{ // Returns NULL if the array is not stored as contiguous unsigned chars. Valid until the table is modified
+    if ( (_arrayStorage!=STACK_ARRAY_UCHARS)||(_ucharArray.size()==0) )
+        return(NULL);
+    count=(int)_ucharArray.size();
+    return(&_ucharArray[0]);
+}
+
+const int* CInterfaceStackTable::getIntArrayPtr(int& count) const
+{ // Returns NULL if the array is not stored as contiguous ints. Valid until the table is modified
+    if ( (_arrayStorage!=STACK_ARRAY_INTS)||(_intArray.size()==0) )
+        return(NULL);
+    count=(int)_intArray.size();
+    return(&_intArray[0]);
+}
+
+const float* CInterfaceStackTable::getFloatArrayPtr(int& count) const
+{ // Returns NULL if the array is not stored as contiguous floats. Valid until the table is modified
+    if ( (_arrayStorage!=STACK_ARRAY_FLOATS)||(_floatArray.size()==0) )
+        return(NULL);
+    count=(int)_floatArray.size();
+    return(&_floatArray[0]);
+}
+
+const double* CInterfaceStackTable::getDoubleArrayPtr(int& count) const
+{ // Returns NULL if the array is not stored as contiguous doubles. Valid until the table is modified
+    if ( (_arrayStorage!=STACK_ARRAY_DOUBLES)||(_doubleArray.size()==0) )
+        return(NULL);
+    count=(int)_doubleArray.size();
+    return(&_doubleArray[0]);
 }
 
 bool CInterfaceStackTable::isTableArray() const
@@ -29,6 +125,8 @@ int CInterfaceStackTable::getArraySize() const
 {
     if (!_isTableArray)
         return(0);
+    if (_arrayStorage!=STACK_ARRAY_OBJECTS)
+        return(_getPackedArraySize());
     return((int)_tableObjects.size());
 }
 
@@ -54,6 +152,23 @@ bool CInterfaceStackTable::getUCharArray(unsigned char* array,int count) const
 {
     if (!_isTableArray)
         return(false);
+    if (_arrayStorage!=STACK_ARRAY_OBJECTS)
+    { // no type check needed
+        size_t c=(size_t)_getPackedArraySize();
+        if (c>(size_t)count)
+            c=(size_t)count;
+        if (_arrayStorage==STACK_ARRAY_UCHARS)
+            _copyArray(_ucharArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_INTS)
+            _copyArray(_intArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_FLOATS)
+            _copyArray(_floatArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_DOUBLES)
+            _copyArray(_doubleArray,array,c);
+        for (size_t i=c;i<(size_t)count;i++)
+            array[i]=0; // fill with zeros
+        return(true);
+    }
     bool retVal=true;
     size_t c=(size_t)count;
     if (c>_tableObjects.size())
@@ -78,6 +193,23 @@ bool CInterfaceStackTable::getIntArray(int* array,int count) const
 {
     if (!_isTableArray)
         return(false);
+    if (_arrayStorage!=STACK_ARRAY_OBJECTS)
+    { // no type check needed
+        size_t c=(size_t)_getPackedArraySize();
+        if (c>(size_t)count)
+            c=(size_t)count;
+        if (_arrayStorage==STACK_ARRAY_UCHARS)
+            _copyArray(_ucharArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_INTS)
+            _copyArray(_intArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_FLOATS)
+            _copyArray(_floatArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_DOUBLES)
+            _copyArray(_doubleArray,array,c);
+        for (size_t i=c;i<(size_t)count;i++)
+            array[i]=0; // fill with zeros
+        return(true);
+    }
     bool retVal=true;
     size_t c=(size_t)count;
     if (c>_tableObjects.size())
@@ -102,6 +234,23 @@ bool CInterfaceStackTable::getFloatArray(float* array,int count) const
 {
     if (!_isTableArray)
         return(false);
+    if (_arrayStorage!=STACK_ARRAY_OBJECTS)
+    { // no type check needed
+        size_t c=(size_t)_getPackedArraySize();
+        if (c>(size_t)count)
+            c=(size_t)count;
+        if (_arrayStorage==STACK_ARRAY_UCHARS)
+            _copyArray(_ucharArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_INTS)
+            _copyArray(_intArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_FLOATS)
+            _copyArray(_floatArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_DOUBLES)
+            _copyArray(_doubleArray,array,c);
+        for (size_t i=c;i<(size_t)count;i++)
+            array[i]=0.0; // fill with zeros
+        return(true);
+    }
     bool retVal=true;
     size_t c=(size_t)count;
     if (c>_tableObjects.size())
@@ -126,6 +275,23 @@ bool CInterfaceStackTable::getDoubleArray(double* array,int count) const
 {
     if (!_isTableArray)
         return(false);
+    if (_arrayStorage!=STACK_ARRAY_OBJECTS)
+    { // no type check needed
+        size_t c=(size_t)_getPackedArraySize();
+        if (c>(size_t)count)
+            c=(size_t)count;
+        if (_arrayStorage==STACK_ARRAY_UCHARS)
+            _copyArray(_ucharArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_INTS)
+            _copyArray(_intArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_FLOATS)
+            _copyArray(_floatArray,array,c);
+        if (_arrayStorage==STACK_ARRAY_DOUBLES)
+            _copyArray(_doubleArray,array,c);
+        for (size_t i=c;i<(size_t)count;i++)
+            array[i]=0.0; // fill with zeros
+        return(true);
+    }
     bool retVal=true;
     size_t c=(size_t)count;
     if (c>_tableObjects.size())
@@ -238,11 +404,13 @@ bool CInterfaceStackTable::removeFromKey(const CInterfaceStackObject* keyToRemov
 
 void CInterfaceStackTable::appendArrayObject(CInterfaceStackObject* obj)
 {
+    _unpackArray();
     _tableObjects.push_back(obj);
 }
 
 void CInterfaceStackTable::appendMapObject(CInterfaceStackObject* obj,const char* key)
 {
+    _unpackArray();
     _isTableArray=false;
     _tableObjects.push_back(new CInterfaceStackString(key,0));
     _tableObjects.push_back(obj);
@@ -250,6 +418,7 @@ void CInterfaceStackTable::appendMapObject(CInterfaceStackObject* obj,const char
 
 void CInterfaceStackTable::appendMapObject(CInterfaceStackObject* obj,double key)
 {
+    _unpackArray();
     _isTableArray=false;
     _tableObjects.push_back(new CInterfaceStackNumber(key));
     _tableObjects.push_back(obj);
@@ -257,6 +426,7 @@ void CInterfaceStackTable::appendMapObject(CInterfaceStackObject* obj,double key
 
 void CInterfaceStackTable::appendMapObject(CInterfaceStackObject* obj,bool key)
 {
+    _unpackArray();
     _isTableArray=false;
     _tableObjects.push_back(new CInterfaceStackBool(key));
     _tableObjects.push_back(obj);
@@ -266,6 +436,7 @@ void CInterfaceStackTable::appendArrayOrMapObject(CInterfaceStackObject* obj,CIn
 {   // here we basically treat this table as an array, until the key is:
     // 1) not a number, 2) not consecutive, 3) does not start at 1.
     // In that case, we then convert that table from array to map representation
+    _unpackArray();
     bool valueInserted=false;
     if (_isTableArray)
     {
@@ -297,6 +468,7 @@ void CInterfaceStackTable::appendArrayOrMapObject(CInterfaceStackObject* obj,CIn
 
 CInterfaceStackObject* CInterfaceStackTable::getArrayItemAtIndex(int ind) const
 {
+    _unpackArray(); // the returned object has to stay valid
     if ( (!_isTableArray)||(ind>=(int)_tableObjects.size()) )
         return(NULL);
     return(_tableObjects[ind]);
@@ -330,6 +502,11 @@ CInterfaceStackObject* CInterfaceStackTable::copyYourself() const
     CInterfaceStackTable* retVal=new CInterfaceStackTable();
     for (size_t i=0;i<_tableObjects.size();i++)
         retVal->_tableObjects.push_back(_tableObjects[i]->copyYourself());
+    retVal->_arrayStorage=_arrayStorage;
+    retVal->_ucharArray=_ucharArray;
+    retVal->_intArray=_intArray;
+    retVal->_floatArray=_floatArray;
+    retVal->_doubleArray=_doubleArray;
     retVal->_isTableArray=_isTableArray;
     retVal->_isCircularRef=_isCircularRef;
     return(retVal);
@@ -337,6 +514,7 @@ CInterfaceStackObject* CInterfaceStackTable::copyYourself() const
 
 void CInterfaceStackTable::getAllObjectsAndClearTable(std::vector<CInterfaceStackObject*>& allObjs)
 {
+    _unpackArray();
     allObjs.clear();
     allObjs.assign(_tableObjects.begin(),_tableObjects.end());
     _tableObjects.clear();
@@ -344,35 +522,47 @@ void CInterfaceStackTable::getAllObjectsAndClearTable(std::vector<CInterfaceStac
 }
 
 void CInterfaceStackTable::setUCharArray(const unsigned char* array,int l)
-{
-    _tableObjects.clear();
+{ // the items are stored contiguously. Item objects are only created if requested
+    _clearArrays();
     _isTableArray=true;
-    for (int i=0;i<l;i++)
-        _tableObjects.push_back(new CInterfaceStackNumber((double)array[i]));
+    if (l>0)
+    {
+        _ucharArray.assign(array,array+l);
+        _arrayStorage=STACK_ARRAY_UCHARS;
+    }
 }
 
 void CInterfaceStackTable::setIntArray(const int* array,int l)
-{
-    _tableObjects.clear();
+{ // the items are stored contiguously. Item objects are only created if requested
+    _clearArrays();
     _isTableArray=true;
-    for (int i=0;i<l;i++)
-        _tableObjects.push_back(new CInterfaceStackNumber((double)array[i]));
+    if (l>0)
+    {
+        _intArray.assign(array,array+l);
+        _arrayStorage=STACK_ARRAY_INTS;
+    }
 }
 
 void CInterfaceStackTable::setFloatArray(const float* array,int l)
-{
-    _tableObjects.clear();
+{ // the items are stored contiguously. Item objects are only created if requested
+    _clearArrays();
     _isTableArray=true;
-    for (int i=0;i<l;i++)
-        _tableObjects.push_back(new CInterfaceStackNumber((float)array[i]));
+    if (l>0)
+    {
+        _floatArray.assign(array,array+l);
+        _arrayStorage=STACK_ARRAY_FLOATS;
+    }
 }
 
 void CInterfaceStackTable::setDoubleArray(const double* array,int l)
-{
-    _tableObjects.clear();
+{ // the items are stored contiguously. Item objects are only created if requested
+    _clearArrays();
     _isTableArray=true;
-    for (int i=0;i<l;i++)
-        _tableObjects.push_back(new CInterfaceStackNumber(array[i]));
+    if (l>0)
+    {
+        _doubleArray.assign(array,array+l);
+        _arrayStorage=STACK_ARRAY_DOUBLES;
+    }
 }
 
 int CInterfaceStackTable::getTableInfo(int infoType) const
@@ -401,6 +591,8 @@ int CInterfaceStackTable::getTableInfo(int infoType) const
 
 bool CInterfaceStackTable::_areAllValueThis(int what) const
 {
+    if (_arrayStorage!=STACK_ARRAY_OBJECTS)
+        return(what==STACK_OBJECT_NUMBER);
     if (_tableObjects.size()==0)
         return(true);
     if (_isTableArray)
@@ -428,6 +620,16 @@ void CInterfaceStackTable::printContent(int spaces) const
         printf(" ");
     if (_isCircularRef)
         printf("TABLE: <circular reference>\n");
+    else if (_arrayStorage!=STACK_ARRAY_OBJECTS)
+    {
+        printf("ARRAY TABLE (%i items, keys are omitted):\n",_getPackedArraySize()*2);
+        for (int i=0;i<_getPackedArraySize();i++)
+        {
+            for (int j=0;j<spaces+4;j++)
+                printf(" ");
+            printf("NUMBER: %f\n",_getPackedArrayValue(i));
+        }
+    }
     else
     {
         if (_tableObjects.size()==0)
@@ -463,6 +665,22 @@ std::string CInterfaceStackTable::getObjectData() const
         else
             retVal=char(0);
     }
+    if (_arrayStorage!=STACK_ARRAY_OBJECTS)
+    { // same format as with item objects, without creating them
+        unsigned int l=(unsigned int)_getPackedArraySize();
+        retVal.resize(1+sizeof(l)+l*(1+sizeof(double)));
+        char* w=&retVal[1];
+        memcpy(w,&l,sizeof(l));
+        w+=sizeof(l);
+        for (unsigned int i=0;i<l;i++)
+        {
+            double v=_getPackedArrayValue(i);
+            w[0]=(char)STACK_OBJECT_NUMBER;
+            memcpy(w+1,&v,sizeof(v));
+            w+=1+sizeof(v);
+        }
+        return(retVal);
+    }
     unsigned int l=(unsigned int)_tableObjects.size();
     char* tmp=(char*)(&l);
     for (size_t i=0;i<sizeof(l);i++)
@@ -552,6 +770,26 @@ unsigned int CInterfaceStackTable::createFromData(const char* data)
     for (size_t i=0;i<sizeof(l);i++)
         tmp[i]=data[retVal+i];
     retVal+=sizeof(l);
+    if (_isTableArray&&(!_isCircularRef)&&(l>0))
+    { // arrays of numbers are read directly into the contiguous representation:
+        bool allNumbers=true;
+        for (size_t i=0;i<l;i++)
+        {
+            if (data[retVal+i*(1+sizeof(double))]!=STACK_OBJECT_NUMBER)
+            {
+                allNumbers=false;
+                break;
+            }
+        }
+        if (allNumbers)
+        {
+            _doubleArray.resize(l);
+            for (size_t i=0;i<l;i++)
+                memcpy(&_doubleArray[i],data+retVal+i*(1+sizeof(double))+1,sizeof(double));
+            _arrayStorage=STACK_ARRAY_DOUBLES;
+            return(retVal+l*(1+sizeof(double)));
+        }
+    }
     for (size_t i=0;i<l;i++)
     {
         unsigned int r=0;
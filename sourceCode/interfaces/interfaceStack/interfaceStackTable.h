@@ -4,6 +4,13 @@
 #include "interfaceStackObject.h"
 #include <vector>
 
+// How the items of an array table are stored:
+#define STACK_ARRAY_OBJECTS 0
+#define STACK_ARRAY_UCHARS 1 // contiguous, without item objects
+#define STACK_ARRAY_INTS 2 // contiguous, without item objects
+#define STACK_ARRAY_FLOATS 3 // contiguous, without item objects
+#define STACK_ARRAY_DOUBLES 4 // contiguous, without item objects
+
 class CInterfaceStackTable : public CInterfaceStackObject
 {
 public:
@@ -41,6 +48,11 @@ public:
     bool getIntArray(int* array,int count) const;
     bool getFloatArray(float* array,int count) const;
     bool getDoubleArray(double* array,int count) const;
+    const unsigned char* getUCharArrayPtr(int& count) const;
+    const int* getIntArrayPtr(int& count) const;
+    const float* getFloatArrayPtr(int& count) const;
+    const double* getDoubleArrayPtr(int& count) const;
+    int getArrayStorage() const;
     CInterfaceStackObject* getMapObject(const std::string& fieldName) const;
 
     bool removeFromKey(const CInterfaceStackObject* keyToRemove);
@@ -49,8 +61,17 @@ public:
 
 protected:
     bool _areAllValueThis(int what) const;
+    int _getPackedArraySize() const;
+    double _getPackedArrayValue(int ind) const;
+    void _clearArrays();
+    void _unpackArray() const;
 
-    std::vector<CInterfaceStackObject*> _tableObjects;
+    mutable std::vector<CInterfaceStackObject*> _tableObjects;
+    mutable int _arrayStorage; // numeric arrays are unpacked into objects only when an object is requested
+    mutable std::vector<unsigned char> _ucharArray;
+    mutable std::vector<int> _intArray;
+    mutable std::vector<float> _floatArray;
+    mutable std::vector<double> _doubleArray;
     bool _isTableArray;
     bool _isCircularRef;
 };
@@ -447,7 +447,7 @@ const SLuaCommands simLuaCommands[]=
     {"sim.auxFunc",_simAuxFunc,                                  "... =sim.auxFunc(...)",true},
     {"sim.setReferencedHandles",_simSetReferencedHandles,        "number result=sim.setReferencedHandles(number objectHandle,table referencedHandles)",true},
     {"sim.getReferencedHandles",_simGetReferencedHandles,        "table referencedHandles=sim.getReferencedHandles(number objectHandle)",true},
-    {"sim.getGraphCurve",_simGetGraphCurve,                      "string label,number curveType,table curveColor,table xData,table yData,table zData,table minMax=\nsim.getGraphCurve(number graphHandle,number graphType,number curveIndex)",true},
+    {"sim.getGraphCurve",_simGetGraphCurve,                      "string label,number curveType,table curveColor,table xData,table yData,table zData,table minMax=\nsim.getGraphCurve(number graphHandle,number graphType,number curveIndex,number firstPoint=0,number pointCount=-1)",true},
     {"sim.getGraphInfo",_simGetGraphInfo,                        "number bitCoded,table_3 bgColor,table_3 fgColor=sim.getGraphInfo(number graphHandle)",true},
     {"sim.getShapeViz",_simGetShapeViz,                          "map data=sim.getShapeViz(number shapeHandle,number itemIndex)",true},
     {"sim.executeScriptString",_simExecuteScriptString,          "number result,executionResult=sim.executeScriptString(string stringAtScriptName,number scriptHandleOrType)",true},
@@ -3295,7 +3295,7 @@ void getScriptChain(luaWrap_lua_State* L,bool selfIncluded,bool mainIncluded,std
     }
 }
 
-luaWrap_lua_State* initializeNewLuaState(const char* scriptSuffixNumberString,int debugLevel)
+luaWrap_lua_State* initializeNewLuaState(const char* scriptSuffixNumberString,int debugLevel,bool watchdogHook)
 {
     luaWrap_lua_State* L=luaWrap_luaL_newstate();
     luaWrap_luaL_openlibs(L);
@@ -3359,12 +3359,20 @@ luaWrap_lua_State* initializeNewLuaState(const char* scriptSuffixNumberString,in
 
     luaWrap_luaL_dostring(L,"__HIDDEN__.executeAfterLuaStateInit()"); // needed for various
 
+    setLuaHook(L,debugLevel,watchdogHook);
+
+    return(L);
+}
+
+void setLuaHook(luaWrap_lua_State* L,int debugLevel,bool watchdogHook)
+{ // the hook as armed when the Lua state is created
     int hookMask=luaWrapGet_LUA_MASKCOUNT();
     if (debugLevel>=sim_scriptdebug_allcalls)
         hookMask|=luaWrapGet_LUA_MASKCALL()|luaWrapGet_LUA_MASKRET();
-    luaWrap_lua_sethook(L,luaHookFunction,hookMask,100); // This instruction gets also called in luaHookFunction!!!!
-
-    return(L);
+    int hookCount=100;
+    if ( watchdogHook&&(debugLevel==sim_scriptdebug_none) )
+        hookCount=LUA_WATCHDOG_HOOK_COUNT;
+    luaWrap_lua_sethook(L,luaHookFunction,hookMask,hookCount); // This instruction gets also called in luaHookFunction!!!!
 }
 
 void registerTableFunction(luaWrap_lua_State* L,char const* const tableName,char const* const functionName,luaWrap_lua_CFunction functionCallback)
@@ -3383,42 +3391,134 @@ void registerTableFunction(luaWrap_lua_State* L,char const* const tableName,char
     luaWrap_lua_pop(L,1);
 }
 
-void registerNewLuaFunctions(luaWrap_lua_State* L)
-{
-    // V-REP API functions:
-    for (int i=0;simLuaCommands[i].name!="";i++)
+static void _registerLuaCommands(luaWrap_lua_State* L,const SLuaCommands* commands)
+{ // the sim table is kept on the stack, functions are directly set as fields (no lookup per function)
+    luaWrap_lua_getfield(L,luaWrapGet_LUA_GLOBALSINDEX(),"sim");
+    if (!luaWrap_lua_istable(L,-1))
+    { // we first need to create the table
+        luaWrap_lua_pop(L,1);
+        luaWrap_lua_createtable(L,0,1);
+        luaWrap_lua_pushvalue(L,-1);
+        luaWrap_lua_setfield(L,luaWrapGet_LUA_GLOBALSINDEX(),"sim");
+    }
+    for (int i=0;commands[i].name!="";i++)
     {
-        std::string name(simLuaCommands[i].name);
-        if (name.find("sim.")!=std::string::npos)
+        const std::string& name=commands[i].name;
+        if (name.compare(0,4,"sim.")==0)
         { // this is the new notation, e.g. sim.getObjectName()
-            name.erase(name.begin(),name.begin()+4);
-            registerTableFunction(L,"sim",name.c_str(),simLuaCommands[i].func);
+            luaWrap_lua_pushcfunction(L,commands[i].func);
+            luaWrap_lua_setfield(L,-2,name.c_str()+4);
         }
         else
-            luaWrap_lua_register(L,simLuaCommands[i].name.c_str(),simLuaCommands[i].func);
+            luaWrap_lua_register(L,name.c_str(),commands[i].func);
     }
+    luaWrap_lua_pop(L,1);
+}
+
+void registerNewLuaFunctions(luaWrap_lua_State* L)
+{
+    // V-REP API functions:
+    _registerLuaCommands(L,simLuaCommands);
     if (App::userSettings->getSupportOldApiNotation())
+        _registerLuaCommands(L,simLuaCommandsOldApi);
+    // Plugin API functions:
+    App::ct->luaCustomFuncAndVarContainer->registerCustomLuaFunctions(L,_simGenericFunctionHandler);
+}
+
+static void _handleLuaHookChecks(luaWrap_lua_State* L,CLuaScriptObject* it,int debugLevel)
+{ // emergency stop, forced script stop and automatic thread switches
+    int scriptType=it->getScriptType();
+    if ( (scriptType==sim_scripttype_mainscript)||(scriptType==sim_scripttype_childscript)||(scriptType==sim_scripttype_jointctrlcallback)||(scriptType==sim_scripttype_contactcallback) ) //||(scriptType==sim_scripttype_generalcallback) )
     {
-        for (int i=0;simLuaCommandsOldApi[i].name!="";i++)
+#ifdef SIM_WITH_GUI
+        if (App::userSettings->abortScriptExecutionButton!=0)
         {
-            std::string name(simLuaCommandsOldApi[i].name);
-            if (name.find("sim.")!=std::string::npos)
-            { // this is the new notation, e.g. sim.getObjectName()
-                name.erase(name.begin(),name.begin()+4);
-                registerTableFunction(L,"sim",name.c_str(),simLuaCommandsOldApi[i].func);
+            bool doIt=( (App::ct->luaScriptContainer->getMainScriptExecTimeInMs()>(App::userSettings->abortScriptExecutionButton*1000))&&App::ct->luaScriptContainer->getInMainScriptNow() );
+            if ( (App::mainWindow!=NULL)&&(App::mainWindow->openglWidget->getModelDragAndDropInfo()==NULL) )
+            { // Otherwise can get very slow somehow
+                App::ct->simulation->showAndHandleEmergencyStopButton(doIt,it->getShortDescriptiveName().c_str());
+            }
+        }
+
+        if ( CThreadPool::getSimulationEmergencyStop() ) // No automatic yield when flagged for destruction!! ||it->getFlaggedForDestruction() )
+        { // This is the only way a non-threaded script can yield. But threaded child scripts can also yield here
+            if (debugLevel!=sim_scriptdebug_none)
+                it->handleDebug("force_script_stop","C",true,true);
+            luaWrap_lua_yield(L,0);
+            return;
+        }
+        else
+        {
+            if (CThreadPool::getSimulationStopRequestedAndActivated())
+            { // returns true only after 1-2 seconds after the request arrived
+                if (!VThread::isCurrentThreadTheMainSimulationThread())
+                { // Here only threaded scripts can yield!
+                    if (debugLevel!=sim_scriptdebug_none)
+                        it->handleDebug("force_script_stop","C",true,true);
+                    luaWrap_lua_yield(L,0);
+                    return;
+                }
+            }
+        }
+#endif
+        if (!VThread::isCurrentThreadTheMainSimulationThread())
+        {
+            if (CThreadPool::isSwitchBackToPreviousThreadNeeded())
+            {
+                if (debugLevel!=sim_scriptdebug_none)
+                    it->handleDebug("thread_automatic_switch","C",true,true);
+                CThreadPool::switchBackToPreviousThreadIfNeeded();
+                if (debugLevel!=sim_scriptdebug_none)
+                    it->handleDebug("thread_automatic_switch","C",false,true);
             }
-            else
-                luaWrap_lua_register(L,simLuaCommandsOldApi[i].name.c_str(),simLuaCommandsOldApi[i].func);
         }
     }
-    // Plugin API functions:
-    App::ct->luaCustomFuncAndVarContainer->registerCustomLuaFunctions(L,_simGenericFunctionHandler);
+    else
+    { // non-simulation scripts (i.e. add-ons and customization scripts)
+#ifdef SIM_WITH_GUI
+        if (App::userSettings->abortScriptExecutionButton!=0)
+        {
+            if ( (App::mainWindow!=NULL)&&(App::mainWindow->openglWidget->getModelDragAndDropInfo()==NULL) )
+            { // Otherwise can get very slow somehow
+                if ( it->getScriptExecutionTimeInMs()>(App::userSettings->abortScriptExecutionButton*1000) )
+                {
+                    App::ct->simulation->showAndHandleEmergencyStopButton(true,it->getShortDescriptiveName().c_str());
+                    if (CLuaScriptObject::emergencyStopButtonPressed)
+                    {
+                        CLuaScriptObject::emergencyStopButtonPressed=false;
+                        if (it->getScriptType()==sim_scripttype_customizationscript)
+                            it->setCustomizationScriptIsTemporarilyDisabled(true); // stop it
+                        if (it->getScriptType()==sim_scripttype_addonscript)
+                            it->flagForDestruction(); // stop it
+                        if (debugLevel!=sim_scriptdebug_none)
+                            it->handleDebug("force_script_stop","C",true,true);
+                        luaWrap_lua_yield(L,0);
+                    }
+                }
+                else
+                    App::ct->simulation->showAndHandleEmergencyStopButton(false,"");
+            }
+        }
+#endif
+    }
 }
 
 void luaHookFunction(luaWrap_lua_State* L,luaWrap_lua_Debug* ar)
 {
     FUNCTION_DEBUG;
-    CLuaScriptObject* it=App::ct->luaScriptContainer->getScriptFromID_alsoAddOnsAndSandbox(getCurrentScriptID(L));
+    CLuaScriptObject* it=getScriptObjectFromLuaRegistry(L);
+    if ( (it!=NULL)&&it->getWatchdogHookEnabled()&&(it->getDebugLevel()==sim_scriptdebug_none) )
+    { // Watchdog mode: the hook is called less often, is not re-armed at each call, and the checks below
+      // are done only when the watchdog timer ticked since the last check. Debugging uses the regular path
+        if (it->isWatchdogCheckDue())
+        { // the random component (see further down) is applied here, i.e. about once per millisecond:
+            luaWrap_lua_sethook(L,luaHookFunction,luaWrapGet_LUA_MASKCOUNT(),it->getNextWatchdogHookCount());
+            _handleLuaHookChecks(L,it,sim_scriptdebug_none);
+        }
+        return;
+    }
+    if (it==NULL)
+        it=App::ct->luaScriptContainer->getScriptFromID_alsoAddOnsAndSandbox(getCurrentScriptID(L));
     if (it==NULL)
         return; // the script ID was not yet set
     int debugLevel=it->getDebugLevel();
@@ -3446,80 +3546,7 @@ void luaHookFunction(luaWrap_lua_State* L,luaWrap_lua_Debug* ar)
         luaWrap_lua_sethook(L,luaHookFunction,hookMask,95+randComponent);
         // Also remember: the hook gets also called when calling luaWrap_luaL_doString from c++ and similar!!
 
-        int scriptType=it->getScriptType();
-        if ( (scriptType==sim_scripttype_mainscript)||(scriptType==sim_scripttype_childscript)||(scriptType==sim_scripttype_jointctrlcallback)||(scriptType==sim_scripttype_contactcallback) ) //||(scriptType==sim_scripttype_generalcallback) )
-        {
-#ifdef SIM_WITH_GUI
-            if (App::userSettings->abortScriptExecutionButton!=0)
-            {
-                bool doIt=( (App::ct->luaScriptContainer->getMainScriptExecTimeInMs()>(App::userSettings->abortScriptExecutionButton*1000))&&App::ct->luaScriptContainer->getInMainScriptNow() );
-                if ( (App::mainWindow!=NULL)&&(App::mainWindow->openglWidget->getModelDragAndDropInfo()==NULL) )
-                { // Otherwise can get very slow somehow
-                    App::ct->simulation->showAndHandleEmergencyStopButton(doIt,it->getShortDescriptiveName().c_str());
-                }
-            }
-
-            if ( CThreadPool::getSimulationEmergencyStop() ) // No automatic yield when flagged for destruction!! ||it->getFlaggedForDestruction() )
-            { // This is the only way a non-threaded script can yield. But threaded child scripts can also yield here
-                if (debugLevel!=sim_scriptdebug_none)
-                    it->handleDebug("force_script_stop","C",true,true);
-                luaWrap_lua_yield(L,0);
-                return;
-            }
-            else
-            {
-                if (CThreadPool::getSimulationStopRequestedAndActivated())
-                { // returns true only after 1-2 seconds after the request arrived
-                    if (!VThread::isCurrentThreadTheMainSimulationThread())
-                    { // Here only threaded scripts can yield!
-                        if (debugLevel!=sim_scriptdebug_none)
-                            it->handleDebug("force_script_stop","C",true,true);
-                        luaWrap_lua_yield(L,0);
-                        return;
-                    }
-                }
-            }
-#endif
-            if (!VThread::isCurrentThreadTheMainSimulationThread())
-            {
-                if (CThreadPool::isSwitchBackToPreviousThreadNeeded())
-                {
-                    if (debugLevel!=sim_scriptdebug_none)
-                        it->handleDebug("thread_automatic_switch","C",true,true);
-                    CThreadPool::switchBackToPreviousThreadIfNeeded();
-                    if (debugLevel!=sim_scriptdebug_none)
-                        it->handleDebug("thread_automatic_switch","C",false,true);
-                }
-            }
-        }
-        else
-        { // non-simulation scripts (i.e. add-ons and customization scripts)
-#ifdef SIM_WITH_GUI
-            if (App::userSettings->abortScriptExecutionButton!=0)
-            {
-                if ( (App::mainWindow!=NULL)&&(App::mainWindow->openglWidget->getModelDragAndDropInfo()==NULL) )
-                { // Otherwise can get very slow somehow
-                    if ( it->getScriptExecutionTimeInMs()>(App::userSettings->abortScriptExecutionButton*1000) )
-                    {
-                        App::ct->simulation->showAndHandleEmergencyStopButton(true,it->getShortDescriptiveName().c_str());
-                        if (CLuaScriptObject::emergencyStopButtonPressed)
-                        {
-                            CLuaScriptObject::emergencyStopButtonPressed=false;
-                            if (it->getScriptType()==sim_scripttype_customizationscript)
-                                it->setCustomizationScriptIsTemporarilyDisabled(true); // stop it
-                            if (it->getScriptType()==sim_scripttype_addonscript)
-                                it->flagForDestruction(); // stop it
-                            if (debugLevel!=sim_scriptdebug_none)
-                                it->handleDebug("force_script_stop","C",true,true);
-                            luaWrap_lua_yield(L,0);
-                        }
-                    }
-                    else
-                        App::ct->simulation->showAndHandleEmergencyStopButton(false,"");
-                }
-            }
-#endif
-        }
+        _handleLuaHookChecks(L,it,debugLevel);
     }
 }
 
@@ -3542,9 +3569,59 @@ void prepareNewLuaVariables_noRequire(luaWrap_lua_State* L)
 
 void setNewLuaVariable(luaWrap_lua_State* L,const char* name,int identifier)
 {
-    std::string tmp(name);
-    tmp+="="+boost::lexical_cast<std::string>(identifier);
-    luaWrap_luaL_dostring(L,tmp.c_str());
+    luaWrap_lua_pushinteger(L,identifier);
+    assignLuaVariableFromStack(L,name);
+}
+
+void assignLuaVariableFromStack(luaWrap_lua_State* L,const char* name)
+{ // Pops the value on top of the stack and assigns it to name, e.g. "sim_x" or "sim.x", without compiling
+  // a Lua snippet. A missing table is created. Names with more than one dot go through Lua
+    const char* dot=strchr(name,'.');
+    if (dot==NULL)
+        luaWrap_lua_setglobal(L,name);
+    else if (strchr(dot+1,'.')==NULL)
+    {
+        std::string tableName(name,dot);
+        luaWrap_lua_getfield(L,luaWrapGet_LUA_GLOBALSINDEX(),tableName.c_str());
+        if (!luaWrap_lua_istable(L,-1))
+        {
+            luaWrap_lua_pop(L,1);
+            luaWrap_lua_newtable(L);
+            luaWrap_lua_pushvalue(L,-1);
+            luaWrap_lua_setfield(L,luaWrapGet_LUA_GLOBALSINDEX(),tableName.c_str());
+        }
+        luaWrap_lua_insert(L,-2); // table below value
+        luaWrap_lua_setfield(L,-2,dot+1);
+        luaWrap_lua_pop(L,1);
+    }
+    else
+    {
+        luaWrap_lua_setfield(L,luaWrapGet_LUA_GLOBALSINDEX(),"__iuafkjsdgoi158zLK");
+        std::string tmp(name);
+        tmp+="=__iuafkjsdgoi158zLK __iuafkjsdgoi158zLK=nil";
+        luaWrap_luaL_dostring(L,tmp.c_str());
+    }
+}
+
+void setScriptObjectInLuaRegistry(luaWrap_lua_State* L,CLuaScriptObject* script)
+{ // allows the hook function to find the script without lookup
+    if (luaWrap_isRegistryAccessAvailable())
+    {
+        luaWrap_lua_pushlightuserdata(L,script);
+        luaWrap_lua_setfield(L,luaWrapGet_LUA_REGISTRYINDEX(),"vrep_scriptObject");
+    }
+}
+
+CLuaScriptObject* getScriptObjectFromLuaRegistry(luaWrap_lua_State* L)
+{ // returns NULL if not set
+    CLuaScriptObject* retVal=NULL;
+    if (luaWrap_isRegistryAccessAvailable())
+    {
+        luaWrap_lua_getfield(L,luaWrapGet_LUA_REGISTRYINDEX(),"vrep_scriptObject");
+        retVal=(CLuaScriptObject*)luaWrap_lua_touserdata(L,-1);
+        luaWrap_lua_pop(L,1);
+    }
+    return(retVal);
 }
 
 int getCurrentScriptID(luaWrap_lua_State* L)
@@ -11358,13 +11435,11 @@ int _simGetStringSignal(luaWrap_lua_State* L)
     LUA_START("sim.getStringSignal");
 
     if (checkInputArguments(L,&errorString,lua_arg_string,0))
-    {
-        int stringLength;
-        char* str=simGetStringSignal_internal(std::string(luaWrap_lua_tostring(L,1)).c_str(),&stringLength);
+    { // the value is pushed directly from the signal container (no intermediate buffer)
+        const std::string* str=App::ct->signalContainer->getStringSignalPointer(std::string(luaWrap_lua_tostring(L,1)).c_str());
         if (str!=NULL)
         {
-            luaWrap_lua_pushlstring(L,str,stringLength);
-            simReleaseBuffer_internal(str);
+            luaWrap_lua_pushlstring(L,str->c_str(),str->length());
             LUA_END(1);
         }
     }
@@ -11448,10 +11523,12 @@ int _simWaitForSignal(luaWrap_lua_State* L)
                     signalPresent=true;
                     LUA_END(1);
                 }
-                std::string strVal;
-                if ( (!signalPresent)&&(sigCont->getStringSignal(signalName.c_str(),strVal)) )
+                const std::string* strVal=NULL;
+                if (!signalPresent)
+                    strVal=sigCont->getStringSignalPointer(signalName.c_str());
+                if (strVal!=NULL)
                 {
-                    luaWrap_lua_pushstring(L,strVal.c_str());
+                    luaWrap_lua_pushstring(L,strVal->c_str());
                     signalPresent=true;
                     LUA_END(1);
                 }
@@ -17451,58 +17528,72 @@ int _simGetGraphCurve(luaWrap_lua_State* L)
         int graphHandle=(luaWrap_lua_tointeger(L,1));
         int graphType=(luaWrap_lua_tointeger(L,2));
         int index=(luaWrap_lua_tointeger(L,3));
-        CGraph* graph=App::ct->objCont->getGraph(graphHandle);
-        if (graph!=NULL)
+        int firstPoint=0;
+        int pointCount=-1;
+        int res=checkOneGeneralInputArgument(L,4,lua_arg_number,0,true,false,&errorString);
+        if (res==2)
+            firstPoint=luaToInt(L,4);
+        if (res>=0)
         {
-            std::vector<float> xVals;
-            std::vector<float> yVals;
-            std::vector<float> zVals;
-            std::string label;
-            int curveType;
-            float col[3];
-            float minMax[6];
-            if (graph->getGraphCurve(graphType,index,label,xVals,yVals,zVals,curveType,col,minMax))
+            res=checkOneGeneralInputArgument(L,5,lua_arg_number,0,true,false,&errorString);
+            if (res==2)
+                pointCount=luaToInt(L,5);
+        }
+        if (res>=0)
+        {
+            CGraph* graph=App::ct->objCont->getGraph(graphHandle);
+            if (graph!=NULL)
             {
-                luaWrap_lua_pushstring(L,label.c_str());
-                luaWrap_lua_pushnumber(L,curveType);
-                pushFloatTableOntoStack(L,3,col);
-                if (xVals.size()>0)
-                    pushFloatTableOntoStack(L,(int)xVals.size(),&xVals[0]);
-                else
-                    pushFloatTableOntoStack(L,0,NULL);
-                if (yVals.size()>0)
-                    pushFloatTableOntoStack(L,(int)yVals.size(),&yVals[0]);
-                else
-                    pushFloatTableOntoStack(L,0,NULL);
-                if (graphType==2)
+                std::vector<float> xVals;
+                std::vector<float> yVals;
+                std::vector<float> zVals;
+                std::string label;
+                int curveType;
+                float col[3];
+                float minMax[6];
+                if (graph->getGraphCurve(graphType,index,label,xVals,yVals,zVals,curveType,col,minMax,firstPoint,pointCount))
                 {
-                    if (zVals.size()>0)
-                        pushFloatTableOntoStack(L,(int)zVals.size(),&zVals[0]);
+                    luaWrap_lua_pushstring(L,label.c_str());
+                    luaWrap_lua_pushnumber(L,curveType);
+                    pushFloatTableOntoStack(L,3,col);
+                    if (xVals.size()>0)
+                        pushFloatTableOntoStack(L,(int)xVals.size(),&xVals[0]);
                     else
                         pushFloatTableOntoStack(L,0,NULL);
-                    if (xVals.size()>0)
+                    if (yVals.size()>0)
+                        pushFloatTableOntoStack(L,(int)yVals.size(),&yVals[0]);
+                    else
+                        pushFloatTableOntoStack(L,0,NULL);
+                    if (graphType==2)
                     {
-                        pushFloatTableOntoStack(L,6,minMax);
-                        LUA_END(7);
+                        if (zVals.size()>0)
+                            pushFloatTableOntoStack(L,(int)zVals.size(),&zVals[0]);
+                        else
+                            pushFloatTableOntoStack(L,0,NULL);
+                        if (xVals.size()>0)
+                        {
+                            pushFloatTableOntoStack(L,6,minMax);
+                            LUA_END(7);
+                        }
+                        LUA_END(6);
                     }
-                    LUA_END(6);
-                }
-                else
-                {
-                    if (xVals.size()>0)
+                    else
                     {
-                        pushFloatTableOntoStack(L,4,minMax);
-                        LUA_END(6);
+                        if (xVals.size()>0)
+                        {
+                            pushFloatTableOntoStack(L,4,minMax);
+                            LUA_END(6);
+                        }
+                        LUA_END(5);
                     }
-                    LUA_END(5);
+                }
+                else
+                { // this should not generate an error!
                 }
             }
             else
-            { // this should not generate an error!
-            }
+                errorString=SIM_ERROR_OBJECT_NOT_GRAPH;
         }
-        else
-            errorString=SIM_ERROR_OBJECT_NOT_GRAPH;
     }
     LUA_SET_OR_RAISE_ERROR(); // we might never return from this!
     LUA_END(0);
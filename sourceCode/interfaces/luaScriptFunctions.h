@@ -12,6 +12,8 @@ class CLuaScriptObject;
 class CInterfaceStack;
 class CLuaCustomFunction;
 
+#define LUA_WATCHDOG_HOOK_COUNT 1000 // instructions between two watchdog hook calls (approx.)
+
 enum {lua_arg_empty,lua_arg_nil,lua_arg_number,lua_arg_bool,lua_arg_string,lua_arg_function,lua_arg_userdata,lua_arg_table};
 
 struct SLuaCommands
@@ -30,12 +32,14 @@ struct SLuaVariables
 };
 
 
-luaWrap_lua_State* initializeNewLuaState(const char* scriptSuffixNumberString,int debugLevel);
+luaWrap_lua_State* initializeNewLuaState(const char* scriptSuffixNumberString,int debugLevel,bool watchdogHook);
+void setLuaHook(luaWrap_lua_State* L,int debugLevel,bool watchdogHook);
 void registerTableFunction(luaWrap_lua_State* L,char const* const tableName,char const* const functionName,luaWrap_lua_CFunction functionCallback);
 void registerNewLuaFunctions(luaWrap_lua_State* L);
 void prepareNewLuaVariables_onlyRequire(luaWrap_lua_State* L);
 void prepareNewLuaVariables_noRequire(luaWrap_lua_State* L);
 void setNewLuaVariable(luaWrap_lua_State* L,const char* name,int identifier);
+void assignLuaVariableFromStack(luaWrap_lua_State* L,const char* name);
 
 void pushCorrectTypeOntoLuaStack(luaWrap_lua_State* L,const std::string& txt);
 int getCorrectType(const std::string& txt);
@@ -82,6 +86,8 @@ bool luaToBool(luaWrap_lua_State* L,int pos);
 bool isDashFree(const std::string& functionName,const std::string& name);
 bool suffixAdjustStringIfNeeded(const std::string& functionName,bool outputError,luaWrap_lua_State* L,std::string& name);
 int getCurrentScriptID(luaWrap_lua_State* L);
+void setScriptObjectInLuaRegistry(luaWrap_lua_State* L,CLuaScriptObject* script);
+CLuaScriptObject* getScriptObjectFromLuaRegistry(luaWrap_lua_State* L);
 
 void getScriptTree_mainOr(luaWrap_lua_State* L,bool selfIncluded,std::vector<int>& scriptHandles);
 void getScriptChain(luaWrap_lua_State* L,bool selfIncluded,bool mainIncluded,std::vector<int>& scriptHandles);
@@ -1131,6 +1131,22 @@ VREP_DLLEXPORT simUChar* simGetVisionSensorCharImage(simInt visionSensorHandle,s
 {
     return(simGetVisionSensorCharImage_internal(visionSensorHandle,resolutionX,resolutionY));
 }
+VREP_DLLEXPORT const simUChar* simGetVisionSensorCharImageView(simInt visionSensorHandle,simInt* resolutionX,simInt* resolutionY)
+{
+    return(simGetVisionSensorCharImageView_internal(visionSensorHandle,resolutionX,resolutionY));
+}
+VREP_DLLEXPORT const simFloat* simGetVisionSensorDepthBufferView(simInt visionSensorHandle,simInt* resolutionX,simInt* resolutionY)
+{
+    return(simGetVisionSensorDepthBufferView_internal(visionSensorHandle,resolutionX,resolutionY));
+}
+VREP_DLLEXPORT simInt simGetVisionSensorImagePortion(simInt visionSensorHandle,simInt posX,simInt posY,simInt sizeX,simInt sizeY,simFloat* buffer)
+{
+    return(simGetVisionSensorImagePortion_internal(visionSensorHandle,posX,posY,sizeX,sizeY,buffer));
+}
+VREP_DLLEXPORT simInt simGetVisionSensorCharImagePortion(simInt visionSensorHandle,simInt posX,simInt posY,simInt sizeX,simInt sizeY,simUChar* buffer)
+{
+    return(simGetVisionSensorCharImagePortion_internal(visionSensorHandle,posX,posY,sizeX,sizeY,buffer));
+}
 VREP_DLLEXPORT simInt simSetVisionSensorImage(simInt visionSensorHandle,const simFloat* image)
 {
     return(simSetVisionSensorImage_internal(visionSensorHandle,image));
@@ -1534,6 +1550,22 @@ VREP_DLLEXPORT simInt simGetStackDoubleTable(simInt stackHandle,simDouble* array
 {
     return(simGetStackDoubleTable_internal(stackHandle,array,count));
 }
+VREP_DLLEXPORT const simUChar* simGetStackUInt8TableView(simInt stackHandle,simInt* count)
+{
+    return(simGetStackUInt8TableView_internal(stackHandle,count));
+}
+VREP_DLLEXPORT const simInt* simGetStackInt32TableView(simInt stackHandle,simInt* count)
+{
+    return(simGetStackInt32TableView_internal(stackHandle,count));
+}
+VREP_DLLEXPORT const simFloat* simGetStackFloatTableView(simInt stackHandle,simInt* count)
+{
+    return(simGetStackFloatTableView_internal(stackHandle,count));
+}
+VREP_DLLEXPORT const simDouble* simGetStackDoubleTableView(simInt stackHandle,simInt* count)
+{
+    return(simGetStackDoubleTableView_internal(stackHandle,count));
+}
 VREP_DLLEXPORT simInt simUnfoldStackTable(simInt stackHandle)
 {
     return(simUnfoldStackTable_internal(stackHandle));
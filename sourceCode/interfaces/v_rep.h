@@ -299,6 +299,10 @@ VREP_DLLEXPORT simFloat* simCheckVisionSensorEx(simInt visionSensorHandle,simInt
 VREP_DLLEXPORT simInt simGetVisionSensorResolution(simInt visionSensorHandle,simInt* resolution);
 VREP_DLLEXPORT simFloat* simGetVisionSensorImage(simInt visionSensorHandle);
 VREP_DLLEXPORT simUChar* simGetVisionSensorCharImage(simInt visionSensorHandle,simInt* resolutionX,simInt* resolutionY);
+VREP_DLLEXPORT const simUChar* simGetVisionSensorCharImageView(simInt visionSensorHandle,simInt* resolutionX,simInt* resolutionY);
+VREP_DLLEXPORT const simFloat* simGetVisionSensorDepthBufferView(simInt visionSensorHandle,simInt* resolutionX,simInt* resolutionY);
+VREP_DLLEXPORT simInt simGetVisionSensorImagePortion(simInt visionSensorHandle,simInt posX,simInt posY,simInt sizeX,simInt sizeY,simFloat* buffer);
+VREP_DLLEXPORT simInt simGetVisionSensorCharImagePortion(simInt visionSensorHandle,simInt posX,simInt posY,simInt sizeX,simInt sizeY,simUChar* buffer);
 VREP_DLLEXPORT simInt simSetVisionSensorImage(simInt visionSensorHandle,const simFloat* image);
 VREP_DLLEXPORT simInt simSetVisionSensorCharImage(simInt visionSensorHandle,const simUChar* image);
 VREP_DLLEXPORT simFloat* simGetVisionSensorDepthBuffer(simInt visionSensorHandle);
@@ -399,6 +403,10 @@ VREP_DLLEXPORT simInt simGetStackUInt8Table(simInt stackHandle,simUChar* array,s
 VREP_DLLEXPORT simInt simGetStackInt32Table(simInt stackHandle,simInt* array,simInt count);
 VREP_DLLEXPORT simInt simGetStackFloatTable(simInt stackHandle,simFloat* array,simInt count);
 VREP_DLLEXPORT simInt simGetStackDoubleTable(simInt stackHandle,simDouble* array,simInt count);
+VREP_DLLEXPORT const simUChar* simGetStackUInt8TableView(simInt stackHandle,simInt* count);
+VREP_DLLEXPORT const simInt* simGetStackInt32TableView(simInt stackHandle,simInt* count);
+VREP_DLLEXPORT const simFloat* simGetStackFloatTableView(simInt stackHandle,simInt* count);
+VREP_DLLEXPORT const simDouble* simGetStackDoubleTableView(simInt stackHandle,simInt* count);
 VREP_DLLEXPORT simInt simUnfoldStackTable(simInt stackHandle);
 VREP_DLLEXPORT simInt simDebugStack(simInt stackHandle,simInt cIndex);
 VREP_DLLEXPORT simInt simSetScriptVariable(simInt scriptHandleOrType,const simChar* variableNameAtScriptName,simInt stackHandle);
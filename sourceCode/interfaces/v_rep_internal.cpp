@@ -13,6 +13,7 @@
 #include "graphingRoutines.h"
 #include "sceneObjectOperations.h"
 #include "threadPool.h"
+#include "workerPool.h"
 #include "dxfFile.h"
 #include "objFile.h"
 #include "stlFile.h"
@@ -633,6 +634,8 @@ simInt simRunSimulator_internal(const simChar* applicationName,simInt options,si
     printf(".");
     handleVerSpecRunSimulator5();
     printf(".");
+    CWorkerPool::cleanUp();
+    CLuaScriptObject::stopWatchdogTimer();
     CThreadPool::cleanUp();
     printf("done.\n");
     return(1);
@@ -4833,24 +4836,26 @@ simInt simHandleProximitySensor_internal(simInt sensorHandle,simFloat* detectedP
             int detectedObjectID=-1;
             C3Vector detectedSurfaceNormal;
             float allSmallestL=SIM_MAX_FLOAT;
+            std::vector<CProxSensor*> sensors;
             for (int i=0;i<int(App::ct->objCont->proximitySensorList.size());i++)
-            {
-                int detectedObj;
-                C3Vector detectedSurf;
-                CProxSensor* it=(CProxSensor*)App::ct->objCont->getObject(App::ct->objCont->proximitySensorList[i]);
-                bool detected=false;
-                detected=it->handleSensor(sensorHandle==sim_handle_all_except_explicit,detectedObj,detectedSurf);
-                if (detected)
+                sensors.push_back((CProxSensor*)App::ct->objCont->getObject(App::ct->objCont->proximitySensorList[i]));
+            std::vector<char> detected;
+            std::vector<int> detectedObjs;
+            std::vector<C3Vector> detectedSurfs;
+            CProxSensorRoutine::handleSensors(sensors,sensorHandle==sim_handle_all_except_explicit,detected,detectedObjs,detectedSurfs);
+            for (size_t i=0;i<sensors.size();i++)
+            {
+                if (detected[i]!=0)
                 {
-                    C3Vector smallest(it->getDetectedPoint());
+                    C3Vector smallest(sensors[i]->getDetectedPoint());
                     float smallestL=smallest.getLength();
 
                     if (smallestL<allSmallestL)
                     {
                         allSmallest=smallest;
                         allSmallestL=smallestL;
-                        detectedObjectID=detectedObj;
-                        detectedSurfaceNormal=detectedSurf;
+                        detectedObjectID=detectedObjs[i];
+                        detectedSurfaceNormal=detectedSurfs[i];
                         retVal=1;
                     }
                 }
@@ -7920,14 +7925,13 @@ simChar* simGetStringSignal_internal(const simChar* signalName,simInt* stringLen
 
     IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA
     {
-        std::string sigVal;
-
-        if (App::ct->signalContainer->getStringSignal(signalName,sigVal))
+        const std::string* sigVal=App::ct->signalContainer->getStringSignalPointer(signalName);
+        if (sigVal!=NULL)
         {
-            char* retVal=new char[sigVal.length()];
-            for (unsigned int i=0;i<sigVal.length();i++)
-                retVal[i]=sigVal[i];
-            stringLength[0]=(int)sigVal.length();
+            char* retVal=new char[sigVal->length()];
+            if (sigVal->length()>0)
+                memcpy(retVal,sigVal->data(),sigVal->length());
+            stringLength[0]=(int)sigVal->length();
             return(retVal);
         }
 
@@ -12520,6 +12524,7 @@ simInt simHandleVisionSensor_internal(simInt visionSensorHandle,simFloat** auxVa
         if (auxValuesCount!=NULL)
             auxValuesCount[0]=NULL;
         int retVal=0;
+        std::vector<CVisionSensor*> toHandle;
         for (int i=0;i<int(App::ct->objCont->visionSensorList.size());i++)
         {
             CVisionSensor* it=(CVisionSensor*)App::ct->objCont->getObject(App::ct->objCont->visionSensorList[i]);
@@ -12552,11 +12557,20 @@ simInt simHandleVisionSensor_internal(simInt visionSensorHandle,simFloat** auxVa
             else
             {
                 if ( (!it->getExplicitHandling())||(visionSensorHandle==sim_handle_all) )
-                    retVal+=it->handleSensor();
+                    toHandle.push_back(it);
             }
             if (visionSensorHandle>=0)
                 break;
         }
+        // All sensors are rendered first, then the images are fetched. With asynchronous readback, no
+        // image is waited for before all sensors were rendered:
+        for (size_t i=0;i<toHandle.size();i++)
+            toHandle[i]->startSensorHandling(App::userSettings->visionSensorsAsyncReadback);
+        for (size_t i=0;i<toHandle.size();i++)
+        {
+            if (toHandle[i]->finishSensorHandling())
+                retVal++;
+        }
         return(retVal);
     }
     CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
@@ -12801,22 +12815,10 @@ simFloat* simGetVisionSensorImage_internal(simInt sensorHandle)
         if ((handleFlags&sim_handleflag_greyscale)!=0)
             valPerPixel=1;
         float* buff=new float[res[0]*res[1]*valPerPixel];
-        unsigned char* imgBuff=it->getRgbBufferPointer();
+        int rgbOrGrey=0;
         if ((handleFlags&sim_handleflag_greyscale)!=0)
-        {
-            for (int i=0;i<res[0]*res[1];i++)
-            {
-                float v=float(imgBuff[3*i+0])/255.0f;
-                v+=float(imgBuff[3*i+1])/255.0f;
-                v+=float(imgBuff[3*i+2])/255.0f;
-                buff[i]=v/3.0f;
-            }
-        }
-        else
-        {
-            for (int i=0;i<res[0]*res[1]*3;i++)
-                buff[i]=float(imgBuff[i])/255.0f;
-        }
+            rgbOrGrey=1;
+        it->readPortionOfImage(0,0,res[0],res[1],rgbOrGrey,buff);
         return(buff);
     }
     CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
@@ -12880,6 +12882,115 @@ simUChar* simGetVisionSensorCharImage_internal(simInt sensorHandle,simInt* resol
     return(NULL);
 }
 
+const simUChar* simGetVisionSensorCharImageView_internal(simInt sensorHandle,simInt* resolutionX,simInt* resolutionY)
+{ // Returns the sensor's own RGB buffer, without copy. Valid until the sensor is handled, reset or resized. Do not release it
+    C_API_FUNCTION_DEBUG;
+
+    if (!isSimulatorInitialized(__func__))
+        return(NULL);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA
+    {
+        if (!doesObjectExist(__func__,sensorHandle))
+            return(NULL);
+        if (!isVisionSensor(__func__,sensorHandle))
+            return(NULL);
+        CVisionSensor* it=App::ct->objCont->getVisionSensor(sensorHandle);
+        int res[2];
+        it->getRealResolution(res);
+        if (resolutionX!=NULL)
+            resolutionX[0]=res[0];
+        if (resolutionY!=NULL)
+            resolutionY[0]=res[1];
+        return(it->getRgbBufferPointer());
+    }
+    CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
+    return(NULL);
+}
+
+const simFloat* simGetVisionSensorDepthBufferView_internal(simInt sensorHandle,simInt* resolutionX,simInt* resolutionY)
+{ // Returns the sensor's own depth buffer (0=close clipping plane, 1=far clipping plane), without copy. Same validity as above
+    C_API_FUNCTION_DEBUG;
+
+    if (!isSimulatorInitialized(__func__))
+        return(NULL);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA
+    {
+        if (!doesObjectExist(__func__,sensorHandle))
+            return(NULL);
+        if (!isVisionSensor(__func__,sensorHandle))
+            return(NULL);
+        CVisionSensor* it=App::ct->objCont->getVisionSensor(sensorHandle);
+        int res[2];
+        it->getRealResolution(res);
+        if (resolutionX!=NULL)
+            resolutionX[0]=res[0];
+        if (resolutionY!=NULL)
+            resolutionY[0]=res[1];
+        return(it->getDepthBufferPointer());
+    }
+    CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
+    return(NULL);
+}
+
+simInt simGetVisionSensorImagePortion_internal(simInt sensorHandle,simInt posX,simInt posY,simInt sizeX,simInt sizeY,simFloat* buffer)
+{ // Fills a buffer provided by the caller, so that it can be reused from one call to the next
+    C_API_FUNCTION_DEBUG;
+
+    if (!isSimulatorInitialized(__func__))
+        return(-1);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA
+    {
+        int handleFlags=sensorHandle&0xff00000;
+        sensorHandle=sensorHandle&0xfffff;
+        if (!doesObjectExist(__func__,sensorHandle))
+            return(-1);
+        if (!isVisionSensor(__func__,sensorHandle))
+            return(-1);
+        CVisionSensor* it=App::ct->objCont->getVisionSensor(sensorHandle);
+        int rgbOrGrey=0;
+        if ((handleFlags&sim_handleflag_greyscale)!=0)
+            rgbOrGrey=1;
+        if ( (buffer==NULL)||(!it->readPortionOfImage(posX,posY,sizeX,sizeY,rgbOrGrey,buffer)) )
+        {
+            CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_INVALID_ARGUMENTS);
+            return(-1);
+        }
+        return(1);
+    }
+    CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
+    return(-1);
+}
+
+simInt simGetVisionSensorCharImagePortion_internal(simInt sensorHandle,simInt posX,simInt posY,simInt sizeX,simInt sizeY,simUChar* buffer)
+{ // Fills a buffer provided by the caller, so that it can be reused from one call to the next
+    C_API_FUNCTION_DEBUG;
+
+    if (!isSimulatorInitialized(__func__))
+        return(-1);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA
+    {
+        int handleFlags=sensorHandle&0xff00000;
+        sensorHandle=sensorHandle&0xfffff;
+        if (!doesObjectExist(__func__,sensorHandle))
+            return(-1);
+        if (!isVisionSensor(__func__,sensorHandle))
+            return(-1);
+        CVisionSensor* it=App::ct->objCont->getVisionSensor(sensorHandle);
+        if ( (buffer==NULL)||(!it->readPortionOfCharImage(posX,posY,sizeX,sizeY,0.0f,(handleFlags&sim_handleflag_greyscale)!=0,buffer)) )
+        {
+            CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_INVALID_ARGUMENTS);
+            return(-1);
+        }
+        return(1);
+    }
+    CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
+    return(-1);
+}
+
 simInt simSetVisionSensorImage_internal(simInt sensorHandle,const simFloat* image)
 {
     C_API_FUNCTION_DEBUG;
@@ -17079,6 +17190,131 @@ simInt simGetStackDoubleTable_internal(simInt stackHandle,simDouble* array,simIn
     return(-1);
 }
 
+const simUChar* simGetStackUInt8TableView_internal(simInt stackHandle,simInt* count)
+{ // Returns the table items without copy, or NULL if the top item is not a table stored contiguously in that format.
+  // Valid until the stack is modified
+    C_API_FUNCTION_DEBUG;
+
+    if (!isSimulatorInitialized(__func__))
+        return(NULL);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA
+    {
+        CInterfaceStack* stack=App::ct->interfaceStackContainer->getStack(stackHandle);
+        if (stack!=NULL)
+        {
+            if (stack->getStackSize()>0)
+            {
+                int cnt=0;
+                const simUChar* retVal=(const simUChar*)stack->getStackUCharArrayPtr(cnt);
+                if ( (retVal!=NULL)&&(count!=NULL) )
+                    count[0]=cnt;
+                return(retVal);
+            }
+            CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_INVALID_STACK_CONTENT);
+            return(NULL);
+        }
+        CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_INVALID_HANDLE);
+        return(NULL);
+    }
+
+    CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
+    return(NULL);
+}
+
+const simInt* simGetStackInt32TableView_internal(simInt stackHandle,simInt* count)
+{ // see simGetStackUInt8TableView_internal
+    C_API_FUNCTION_DEBUG;
+
+    if (!isSimulatorInitialized(__func__))
+        return(NULL);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA
+    {
+        CInterfaceStack* stack=App::ct->interfaceStackContainer->getStack(stackHandle);
+        if (stack!=NULL)
+        {
+            if (stack->getStackSize()>0)
+            {
+                int cnt=0;
+                const simInt* retVal=(const simInt*)stack->getStackIntArrayPtr(cnt);
+                if ( (retVal!=NULL)&&(count!=NULL) )
+                    count[0]=cnt;
+                return(retVal);
+            }
+            CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_INVALID_STACK_CONTENT);
+            return(NULL);
+        }
+        CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_INVALID_HANDLE);
+        return(NULL);
+    }
+
+    CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
+    return(NULL);
+}
+
+const simFloat* simGetStackFloatTableView_internal(simInt stackHandle,simInt* count)
+{ // see simGetStackUInt8TableView_internal
+    C_API_FUNCTION_DEBUG;
+
+    if (!isSimulatorInitialized(__func__))
+        return(NULL);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA
+    {
+        CInterfaceStack* stack=App::ct->interfaceStackContainer->getStack(stackHandle);
+        if (stack!=NULL)
+        {
+            if (stack->getStackSize()>0)
+            {
+                int cnt=0;
+                const simFloat* retVal=(const simFloat*)stack->getStackFloatArrayPtr(cnt);
+                if ( (retVal!=NULL)&&(count!=NULL) )
+                    count[0]=cnt;
+                return(retVal);
+            }
+            CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_INVALID_STACK_CONTENT);
+            return(NULL);
+        }
+        CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_INVALID_HANDLE);
+        return(NULL);
+    }
+
+    CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
+    return(NULL);
+}
+
+const simDouble* simGetStackDoubleTableView_internal(simInt stackHandle,simInt* count)
+{ // see simGetStackUInt8TableView_internal
+    C_API_FUNCTION_DEBUG;
+
+    if (!isSimulatorInitialized(__func__))
+        return(NULL);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA
+    {
+        CInterfaceStack* stack=App::ct->interfaceStackContainer->getStack(stackHandle);
+        if (stack!=NULL)
+        {
+            if (stack->getStackSize()>0)
+            {
+                int cnt=0;
+                const simDouble* retVal=(const simDouble*)stack->getStackDoubleArrayPtr(cnt);
+                if ( (retVal!=NULL)&&(count!=NULL) )
+                    count[0]=cnt;
+                return(retVal);
+            }
+            CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_INVALID_STACK_CONTENT);
+            return(NULL);
+        }
+        CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_INVALID_HANDLE);
+        return(NULL);
+    }
+
+    CApiErrors::setApiCallErrorMessage(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
+    return(NULL);
+}
+
 simInt simUnfoldStackTable_internal(simInt stackHandle)
 {
     C_API_FUNCTION_DEBUG;
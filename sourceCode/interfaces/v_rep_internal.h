@@ -289,6 +289,10 @@ simFloat* simCheckVisionSensorEx_internal(simInt visionSensorHandle,simInt entit
 simInt simGetVisionSensorResolution_internal(simInt visionSensorHandle,simInt* resolution);
 simFloat* simGetVisionSensorImage_internal(simInt visionSensorHandle);
 simUChar* simGetVisionSensorCharImage_internal(simInt visionSensorHandle,simInt* resolutionX,simInt* resolutionY);
+const simUChar* simGetVisionSensorCharImageView_internal(simInt visionSensorHandle,simInt* resolutionX,simInt* resolutionY);
+const simFloat* simGetVisionSensorDepthBufferView_internal(simInt visionSensorHandle,simInt* resolutionX,simInt* resolutionY);
+simInt simGetVisionSensorImagePortion_internal(simInt visionSensorHandle,simInt posX,simInt posY,simInt sizeX,simInt sizeY,simFloat* buffer);
+simInt simGetVisionSensorCharImagePortion_internal(simInt visionSensorHandle,simInt posX,simInt posY,simInt sizeX,simInt sizeY,simUChar* buffer);
 simInt simSetVisionSensorImage_internal(simInt visionSensorHandle,const simFloat* image);
 simInt simSetVisionSensorCharImage_internal(simInt visionSensorHandle,const simUChar* image);
 simFloat* simGetVisionSensorDepthBuffer_internal(simInt visionSensorHandle);
@@ -389,6 +393,10 @@ simInt simGetStackUInt8Table_internal(simInt stackHandle,simUChar* array,simInt
 simInt simGetStackInt32Table_internal(simInt stackHandle,simInt* array,simInt count);
 simInt simGetStackFloatTable_internal(simInt stackHandle,simFloat* array,simInt count);
 simInt simGetStackDoubleTable_internal(simInt stackHandle,simDouble* array,simInt count);
+const simUChar* simGetStackUInt8TableView_internal(simInt stackHandle,simInt* count);
+const simInt* simGetStackInt32TableView_internal(simInt stackHandle,simInt* count);
+const simFloat* simGetStackFloatTableView_internal(simInt stackHandle,simInt* count);
+const simDouble* simGetStackDoubleTableView_internal(simInt stackHandle,simInt* count);
 simInt simUnfoldStackTable_internal(simInt stackHandle);
 simInt simDebugStack_internal(simInt stackHandle,simInt cIndex);
 simInt simSetScriptVariable_internal(simInt scriptHandleOrType,const simChar* variableNameAtScriptName,simInt stackHandle);
@@ -7,6 +7,7 @@
 #include "iKGraphJoint.h"
 #include "iKGraphObjCont.h"
 #include "gCSDefs.h"
+#include "ikSolver.h"
 
 bool CGeometricConstraintSolver::solve(CIKGraphObjCont& graphContainer,SGeomConstrSolverParam& parameters)
 {
@@ -634,16 +635,7 @@ int CGeometricConstraintSolver::performOnePass(CIKChainCont& chainCont,bool& lim
     CMatrix solution(doF,1);
 
 //************************************** RESOLUTION ***************************************
-    CMatrix JT(mainMatrix.rows,mainMatrix.cols);
-    JT=mainMatrix;
-    JT.transpose();
-    CMatrix DLSJ(doF,eqNumb);
-    CMatrix JJTInv(eqNumb,eqNumb);
-    JJTInv=mainMatrix*JT;
-    CMatrix ID(mainMatrix.rows,mainMatrix.rows);
-    ID.setIdentity();
-    for (int i=0;i<ID.rows;i++)
-        ID(i,i)=0.0f;
+    std::vector<float> rowDampings(eqNumb,0.0f);
     int rowPos=0;
     for (int elementNumber=0;elementNumber<int(chainCont.allChains.size());elementNumber++)
     {
@@ -651,15 +643,12 @@ int CGeometricConstraintSolver::performOnePass(CIKChainCont& chainCont,bool& lim
         for (int i=0;i<element->errorVector->rows;i++)
         {
             float damping=element->tooltip->dampingFactor+parameters.generalDamping;
-            ID(rowPos,rowPos)=damping*damping;
+            rowDampings[rowPos]=damping*damping;
             rowPos++;
         }
     }
-    JJTInv+=ID;
-    if (!JJTInv.inverse())
-        return(false); // error occured (matrix not invertible, nan numbers or such!)
-    DLSJ=JT*JJTInv;
-    solution=DLSJ*mainErrorVector;
+    if (!CIkSolver::solveDampedLeastSquares(mainMatrix,mainErrorVector,0.0f,(eqNumb>0)?&rowDampings[0]:NULL,solution,&parameters.solverScratch))
+        return(false); // error occured (matrix not positive definite, nan numbers or such!)
 //*****************************************************************************************
 
 
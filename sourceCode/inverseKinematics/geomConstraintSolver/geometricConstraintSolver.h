@@ -15,6 +15,7 @@ struct SGeomConstrSolverParam
     float maxLinearVariation;
     float loopClosurePositionTolerance;
     float loopClosureOrientationTolerance;
+    std::vector<float> solverScratch; // reused by all passes of a solve, for large systems
 };
 
 //FULLY STATIC CLASS
@@ -5,10 +5,13 @@
 #include "distanceRoutine.h"
 #include "ikGroup.h"
 #include "ikRoutine.h"
+#include "ikSolver.h"
 #include "app.h"
+#include "stepProfiler.h"
 #include "tt.h"
 #include "ttUtil.h"
 #include <algorithm>
+#include <set>
 
 CikGroup::CikGroup()
 {
@@ -23,6 +26,8 @@ CikGroup::CikGroup()
     _calcTimeInMs=0;
     _initialValuesInitialized=false;
     _lastJacobian=NULL;
+    for (int i=0;i<4;i++)
+        _passMatrices[i]=NULL;
     _explicitHandling=false;
     dlsFactor=0.1f;
     calculationMethod=sim_ik_pseudo_inverse_method;
@@ -37,6 +42,9 @@ CikGroup::CikGroup()
     jointTreshholdLinear=0.001f;
     _calculationResult=sim_ikresult_not_performed;
     _correctJointLimits=false;
+    _temporaryParameterJoints=NULL;
+    _temporaryParameterDummies=NULL;
+    _computedConcurrently=false;
     _uniquePersistentIdString=CTTUtil::generateUniqueReadableString(); // persistent
 }
 
@@ -51,6 +59,8 @@ CikGroup::~CikGroup()
         removeIkElement(ikElements[0]->getObjectID());
 
     delete _lastJacobian;
+    for (int i=0;i<4;i++)
+        delete _passMatrices[i];
 }
 
 void CikGroup::initializeInitialValues(bool simulationIsRunning)
@@ -1015,6 +1025,7 @@ int CikGroup::computeGroupIk(bool forMotionPlanning)
 { // Return value is one of following: sim_ikresult_not_performed, sim_ikresult_success, sim_ikresult_fail
     if (!active)
         return(sim_ikresult_not_performed); // That group is not active!
+    CStepProfilerScope profilerScope(PROFILER_CATEGORY_IK,getObjectID(),!_computedConcurrently); // when computed concurrently, the caller records the event
     if (!forMotionPlanning)
     {
         if (doOnFailOrSuccessOf!=-1)
@@ -1046,7 +1057,7 @@ int CikGroup::computeGroupIk(bool forMotionPlanning)
         }
     }
 
-    if (!forMotionPlanning)
+    if ( (!forMotionPlanning)&&(!_computedConcurrently) )
         App::ct->calcInfo->inverseKinematicsStart();
     // Now we prepare a vector with all valid and active elements:
     std::vector<CikEl*> validElements;
@@ -1098,7 +1109,7 @@ int CikGroup::computeGroupIk(bool forMotionPlanning)
     // Now validElements contains all valid elements we have to use in the following computation!
     if (validElements.size()==0)
     {
-        if (!forMotionPlanning)
+        if ( (!forMotionPlanning)&&(!_computedConcurrently) )
             App::ct->calcInfo->inverseKinematicsEnd();
         return(sim_ikresult_fail); // Error!
     }
@@ -1184,13 +1195,28 @@ int CikGroup::computeGroupIk(bool forMotionPlanning)
     // We set all joint parameters:
     if (setNewValues)
         _applyTemporaryParameters();
-    if (!forMotionPlanning)
+    if ( (!forMotionPlanning)&&(!_computedConcurrently) )
         App::ct->calcInfo->inverseKinematicsEnd();
     return(returnValue);
 }
 
 void CikGroup::_resetTemporaryParameters()
 {
+    if (_temporaryParameterJoints!=NULL)
+    { // Only the objects this group (or groups it depends on) can modify. Used when groups are solved concurrently
+        for (size_t i=0;i<_temporaryParameterJoints->size();i++)
+        {
+            CJoint* it=_temporaryParameterJoints->at(i);
+            it->setPosition(it->getPosition(),true);
+            it->initializeParametersForIK(getJointTreshholdAngular());
+        }
+        for (size_t i=0;i<_temporaryParameterDummies->size();i++)
+        {
+            CDummy* it=_temporaryParameterDummies->at(i);
+            it->setTempLocalTransformation(it->getLocalTransformation());
+        }
+        return;
+    }
     // We prepare all joint temporary parameters:
     for (int jc=0;jc<int(App::ct->objCont->jointList.size());jc++)
     {
@@ -1209,6 +1235,21 @@ void CikGroup::_resetTemporaryParameters()
 
 void CikGroup::_applyTemporaryParameters()
 {
+    if (_temporaryParameterJoints!=NULL)
+    { // see _resetTemporaryParameters
+        for (size_t i=0;i<_temporaryParameterJoints->size();i++)
+        {
+            CJoint* it=_temporaryParameterJoints->at(i);
+            it->setPosition(it->getPosition(true),false);
+            it->applyTempParametersEx();
+        }
+        for (size_t i=0;i<_temporaryParameterDummies->size();i++)
+        {
+            CDummy* it=_temporaryParameterDummies->at(i);
+            it->setLocalTransformation(it->getTempLocalTransformation());
+        }
+        return;
+    }
     // Joints:
     for (int jc=0;jc<int(App::ct->objCont->jointList.size());jc++)
     {
@@ -1225,6 +1266,131 @@ void CikGroup::_applyTemporaryParameters()
     }
 }
 
+void CikGroup::setTemporaryParameterObjects(const std::vector<CJoint*>* joints,const std::vector<CDummy*>* dummies)
+{ // NULL (default) means all joints and dummies of the scene
+    _temporaryParameterJoints=joints;
+    _temporaryParameterDummies=dummies;
+}
+
+bool CikGroup::resetAllTemporaryParameters()
+{ // static. Sets the temporary parameters of all joints and dummies to their current values. Returns false if
+  // applying them back would modify a joint (i.e. spherical joints, or dependent joints that are not up-to-date).
+  // Each group that applies its result does that for all joints of the scene: groups can then not be solved
+  // concurrently and still give the same results as when solved one after the other
+    bool retVal=true;
+    for (int jc=0;jc<int(App::ct->objCont->jointList.size());jc++)
+    {
+        CJoint* it=App::ct->objCont->getJoint(App::ct->objCont->jointList[jc]);
+        it->setPosition(it->getPosition(),true);
+        it->initializeParametersForIK(0.0f);
+    }
+    for (int jc=0;jc<int(App::ct->objCont->jointList.size());jc++)
+    { // (dependent joints were rectified above, after their master joint)
+        CJoint* it=App::ct->objCont->getJoint(App::ct->objCont->jointList[jc]);
+        if ( (it->getJointType()==sim_joint_spherical_subtype)||(it->getPosition(true)!=it->getPosition()) )
+            retVal=false;
+    }
+    for (int jc=0;jc<int(App::ct->objCont->dummyList.size());jc++)
+    {
+        CDummy* it=App::ct->objCont->getDummy(App::ct->objCont->dummyList[jc]);
+        it->setTempLocalTransformation(it->getLocalTransformation());
+    }
+    return(retVal);
+}
+
+void CikGroup::setComputedConcurrently(bool concurrent)
+{ // Set while this group is computed by a worker thread: computeGroupIk then neither updates the calculation
+  // info nor records a profiler event. The calling thread does it, once all groups were computed
+    _computedConcurrently=concurrent;
+}
+
+void CikGroup::getConcurrencyObjects(std::vector<int>& readObjects,std::vector<int>& writtenObjects,bool& conflictsWithAllGroups)
+{ // Objects this group reads or (temporarily or not) modifies when computed. Two groups that do not
+  // modify what the other one reads can be computed concurrently
+    conflictsWithAllGroups=( (constraints&sim_ik_avoidance_constraint)&&(_avoidanceRobotEntity!=-1) ); // avoidance looks at the whole scene
+    std::vector<CJoint*> joints;
+    std::vector<C3DObject*> subtreeRoots;
+    for (size_t i=0;i<ikElements.size();i++)
+    {
+        CikEl* element=ikElements[i];
+        CDummy* tooltip=App::ct->objCont->getDummy(element->getTooltip());
+        if (tooltip==NULL)
+            continue;
+        subtreeRoots.push_back(tooltip);
+        C3DObject* base=App::ct->objCont->getObject(element->getBase());
+        C3DObject* iterat=tooltip->getParent();
+        bool baseIsAncestor=false;
+        while (iterat!=NULL)
+        {
+            if (iterat==base)
+                baseIsAncestor=true;
+            iterat=iterat->getParent();
+        }
+        iterat=tooltip->getParent();
+        while ( (iterat!=NULL)&&((iterat!=base)||(!baseIsAncestor)) )
+        { // an illegal base is reset during computation: we take the whole chain
+            if (iterat->getObjectType()==sim_object_joint_type)
+                joints.push_back((CJoint*)iterat);
+            iterat=iterat->getParent();
+        }
+
+        // Tip and target dummies that slide along a path (the path is marked as modified too, since its curve is queried):
+        CDummy* target=App::ct->objCont->getDummy(element->getTarget());
+        CDummy* slidingDummies[2]={tooltip,target};
+        for (int j=0;j<2;j++)
+        {
+            if ( (slidingDummies[j]!=NULL)&&(slidingDummies[j]->getParent()!=NULL)&&(slidingDummies[j]->getParent()->getObjectType()==sim_object_path_type) )
+            {
+                writtenObjects.push_back(slidingDummies[j]->getID());
+                writtenObjects.push_back(slidingDummies[j]->getParent()->getID());
+            }
+        }
+
+        C3DObject* readObjs[4]={tooltip,target,base,App::ct->objCont->getObject(element->getAlternativeBaseForConstraints())};
+        for (int j=0;j<4;j++)
+        {
+            iterat=readObjs[j];
+            while (iterat!=NULL)
+            {
+                readObjects.push_back(iterat->getID());
+                iterat=iterat->getParent();
+            }
+        }
+    }
+
+    // Joints that are linked via dependencies are modified together:
+    std::set<CJoint*> modifiedJoints;
+    while (joints.size()!=0)
+    {
+        CJoint* joint=joints[joints.size()-1];
+        joints.pop_back();
+        if (modifiedJoints.insert(joint).second)
+        {
+            writtenObjects.push_back(joint->getID());
+            CJoint* master=App::ct->objCont->getJoint(joint->getDependencyJointID());
+            if (master!=NULL)
+                joints.push_back(master);
+            joints.insert(joints.end(),joint->directDependentJoints.begin(),joint->directDependentJoints.end());
+            subtreeRoots.push_back(joint);
+        }
+    }
+
+    // Everything below a modified joint or a tip moves with it (and has its cached transformation invalidated):
+    // groups whose subtrees overlap are not independent
+    std::set<C3DObject*> subtreeObjects;
+    while (subtreeRoots.size()!=0)
+    {
+        C3DObject* obj=subtreeRoots[subtreeRoots.size()-1];
+        subtreeRoots.pop_back();
+        if (subtreeObjects.insert(obj).second)
+        {
+            if (modifiedJoints.find((CJoint*)obj)==modifiedJoints.end())
+                writtenObjects.push_back(obj->getID());
+            subtreeRoots.insert(subtreeRoots.end(),obj->childList.begin(),obj->childList.end());
+        }
+    }
+}
+
 int CikGroup::performOnePass(std::vector<CikEl*>* validElements,bool& limitOrAvoidanceNeedMoreCalculation,float interpolFact,bool forMotionPlanning)
 {   // Return value -1 means that an error occured --> keep old configuration
     // Return value 0 means that the max. angular or linear variation were overpassed.
@@ -1532,13 +1698,14 @@ int CikGroup::performOnePass(std::vector<CikEl*>* validElements,bool& limitOrAvo
     }
     //---------------------------------------------------------------------------
 
-    // We prepare the main matrix and the main error vector.
-    CMatrix mainMatrix(numberOfRows,int(allJoints.size()));
-    CMatrix mainMatrix_correctJacobian(numberOfRows,int(allJoints.size()));
+    // We prepare the main matrix and the main error vector (kept from one pass to the next):
+    CMatrix& mainMatrix=_getPassMatrix(0,numberOfRows,int(allJoints.size()));
+    CMatrix& mainMatrix_correctJacobian=_getPassMatrix(1,numberOfRows,int(allJoints.size()));
     // We have to zero it first:
     mainMatrix.clear();
     mainMatrix_correctJacobian.clear();
-    CMatrix mainErrorVector(numberOfRows,1);
+    CMatrix& mainErrorVector=_getPassMatrix(2,numberOfRows,1);
+    mainErrorVector.clear();
     
     // Now we fill in the main matrix and the main error vector:
     int currentRow=0;
@@ -1679,40 +1846,20 @@ int CikGroup::performOnePass(std::vector<CikEl*>* validElements,bool& limitOrAvo
     }
     // Now we just have to solve:
     int doF=mainMatrix.cols;
-    int eqNumb=mainMatrix.rows;
-    CMatrix solution(doF,1);
+    CMatrix& solution=_getPassMatrix(3,doF,1);
 
     if (!forMotionPlanning)
-    {
-        delete _lastJacobian;
-        _lastJacobian=new CMatrix(mainMatrix_correctJacobian); //mainMatrix);
-    }
+        _setLastJacobian(mainMatrix_correctJacobian); //mainMatrix);
 
     if (calculationMethod==sim_ik_pseudo_inverse_method)
     {
-        CMatrix JT(mainMatrix);
-        JT.transpose();
-        CMatrix pseudoJ(doF,eqNumb);
-        CMatrix JJTInv(mainMatrix*JT);
-        if (!JJTInv.inverse())
+        if (!CIkSolver::solveDampedLeastSquares(mainMatrix,mainErrorVector,0.0f,NULL,solution,&_solverScratch))
             return(-1);
-        pseudoJ=JT*JJTInv;
-        solution=pseudoJ*mainErrorVector;
     }
     if (calculationMethod==sim_ik_damped_least_squares_method)
     {
-        CMatrix JT(mainMatrix);
-        JT.transpose();
-        CMatrix DLSJ(doF,eqNumb);
-        CMatrix JJTInv(mainMatrix*JT);
-        CMatrix ID(mainMatrix.rows,mainMatrix.rows);
-        ID.setIdentity();
-        ID/=1.0f/(dlsFactor*dlsFactor);
-        JJTInv+=ID;
-        if (!JJTInv.inverse())
+        if (!CIkSolver::solveDampedLeastSquares(mainMatrix,mainErrorVector,dlsFactor*dlsFactor,NULL,solution,&_solverScratch))
             return(-1);
-        DLSJ=JT*JJTInv;
-        solution=DLSJ*mainErrorVector;
     }
     if (calculationMethod==sim_ik_jacobian_transpose_method)
     {
@@ -1754,6 +1901,32 @@ int CikGroup::performOnePass(std::vector<CikEl*>* validElements,bool& limitOrAvo
     return(1);
 }
 
+CMatrix& CikGroup::_getPassMatrix(int index,int rows,int cols)
+{ // Only reallocated when the size of the system changes
+    CMatrix* m=_passMatrices[index];
+    if ( (m==NULL)||(m->rows!=rows)||(m->cols!=cols) )
+    {
+        delete m;
+        m=new CMatrix(rows,cols);
+        _passMatrices[index]=m;
+    }
+    return(m[0]);
+}
+
+void CikGroup::_setLastJacobian(const CMatrix& jacobian)
+{ // Only reallocated when the size of the system changes
+    if ( (_lastJacobian==NULL)||(_lastJacobian->rows!=jacobian.rows)||(_lastJacobian->cols!=jacobian.cols) )
+    {
+        delete _lastJacobian;
+        _lastJacobian=new CMatrix(jacobian);
+    }
+    else
+    {
+        for (int i=0;i<jacobian.rows*jacobian.cols;i++)
+            _lastJacobian->data[i]=jacobian.data[i];
+    }
+}
+
 bool CikGroup::performOnePass_jacobianOnly(std::vector<CikEl*>* validElements,int options)
 {
     // We prepare a vector of all used joints and a counter for the number of rows:
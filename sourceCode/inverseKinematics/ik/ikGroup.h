@@ -105,6 +105,11 @@ public:
     float getDeterminant(const CMatrix& m,const std::vector<int>* activeRows,const std::vector<int>* activeColumns);
     bool computeOnlyJacobian(int options);
 
+    void getConcurrencyObjects(std::vector<int>& readObjects,std::vector<int>& writtenObjects,bool& conflictsWithAllGroups);
+    void setTemporaryParameterObjects(const std::vector<CJoint*>* joints,const std::vector<CDummy*>* dummies);
+    static bool resetAllTemporaryParameters();
+    void setComputedConcurrently(bool concurrent);
+
     // Variables which need to be serialized and copied:
     std::vector<CikEl*> ikElements;
 
@@ -114,6 +119,8 @@ private:
     void _applyTemporaryParameters();
 
     int performOnePass(std::vector<CikEl*>* validElements,bool& limitOrAvoidanceNeedMoreCalculation,float interpolFact,bool forMotionPlanning);
+    CMatrix& _getPassMatrix(int index,int rows,int cols);
+    void _setLastJacobian(const CMatrix& jacobian);
     bool performOnePass_jacobianOnly(std::vector<CikEl*>* validElements,int options);
 
     // Variables which need to be serialized and copied:
@@ -150,6 +157,12 @@ private:
     int _calculationResult;
 
     CMatrix* _lastJacobian;
+    std::vector<float> _solverScratch; // for large systems. A group is handled by one thread at a time
+    CMatrix* _passMatrices[4]; // main matrix, corrected Jacobian, error vector and solution of performOnePass
 
     bool _explicitHandling;
+
+    const std::vector<CJoint*>* _temporaryParameterJoints; // NULL: all joints of the scene
+    const std::vector<CDummy*>* _temporaryParameterDummies; // NULL: all dummies of the scene
+    bool _computedConcurrently;
 };
@@ -0,0 +1,201 @@
+#include "vrepMainHeader.h"
+#include "ikSolver.h"
+#include "app.h"
+#include "tt.h"
+#include "vDateTime.h"
+#include <boost/lexical_cast.hpp>
+
+bool CIkSolver::solveDampedLeastSquares(CMatrix& jacobian,CMatrix& errorVector,float damping,const float* rowDampings,CMatrix& solution,std::vector<float>* scratch/*=NULL*/)
+{ // Returns false if J*J^T+D cannot be inverted
+    if (_solveWithFactorization(jacobian,errorVector,damping,rowDampings,solution,scratch))
+        return(true);
+    // J*J^T+D is (near) singular, e.g. at a singular configuration without damping. The factorization
+    // gives up on such systems, the previous implementation might still find a solution:
+    return(solveDampedLeastSquaresWithInverse(jacobian,errorVector,damping,rowDampings,solution));
+}
+
+bool CIkSolver::_solveWithFactorization(CMatrix& jacobian,CMatrix& errorVector,float damping,const float* rowDampings,CMatrix& solution,std::vector<float>* scratch)
+{
+    int rows=jacobian.rows;
+    int cols=jacobian.cols;
+    if ( (rows<=6)&&(cols<=12) )
+        return(_solveFixedSize<6,12>(jacobian,errorVector,damping,rowDampings,solution));
+    if ( (rows<=12)&&(cols<=24) )
+        return(_solveFixedSize<12,24>(jacobian,errorVector,damping,rowDampings,solution));
+    if ( (rows<=24)&&(cols<=48) )
+        return(_solveFixedSize<24,48>(jacobian,errorVector,damping,rowDampings,solution));
+    size_t requiredSize=size_t(rows*cols+rows*rows+rows+1);
+    std::vector<float> localBuffer;
+    if (scratch==NULL)
+        scratch=&localBuffer;
+    if (scratch->size()<requiredSize)
+        scratch->resize(requiredSize);
+    float* buffer=&(*scratch)[0];
+    return(_solve(jacobian,errorVector,damping,rowDampings,solution,buffer,buffer+rows*cols,buffer+rows*cols+rows*rows));
+}
+
+bool CIkSolver::_solve(CMatrix& jacobian,CMatrix& errorVector,float damping,const float* rowDampings,CMatrix& solution,float* j,float* a,float* y)
+{ // j: rows*cols, a: rows*rows, y: rows. Returns false if a pivot is too small (J*J^T+D near singular)
+    int rows=jacobian.rows;
+    int cols=jacobian.cols;
+    for (int r=0;r<rows;r++)
+    {
+        for (int c=0;c<cols;c++)
+            j[r*cols+c]=jacobian(r,c);
+    }
+
+    // Lower triangle of J*J^T+D:
+    for (int r=0;r<rows;r++)
+    {
+        const float* jr=j+r*cols;
+        for (int c=0;c<=r;c++)
+        {
+            const float* jc=j+c*cols;
+            float s=0.0f;
+            for (int k=0;k<cols;k++)
+                s+=jr[k]*jc[k];
+            a[r*rows+c]=s;
+        }
+        if (rowDampings!=NULL)
+            a[r*rows+r]+=rowDampings[r];
+        else
+            a[r*rows+r]+=damping;
+    }
+    float pivotTolerance=0.0f;
+    for (int r=0;r<rows;r++)
+        pivotTolerance=SIM_MAX(pivotTolerance,a[r*rows+r]);
+    pivotTolerance*=0.000001f; // relative to the largest diagonal element
+
+    // In place LDL^T factorization: L below the diagonal (unit diagonal implied), D on the diagonal:
+    for (int i=0;i<rows;i++)
+    {
+        float* ai=a+i*rows;
+        for (int c=0;c<i;c++)
+        {
+            const float* ac=a+c*rows;
+            float s=ai[c];
+            for (int k=0;k<c;k++)
+                s-=ai[k]*ac[k]*a[k*rows+k];
+            ai[c]=s/ac[c];
+        }
+        float d=ai[i];
+        for (int k=0;k<i;k++)
+            d-=ai[k]*ai[k]*a[k*rows+k];
+        if (!(d>pivotTolerance)) // also catches NaNs
+            return(false);
+        ai[i]=d;
+    }
+
+    // Forward substitution (L*z=e), scaling (D*w=z), backward substitution (L^T*y=w):
+    for (int i=0;i<rows;i++)
+    {
+        float s=errorVector(i,0);
+        for (int k=0;k<i;k++)
+            s-=a[i*rows+k]*y[k];
+        y[i]=s;
+    }
+    for (int i=0;i<rows;i++)
+        y[i]/=a[i*rows+i];
+    for (int i=rows-1;i>=0;i--)
+    {
+        float s=y[i];
+        for (int k=i+1;k<rows;k++)
+            s-=a[k*rows+i]*y[k];
+        y[i]=s;
+    }
+
+    // solution=J^T*y:
+    for (int c=0;c<cols;c++)
+    {
+        float s=0.0f;
+        for (int r=0;r<rows;r++)
+            s+=j[r*cols+c]*y[r];
+        solution(c,0)=s;
+    }
+    return(true);
+}
+
+bool CIkSolver::solveDampedLeastSquaresWithInverse(CMatrix& jacobian,CMatrix& errorVector,float damping,const float* rowDampings,CMatrix& solution)
+{
+    CMatrix JT(jacobian);
+    JT.transpose();
+    CMatrix JJTInv(jacobian*JT);
+    for (int i=0;i<JJTInv.rows;i++)
+    {
+        if (rowDampings!=NULL)
+            JJTInv(i,i)+=rowDampings[i];
+        else
+            JJTInv(i,i)+=damping;
+    }
+    if (!JJTInv.inverse())
+        return(false);
+    CMatrix DLSJ(JT*JJTInv);
+    solution=DLSJ*errorVector;
+    return(true);
+}
+
+void CIkSolver::runBenchmark()
+{ // Times IK steps (Jacobian of typical sizes) with the previous and the current implementation. Enabled via the user settings
+    const int sizes[5][2]={{6,6},{6,7},{12,14},{30,40},{6,7}}; // equations x DoF. The 4th one does not fit the stack buffers
+    for (int s=0;s<5;s++)
+    {
+        int rows=sizes[s][0];
+        int cols=sizes[s][1];
+        bool singular=(s==4);
+        CMatrix jacobian(rows,cols);
+        CMatrix errorVector(rows,1);
+        unsigned int seed=1;
+        for (int r=0;r<rows;r++)
+        { // same Jacobian each time
+            for (int c=0;c<cols;c++)
+            {
+                seed=seed*1103515245+12345;
+                jacobian(r,c)=float((seed>>16)&0x7fff)/16383.5f-1.0f;
+            }
+            seed=seed*1103515245+12345;
+            errorVector(r,0)=(float((seed>>16)&0x7fff)/16383.5f-1.0f)*0.01f;
+        }
+        if (singular)
+        { // singular configuration: the last row is (almost) the same as the first one. Without damping, the
+            // factorization has to fall back to the previous implementation, and both have to agree
+            for (int c=0;c<cols;c++)
+                jacobian(rows-1,c)=jacobian(0,c)*(1.0f+0.0001f*float(c));
+        }
+        for (int m=0;m<2;m++)
+        { // pseudo-inverse, then damped least squares
+            float damping=0.0f;
+            if (m==1)
+                damping=0.1f*0.1f;
+            int passes=2000000/(rows*cols*rows);
+            CMatrix solutions[2]={CMatrix(cols,1),CMatrix(cols,1)};
+            float stepsPerSecond[2];
+            bool ok[2];
+            std::vector<float> scratch;
+            for (int impl=0;impl<2;impl++)
+            {
+                suint64 startTime=VDateTime::getTimeInUs();
+                for (int p=0;p<passes;p++)
+                {
+                    if (impl==0)
+                        ok[impl]=solveDampedLeastSquaresWithInverse(jacobian,errorVector,damping,NULL,solutions[impl]);
+                    else
+                        ok[impl]=solveDampedLeastSquares(jacobian,errorVector,damping,NULL,solutions[impl],&scratch);
+                }
+                suint64 duration=SIM_MAX(VDateTime::getTimeInUs()-startTime,suint64(1));
+                stepsPerSecond[impl]=float(passes)*1000000.0f/float(duration);
+            }
+            float maxDiff=0.0f;
+            for (int c=0;c<cols;c++)
+                maxDiff=SIM_MAX(maxDiff,fabs(solutions[0](c,0)-solutions[1](c,0)));
+            std::string txt("IK solver benchmark, ");
+            txt+=boost::lexical_cast<std::string>(rows)+"x"+boost::lexical_cast<std::string>(cols)+(singular?" singular":"")+((m==0)?" pseudo-inverse: ":" DLS: ");
+            txt+=tt::FNb(0,stepsPerSecond[0],0,false)+" steps/s --> "+tt::FNb(0,stepsPerSecond[1],0,false)+" steps/s";
+            txt+=" ("+tt::FNb(0,stepsPerSecond[1]/stepsPerSecond[0],1,false)+"x)";
+            if (ok[0]!=ok[1])
+                txt+=", RESULTS DIFFER";
+            else if (ok[0])
+                txt+=", max. difference: "+tt::FNb(0,maxDiff,6,false);
+            App::addStatusbarMessage(txt);
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "vrepMainHeader.h"
+#include "MyMath.h"
+
+// Solves the (damped) least squares step of the IK passes: solution=J^T*(J*J^T+D)^-1*e, with D a
+// diagonal damping matrix. J*J^T+D is factorized (LDL^T) instead of inverted. For the usual sizes, all
+// temporary matrices live on the stack (sizes fixed at compile time), otherwise in a scratch buffer owned
+// by the caller, so that it can be reused from one pass to the next. If J*J^T+D is near singular, the
+// previous implementation (explicit inverse) is used instead
+// FULLY STATIC CLASS
+class CIkSolver
+{
+public:
+    static bool solveDampedLeastSquares(CMatrix& jacobian,CMatrix& errorVector,float damping,const float* rowDampings,CMatrix& solution,std::vector<float>* scratch=NULL); // rowDampings: one damping per row (or NULL). scratch: grown as needed, never shrunk (or NULL)
+    static bool solveDampedLeastSquaresWithInverse(CMatrix& jacobian,CMatrix& errorVector,float damping,const float* rowDampings,CMatrix& solution); // previous implementation, kept for the benchmark
+    static void runBenchmark();
+
+private:
+    template<int MAX_ROWS,int MAX_COLS>
+    static bool _solveFixedSize(CMatrix& jacobian,CMatrix& errorVector,float damping,const float* rowDampings,CMatrix& solution)
+    {
+        float j[MAX_ROWS*MAX_COLS];
+        float a[MAX_ROWS*MAX_ROWS];
+        float y[MAX_ROWS];
+        return(_solve(jacobian,errorVector,damping,rowDampings,solution,j,a,y));
+    }
+    static bool _solveWithFactorization(CMatrix& jacobian,CMatrix& errorVector,float damping,const float* rowDampings,CMatrix& solution,std::vector<float>* scratch);
+    static bool _solve(CMatrix& jacobian,CMatrix& errorVector,float damping,const float* rowDampings,CMatrix& solution,float* j,float* a,float* y);
+};
@@ -4,7 +4,8 @@
 #include "pluginContainer.h"
 #include "v_repConst.h"
 #include "pathPlanningInterface.h"
-#include "easyLock.h"
+#include "vReadWriteLock.h"
+#include <algorithm>
 #include "v_rep_internal.h"
 
 CPlugin::CPlugin(const char* filename,const char* pluginName)
@@ -257,7 +258,76 @@ CPlugin* CPluginContainer::currentMeshEngine=NULL;
 CPlugin* CPluginContainer::currentCodeEditor=NULL;
 CPlugin* CPluginContainer::currentCustomUi=NULL;
 
-VMutex _meshMutex;
+// Geometries (collision information structures, octrees and point clouds) are mapped to one of following
+// locks. Read-only queries lock shared, modifying calls lock exclusively. The locks only protect against
+// the concurrency V-REP itself creates: internal worker batches (queries only lock in between
+// mesh_setConcurrentAccess(true) and mesh_setConcurrentAccess(false)), and cutting vs. the display of cut
+// shapes (mesh_lockUnlock), which always lock. Threaded scripts never run at the same time as the
+// simulation thread (see CThreadPool), and mesh functions must not be called from other threads (e.g.
+// threads created by plugins) outside of such a batch:
+#define MESH_GEOMETRY_LOCK_COUNT 64
+VReadWriteLock _meshGeometryLocks[MESH_GEOMETRY_LOCK_COUNT];
+int CPluginContainer::_meshConcurrentAccessCount=0;
+
+static size_t _getMeshGeometryLockIndex(const void* geometry)
+{
+    size_t v=(size_t)geometry;
+    return(((v>>4)^(v>>12))%MESH_GEOMETRY_LOCK_COUNT);
+}
+
+class CMeshGeometryLock
+{ // locks one or two geometries for the lifetime of the object. Locks are always taken in increasing index order
+public:
+    CMeshGeometryLock(const void* geometry1,bool exclusive1,const void* geometry2=NULL,bool exclusive2=false,bool alwaysLock=false)
+    {
+        _lockCount=0;
+        if ( (!alwaysLock)&&(!CPluginContainer::mesh_isConcurrentAccessActive()) )
+            return; // single-threaded access: no lock needed
+        if (geometry1!=NULL)
+            _add(_getMeshGeometryLockIndex(geometry1),exclusive1);
+        if (geometry2!=NULL)
+            _add(_getMeshGeometryLockIndex(geometry2),exclusive2);
+        if ( (_lockCount==2)&&(_indices[1]<_indices[0]) )
+        {
+            std::swap(_indices[0],_indices[1]);
+            std::swap(_exclusive[0],_exclusive[1]);
+        }
+        for (int i=0;i<_lockCount;i++)
+        {
+            if (_exclusive[i])
+                _meshGeometryLocks[_indices[i]].lockForWrite();
+            else
+                _meshGeometryLocks[_indices[i]].lockForRead();
+        }
+    }
+    virtual ~CMeshGeometryLock()
+    {
+        for (int i=_lockCount-1;i>=0;i--)
+        {
+            if (_exclusive[i])
+                _meshGeometryLocks[_indices[i]].unlockForWrite();
+            else
+                _meshGeometryLocks[_indices[i]].unlockForRead();
+        }
+    }
+
+private:
+    void _add(size_t index,bool exclusive)
+    {
+        if ( (_lockCount==1)&&(_indices[0]==index) )
+            _exclusive[0]=_exclusive[0]||exclusive; // both geometries map to the same lock
+        else
+        {
+            _indices[_lockCount]=index;
+            _exclusive[_lockCount]=exclusive;
+            _lockCount++;
+        }
+    }
+
+    size_t _indices[2];
+    bool _exclusive[2];
+    int _lockCount;
+};
 
 CPluginContainer::CPluginContainer()
 {
@@ -709,12 +779,47 @@ bool CPluginContainer::isCustomUiPluginAvailable()
     return(currentCustomUi!=NULL);
 }
 
-void CPluginContainer::mesh_lockUnlock(bool lock)
-{
+void CPluginContainer::mesh_lockUnlock(const void* geometry,bool lock)
+{ // shared lock, e.g. when accessing the calculated triangles of a geometry
+    VReadWriteLock* l=&_meshGeometryLocks[_getMeshGeometryLockIndex(geometry)];
     if (lock)
-        _meshMutex.lock();
+        l->lockForRead();
     else
-        _meshMutex.unlock();
+        l->unlockForRead();
+}
+
+void CPluginContainer::mesh_setConcurrentAccess(bool concurrent)
+{ // Call with true before mesh functions are called from worker threads, and with false after that (from
+  // the thread that launched the workers). Geometry locks are only taken in between: outside of such a
+  // batch, only one thread may call the mesh functions (except for cutting and mesh_lockUnlock)
+    if (concurrent)
+        _meshConcurrentAccessCount++;
+    else
+        _meshConcurrentAccessCount--;
+}
+
+bool CPluginContainer::mesh_isConcurrentAccessActive()
+{
+    return(_meshConcurrentAccessCount>0);
+}
+
+void CPluginContainer::mesh_getLockStatistics(unsigned int& lockCount,unsigned int& contentionCount)
+{
+    lockCount=0;
+    contentionCount=0;
+    for (size_t i=0;i<MESH_GEOMETRY_LOCK_COUNT;i++)
+    {
+        unsigned int l,c;
+        _meshGeometryLocks[i].getStatistics(l,c);
+        lockCount+=l;
+        contentionCount+=c;
+    }
+}
+
+void CPluginContainer::mesh_resetLockStatistics()
+{
+    for (size_t i=0;i<MESH_GEOMETRY_LOCK_COUNT;i++)
+        _meshGeometryLocks[i].resetStatistics();
 }
 
 void* CPluginContainer::mesh_createCollisionInformationStructure(const float* cumulMeshVertices,int cumulMeshVerticesSize,const int* cumulMeshIndices,int cumulMeshIndicesSize,float maxTriSize,float edgeAngle,int maxTriCount)
@@ -726,6 +831,7 @@ void* CPluginContainer::mesh_createCollisionInformationStructure(const float* cu
 
 void* CPluginContainer::mesh_copyCollisionInformationStructure(const void* collInfo)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_copyCollisionInformationStructure(collInfo));
     return(NULL);
@@ -733,18 +839,21 @@ void* CPluginContainer::mesh_copyCollisionInformationStructure(const void* collI
 
 void CPluginContainer::mesh_destroyCollisionInformationStructure(void* collInfo)
 {
+    CMeshGeometryLock geometryLock(collInfo,true);
     if (currentMeshEngine!=NULL)
         currentMeshEngine->v_repMesh_destroyCollisionInformationStructure(collInfo);
 }
 
 void CPluginContainer::mesh_scaleCollisionInformationStructure(void* collInfo,float scaleFactor)
 {
+    CMeshGeometryLock geometryLock(collInfo,true);
     if (currentMeshEngine!=NULL)
         currentMeshEngine->v_repMesh_scaleCollisionInformationStructure(collInfo,scaleFactor);
 }
 
 unsigned char* CPluginContainer::mesh_getCollisionInformationStructureSerializationData(const void* collInfo,int& dataSize)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCollisionInformationStructureSerializationData(collInfo,&dataSize));
     return(NULL);
@@ -765,6 +874,7 @@ void CPluginContainer::mesh_releaseBuffer(void* buffer)
 
 bool CPluginContainer::mesh_getCutMesh(const void* collInfo,const C7Vector* tr,float** vertices,int* verticesSize,int** indices,int* indicesSize,int options)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
     {
         float tr_[7];
@@ -776,6 +886,7 @@ bool CPluginContainer::mesh_getCutMesh(const void* collInfo,const C7Vector* tr,f
 
 int CPluginContainer::mesh_getCalculatedTriangleCount(const void* collInfo)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCalculatedTriangleCount(collInfo));
     return(0);
@@ -783,6 +894,7 @@ int CPluginContainer::mesh_getCalculatedTriangleCount(const void* collInfo)
 
 int* CPluginContainer::mesh_getCalculatedTrianglesPointer(const void* collInfo)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCalculatedTrianglesPointer(collInfo));
     return(NULL);
@@ -790,6 +902,7 @@ int* CPluginContainer::mesh_getCalculatedTrianglesPointer(const void* collInfo)
 
 int CPluginContainer::mesh_getCalculatedVerticeCount(const void* collInfo)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCalculatedVerticeCount(collInfo));
     return(0);
@@ -797,6 +910,7 @@ int CPluginContainer::mesh_getCalculatedVerticeCount(const void* collInfo)
 
 float* CPluginContainer::mesh_getCalculatedVerticesPointer(const void* collInfo)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCalculatedVerticesPointer(collInfo));
     return(NULL);
@@ -804,6 +918,7 @@ float* CPluginContainer::mesh_getCalculatedVerticesPointer(const void* collInfo)
 
 int CPluginContainer::mesh_getCalculatedSegmentCount(const void* collInfo)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCalculatedSegmentCount(collInfo));
     return(0);
@@ -811,6 +926,7 @@ int CPluginContainer::mesh_getCalculatedSegmentCount(const void* collInfo)
 
 int* CPluginContainer::mesh_getCalculatedSegmentsPointer(const void* collInfo)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCalculatedSegmentsPointer(collInfo));
     return(NULL);
@@ -818,6 +934,7 @@ int* CPluginContainer::mesh_getCalculatedSegmentsPointer(const void* collInfo)
 
 int CPluginContainer::mesh_getCalculatedPolygonCount(const void* collInfo)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCalculatedPolygonCount(collInfo));
     return(0);
@@ -825,6 +942,7 @@ int CPluginContainer::mesh_getCalculatedPolygonCount(const void* collInfo)
 
 int CPluginContainer::mesh_getCalculatedPolygonSize(const void* collInfo,int polygonIndex)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCalculatedPolygonSize(collInfo,polygonIndex));
     return(0);
@@ -832,6 +950,7 @@ int CPluginContainer::mesh_getCalculatedPolygonSize(const void* collInfo,int pol
 
 int* CPluginContainer::mesh_getCalculatedPolygonArrayPointer(const void* collInfo,int polygonIndex)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCalculatedPolygonArrayPointer(collInfo,polygonIndex));
     return(NULL);
@@ -839,6 +958,7 @@ int* CPluginContainer::mesh_getCalculatedPolygonArrayPointer(const void* collInf
 
 bool CPluginContainer::mesh_getCalculatedTriangleAt(const void* collInfo,C3Vector& a0,C3Vector& a1,C3Vector& a2,int ind)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getCalculatedTriangleAt(collInfo,a0.data,a1.data,a2.data,ind)!=0);
     return(false);
@@ -846,6 +966,7 @@ bool CPluginContainer::mesh_getCalculatedTriangleAt(const void* collInfo,C3Vecto
 
 bool CPluginContainer::mesh_getMeshMeshCollision(const void* collInfo1,const void* collInfo2,const C4X4Matrix collObjMatr[2],const void* collInfos[2],bool inverseExploration,std::vector<float>* intersections,int caching[2])
 {
+    CMeshGeometryLock geometryLock(collInfo1,false,collInfo2,false);
     if (currentMeshEngine!=NULL)
     {
         float collObjMatr1[12];
@@ -915,6 +1036,7 @@ bool CPluginContainer::mesh_getBoxPointCollision(const C4X4Matrix& boxTr,const C
 
 void CPluginContainer::mesh_getMeshMeshDistance(const void* collInfo1,const void* collInfo2,const C4X4Matrix distObjMatr[2],const void* collInfos[2],bool inverseExploration,float distances[7],int caching[2])
 {
+    CMeshGeometryLock geometryLock(collInfo1,false,collInfo2,false);
     if (currentMeshEngine!=NULL)
     {
         float distObjMatr1[12];
@@ -927,6 +1049,7 @@ void CPluginContainer::mesh_getMeshMeshDistance(const void* collInfo1,const void
 
 bool CPluginContainer::mesh_getDistanceAgainstDummy_ifSmaller(const void* collInfo,const C3Vector& dummyPos,const C4X4Matrix& itPCTM,float &dist,C3Vector& ray0,C3Vector& ray1,int& itBuff)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
     {
         float _itPCTM[12];
@@ -1000,6 +1123,7 @@ bool CPluginContainer::mesh_getTrianglePointDistance_ifSmaller(const C3Vector& a
 
 bool CPluginContainer::mesh_getRayProxSensorDistance_ifSmaller(const void* collInfo,const C4X4Matrix& selfPCTM,float &dist,const C3Vector& lp,float closeThreshold,const C3Vector& lvFar,float cosAngle,C3Vector& detectPoint,bool fast,bool frontFace,bool backFace,char* closeDetectionTriggered,C3Vector& triNormalNotNormalized,void* theOcclusionCheckCallback)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
     {
         float _selfPCTM[12];
@@ -1058,6 +1182,7 @@ bool CPluginContainer::mesh_isPointTouchingVolume(const C3Vector& p,const std::v
 
 bool CPluginContainer::mesh_getProxSensorDistance_ifSmaller(const void* collInfo,const C4X4Matrix& itPCTM,float &dist,const std::vector<float>* planes,const std::vector<float>* planesOutside,float cosAngle,C3Vector& detectPoint,bool fast,bool frontFace,bool backFace,std::vector<float>* cutEdges,C3Vector& triNormalNotNormalized,void* theOcclusionCheckCallback)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     if (currentMeshEngine!=NULL)
     {
         const float* _planes=NULL;
@@ -1149,9 +1274,9 @@ bool CPluginContainer::mesh_getProxSensorDistanceToTriangle_ifSmaller(const C3Ve
 
 float CPluginContainer::mesh_cutNodeWithVolume(void* collInfo,const C4X4Matrix& itPCTM,const std::vector<float>* planes)
 {
+    CMeshGeometryLock geometryLock(collInfo,true,NULL,false,true); // the display might read the structure at the same time
     if (currentMeshEngine!=NULL)
     {
-        EASYLOCK(_meshMutex);
         const float* _planes=NULL;
         int _planesSize=0;
         if ((planes!=NULL)&&(planes->size()!=0))
@@ -1183,6 +1308,7 @@ void* CPluginContainer::mesh_createColorPointCloud(const float* relPoints,int pt
 
 void* CPluginContainer::mesh_copyPointCloud(const void* pointCloudInfo)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_copyPointCloud(pointCloudInfo));
     return(NULL);
@@ -1190,18 +1316,21 @@ void* CPluginContainer::mesh_copyPointCloud(const void* pointCloudInfo)
 
 void CPluginContainer::mesh_destroyPointCloud(void* pointCloudInfo)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,true);
     if (currentMeshEngine!=NULL)
         currentMeshEngine->v_repMesh_destroyPointCloud(pointCloudInfo);
 }
 
 void CPluginContainer::mesh_scalePointCloud(void* pointCloudInfo,float scaleFactor)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,true);
     if (currentMeshEngine!=NULL)
         currentMeshEngine->v_repMesh_scalePointCloud(pointCloudInfo,scaleFactor);
 }
 
 void CPluginContainer::mesh_insertPointsIntoPointCloud(void* pointCloudInfo,const float* relPoints,int ptCnt,const float theColor[3],float distTolerance)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,true);
     unsigned char cols[3]={(unsigned char)(theColor[0]*255.0f),(unsigned char)(theColor[1]*255.0f),(unsigned char)(theColor[2]*255.0f)};
     if (currentMeshEngine!=NULL)
         currentMeshEngine->v_repMesh_insertPointsIntoPointCloud(pointCloudInfo,relPoints,ptCnt,cols,distTolerance);
@@ -1209,12 +1338,14 @@ void CPluginContainer::mesh_insertPointsIntoPointCloud(void* pointCloudInfo,cons
 
 void CPluginContainer::mesh_insertColorPointsIntoPointCloud(void* pointCloudInfo,const float* relPoints,int ptCnt,const unsigned char* theColors,float distTolerance)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,true);
     if (currentMeshEngine!=NULL)
         currentMeshEngine->v_repMesh_insertColorPointsIntoPointCloud(pointCloudInfo,relPoints,ptCnt,theColors,distTolerance);
 }
 
 bool CPluginContainer::mesh_removePointCloudPoints(void* pointCloudInfo,const float* relPoints,int ptCnt,float distTolerance,int& removedCnt)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,true);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_removePointCloudPoints(pointCloudInfo,relPoints,ptCnt,distTolerance,&removedCnt)!=0);
     return(false);
@@ -1222,6 +1353,7 @@ bool CPluginContainer::mesh_removePointCloudPoints(void* pointCloudInfo,const fl
 
 bool CPluginContainer::mesh_intersectPointCloudPoints(void* pointCloudInfo,const float* relPoints,int ptCnt,float distTolerance)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,true);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_intersectPointCloudPoints(pointCloudInfo,relPoints,ptCnt,distTolerance)!=0);
     return(false);
@@ -1229,6 +1361,7 @@ bool CPluginContainer::mesh_intersectPointCloudPoints(void* pointCloudInfo,const
 
 void CPluginContainer::mesh_getPointCloudDebugCorners(const void* pointCloudInfo,std::vector<float>& cubeCorners)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,false);
     cubeCorners.clear();
     if (currentMeshEngine!=NULL)
     {
@@ -1241,6 +1374,7 @@ void CPluginContainer::mesh_getPointCloudDebugCorners(const void* pointCloudInfo
 
 void CPluginContainer::mesh_getPointCloudSerializationData(const void* pointCloudInfo,std::vector<unsigned char>& data)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,false);
     data.clear();
     if (currentMeshEngine!=NULL)
     {
@@ -1280,6 +1414,7 @@ void* CPluginContainer::mesh_createOctreeFromColorPoints(const float* relPoints,
 
 void* CPluginContainer::mesh_copyOctree(const void* octreeInfo)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_copyOctree(octreeInfo));
     return(NULL);
@@ -1287,18 +1422,21 @@ void* CPluginContainer::mesh_copyOctree(const void* octreeInfo)
 
 void CPluginContainer::mesh_destroyOctree(void* octreeInfo)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,true);
     if (currentMeshEngine!=NULL)
         currentMeshEngine->v_repMesh_destroyOctree(octreeInfo);
 }
 
 void CPluginContainer::mesh_scaleOctree(void* octreeInfo,float scaleFactor)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,true);
     if (currentMeshEngine!=NULL)
         currentMeshEngine->v_repMesh_scaleOctree(octreeInfo,scaleFactor);
 }
 
 bool CPluginContainer::mesh_removeOctreeVoxelsFromPoints(void* octreeInfo,const float* relPoints,int ptCnt)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,true);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_removeOctreeVoxelsFromPoints(octreeInfo,relPoints,ptCnt)!=0);
     return(false);
@@ -1306,6 +1444,7 @@ bool CPluginContainer::mesh_removeOctreeVoxelsFromPoints(void* octreeInfo,const
 
 void CPluginContainer::mesh_insertPointsIntoOctree(void* octreeInfo,const float* relPoints,int ptCnt,const float theColor[3],unsigned int theTag)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,true);
     unsigned char cols[3]={(unsigned char)(theColor[0]*255.0f),(unsigned char)(theColor[1]*255.0f),(unsigned char)(theColor[2]*255.0f)};
     if (currentMeshEngine!=NULL)
         currentMeshEngine->v_repMesh_insertPointsIntoOctree(octreeInfo,relPoints,ptCnt,cols,theTag);
@@ -1313,12 +1452,14 @@ void CPluginContainer::mesh_insertPointsIntoOctree(void* octreeInfo,const float*
 
 void CPluginContainer::mesh_insertColorPointsIntoOctree(void* octreeInfo,const float* relPoints,int ptCnt,const unsigned char* theColors,const unsigned int* theTags)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,true);
     if (currentMeshEngine!=NULL)
         currentMeshEngine->v_repMesh_insertColorPointsIntoOctree(octreeInfo,relPoints,ptCnt,theColors,theTags);
 }
 
 void CPluginContainer::mesh_getOctreeVoxels(const void* octreeInfo,std::vector<float>& voxelPositions,std::vector<float>& voxelColors)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false);
     voxelPositions.clear();
     voxelColors.clear();
     if (currentMeshEngine!=NULL)
@@ -1341,6 +1482,7 @@ void CPluginContainer::mesh_getOctreeVoxels(const void* octreeInfo,std::vector<f
 
 void CPluginContainer::mesh_getPointCloudPointData(const void* pointCloudInfo,std::vector<float>& pointPositions,std::vector<float>& pointColors)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,false);
     pointPositions.clear();
     pointColors.clear();
     if (currentMeshEngine!=NULL)
@@ -1363,6 +1505,7 @@ void CPluginContainer::mesh_getPointCloudPointData(const void* pointCloudInfo,st
 
 void CPluginContainer::mesh_getPartialPointCloudPointData(const void* pointCloudInfo,std::vector<float>& pointPositions,std::vector<float>& pointColors,float ratio)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,false);
     pointPositions.clear();
     pointColors.clear();
     if (currentMeshEngine!=NULL)
@@ -1385,6 +1528,7 @@ void CPluginContainer::mesh_getPartialPointCloudPointData(const void* pointCloud
 
 void CPluginContainer::mesh_getOctreeDebugCorners(const void* octreeInfo,std::vector<float>& cubeCorners)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false);
     cubeCorners.clear();
     if (currentMeshEngine!=NULL)
     {
@@ -1397,6 +1541,7 @@ void CPluginContainer::mesh_getOctreeDebugCorners(const void* octreeInfo,std::ve
 
 void CPluginContainer::mesh_getOctreeSerializationData(const void* octreeInfo,std::vector<unsigned char>& data)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false);
     data.clear();
     if (currentMeshEngine!=NULL)
     {
@@ -1419,6 +1564,7 @@ void* CPluginContainer::mesh_getOctreeFromSerializationData(const std::vector<un
 
 void* CPluginContainer::mesh_createOctreeFromShape(const C4X4Matrix& octreePCTM,const void* collInfo,const C4X4Matrix& collnodePCTM,float cellSize,const float theColor[3],unsigned int theTag)
 {
+    CMeshGeometryLock geometryLock(collInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1434,6 +1580,7 @@ void* CPluginContainer::mesh_createOctreeFromShape(const C4X4Matrix& octreePCTM,
 
 bool CPluginContainer::mesh_removeOctreeVoxelsFromShape(void* octreeInfo,const C4X4Matrix& octreePCTM,const void* collInfo,const C4X4Matrix& collnodePCTM)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,true,collInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1447,6 +1594,7 @@ bool CPluginContainer::mesh_removeOctreeVoxelsFromShape(void* octreeInfo,const C
 
 void CPluginContainer::mesh_insertShapeIntoOctree(void* octreeInfo,const C4X4Matrix& octreePCTM,const void* collInfo,const C4X4Matrix& collnodePCTM,const float theColor[3],unsigned int theTag)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,true,collInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1461,6 +1609,7 @@ void CPluginContainer::mesh_insertShapeIntoOctree(void* octreeInfo,const C4X4Mat
 
 void* CPluginContainer::mesh_createOctreeFromOctree(const C4X4Matrix& octreePCTM,const void* octree2Info,const C4X4Matrix& octree2PCTM,float cellSize,const float theColor[3],unsigned int theTag)
 {
+    CMeshGeometryLock geometryLock(octree2Info,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1476,6 +1625,7 @@ void* CPluginContainer::mesh_createOctreeFromOctree(const C4X4Matrix& octreePCTM
 
 bool CPluginContainer::mesh_removeOctreeVoxelsFromOctree(void* octreeInfo,const C4X4Matrix& octreePCTM,const void* octree2Info,const C4X4Matrix& octree2PCTM)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,true,octree2Info,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1489,6 +1639,7 @@ bool CPluginContainer::mesh_removeOctreeVoxelsFromOctree(void* octreeInfo,const
 
 void CPluginContainer::mesh_insertOctreeIntoOctree(void* octreeInfo,const C4X4Matrix& octreePCTM,const void* octree2Info,const C4X4Matrix& octree2PCTM,const float theColor[3],unsigned int theTag)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,true,octree2Info,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1503,6 +1654,7 @@ void CPluginContainer::mesh_insertOctreeIntoOctree(void* octreeInfo,const C4X4Ma
 
 bool CPluginContainer::mesh_checkOctreeCollisionWithShape(const void* octreeInfo,const C4X4Matrix& octreePCTM,const void* collInfo,const C4X4Matrix& collNodePCTM)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false,collInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1516,6 +1668,7 @@ bool CPluginContainer::mesh_checkOctreeCollisionWithShape(const void* octreeInfo
 
 bool CPluginContainer::mesh_checkOctreeCollisionWithOctree(const void* octree1Info,const C4X4Matrix& octree1PCTM,const void* octree2Info,const C4X4Matrix& octree2PCTM)
 {
+    CMeshGeometryLock geometryLock(octree1Info,false,octree2Info,false);
     float _octree1PCTM[12];
     octree1PCTM.copyToInterface(_octree1PCTM);
 
@@ -1529,6 +1682,7 @@ bool CPluginContainer::mesh_checkOctreeCollisionWithOctree(const void* octree1In
 
 bool CPluginContainer::mesh_checkOctreeCollisionWithSeveralPoints(const void* octreeInfo,const C4X4Matrix& octreePCTM,const float* absPoints,int ptCnt)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1539,6 +1693,7 @@ bool CPluginContainer::mesh_checkOctreeCollisionWithSeveralPoints(const void* oc
 
 bool CPluginContainer::mesh_checkOctreeCollisionWithSinglePoint(const void* octreeInfo,const C4X4Matrix& octreePCTM,const C3Vector& absPoint,unsigned int* tag,unsigned long long int* location)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1549,6 +1704,7 @@ bool CPluginContainer::mesh_checkOctreeCollisionWithSinglePoint(const void* octr
 
 bool CPluginContainer::mesh_checkOctreeCollisionWithPointCloud(const void* octreeInfo,const C4X4Matrix& octreePCTM,const void* pointCloudInfo,const C4X4Matrix& pointCloudPCTM)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false,pointCloudInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1562,6 +1718,7 @@ bool CPluginContainer::mesh_checkOctreeCollisionWithPointCloud(const void* octre
 
 bool CPluginContainer::mesh_getPointCloudDistanceToPointIfSmaller(const void* pointCloudInfo,const C4X4Matrix& pointCloudPCTM,const C3Vector& absPoint,float ray[7],long long int& cacheValue)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,false);
     float _pointCloudPCTM[12];
     pointCloudPCTM.copyToInterface(_pointCloudPCTM);
 
@@ -1572,6 +1729,7 @@ bool CPluginContainer::mesh_getPointCloudDistanceToPointIfSmaller(const void* po
 
 bool CPluginContainer::mesh_getPointCloudDistanceToPointCloudIfSmaller(const void* pointCloudInfo1,const void* pointCloudInfo2,const C4X4Matrix& thisPcPCTM,const C4X4Matrix& otherPcPCTM,float ray[7],long long int& thisCacheValue,long long int& otherCacheValue)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo1,false,pointCloudInfo2,false);
     float _pointCloud1PCTM[12];
     thisPcPCTM.copyToInterface(_pointCloud1PCTM);
 
@@ -1585,6 +1743,7 @@ bool CPluginContainer::mesh_getPointCloudDistanceToPointCloudIfSmaller(const voi
 
 float* CPluginContainer::mesh_getPointCloudPointsFromCache(const void* pointCloudInfo,const C4X4Matrix& pointCloudPCTM,const long long int cacheValue,int& ptCnt,C4X4Matrix& ptsRetToThisM)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,false);
     float _pointCloudPCTM[12];
     pointCloudPCTM.copyToInterface(_pointCloudPCTM);
 
@@ -1602,6 +1761,7 @@ float* CPluginContainer::mesh_getPointCloudPointsFromCache(const void* pointClou
 
 int CPluginContainer::mesh_getPointCloudNonEmptyCellCount(const void* pointCloudInfo)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,false);
     if (currentMeshEngine!=NULL)
         return(currentMeshEngine->v_repMesh_getPointCloudNonEmptyCellCount(pointCloudInfo));
     return(0);
@@ -1609,6 +1769,7 @@ int CPluginContainer::mesh_getPointCloudNonEmptyCellCount(const void* pointCloud
 
 bool CPluginContainer::mesh_getOctreeDistanceToPointIfSmaller(const void* octreeInfo,const C4X4Matrix& octreePCTM,const C3Vector& absPoint,float ray[7],long long int& cacheValue)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1619,6 +1780,7 @@ bool CPluginContainer::mesh_getOctreeDistanceToPointIfSmaller(const void* octree
 
 bool CPluginContainer::mesh_getOctreeCellFromCache(const void* octreeInfo,const C4X4Matrix& octreePCTM,const long long int cacheValue,float& cellSize,C4X4Matrix& cellRetToThisM)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1636,6 +1798,7 @@ bool CPluginContainer::mesh_getOctreeCellFromCache(const void* octreeInfo,const
 
 bool CPluginContainer::mesh_getOctreeDistanceToOctreeIfSmaller(const void* octreeInfo1,const void* octreeInfo2,const C4X4Matrix& octree1PCTM,const C4X4Matrix& octree2PCTM,float ray[7],long long int& octree1CacheValue,long long int& octree2CacheValue,bool weHaveSomeCoherency)
 {
+    CMeshGeometryLock geometryLock(octreeInfo1,false,octreeInfo2,false);
     float _octree1PCTM[12];
     octree1PCTM.copyToInterface(_octree1PCTM);
 
@@ -1649,6 +1812,7 @@ bool CPluginContainer::mesh_getOctreeDistanceToOctreeIfSmaller(const void* octre
 
 bool CPluginContainer::mesh_getOctreeDistanceToPointCloudIfSmaller(const void* octreeInfo,const void* pointCloudInfo,const C4X4Matrix& octreePCTM,const C4X4Matrix& pointCloudPCTM,float ray[7],long long int& octreeCacheValue,long long int& pointCloudCacheValue)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false,pointCloudInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1662,6 +1826,7 @@ bool CPluginContainer::mesh_getOctreeDistanceToPointCloudIfSmaller(const void* o
 
 bool CPluginContainer::mesh_getOctreeDistanceToShapeIfSmaller(const void* octreeInfo,const void* collInfo,const C4X4Matrix& octreePCTM,const C4X4Matrix& collNodePCTM,float ray[7],long long int& octreeCacheValue,int& collNodeCacheValue)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false,collInfo,false);
     float _octreePCTM[12];
     octreePCTM.copyToInterface(_octreePCTM);
 
@@ -1682,6 +1847,7 @@ bool CPluginContainer::mesh_getMinDistBetweenCubeAndTriangleIfSmaller(float cube
 
 bool CPluginContainer::mesh_getPointCloudDistanceToShapeIfSmaller(const void* pointCloudInfo,const void* collInfo,const C4X4Matrix& pointCloudPCTM,const C4X4Matrix& collNodePCTM,float ray[7],long long int& pointCloudCacheValue,int& collNodeCacheValue)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,false,collInfo,false);
     float _pointCloudPCTM[12];
     pointCloudPCTM.copyToInterface(_pointCloudPCTM);
 
@@ -1713,6 +1879,7 @@ float CPluginContainer::mesh_getBoxBoxDistance(const C4X4Matrix& m1,const C3Vect
 
 bool CPluginContainer::mesh_getProxSensorPointCloudDistanceIfSmaller(const void* pointCloudInfo,const C4X4Matrix& pointCloudPCTM,float &dist,const std::vector<float>* planes,const std::vector<float>* planesOutside,C3Vector& detectPoint,bool fast,void* theOcclusionCheckCallback)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,false);
     if (currentMeshEngine!=NULL)
     {
         const float* _planes=NULL;
@@ -1738,6 +1905,7 @@ bool CPluginContainer::mesh_getProxSensorPointCloudDistanceIfSmaller(const void*
 
 bool CPluginContainer::mesh_getRayProxSensorOctreeDistanceIfSmaller(const void* octreeInfo,const C4X4Matrix& octreePCTM,float &dist,const C3Vector& lp,const C3Vector& lvFar,float cosAngle,C3Vector& detectPoint,bool fast,bool frontFace,bool backFace,C3Vector& triNormalNotNormalized,void* theOcclusionCheckCallback)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false);
     if (currentMeshEngine!=NULL)
     {
         float _octreePCTM[12];
@@ -1757,6 +1925,7 @@ bool CPluginContainer::mesh_getRayProxSensorOctreeDistanceIfSmaller(const void*
 
 bool CPluginContainer::mesh_getProxSensorOctreeDistanceIfSmaller(const void* octreeInfo,const C4X4Matrix& octreeRTM,float& dist,const std::vector<float>* planes,const std::vector<float>* planesOutside,float cosAngle,C3Vector& detectPoint,bool fast,bool frontFace,bool backFace,C3Vector& triNormalNotNormalized,void* theOcclusionCheckCallback)
 {
+    CMeshGeometryLock geometryLock(octreeInfo,false);
     if (currentMeshEngine!=NULL)
     {
         const float* _planes=NULL;
@@ -1782,6 +1951,7 @@ bool CPluginContainer::mesh_getProxSensorOctreeDistanceIfSmaller(const void* oct
 
 bool CPluginContainer::mesh_removePointCloudPointsFromOctree(void* pointCloudInfo,const C4X4Matrix& pointCloudPCTM,const void* octreeInfo,const C4X4Matrix& octreePCTM,int& removedCnt)
 {
+    CMeshGeometryLock geometryLock(pointCloudInfo,true,octreeInfo,false);
     float _pointCloudPCTM[12];
     pointCloudPCTM.copyToInterface(_pointCloudPCTM);
 
@@ -320,7 +320,11 @@ public:
     // mesh calc engine:
     static CPlugin* currentMeshEngine;
     static bool isMeshPluginAvailable();
-    static void mesh_lockUnlock(bool lock);
+    static void mesh_lockUnlock(const void* geometry,bool lock);
+    static void mesh_setConcurrentAccess(bool concurrent); // geometry locks are only taken while this is active
+    static bool mesh_isConcurrentAccessActive();
+    static void mesh_getLockStatistics(unsigned int& lockCount,unsigned int& contentionCount);
+    static void mesh_resetLockStatistics();
     static void* mesh_createCollisionInformationStructure(const float* cumulMeshVertices,int cumulMeshVerticesSize,const int* cumulMeshIndices,int cumulMeshIndicesSize,float maxTriSize,float edgeAngle,int maxTriCount);
     static void* mesh_copyCollisionInformationStructure(const void* collInfo);
     static void mesh_destroyCollisionInformationStructure(void* collInfo);
@@ -450,6 +454,7 @@ public:
 private:
     static int _nextHandle;
     static std::vector<CPlugin*> _allPlugins;
+    static int _meshConcurrentAccessCount;
 
     static std::vector<std::string> _renderingpass_eventEnabledPluginNames;
     static std::vector<std::string> _opengl_eventEnabledPluginNames;
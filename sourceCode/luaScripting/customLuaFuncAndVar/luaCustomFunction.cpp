@@ -1,6 +1,7 @@
 
 #include "vrepMainHeader.h"
 #include "luaCustomFunction.h"
+#include "luaScriptFunctions.h"
 
 CLuaCustomFunction::CLuaCustomFunction(const char* theFullFunctionName,const char* theCallTips,std::vector<int>& theInputArgTypes,void(*callBack)(struct SLuaCallBack* p))
 { // the old way, called through simRegisterCustomLuaFunction
@@ -70,30 +71,10 @@ void CLuaCustomFunction::registerCustomLuaFunction(luaWrap_lua_State* L,luaWrap_
 {
     if (hasCallback())
     {
-        size_t p=functionName.find(".");
-        if (p!=std::string::npos)
-        { // this is the new notation, e.g. simUI.create()
-            std::string prefix(functionName.begin(),functionName.begin()+p);
-
-            luaWrap_lua_pushnumber(L,functionID+1);
-            luaWrap_lua_pushcclosure(L,func,1);
-            luaWrap_lua_setfield(L,luaWrapGet_LUA_GLOBALSINDEX(),"__iuafkjsdgoi158zLK");
-
-            std::string tmp("if not ");
-            tmp+=prefix;
-            tmp+=" then ";
-            tmp+=prefix;
-            tmp+="={} end ";
-            tmp+=functionName;
-            tmp+="=__iuafkjsdgoi158zLK __iuafkjsdgoi158zLK=nil";
-            luaWrap_luaL_dostring(L,tmp.c_str());
-        }
-        else
-        {
-            luaWrap_lua_pushnumber(L,functionID+1);
-            luaWrap_lua_pushcclosure(L,func,1);
-            luaWrap_lua_setfield(L,luaWrapGet_LUA_GLOBALSINDEX(),functionName.c_str());
-        }
+        // also handles the new notation, e.g. simUI.create() (the table is created if needed):
+        luaWrap_lua_pushnumber(L,functionID+1);
+        luaWrap_lua_pushcclosure(L,func,1);
+        assignLuaVariableFromStack(L,functionName.c_str());
     }
 }
 
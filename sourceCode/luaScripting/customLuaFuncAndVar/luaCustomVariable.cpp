@@ -2,6 +2,8 @@
 #include "vrepMainHeader.h"
 #include "luaCustomVariable.h"
 #include "app.h"
+#include "tt.h"
+#include "luaScriptFunctions.h"
 
 CLuaCustomVariable::CLuaCustomVariable(const char* theFullVariableName,const char* theVariableValue,int theVariableStackValue)
 {
@@ -45,9 +47,18 @@ void CLuaCustomVariable::pushVariableOntoLuaStack(luaWrap_lua_State* L,bool hand
             doIt=true;
         if (doIt)
         {
-            std::string tmp(_variableName);
-            tmp+="="+_variableValue;
-            luaWrap_luaL_dostring(L,tmp.c_str());
+            int v;
+            if (tt::stringToInt(_variableValue.c_str(),v))
+            { // most variables are integer constants: no need to compile a Lua snippet
+                luaWrap_lua_pushinteger(L,v);
+                assignLuaVariableFromStack(L,_variableName.c_str());
+            }
+            else
+            {
+                std::string tmp(_variableName);
+                tmp+="="+_variableValue;
+                luaWrap_luaL_dostring(L,tmp.c_str());
+            }
         }
     }
     else
@@ -12,11 +12,15 @@
 #include "app.h"
 #include "apiErrors.h"
 #include "pluginContainer.h"
+#include "stepProfiler.h"
 
 int CLuaScriptObject::_nextIdForExternalScriptEditor=-1;
 bool CLuaScriptObject::emergencyStopButtonPressed=false;
 VMutex CLuaScriptObject::_globalMutex;
 std::vector<CLuaScriptObject*> CLuaScriptObject::toBeCalledByThread;
+volatile unsigned int CLuaScriptObject::_watchdogTimerTick=0;
+volatile bool CLuaScriptObject::_watchdogTimerRunning=false;
+volatile bool CLuaScriptObject::_watchdogTimerShouldEnd=false;
 
 CLuaScriptObject::CLuaScriptObject(int scriptTypeOrMinusOneForSerialization)
 {
@@ -43,6 +47,9 @@ CLuaScriptObject::CLuaScriptObject(int scriptTypeOrMinusOneForSerialization)
     _executionOrder=sim_scriptexecorder_normal;
     _debugLevel=0;
     _inDebug=false;
+    _watchdogHook=false;
+    _watchdogLastTimerTick=0;
+    _watchdogRandomSeed=(unsigned int)(size_t)this;
     _treeTraversalDirection=0; // reverse by default
     _customizationScriptIsTemporarilyDisabled=false;
     _custScriptDisabledDSim_compatibilityMode=false;
@@ -72,6 +79,8 @@ CLuaScriptObject::CLuaScriptObject(int scriptTypeOrMinusOneForSerialization)
     _containsJointCallbackFunction=false;
     _containsContactCallbackFunction=false;
     _containsDynCallbackFunction=false;
+    _systemCallbackPresence=~suint64(0);
+    _systemCallbackPresenceCheckTime=0;
 
 
     L=NULL;
@@ -89,7 +98,7 @@ CLuaScriptObject::CLuaScriptObject(int scriptTypeOrMinusOneForSerialization)
     {
         scriptID=SIM_IDSTART_SANDBOXSCRIPT;
         _errorReportMode=sim_api_error_output|sim_api_warning_output;
-        L=initializeNewLuaState(getScriptSuffixNumberString().c_str(),_debugLevel);
+        _initializeNewLuaState(getScriptSuffixNumberString().c_str());
         std::string tmp("sim_current_script_id=");
         tmp+=boost::lexical_cast<std::string>(getScriptID());
         luaWrap_luaL_dostring(L,tmp.c_str());
@@ -574,6 +583,41 @@ bool CLuaScriptObject::getContainsDynCallbackFunction() const
     return(_containsDynCallbackFunction);
 }
 
+bool CLuaScriptObject::getContainsSystemCallbackFunction(int callType)
+{ // true if unknown (e.g. script not yet initialized, or old calling method). A callback can also be defined
+  // later (e.g. by another callback, via require, or by another script): missing callbacks are looked up again
+  // if the last check is older than half a second
+    if ( (callType<0)||(callType>=64) )
+        return(true);
+    if (((_systemCallbackPresence>>callType)&1)!=0)
+        return(true);
+    if ( (L!=NULL)&&(VDateTime::getTimeDiffInMs(_systemCallbackPresenceCheckTime)>500) )
+    {
+        _recordSystemCallbackPresence();
+        return(((_systemCallbackPresence>>callType)&1)!=0);
+    }
+    return(false);
+}
+
+void CLuaScriptObject::_recordSystemCallbackPresence()
+{ // Called once sysCall_init ran, then again from time to time. Callbacks that have a sysCallEx_ counterpart are always flagged as present
+    _systemCallbackPresenceCheckTime=VDateTime::getTimeInMs();
+    _systemCallbackPresence=0;
+    for (int i=0;i<64;i++)
+    {
+        bool present=true;
+        std::string funcName(getSystemCallbackString(i,false));
+        if ( (funcName.size()>0)&&(getSystemCallbackExString(i).size()==0) )
+        {
+            luaWrap_lua_getglobal(L,funcName.c_str());
+            present=luaWrap_lua_isfunction(L,-1);
+            luaWrap_lua_pop(L,1);
+        }
+        if (present)
+            _systemCallbackPresence|=suint64(1)<<i;
+    }
+}
+
 int CLuaScriptObject::getErrorReportMode() const
 {
     return(_errorReportMode);
@@ -877,6 +921,7 @@ bool CLuaScriptObject::hasCustomizationScripAnyChanceToGetExecuted(bool whenSimu
 void CLuaScriptObject::setExecutionOrder(int order)
 {
     _executionOrder=tt::getLimitedInt(sim_scriptexecorder_first,sim_scriptexecorder_last,order);
+    CLuaScriptContainer::incrementScriptExecutionPlanValidityNumber();
 }
 
 int CLuaScriptObject::getExecutionOrder() const
@@ -897,6 +942,7 @@ int CLuaScriptObject::getDebugLevel() const
 void CLuaScriptObject::setTreeTraversalDirection(int dir)
 {
     _treeTraversalDirection=tt::getLimitedInt(sim_scripttreetraversal_reverse,sim_scripttreetraversal_parent,dir);
+    CLuaScriptContainer::incrementScriptExecutionPlanValidityNumber();
 }
 
 int CLuaScriptObject::getTreeTraversalDirection() const
@@ -937,6 +983,7 @@ void CLuaScriptObject::setScriptIsDisabled(bool isDisabled)
     }
     else
         _scriptIsDisabled=false;
+    CLuaScriptContainer::incrementScriptExecutionPlanValidityNumber();
 }
 
 bool CLuaScriptObject::getScriptIsDisabled() const
@@ -1284,6 +1331,7 @@ void CLuaScriptObject::setThreadedExecution(bool threadedExec)
     }
     else
         _threadedExecution=false;
+    CLuaScriptContainer::incrementScriptExecutionPlanValidityNumber();
 }
 
 bool CLuaScriptObject::getThreadedExecution() const
@@ -1303,6 +1351,7 @@ void CLuaScriptObject::perform3DObjectLoadingMapping(std::vector<int>* map)
         _objectIDAttachedTo_child=App::ct->objCont->getLoadingMapping(map,_objectIDAttachedTo_child);
         _objectIDAttachedTo_callback=App::ct->objCont->getLoadingMapping(map,_objectIDAttachedTo_callback);
         _objectIDAttachedTo_customization=App::ct->objCont->getLoadingMapping(map,_objectIDAttachedTo_customization);
+        CLuaScriptContainer::incrementScriptExecutionPlanValidityNumber();
     }
 }
 
@@ -1319,6 +1368,7 @@ bool CLuaScriptObject::announce3DObjectWillBeErased(int objectID,bool copyBuffer
                 App::mainWindow->scintillaEditorContainer->closeEditor(scriptID);
 #endif
             _objectIDAttachedTo_child=-1; // This is for a potential threaded simulation running
+            CLuaScriptContainer::incrementScriptExecutionPlanValidityNumber();
             _flaggedForDestruction=true;
             return(!_inExecutionNow); // from false to !_inExecutionNow on 8/9/2016
         }
@@ -1385,11 +1435,13 @@ void CLuaScriptObject::setObjectIDThatScriptIsAttachedTo_child(int newObjectID)
     _objectIDAttachedTo_child=newObjectID;
     if (newObjectID!=-1)
         _scriptType=sim_scripttype_childscript;
+    CLuaScriptContainer::incrementScriptExecutionPlanValidityNumber();
 }
 
 void CLuaScriptObject::setObjectIDThatScriptIsAttachedTo_customization(int newObjectID)
 {
     _objectIDAttachedTo_customization=newObjectID;
+    CLuaScriptContainer::incrementScriptExecutionPlanValidityNumber();
 }
 
 int CLuaScriptObject::getNumberOfPasses() const
@@ -1578,7 +1630,7 @@ void CLuaScriptObject::_launchThreadedChildScriptNow()
     {
         _errorReportMode=sim_api_error_output|sim_api_warning_output;
         _lastErrorString=SIM_API_CALL_NO_ERROR;
-        L=initializeNewLuaState(getScriptSuffixNumberString().c_str(),_debugLevel);
+        _initializeNewLuaState(getScriptSuffixNumberString().c_str());
     }
     int oldTop=luaWrap_lua_gettop(L);   // We store lua's stack
 
@@ -1750,7 +1802,7 @@ int CLuaScriptObject::_runScriptOrCallScriptFunction(int callType,const CInterfa
     {
         _errorReportMode=sim_api_error_output|sim_api_warning_output;
         _lastErrorString=SIM_API_CALL_NO_ERROR;
-        L=initializeNewLuaState(getScriptSuffixNumberString().c_str(),_debugLevel);
+        _initializeNewLuaState(getScriptSuffixNumberString().c_str());
         if (_checkIfMixingOldAndNewCallMethods())
         {
             std::string msg("Warning: [");
@@ -1896,6 +1948,8 @@ int CLuaScriptObject::_runScriptOrCallScriptFunction(int callType,const CInterfa
             retVal=0;
         }
         _handleSimpleSysExCalls(callType);
+        if (callType==sim_syscb_init)
+            _recordSystemCallbackPresence(); // sysCall_init might have defined other callbacks
     }
     luaWrap_lua_settop(L,oldTop);       // We restore lua's stack
     CApiErrors::popLocation(); // for correct error handling (i.e. assignement to the correct script and output)
@@ -2493,6 +2547,8 @@ void CLuaScriptObject::killLuaState()
     _containsJointCallbackFunction=false;
     _containsContactCallbackFunction=false;
     _containsDynCallbackFunction=false;
+    _systemCallbackPresence=~suint64(0);
+    _systemCallbackPresenceCheckTime=0;
     _flaggedForDestruction=false;
 }
 
@@ -3142,6 +3198,115 @@ int CLuaScriptObject::appendTableEntry(const char* arrayName,const char* keyName
     return(0);
 }
 
+void CLuaScriptObject::_initializeNewLuaState(const char* scriptSuffixNumberString)
+{ // creation time shows in the step profiler (e.g. when many child scripts are initialized in the first step)
+    bool profile=CStepProfiler::isEnabled();
+    suint64 profilerStartTime=0;
+    if (profile)
+        profilerStartTime=VDateTime::getTimeInUs();
+    _watchdogHook=App::userSettings->luaWatchdogHook;
+    if (_watchdogHook)
+        _startWatchdogTimerIfNeeded();
+    L=initializeNewLuaState(scriptSuffixNumberString,_debugLevel,_watchdogHook);
+    setScriptObjectInLuaRegistry(L,this);
+    if (profile)
+        CStepProfiler::recordEvent(PROFILER_CATEGORY_SCRIPT_STATE,scriptID,profilerStartTime,VDateTime::getTimeInUs()-profilerStartTime);
+}
+
+bool CLuaScriptObject::getWatchdogHookEnabled()
+{
+    return(_watchdogHook);
+}
+
+bool CLuaScriptObject::isWatchdogCheckDue()
+{ // used by the Lua hook in watchdog mode: true at most once per tick of the watchdog timer (i.e. once per millisecond)
+    unsigned int t=_watchdogTimerTick;
+    if (t==_watchdogLastTimerTick)
+        return(false);
+    _watchdogLastTimerTick=t;
+    return(true);
+}
+
+int CLuaScriptObject::getNextWatchdogHookCount()
+{ // LUA_WATCHDOG_HOOK_COUNT +-10%. The random component avoids that the hook always hits the same
+  // location in a loop (e.g. where automatic thread switches are forbidden). No rand() here, it is
+  // not thread-safe on all platforms and is shared with the user
+    _watchdogRandomSeed=_watchdogRandomSeed*1103515245+12345;
+    int r=int((_watchdogRandomSeed>>16)%(LUA_WATCHDOG_HOOK_COUNT/5+1));
+    return(LUA_WATCHDOG_HOOK_COUNT-LUA_WATCHDOG_HOOK_COUNT/10+r);
+}
+
+void CLuaScriptObject::runHookBenchmark()
+{ // Times a tight Lua loop in the sandbox script without hook, with the regular hook, and with the watchdog hook
+    CLuaScriptObject* script=App::ct->sandboxScript;
+    if ( (script==NULL)||(script->L==NULL) )
+        return;
+    luaWrap_lua_State* L=script->L;
+    const char* code="local a=0 for i=1,20000000,1 do a=a+i*0.5 end";
+    const char* modeNames[3]={"no hook","regular hook","watchdog hook"};
+    bool watchdogHook=script->_watchdogHook;
+    float times[3];
+    for (int mode=0;mode<3;mode++)
+    { // only the sandbox script's hook mode is changed
+        if (mode==0)
+            luaWrap_lua_sethook(L,luaHookFunction,0,0);
+        else
+        {
+            script->_watchdogHook=(mode==2);
+            if (script->_watchdogHook)
+                _startWatchdogTimerIfNeeded();
+            setLuaHook(L,sim_scriptdebug_none,script->_watchdogHook);
+        }
+        int oldTop=luaWrap_lua_gettop(L);
+        suint64 startTime=VDateTime::getTimeInUs();
+        luaWrap_luaL_dostring(L,code);
+        times[mode]=float(VDateTime::getTimeInUs()-startTime)/1000.0f;
+        luaWrap_lua_settop(L,oldTop);
+    }
+    script->_watchdogHook=watchdogHook;
+    setLuaHook(L,script->_debugLevel,watchdogHook); // same hook mask and count as before the benchmark
+    for (int mode=0;mode<3;mode++)
+    {
+        std::string txt("Lua hook benchmark (");
+        txt+=std::string(modeNames[mode])+"): ";
+        txt+=tt::FNb(0,times[mode],2,false)+" ms";
+        if (mode>0)
+            txt+=" (overhead: "+tt::FNb(0,100.0f*(times[mode]-times[0])/SIM_MAX(times[0],0.001f),1,false)+"%)";
+        App::addStatusbarMessage(txt);
+    }
+}
+
+void CLuaScriptObject::_startWatchdogTimerIfNeeded()
+{
+    _globalMutex.lock();
+    if (!_watchdogTimerRunning)
+    {
+        _watchdogTimerShouldEnd=false;
+        _watchdogTimerRunning=true;
+        VThread::launchThread(_watchdogTimerThread,false);
+    }
+    _globalMutex.unlock();
+}
+
+void CLuaScriptObject::stopWatchdogTimer()
+{
+    _watchdogTimerShouldEnd=true;
+    while (_watchdogTimerRunning)
+        VThread::sleep(1);
+}
+
+VTHREAD_RETURN_TYPE CLuaScriptObject::_watchdogTimerThread(VTHREAD_ARGUMENT_TYPE lpData)
+{ // the Lua hook in watchdog mode only compares _watchdogTimerTick, instead of reading the clock
+    while (!_watchdogTimerShouldEnd)
+    {
+        VThread::sleep(1);
+        _watchdogTimerTick++;
+    }
+    _watchdogTimerRunning=false;
+    VThread::endThread();
+    return(VTHREAD_RETURN_VAL);
+}
+
 void CLuaScriptObject::handleDebug(const char* funcName,const char* funcType,bool inCall,bool sysCall)
 {
     if ( (_debugLevel!=sim_scriptdebug_none) && (!_inDebug) && (funcName!=NULL) )
@@ -3213,6 +3378,10 @@ int CLuaScriptObject::_luaPCall(luaWrap_lua_State* luaState,int nargs,int nresul
     bool firstCall=_timeOfPcallStart==-1;
     if (firstCall)
         _timeOfPcallStart=VDateTime::getTimeInMs();
+    bool profile=firstCall&&(!_threadedExecution)&&CStepProfiler::isEnabled(); // threaded scripts span several steps
+    suint64 profilerStartTime=0;
+    if (profile)
+        profilerStartTime=VDateTime::getTimeInUs();
     _inExecutionNow=true;
     handleDebug(funcName,"Lua",true,true);
     int retVal=luaWrap_lua_pcall(luaState,nargs,nresult,errfunc);
@@ -3220,6 +3389,8 @@ int CLuaScriptObject::_luaPCall(luaWrap_lua_State* luaState,int nargs,int nresul
     _inExecutionNow=false;
     if (firstCall)
         _timeOfPcallStart=-1;
+    if (profile)
+        CStepProfiler::recordEvent(PROFILER_CATEGORY_SCRIPT,scriptID,profilerStartTime,VDateTime::getTimeInUs()-profilerStartTime);
     return(retVal);
 }
 
@@ -3281,7 +3452,7 @@ void CLuaScriptObject::_runJointCtrlCallback_OLD(int callType,const std::vector<
     {
         _errorReportMode=sim_api_error_output|sim_api_warning_output;
         _lastErrorString=SIM_API_CALL_NO_ERROR;
-        L=initializeNewLuaState(getScriptSuffixNumberString().c_str(),_debugLevel);
+        _initializeNewLuaState(getScriptSuffixNumberString().c_str());
         callType=sim_syscb_init;
     }
 
@@ -3492,7 +3663,7 @@ int CLuaScriptObject::runContactCallback_OLD(const int inDataInt[3],int outDataI
     {
         _errorReportMode=sim_api_error_output|sim_api_warning_output;
         _lastErrorString=SIM_API_CALL_NO_ERROR;
-        L=initializeNewLuaState("",_debugLevel);
+        _initializeNewLuaState("");
     }
 
     int oldTop=luaWrap_lua_gettop(L);   // We store lua's stack
@@ -3569,7 +3740,7 @@ int CLuaScriptObject::runGeneralCallback_OLD(int callbackId,int callbackTag,void
     {
         _errorReportMode=sim_api_error_output|sim_api_warning_output;
         _lastErrorString=SIM_API_CALL_NO_ERROR;
-        L=initializeNewLuaState("",_debugLevel);
+        _initializeNewLuaState("");
     }
 
     int oldTop=luaWrap_lua_gettop(L);   // We store lua's stack
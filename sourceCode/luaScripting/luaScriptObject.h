@@ -65,6 +65,11 @@ public:
     int runSandboxScript(int callType);
 
     void handleDebug(const char* funcName,const char* funcType,bool inCall,bool sysCall);
+    bool getWatchdogHookEnabled();
+    bool isWatchdogCheckDue();
+    int getNextWatchdogHookCount();
+    static void runHookBenchmark();
+    static void stopWatchdogTimer();
 
     int callScriptFunction(const char* functionName, SLuaCallBack* pdata);
     int callScriptFunctionEx(const char* functionName,CInterfaceStack* stack);
@@ -156,6 +161,7 @@ public:
     bool getContainsJointCallbackFunction() const;
     bool getContainsContactCallbackFunction() const;
     bool getContainsDynCallbackFunction() const;
+    bool getContainsSystemCallbackFunction(int callType);
 
 
     std::string getFilenameForExternalScriptEditor() const;
@@ -193,6 +199,8 @@ protected:
     int _runAddOn(int callType,const CInterfaceStack* inStack,CInterfaceStack* outStack);
     int _runScriptOrCallScriptFunction(int callType,const CInterfaceStack* inStack,CInterfaceStack* outStack,std::string* errorMsg,bool* hasJointCallbackFunc,bool* hasContactCallbackFunc,bool* hasDynCallbackFunc);
     void _handleSimpleSysExCalls(int callType);
+    void _recordSystemCallbackPresence();
+    void _initializeNewLuaState(const char* scriptSuffixNumberString);
 
     bool _prepareLuaStateAndCallScriptInitSectionIfNeeded();
     bool _checkIfMixingOldAndNewCallMethods();
@@ -210,6 +218,9 @@ protected:
     int _executionOrder;
     int _debugLevel;
     bool _inDebug;
+    bool _watchdogHook; // see user settings. Fixed when the Lua state is created
+    unsigned int _watchdogLastTimerTick;
+    unsigned int _watchdogRandomSeed;
     int _treeTraversalDirection;
     int _objectIDAttachedTo_child;
     int _objectIDAttachedTo_callback;
@@ -247,6 +258,8 @@ protected:
     bool _containsJointCallbackFunction;
     bool _containsContactCallbackFunction;
     bool _containsDynCallbackFunction;
+    suint64 _systemCallbackPresence; // bit n set: the sysCall_ function for call type n might be defined
+    int _systemCallbackPresenceCheckTime; // cleared bits are checked again after a while
 
     int _messageReportingOverride;
 
@@ -275,4 +288,10 @@ protected:
     static VMutex _globalMutex;
     static std::vector<CLuaScriptObject*> toBeCalledByThread;
     static VTHREAD_RETURN_TYPE _startAddressForThreadedScripts(VTHREAD_ARGUMENT_TYPE lpData);
+
+    static void _startWatchdogTimerIfNeeded();
+    static VTHREAD_RETURN_TYPE _watchdogTimerThread(VTHREAD_ARGUMENT_TYPE lpData);
+    static volatile unsigned int _watchdogTimerTick; // incremented about once per millisecond by the watchdog timer thread
+    static volatile bool _watchdogTimerRunning;
+    static volatile bool _watchdogTimerShouldEnd;
 };
@@ -70,6 +70,9 @@ typedef void (__cdecl *pluaLib_lua_settable)(luaWrap_lua_State* L,int idx);
 typedef int (__cdecl *pluaLib_lua_next)(luaWrap_lua_State* L,int idx);
 typedef int (__cdecl *pluaLib_lua_type)(luaWrap_lua_State* L,int idx);
 typedef int (__cdecl *pluaLib_lua_error)(luaWrap_lua_State* L);
+typedef int (__cdecl *pluaLibGet_LUA_REGISTRYINDEX)(void);
+typedef void (__cdecl *pluaLib_lua_pushlightuserdata)(luaWrap_lua_State* L,void* p);
+typedef void* (__cdecl *pluaLib_lua_touserdata)(luaWrap_lua_State* L,int idx);
 
 
 pluaLibGet_LUA_MULTRET luaLibGet_LUA_MULTRET;
@@ -133,6 +136,9 @@ pluaLib_lua_settable luaLib_lua_settable;
 pluaLib_lua_next luaLib_lua_next;
 pluaLib_lua_type luaLib_lua_type;
 pluaLib_lua_error luaLib_lua_error;
+pluaLibGet_LUA_REGISTRYINDEX luaLibGet_LUA_REGISTRYINDEX;
+pluaLib_lua_pushlightuserdata luaLib_lua_pushlightuserdata;
+pluaLib_lua_touserdata luaLib_lua_touserdata;
 
 WLibrary lib;
 
@@ -204,6 +210,10 @@ bool _getLibProcAddresses()
     luaLib_lua_next=(pluaLib_lua_next)(_getProcAddress("luaLib_lua_next"));
     luaLib_lua_type=(pluaLib_lua_type)(_getProcAddress("luaLib_lua_type"));
     luaLib_lua_error=(pluaLib_lua_error)(_getProcAddress("luaLib_lua_error"));
+    // Following are optional (see luaWrap_isRegistryAccessAvailable):
+    luaLibGet_LUA_REGISTRYINDEX=(pluaLibGet_LUA_REGISTRYINDEX)(_getProcAddress("luaLibGet_LUA_REGISTRYINDEX"));
+    luaLib_lua_pushlightuserdata=(pluaLib_lua_pushlightuserdata)(_getProcAddress("luaLib_lua_pushlightuserdata"));
+    luaLib_lua_touserdata=(pluaLib_lua_touserdata)(_getProcAddress("luaLib_lua_touserdata"));
 
 
     if (luaLibGet_LUA_MULTRET==NULL) return false;
@@ -397,6 +407,20 @@ int luaWrapGet_LUA_GLOBALSINDEX()
     return(LUA_GLOBALSINDEX);
 }
 
+bool luaWrap_isRegistryAccessAvailable()
+{ // older external Lua libraries do not export the 3 functions below
+    if (lib!=NULL)
+        return( (luaLibGet_LUA_REGISTRYINDEX!=NULL)&&(luaLib_lua_pushlightuserdata!=NULL)&&(luaLib_lua_touserdata!=NULL) );
+    return(true);
+}
+
+int luaWrapGet_LUA_REGISTRYINDEX()
+{
+    if (lib!=NULL)
+        return(luaLibGet_LUA_REGISTRYINDEX());
+    return(LUA_REGISTRYINDEX);
+}
+
 luaWrap_lua_State* luaWrap_luaL_newstate()
 {
     if (lib!=NULL)
@@ -451,6 +475,14 @@ void luaWrap_lua_pushnil(luaWrap_lua_State* L)
         lua_pushnil((lua_State*)L);
 }
 
+void luaWrap_lua_pushlightuserdata(luaWrap_lua_State* L,void* p)
+{
+    if (lib!=NULL)
+        luaLib_lua_pushlightuserdata(L,p);
+    else
+        lua_pushlightuserdata((lua_State*)L,p);
+}
+
 void luaWrap_lua_pushboolean(luaWrap_lua_State* L,int b)
 {
     if (lib!=NULL)
@@ -752,6 +784,13 @@ int luaWrap_lua_isuserdata(luaWrap_lua_State* L,int idx)
     return(lua_isuserdata((lua_State*)L,idx));
 }
 
+void* luaWrap_lua_touserdata(luaWrap_lua_State* L,int idx)
+{
+    if (lib!=NULL)
+        return(luaLib_lua_touserdata(L,idx));
+    return(lua_touserdata((lua_State*)L,idx));
+}
+
 int luaWrap_lua_upvalueindex(int i)
 {
     if (lib!=NULL)
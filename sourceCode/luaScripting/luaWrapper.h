@@ -50,6 +50,8 @@ int luaWrapGet_LUA_HOOKCOUNT();
 int luaWrapGet_LUA_HOOKCALL();
 int luaWrapGet_LUA_HOOKRET();
 int luaWrapGet_LUA_GLOBALSINDEX();
+int luaWrapGet_LUA_REGISTRYINDEX();
+bool luaWrap_isRegistryAccessAvailable();
 
 luaWrap_lua_State* luaWrap_luaL_newstate();
 void luaWrap_lua_close(luaWrap_lua_State* L);
@@ -58,6 +60,7 @@ int luaWrap_lua_sethook(luaWrap_lua_State* L,luaWrap_lua_Hook func,int mask,int
 void luaWrap_lua_register(luaWrap_lua_State* L,const char* name,luaWrap_lua_CFunction func);
 void luaWrap_lua_pushnumber(luaWrap_lua_State* L,luaWrap_lua_Number n);
 void luaWrap_lua_pushnil(luaWrap_lua_State* L);
+void luaWrap_lua_pushlightuserdata(luaWrap_lua_State* L,void* p);
 void luaWrap_lua_pushboolean(luaWrap_lua_State* L,int b);
 void luaWrap_lua_pushinteger(luaWrap_lua_State* L,int n);
 void luaWrap_lua_pushstring(luaWrap_lua_State* L,const char* str);
@@ -98,6 +101,7 @@ int luaWrap_lua_pcall(luaWrap_lua_State* L,int nargs,int nresult,int errfunc);
 void luaWrap_lua_remove(luaWrap_lua_State* L,int idx);
 void luaWrap_lua_insert(luaWrap_lua_State* L,int idx);
 int luaWrap_lua_isuserdata(luaWrap_lua_State* L,int idx);
+void* luaWrap_lua_touserdata(luaWrap_lua_State* L,int idx);
 int luaWrap_lua_upvalueindex(int i);
 int luaWrap_getCurrentCodeLine(luaWrap_lua_State* L);
 void luaWrap_lua_settable(luaWrap_lua_State* L,int idx);
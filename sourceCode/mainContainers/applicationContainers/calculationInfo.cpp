@@ -9,6 +9,8 @@
 #include <boost/lexical_cast.hpp>
 #include "v_repStrings.h"
 #include "vDateTime.h"
+#include "3DObject.h"
+#include "stepProfiler.h"
 
 CCalculationInfo::CCalculationInfo()
 {
@@ -28,6 +30,8 @@ CCalculationInfo::CCalculationInfo()
     _ikTxt[1]="";
     _millTxt[0]="";
     _millTxt[1]="";
+    _transfCacheTxt[0]="";
+    _transfCacheTxt[1]="";
     _dynamicsTxt[0]="";
     _dynamicsTxt[1]="";
 }
@@ -39,11 +43,13 @@ CCalculationInfo::~CCalculationInfo()
 void CCalculationInfo::simulationAboutToStart()
 {
     resetInfo();
+    CStepProfiler::simulationAboutToStart();
 }
 
 void CCalculationInfo::simulationEnded()
 {
     resetInfo();
+    CStepProfiler::simulationEnded();
 }
 
 void CCalculationInfo::resetInfo()
@@ -79,6 +85,9 @@ void CCalculationInfo::resetInfo()
     _millRemovedSurface=0.0f;
     _millRemovedVolume=0.0f;
     _millCalcDuration=0;
+
+    C3DObject::resetCumulativeTransformationCacheStatistics();
+    CPluginContainer::mesh_resetLockStatistics();
 }
 
 void CCalculationInfo::formatInfo()
@@ -118,6 +127,10 @@ void CCalculationInfo::formatInfo()
     _collTxt[1]+=boost::lexical_cast<std::string>(_collCalcCount)+", detections: ";
     _collTxt[1]+=boost::lexical_cast<std::string>(_collDetectCount)+" (";
     _collTxt[1]+=boost::lexical_cast<std::string>(_collCalcDuration)+" ms)";
+    unsigned int meshLocks,meshLockContentions;
+    CPluginContainer::mesh_getLockStatistics(meshLocks,meshLockContentions);
+    if (meshLockContentions>0)
+        _collTxt[1]+=", geometry lock contentions: "+boost::lexical_cast<std::string>(meshLockContentions)+"/"+boost::lexical_cast<std::string>(meshLocks);
 
     // Distance calculation:
     if (CPluginContainer::isMeshPluginAvailable())
@@ -170,6 +183,18 @@ void CCalculationInfo::formatInfo()
     _ikTxt[1]+=boost::lexical_cast<std::string>(_ikCalcCount)+" (";
     _ikTxt[1]+=boost::lexical_cast<std::string>(_ikCalcDuration)+" ms)";
 
+    // Cumulative transformation cache (all calculation modules):
+    unsigned int trHits,trMisses;
+    C3DObject::getCumulativeTransformationCacheStatistics(trHits,trMisses);
+    _transfCacheTxt[0]="";
+    _transfCacheTxt[1]="";
+    if (trHits+trMisses>0)
+    {
+        _transfCacheTxt[0]="Transformation cache";
+        _transfCacheTxt[1]="Hits: "+boost::lexical_cast<std::string>((100*(unsigned long long)trHits)/(trHits+trMisses))+"% (";
+        _transfCacheTxt[1]+=boost::lexical_cast<std::string>(trHits)+"/"+boost::lexical_cast<std::string>(trHits+trMisses)+")";
+    }
+
     // Dynamics calculation:
     if (!App::ct->dynamicsContainer->getDynamicsEnabled())
         _dynamicsTxt[0]="&&fg930Dynamics handling disabled";
@@ -303,11 +328,13 @@ void CCalculationInfo::setMainScriptMessage(const char* msg)
 void CCalculationInfo::simulationPassStart()
 {
     _simulationPassStartTime=VDateTime::getTimeInMs();
+    CStepProfiler::stepStart();
 }
 
 void CCalculationInfo::simulationPassEnd()
 {
     _simulationPassDuration+=VDateTime::getTimeDiffInMs(_simulationPassStartTime);
+    CStepProfiler::stepEnd();
 }
 
 void CCalculationInfo::collisionDetectionStart()
@@ -334,6 +361,12 @@ void CCalculationInfo::distanceCalculationEnd()
     _distCalcDuration+=VDateTime::getTimeDiffInMs(_distStartTime);
 }
 
+void CCalculationInfo::distanceCalculationEnd(int calcCount)
+{ // for several distance objects handled concurrently
+    _distCalcCount+=calcCount;
+    _distCalcDuration+=VDateTime::getTimeDiffInMs(_distStartTime);
+}
+
 void CCalculationInfo::proximitySensorSimulationStart()
 {
     _sensStartTime=VDateTime::getTimeInMs();
@@ -347,6 +380,13 @@ void CCalculationInfo::proximitySensorSimulationEnd(bool detected)
     _sensCalcDuration+=VDateTime::getTimeDiffInMs(_sensStartTime);
 }
 
+void CCalculationInfo::proximitySensorSimulationEnd(int calcCount,int detectCount)
+{ // for several sensors handled concurrently
+    _sensCalcCount+=calcCount;
+    _sensDetectCount+=detectCount;
+    _sensCalcDuration+=VDateTime::getTimeDiffInMs(_sensStartTime);
+}
+
 void CCalculationInfo::visionSensorSimulationStart()
 {
     _rendSensStartTime=VDateTime::getTimeInMs();
@@ -360,6 +400,11 @@ void CCalculationInfo::visionSensorSimulationEnd(bool detected)
     _rendSensCalcDuration+=VDateTime::getTimeDiffInMs(_rendSensStartTime);
 }
 
+void CCalculationInfo::visionSensorReadbackStarted()
+{ // instead of visionSensorSimulationEnd: the sensor is counted once its image is fetched
+    _rendSensCalcDuration+=VDateTime::getTimeDiffInMs(_rendSensStartTime);
+}
+
 void CCalculationInfo::inverseKinematicsStart()
 {
     _ikStartTime=VDateTime::getTimeInMs();
@@ -371,6 +416,12 @@ void CCalculationInfo::inverseKinematicsEnd()
     _ikCalcDuration+=VDateTime::getTimeDiffInMs(_ikStartTime);
 }
 
+void CCalculationInfo::addInverseKinematicsCalculation(int calcDuration)
+{ // for an IK group that was computed by a worker thread. calcDuration is in ms
+    _ikCalcCount++;
+    _ikCalcDuration+=calcDuration;
+}
+
 void CCalculationInfo::renderingStart()
 {
     _renderingStartTime=VDateTime::getTimeInMs();
@@ -630,6 +681,12 @@ void CCalculationInfo::printInformation()
             // Milling calculation:
             App::ct->buttonBlockContainer->getInfoBoxButton(pos,0)->label=_millTxt[0];
             App::ct->buttonBlockContainer->getInfoBoxButton(pos++,1)->label=_millTxt[1];
+            // Cumulative transformation cache:
+            if ( (_transfCacheTxt[0].size()>0)&&(pos<INFO_BOX_ROW_COUNT) )
+            {
+                App::ct->buttonBlockContainer->getInfoBoxButton(pos,0)->label=_transfCacheTxt[0];
+                App::ct->buttonBlockContainer->getInfoBoxButton(pos++,1)->label=_transfCacheTxt[1];
+            }
         }
     }
 }
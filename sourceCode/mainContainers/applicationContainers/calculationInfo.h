@@ -26,15 +26,19 @@ public:
 
     void distanceCalculationStart();
     void distanceCalculationEnd();
+    void distanceCalculationEnd(int calcCount);
 
     void proximitySensorSimulationStart();
     void proximitySensorSimulationEnd(bool detected);
+    void proximitySensorSimulationEnd(int calcCount,int detectCount);
 
     void visionSensorSimulationStart();
     void visionSensorSimulationEnd(bool detected);
+    void visionSensorReadbackStarted();
 
     void inverseKinematicsStart();
     void inverseKinematicsEnd();
+    void addInverseKinematicsCalculation(int calcDuration);
 
     void renderingStart();
     void renderingEnd();
@@ -122,4 +126,5 @@ private:
     std::string _ikTxt[2];
     std::string _dynamicsTxt[2];
     std::string _millTxt[2];
+    std::string _transfCacheTxt[2];
 };
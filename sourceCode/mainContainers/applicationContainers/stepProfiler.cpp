@@ -0,0 +1,376 @@
+
+#include "vrepMainHeader.h"
+#include "stepProfiler.h"
+#include "app.h"
+#include "vDateTime.h"
+#include "vThread.h"
+#include "vFile.h"
+#include "vArchive.h"
+#include "luaScriptObject.h"
+#include "regCollision.h"
+#include "regDist.h"
+#include "ikGroup.h"
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+
+bool CStepProfiler::_enabled=false;
+VMutex CStepProfiler::_mutex;
+std::vector<VTHREAD_ID_TYPE> CStepProfiler::_threadIds;
+int CStepProfiler::_stepCount=0;
+suint64 CStepProfiler::_stepStartTime=0;
+std::vector<SProfilerEvent> CStepProfiler::_currentEvents;
+std::vector<SProfilerStep> CStepProfiler::_steps;
+int CStepProfiler::_nextStepSlot=0;
+int CStepProfiler::_stepHistogram[PROFILER_HISTOGRAM_BUCKETS];
+int CStepProfiler::_categoryStepHistograms[PROFILER_CATEGORY_COUNT][PROFILER_HISTOGRAM_BUCKETS];
+std::map<std::pair<int,int>,SProfilerStats> CStepProfiler::_stats;
+
+void CStepProfiler::simulationAboutToStart()
+{
+    _mutex.lock_simple();
+    _enabled=App::userSettings->stepProfilerEnabled;
+    _threadIds.clear();
+    _stepCount=0;
+    _stepStartTime=VDateTime::getTimeInUs();
+    _currentEvents.clear();
+    _steps.clear();
+    _nextStepSlot=0;
+    for (size_t i=0;i<PROFILER_HISTOGRAM_BUCKETS;i++)
+    {
+        _stepHistogram[i]=0;
+        for (size_t j=0;j<PROFILER_CATEGORY_COUNT;j++)
+            _categoryStepHistograms[j][i]=0;
+    }
+    _stats.clear();
+    _mutex.unlock_simple();
+}
+
+void CStepProfiler::simulationEnded()
+{
+    if (!_enabled)
+        return;
+    _enabled=false;
+    _reportSlowestEvents();
+    if (App::userSettings->stepProfilerTraceFile.length()!=0)
+    {
+        if (exportTrace(App::userSettings->stepProfilerTraceFile.c_str()))
+            App::addStatusbarMessage("Step profiler: trace written to "+App::userSettings->stepProfilerTraceFile);
+    }
+}
+
+void CStepProfiler::stepStart()
+{
+    if (!_enabled)
+        return;
+    _mutex.lock_simple();
+    _stepStartTime=VDateTime::getTimeInUs();
+    _mutex.unlock_simple();
+}
+
+void CStepProfiler::stepEnd()
+{
+    if (!_enabled)
+        return;
+    suint64 endTime=VDateTime::getTimeInUs();
+    _mutex.lock_simple();
+    SProfilerStep step;
+    step.stepIndex=_stepCount++;
+    step.simulationTime=float(App::ct->simulation->getSimulationTime_ns())/1000000.0f;
+    step.startTime=_stepStartTime;
+    step.duration=endTime-_stepStartTime;
+    step.events.swap(_currentEvents);
+
+    _stepHistogram[_getHistogramBucket(step.duration)]++;
+    suint64 categoryDurations[PROFILER_CATEGORY_COUNT];
+    bool categoryPresent[PROFILER_CATEGORY_COUNT];
+    for (size_t i=0;i<PROFILER_CATEGORY_COUNT;i++)
+    {
+        categoryDurations[i]=0;
+        categoryPresent[i]=false;
+    }
+    for (size_t i=0;i<step.events.size();i++)
+    {
+        categoryDurations[step.events[i].category]+=step.events[i].duration;
+        categoryPresent[step.events[i].category]=true;
+    }
+    for (size_t i=0;i<PROFILER_CATEGORY_COUNT;i++)
+    {
+        if (categoryPresent[i])
+            _categoryStepHistograms[i][_getHistogramBucket(categoryDurations[i])]++;
+    }
+
+    size_t capacity=size_t(std::max<int>(App::userSettings->stepProfilerStepCount,1));
+    if (_steps.size()<capacity)
+        _steps.push_back(step);
+    else
+    {
+        _steps[_nextStepSlot].stepIndex=step.stepIndex;
+        _steps[_nextStepSlot].simulationTime=step.simulationTime;
+        _steps[_nextStepSlot].startTime=step.startTime;
+        _steps[_nextStepSlot].duration=step.duration;
+        _steps[_nextStepSlot].events.swap(step.events);
+        _nextStepSlot=(_nextStepSlot+1)%int(_steps.size());
+    }
+    _currentEvents.clear();
+    _mutex.unlock_simple();
+}
+
+bool CStepProfiler::isEnabled()
+{
+    return(_enabled);
+}
+
+void CStepProfiler::recordEvent(int category,int handle,suint64 startTime,suint64 duration)
+{ // can be called from several threads
+    if (!_enabled)
+        return;
+    _mutex.lock_simple();
+    SProfilerEvent event;
+    event.category=category;
+    event.handle=handle;
+    event.threadIndex=_getThreadIndex();
+    event.startTime=startTime;
+    event.duration=duration;
+    _currentEvents.push_back(event);
+
+    std::pair<int,int> key(category,handle);
+    std::map<std::pair<int,int>,SProfilerStats>::iterator it=_stats.find(key);
+    if (it==_stats.end())
+    { // names are only looked up the first time (objects might be gone when we export)
+        SProfilerStats stats;
+        stats.name=_getEventName(category,handle);
+        stats.count=0;
+        stats.totalDuration=0;
+        stats.maxDuration=0;
+        for (size_t i=0;i<PROFILER_HISTOGRAM_BUCKETS;i++)
+            stats.histogram[i]=0;
+        it=_stats.insert(std::make_pair(key,stats)).first;
+    }
+    it->second.count++;
+    it->second.totalDuration+=duration;
+    it->second.maxDuration=std::max<suint64>(it->second.maxDuration,duration);
+    it->second.histogram[_getHistogramBucket(duration)]++;
+    _mutex.unlock_simple();
+}
+
+bool CStepProfiler::exportTrace(const char* filename)
+{ // Chrome trace event format. The per-object statistics and histograms are in 'stepProfile'
+    bool retVal=false;
+    _mutex.lock_simple();
+    try
+    {
+        VFile myFile(filename,VFile::CREATE_WRITE|VFile::SHARE_EXCLUSIVE);
+        VArchive ar(&myFile,VArchive::STORE);
+        ar.writeLine("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        bool first=true;
+        for (size_t s=0;s<_steps.size();s++)
+        {
+            const SProfilerStep& step=_steps[(_nextStepSlot+s)%_steps.size()]; // oldest first
+            std::string line(first?"":",");
+            first=false;
+            line+="{\"name\":\"step "+boost::lexical_cast<std::string>(step.stepIndex)+"\",\"cat\":\"step\",\"ph\":\"X\",\"pid\":1,\"tid\":0";
+            line+=",\"ts\":"+boost::lexical_cast<std::string>(step.startTime)+",\"dur\":"+boost::lexical_cast<std::string>(step.duration);
+            line+=",\"args\":{\"simulationTime\":"+boost::lexical_cast<std::string>(step.simulationTime)+"}}";
+            ar.writeLine(line);
+            for (size_t i=0;i<step.events.size();i++)
+            {
+                const SProfilerEvent& event=step.events[i];
+                std::string name;
+                std::map<std::pair<int,int>,SProfilerStats>::iterator it=_stats.find(std::make_pair(event.category,event.handle));
+                if (it!=_stats.end())
+                    name=it->second.name;
+                line=",{\"name\":"+_getJsonString(name)+",\"cat\":\""+_getCategoryName(event.category)+"\",\"ph\":\"X\",\"pid\":1";
+                line+=",\"tid\":"+boost::lexical_cast<std::string>(event.threadIndex);
+                line+=",\"ts\":"+boost::lexical_cast<std::string>(event.startTime)+",\"dur\":"+boost::lexical_cast<std::string>(event.duration);
+                line+=",\"args\":{\"handle\":"+boost::lexical_cast<std::string>(event.handle)+"}}";
+                ar.writeLine(line);
+            }
+        }
+        ar.writeLine("],");
+
+        ar.writeLine("\"stepProfile\":{");
+        ar.writeLine("\"stepCount\":"+boost::lexical_cast<std::string>(_stepCount)+",");
+        ar.writeLine("\"histogramBuckets\":\"bucket 0: <1us, bucket i: [2^(i-1),2^i[ us\",");
+        ar.writeLine("\"stepHistogram\":"+_getHistogramString(_stepHistogram)+",");
+        ar.writeLine("\"categoryStepHistograms\":{");
+        for (size_t i=0;i<PROFILER_CATEGORY_COUNT;i++)
+        {
+            std::string line("\"");
+            line+=_getCategoryName(int(i));
+            line+="\":"+_getHistogramString(_categoryStepHistograms[i]);
+            if (i<PROFILER_CATEGORY_COUNT-1)
+                line+=",";
+            ar.writeLine(line);
+        }
+        ar.writeLine("},");
+        ar.writeLine("\"objects\":[");
+        first=true;
+        for (std::map<std::pair<int,int>,SProfilerStats>::iterator it=_stats.begin();it!=_stats.end();it++)
+        {
+            std::string line(first?"":",");
+            first=false;
+            line+="{\"category\":\"";
+            line+=_getCategoryName(it->first.first);
+            line+="\",\"handle\":"+boost::lexical_cast<std::string>(it->first.second);
+            line+=",\"name\":"+_getJsonString(it->second.name);
+            line+=",\"count\":"+boost::lexical_cast<std::string>(it->second.count);
+            line+=",\"totalUs\":"+boost::lexical_cast<std::string>(it->second.totalDuration);
+            line+=",\"maxUs\":"+boost::lexical_cast<std::string>(it->second.maxDuration);
+            line+=",\"histogram\":"+_getHistogramString(it->second.histogram)+"}";
+            ar.writeLine(line);
+        }
+        ar.writeLine("]");
+        ar.writeLine("}}");
+        ar.close();
+        myFile.close();
+        retVal=true;
+    }
+    catch(VFILE_EXCEPTION_TYPE e)
+    {
+        VFile::reportAndHandleFileExceptionError(e);
+    }
+    _mutex.unlock_simple();
+    return(retVal);
+}
+
+int CStepProfiler::_getThreadIndex()
+{ // _mutex is locked
+    VTHREAD_ID_TYPE id=VThread::getCurrentThreadId();
+    for (size_t i=0;i<_threadIds.size();i++)
+    {
+        if (VThread::areThreadIDsSame(_threadIds[i],id))
+            return(int(i));
+    }
+    _threadIds.push_back(id);
+    return(int(_threadIds.size())-1);
+}
+
+int CStepProfiler::_getHistogramBucket(suint64 duration)
+{
+    int retVal=0;
+    while ( (duration>0)&&(retVal<PROFILER_HISTOGRAM_BUCKETS-1) )
+    {
+        duration>>=1;
+        retVal++;
+    }
+    return(retVal);
+}
+
+std::string CStepProfiler::_getEventName(int category,int handle)
+{
+    std::string retVal;
+    if ( (category==PROFILER_CATEGORY_SCRIPT)||(category==PROFILER_CATEGORY_SCRIPT_STATE) )
+    {
+        CLuaScriptObject* it=App::ct->luaScriptContainer->getScriptFromID_alsoAddOnsAndSandbox(handle);
+        if (it!=NULL)
+            retVal=it->getShortDescriptiveName();
+    }
+    else if (category==PROFILER_CATEGORY_COLLISION)
+    {
+        CRegCollision* it=App::ct->collisions->getObject(handle);
+        if (it!=NULL)
+            retVal=it->getObjectName();
+    }
+    else if (category==PROFILER_CATEGORY_DISTANCE)
+    {
+        CRegDist* it=App::ct->distances->getObject(handle);
+        if (it!=NULL)
+            retVal=it->getObjectName();
+    }
+    else if (category==PROFILER_CATEGORY_IK)
+    {
+        CikGroup* it=App::ct->ikGroups->getIkGroup(handle);
+        if (it!=NULL)
+            retVal=it->getObjectName();
+    }
+    else if (handle!=-1)
+    {
+        C3DObject* it=App::ct->objCont->getObject(handle);
+        if (it!=NULL)
+            retVal=it->getName();
+    }
+    if (retVal.length()==0)
+        retVal=_getCategoryName(category);
+    return(retVal);
+}
+
+const char* CStepProfiler::_getCategoryName(int category)
+{
+    static const char* names[PROFILER_CATEGORY_COUNT]={"script","collision","distance","proximitySensor","visionSensor","mill","ik","dynamics","rendering","scriptStateCreation"};
+    if ( (category>=0)&&(category<PROFILER_CATEGORY_COUNT) )
+        return(names[category]);
+    return("unknown");
+}
+
+std::string CStepProfiler::_getHistogramString(const int histogram[PROFILER_HISTOGRAM_BUCKETS])
+{
+    std::string retVal("[");
+    for (size_t i=0;i<PROFILER_HISTOGRAM_BUCKETS;i++)
+    {
+        if (i>0)
+            retVal+=",";
+        retVal+=boost::lexical_cast<std::string>(histogram[i]);
+    }
+    retVal+="]";
+    return(retVal);
+}
+
+std::string CStepProfiler::_getJsonString(const std::string& str)
+{
+    std::string retVal("\"");
+    for (size_t i=0;i<str.length();i++)
+    {
+        char c=str[i];
+        if ( (c=='"')||(c=='\\') )
+        {
+            retVal+='\\';
+            retVal+=c;
+        }
+        else if ((unsigned char)c<32)
+            retVal+=' ';
+        else
+            retVal+=c;
+    }
+    retVal+="\"";
+    return(retVal);
+}
+
+void CStepProfiler::_reportSlowestEvents()
+{ // in the status bar (i.e. also on the console in headless mode)
+    _mutex.lock_simple();
+    std::vector<std::pair<suint64,std::pair<int,int> > > totals;
+    for (std::map<std::pair<int,int>,SProfilerStats>::iterator it=_stats.begin();it!=_stats.end();it++)
+        totals.push_back(std::make_pair(it->second.totalDuration,it->first));
+    std::sort(totals.rbegin(),totals.rend());
+    std::string msg("Step profiler: "+boost::lexical_cast<std::string>(_stepCount)+" steps profiled");
+    if (totals.size()>0)
+        msg+=", most expensive:";
+    App::addStatusbarMessage(msg);
+    for (size_t i=0;i<std::min<size_t>(totals.size(),5);i++)
+    {
+        const SProfilerStats& stats=_stats[totals[i].second];
+        msg="    ";
+        msg+=_getCategoryName(totals[i].second.first);
+        msg+=" '"+stats.name+"': total "+boost::lexical_cast<std::string>(stats.totalDuration/1000)+" ms, max ";
+        msg+=boost::lexical_cast<std::string>(stats.maxDuration)+" us, "+boost::lexical_cast<std::string>(stats.count)+" calls";
+        App::addStatusbarMessage(msg);
+    }
+    _mutex.unlock_simple();
+}
+
+CStepProfilerScope::CStepProfilerScope(int category,int handle,bool active/*=true*/)
+{
+    _active=active&&CStepProfiler::isEnabled();
+    if (_active)
+    {
+        _category=category;
+        _handle=handle;
+        _startTime=VDateTime::getTimeInUs();
+    }
+}
+
+CStepProfilerScope::~CStepProfilerScope()
+{
+    if (_active)
+        CStepProfiler::recordEvent(_category,_handle,_startTime,VDateTime::getTimeInUs()-_startTime);
+}
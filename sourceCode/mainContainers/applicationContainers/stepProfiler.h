@@ -0,0 +1,101 @@
+#pragma once
+
+#include "vrepMainHeader.h"
+#include "vMutex.h"
+
+enum {
+    PROFILER_CATEGORY_SCRIPT=0,
+    PROFILER_CATEGORY_COLLISION,
+    PROFILER_CATEGORY_DISTANCE,
+    PROFILER_CATEGORY_PROXIMITY_SENSOR,
+    PROFILER_CATEGORY_VISION_SENSOR,
+    PROFILER_CATEGORY_MILL,
+    PROFILER_CATEGORY_IK,
+    PROFILER_CATEGORY_DYNAMICS,
+    PROFILER_CATEGORY_RENDERING,
+    PROFILER_CATEGORY_SCRIPT_STATE, // Lua state creation
+    PROFILER_CATEGORY_COUNT
+};
+
+#define PROFILER_HISTOGRAM_BUCKETS 24 // bucket 0: <1us, bucket i: [2^(i-1),2^i[ us, last bucket: everything above
+
+struct SProfilerEvent
+{
+    int category;
+    int handle;
+    int threadIndex;
+    suint64 startTime; // in us
+    suint64 duration; // in us
+};
+
+struct SProfilerStep
+{
+    int stepIndex;
+    float simulationTime;
+    suint64 startTime;
+    suint64 duration;
+    std::vector<SProfilerEvent> events;
+};
+
+struct SProfilerStats
+{
+    std::string name;
+    int count;
+    suint64 totalDuration;
+    suint64 maxDuration;
+    int histogram[PROFILER_HISTOGRAM_BUCKETS];
+};
+
+// Times simulation steps and what happens in them (per script, sensor, collision object, etc.). Keeps the
+// last steps in a ring buffer, and writes a Chrome trace file (chrome://tracing) when simulation ends.
+// Enabled via the user settings, also in headless mode
+//FULLY STATIC CLASS
+class CStepProfiler
+{
+public:
+    static void simulationAboutToStart();
+    static void simulationEnded();
+    static void stepStart();
+    static void stepEnd();
+
+    static bool isEnabled();
+    static void recordEvent(int category,int handle,suint64 startTime,suint64 duration);
+    static bool exportTrace(const char* filename);
+
+private:
+    static int _getThreadIndex();
+    static int _getHistogramBucket(suint64 duration);
+    static std::string _getEventName(int category,int handle);
+    static const char* _getCategoryName(int category);
+    static std::string _getHistogramString(const int histogram[PROFILER_HISTOGRAM_BUCKETS]);
+    static std::string _getJsonString(const std::string& str);
+    static void _reportSlowestEvents();
+
+    static bool _enabled;
+    static VMutex _mutex;
+    static std::vector<VTHREAD_ID_TYPE> _threadIds;
+
+    static int _stepCount;
+    static suint64 _stepStartTime;
+    static std::vector<SProfilerEvent> _currentEvents;
+    static std::vector<SProfilerStep> _steps; // ring buffer
+    static int _nextStepSlot;
+
+    static int _stepHistogram[PROFILER_HISTOGRAM_BUCKETS];
+    static int _categoryStepHistograms[PROFILER_CATEGORY_COUNT][PROFILER_HISTOGRAM_BUCKETS];
+    static std::map<std::pair<int,int>,SProfilerStats> _stats; // (category,handle) --> stats
+};
+
+// Times the enclosing scope, if the profiler is enabled:
+class CStepProfilerScope
+{
+public:
+    CStepProfilerScope(int category,int handle,bool active=true);
+    virtual ~CStepProfilerScope();
+
+private:
+    int _category;
+    int _handle;
+    bool _active;
+    suint64 _startTime;
+};
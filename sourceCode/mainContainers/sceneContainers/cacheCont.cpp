@@ -10,43 +10,35 @@ CCacheCont::~CCacheCont()
 {
 }
 
-int CCacheCont::_getPosition(int entity1,int entity2,bool& inverted,std::vector<int>& entityPairs,std::vector<int>& cacheDat)
+int CCacheCont::_getPosition(int entity1,int entity2,bool& inverted,std::vector<int>& entityPairs,std::vector<int>& cacheDat,boost::unordered_map<std::pair<int,int>,int>& pairPositions)
 {
     inverted=false;
-    int position=-1;
     // 1. We search for an already existing entry:
-    for (int i=0;i<int(entityPairs.size())/2;i++)
+    boost::unordered_map<std::pair<int,int>,int>::iterator it=pairPositions.find(std::make_pair(entity1,entity2));
+    if (it!=pairPositions.end())
+        return(it->second);
+    it=pairPositions.find(std::make_pair(entity2,entity1));
+    if (it!=pairPositions.end())
     {
-        if ( (entityPairs[2*i+0]==entity1)&&(entityPairs[2*i+1]==entity2) )
-        {
-            position=i;
-            break;
-        }
-        else if ( (entityPairs[2*i+0]==entity2)&&(entityPairs[2*i+1]==entity1) )
-        {
-            position=i;
-            inverted=true;
-            break;
-        }
-    }
-    // 2. we add an entry if necessary:
-    if (position==-1)
-    {
-        entityPairs.push_back(entity1);
-        entityPairs.push_back(entity2);
-        cacheDat.push_back(-1);
-        cacheDat.push_back(-1);
-        cacheDat.push_back(-1);
-        cacheDat.push_back(-1);
-        position=int(entityPairs.size()/2)-1;
+        inverted=true;
+        return(it->second);
     }
+    // 2. we add an entry:
+    entityPairs.push_back(entity1);
+    entityPairs.push_back(entity2);
+    cacheDat.push_back(-1);
+    cacheDat.push_back(-1);
+    cacheDat.push_back(-1);
+    cacheDat.push_back(-1);
+    int position=int(entityPairs.size()/2)-1;
+    pairPositions[std::make_pair(entity1,entity2)]=position;
     return(position);
 }
 
-void CCacheCont::_getCacheData(int entity1,int entity2,int cache[4],std::vector<int>& entityPairs,std::vector<int>& cacheDat)
+void CCacheCont::_getCacheData(int entity1,int entity2,int cache[4],std::vector<int>& entityPairs,std::vector<int>& cacheDat,boost::unordered_map<std::pair<int,int>,int>& pairPositions)
 {
     bool inverted=false;
-    int pos=_getPosition(entity1,entity2,inverted,entityPairs,cacheDat);
+    int pos=_getPosition(entity1,entity2,inverted,entityPairs,cacheDat,pairPositions);
     if (!inverted)
     {
         cache[0]=cacheDat[4*pos+0];
@@ -63,10 +55,10 @@ void CCacheCont::_getCacheData(int entity1,int entity2,int cache[4],std::vector<
     }
 }
 
-void CCacheCont::_setCacheData(int entity1,int entity2,int cache[4],std::vector<int>& entityPairs,std::vector<int>& cacheDat)
+void CCacheCont::_setCacheData(int entity1,int entity2,int cache[4],std::vector<int>& entityPairs,std::vector<int>& cacheDat,boost::unordered_map<std::pair<int,int>,int>& pairPositions)
 {
     bool inverted=false;
-    int pos=_getPosition(entity1,entity2,inverted,entityPairs,cacheDat);
+    int pos=_getPosition(entity1,entity2,inverted,entityPairs,cacheDat,pairPositions);
     if (!inverted)
     {
         cacheDat[4*pos+0]=cache[0];
@@ -85,15 +77,16 @@ void CCacheCont::_setCacheData(int entity1,int entity2,int cache[4],std::vector<
 
 void CCacheCont::getCacheDataDist(int entity1,int entity2,int cache[4])
 {
-    _getCacheData(entity1,entity2,cache,entityPairIDs_dist,cacheData_dist);
+    _getCacheData(entity1,entity2,cache,entityPairIDs_dist,cacheData_dist,pairPositions_dist);
 }
 void CCacheCont::setCacheDataDist(int entity1,int entity2,int cache[4])
 {
-    _setCacheData(entity1,entity2,cache,entityPairIDs_dist,cacheData_dist);
+    _setCacheData(entity1,entity2,cache,entityPairIDs_dist,cacheData_dist,pairPositions_dist);
 }
 
 void CCacheCont::clearCache()
 {
     entityPairIDs_dist.clear();
     cacheData_dist.clear();
+    pairPositions_dist.clear();
 }
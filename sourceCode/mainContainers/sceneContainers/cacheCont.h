@@ -3,6 +3,7 @@
 
 #include "vrepMainHeader.h"
 #include "mainCont.h"
+#include <boost/unordered_map.hpp>
 
 class CCacheCont : CMainCont  
 {
@@ -14,9 +15,10 @@ public:
     void clearCache();
 
 protected:
-    void _getCacheData(int entity1,int entity2,int cache[4],std::vector<int>& entityPairs,std::vector<int>& cacheDat);
-    void _setCacheData(int entity1,int entity2,int cache[4],std::vector<int>& entityPairs,std::vector<int>& cacheDat);
-    int _getPosition(int entity1,int entity2,bool& inverted,std::vector<int>& entityPairs,std::vector<int>& cacheDat);
+    void _getCacheData(int entity1,int entity2,int cache[4],std::vector<int>& entityPairs,std::vector<int>& cacheDat,boost::unordered_map<std::pair<int,int>,int>& pairPositions);
+    void _setCacheData(int entity1,int entity2,int cache[4],std::vector<int>& entityPairs,std::vector<int>& cacheDat,boost::unordered_map<std::pair<int,int>,int>& pairPositions);
+    int _getPosition(int entity1,int entity2,bool& inverted,std::vector<int>& entityPairs,std::vector<int>& cacheDat,boost::unordered_map<std::pair<int,int>,int>& pairPositions);
     std::vector<int> entityPairIDs_dist;
     std::vector<int> cacheData_dist;
+    boost::unordered_map<std::pair<int,int>,int> pairPositions_dist; // (entity1,entity2) --> position in above vectors
 };
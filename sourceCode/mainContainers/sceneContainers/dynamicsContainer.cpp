@@ -4,6 +4,7 @@
 #include "dynamicsContainer.h"
 #include "pluginContainer.h"
 #include "app.h"
+#include "stepProfiler.h"
 #include "v_repStringTable.h"
 #include "tt.h"
 #include "dynamicsRendering.h"
@@ -145,6 +146,7 @@ bool CDynamicsContainer::getCurrentlyInDynamicsCalculations()
 
 void CDynamicsContainer::handleDynamics(float dt)
 {
+    CStepProfilerScope profilerScope(PROFILER_CATEGORY_DYNAMICS,-1);
     App::ct->calcInfo->dynamicsStart();
 
     for (size_t i=0;i<App::ct->objCont->objectList.size();i++)
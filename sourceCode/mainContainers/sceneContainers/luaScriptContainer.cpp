@@ -12,6 +12,7 @@
 #include "funcDebug.h"
 
 bool CLuaScriptContainer::_saveIncludeScriptFiles=false;
+int CLuaScriptContainer::_scriptExecutionPlanValidityNumber=0;
 
 bool CLuaScriptContainer::getSaveIncludeScriptFiles()
 {
@@ -26,6 +27,9 @@ void CLuaScriptContainer::setSaveIncludeScriptFiles(bool save)
 CLuaScriptContainer::CLuaScriptContainer()
 {
     _inMainScriptNow=0;
+    _scriptExecutionPlansInUse=0;
+    _scriptExecutionPlansValidityNumber=-1;
+    _scriptExecutionPlansModelPropertyValidityNumber=-1;
     insertDefaultScript_mainAndChildScriptsOnly(sim_scripttype_mainscript,false);
 }
 
@@ -37,6 +41,8 @@ CLuaScriptContainer::~CLuaScriptContainer()
     for (size_t i=0;i<_callbackStructureToDestroyAtEndOfSimulation_old.size();i++)
         delete _callbackStructureToDestroyAtEndOfSimulation_old[i];
     broadcastDataContainer.removeAllObjects();
+    _retireScriptExecutionPlans();
+    _releaseRetiredScriptExecutionPlans();
 }
 
 bool CLuaScriptContainer::hasSceneIncludeScripts() const
@@ -152,6 +158,7 @@ int CLuaScriptContainer::removeDestroyedScripts(int scriptType)
                 allScripts.erase(allScripts.begin()+i);
                 i--;
                 delete it;
+                incrementScriptExecutionPlanValidityNumber();
             }
         }
     }
@@ -212,6 +219,7 @@ void CLuaScriptContainer::removeAllScripts()
         allScripts.erase(allScripts.begin());
         delete it;
     }
+    incrementScriptExecutionPlanValidityNumber();
 }
 
 void CLuaScriptContainer::killAllSimulationLuaStates()
@@ -264,6 +272,7 @@ bool CLuaScriptContainer::removeScript(int scriptID)
             it->killLuaState(); // should not be done in the destructor!
             allScripts.erase(allScripts.begin()+i);
             delete it;
+            incrementScriptExecutionPlanValidityNumber();
             App::ct->setModificationFlag(16384);
             break;
         }
@@ -355,6 +364,7 @@ int CLuaScriptContainer::insertScript(CLuaScriptObject* script)
         newID++;
     script->setScriptID(newID);
     allScripts.push_back(script);
+    incrementScriptExecutionPlanValidityNumber();
     App::ct->setModificationFlag(8192);
     return(newID);
 }
@@ -492,13 +502,52 @@ int CLuaScriptContainer::_getScriptsToExecute(int scriptType,std::vector<CLuaScr
     return(int(scripts.size()));
 }
 
+void CLuaScriptContainer::incrementScriptExecutionPlanValidityNumber()
+{ // static. Call this when the hierarchy, or a script's attachment, type, disabled state, execution order or traversal direction changed
+    _scriptExecutionPlanValidityNumber++;
+}
+
+const std::vector<CLuaScriptObject*>* CLuaScriptContainer::_getScriptExecutionPlan(int scriptType)
+{
+    int mpvn=C3DObject::getModelPropertyValidityNumber(); // e.g. sim_modelproperty_scripts_inactive
+    if ( (_scriptExecutionPlansValidityNumber!=_scriptExecutionPlanValidityNumber)||(_scriptExecutionPlansModelPropertyValidityNumber!=mpvn) )
+    {
+        _retireScriptExecutionPlans();
+        if (_scriptExecutionPlansInUse==0)
+            _releaseRetiredScriptExecutionPlans();
+        _scriptExecutionPlansValidityNumber=_scriptExecutionPlanValidityNumber;
+        _scriptExecutionPlansModelPropertyValidityNumber=mpvn;
+    }
+    std::map<int,std::vector<CLuaScriptObject*>*>::iterator it=_scriptExecutionPlans.find(scriptType);
+    if (it!=_scriptExecutionPlans.end())
+        return(it->second);
+    std::vector<CLuaScriptObject*>* plan=new std::vector<CLuaScriptObject*>;
+    _getScriptsToExecute(scriptType,plan[0]);
+    _scriptExecutionPlans[scriptType]=plan;
+    return(plan);
+}
+
+void CLuaScriptContainer::_retireScriptExecutionPlans()
+{ // retired plans are released once no cascaded call iterates them anymore
+    for (std::map<int,std::vector<CLuaScriptObject*>*>::iterator it=_scriptExecutionPlans.begin();it!=_scriptExecutionPlans.end();it++)
+        _retiredScriptExecutionPlans.push_back(it->second);
+    _scriptExecutionPlans.clear();
+}
+
+void CLuaScriptContainer::_releaseRetiredScriptExecutionPlans()
+{
+    for (size_t i=0;i<_retiredScriptExecutionPlans.size();i++)
+        delete _retiredScriptExecutionPlans[i];
+    _retiredScriptExecutionPlans.clear();
+}
+
 int CLuaScriptContainer::handleCascadedScriptExecution(int scriptType,int callTypeOrResumeLocation,CInterfaceStack* inStack,CInterfaceStack* outStack,int* retInfo)
 {
     int cnt=0;
     if (retInfo!=NULL)
         retInfo[0]=0;
-    std::vector<CLuaScriptObject*> scripts;
-    _getScriptsToExecute(scriptType,scripts);
+    const std::vector<CLuaScriptObject*>& scripts=_getScriptExecutionPlan(scriptType)[0];
+    _scriptExecutionPlansInUse++; // the scripts might trigger nested cascaded calls, or modify the plans
     for (size_t i=0;i<scripts.size();i++)
     {
         CLuaScriptObject* script=scripts[i];
@@ -506,7 +555,7 @@ int CLuaScriptContainer::handleCascadedScriptExecution(int scriptType,int callTy
         {
             if (scriptType==sim_scripttype_customizationscript)
             {
-                bool doIt=true;
+                bool doIt=script->getContainsSystemCallbackFunction(callTypeOrResumeLocation);
                 if ( (callTypeOrResumeLocation==sim_syscb_dyncallback)&&(!script->getContainsDynCallbackFunction()) )
                     doIt=false;
                 if ( (callTypeOrResumeLocation==sim_syscb_contactcallback)&&(!script->getContainsContactCallbackFunction()) )
@@ -551,7 +600,7 @@ int CLuaScriptContainer::handleCascadedScriptExecution(int scriptType,int callTy
                 }
                 else
                 {
-                    bool doIt=true;
+                    bool doIt=script->getContainsSystemCallbackFunction(callTypeOrResumeLocation);
                     if ( (callTypeOrResumeLocation==sim_syscb_dyncallback)&&(!script->getContainsDynCallbackFunction()) )
                         doIt=false;
                     if ( (callTypeOrResumeLocation==sim_syscb_contactcallback)&&(!script->getContainsContactCallbackFunction()) )
@@ -573,6 +622,9 @@ int CLuaScriptContainer::handleCascadedScriptExecution(int scriptType,int callTy
             }
         }
     }
+    _scriptExecutionPlansInUse--;
+    if (_scriptExecutionPlansInUse==0)
+        _releaseRetiredScriptExecutionPlans();
     return(cnt);
 }
 
@@ -65,9 +65,13 @@ public:
 
     static bool getSaveIncludeScriptFiles();
     static void setSaveIncludeScriptFiles(bool save);
+    static void incrementScriptExecutionPlanValidityNumber();
 
 protected:
     int _getScriptsToExecute(int scriptType,std::vector<CLuaScriptObject*>& scripts) const;
+    const std::vector<CLuaScriptObject*>* _getScriptExecutionPlan(int scriptType);
+    void _retireScriptExecutionPlans();
+    void _releaseRetiredScriptExecutionPlans();
 
     int _inMainScriptNow;
     int _mainScriptStartTimeInMs;
@@ -75,4 +79,12 @@ protected:
     std::vector<SScriptCallBack*> _callbackStructureToDestroyAtEndOfSimulation_new;
     std::vector<SLuaCallBack*> _callbackStructureToDestroyAtEndOfSimulation_old;
     static bool _saveIncludeScriptFiles;
+
+    // Ordered scripts to execute, for each script type. Rebuilt only when the hierarchy, a script or a model property changed:
+    std::map<int,std::vector<CLuaScriptObject*>*> _scriptExecutionPlans;
+    std::vector<std::vector<CLuaScriptObject*>*> _retiredScriptExecutionPlans; // might still be iterated by an outer cascaded call
+    int _scriptExecutionPlansInUse;
+    int _scriptExecutionPlansValidityNumber;
+    int _scriptExecutionPlansModelPropertyValidityNumber;
+    static int _scriptExecutionPlanValidityNumber;
 };
@@ -15,6 +15,9 @@
 #include "v_repStrings.h"
 #include "app.h"
 #include "vDateTime.h"
+#include "workerPool.h"
+#include "collisionStructureCache.h"
+#include <algorithm>
 
 CObjCont::CObjCont()
 {
@@ -342,6 +345,9 @@ bool CObjCont::loadModelOrScene(CSer& ar,bool selectLoaded,bool isScene,bool jus
                                         loadedDynMaterialList,
                                         !isScene,fileVrepVersion,forceModelAsCopy);
 
+    if ( App::userSettings->prebuildCollisionStructures&&(!App::ct->undoBufferContainer->isUndoSavingOrRestoringUnderWay()) )
+        _prebuildCalculationStructures(loadedObjectList);
+
     // Following to avoid the flickering when loading something (also during undo/redo):
     for (size_t i=0;i<App::ct->objCont->objectList.size();i++)
     {
@@ -373,6 +379,53 @@ bool CObjCont::loadModelOrScene(CSer& ar,bool selectLoaded,bool isScene,bool jus
     return(true);
 }
 
+struct SCalculationStructurePrebuild
+{
+    std::vector<CShape*> shapes;
+    std::vector<void*> calculationStructures;
+    int firstShape;
+};
+
+void CObjCont::_prebuildCalculationStructures(const std::vector<C3DObject*>& objects)
+{ // Otherwise the calculation structures are built one at a time, when first needed (i.e. mostly during the first simulation steps).
+  // Structures are computed in the worker threads, but only assigned here. The mesh engine only sees independent creations
+    SCalculationStructurePrebuild prebuild;
+    for (size_t i=0;i<objects.size();i++)
+    {
+        if (objects[i]->getObjectType()==sim_object_shape_type)
+        {
+            CShape* shape=(CShape*)objects[i];
+            int prop=shape->getCumulativeObjectSpecialProperty();
+            if ( (!shape->isCollisionInformationInitialized())&&((prop&(sim_objectspecialproperty_collidable|sim_objectspecialproperty_measurable|sim_objectspecialproperty_detectable_all))!=0) )
+                prebuild.shapes.push_back(shape);
+        }
+    }
+    if (prebuild.shapes.size()==0)
+        return;
+    prebuild.calculationStructures.resize(prebuild.shapes.size(),NULL);
+    // We work in batches, in order to report progress:
+    int batchSize=SIM_MAX(8,4*(CWorkerPool::getEffectiveWorkerCount()+1));
+    int shapeCount=int(prebuild.shapes.size());
+    CCollisionStructureCache::prepareForConcurrentCalls();
+    for (prebuild.firstShape=0;prebuild.firstShape<shapeCount;prebuild.firstShape+=batchSize)
+    {
+        App::uiThread->showOrHideProgressBar(true,float(prebuild.firstShape)/float(shapeCount),"Building collision structures...");
+        CPluginContainer::mesh_setConcurrentAccess(true);
+        CWorkerPool::executeTasks(_prebuildCalculationStructureTask,&prebuild,SIM_MIN(batchSize,shapeCount-prebuild.firstShape));
+        CPluginContainer::mesh_setConcurrentAccess(false);
+    }
+    App::uiThread->showOrHideProgressBar(false);
+    for (size_t i=0;i<prebuild.shapes.size();i++)
+        prebuild.shapes[i]->geomData->collInfo=prebuild.calculationStructures[i];
+}
+
+void CObjCont::_prebuildCalculationStructureTask(void* taskData,int taskIndex)
+{
+    SCalculationStructurePrebuild* prebuild=(SCalculationStructurePrebuild*)taskData;
+    int index=prebuild->firstShape+taskIndex;
+    prebuild->calculationStructures[index]=prebuild->shapes[index]->geomData->computeCalculationStructure();
+}
+
 void CObjCont::addObjectsToSceneAndPerformMappings(std::vector<C3DObject*>* loadedObjectList,
                                                     std::vector<CRegCollection*>* loadedGroupList,
                                                     std::vector<CRegCollision*>* loadedCollisionList,
@@ -1093,7 +1146,7 @@ std::string CObjCont::getSimilarNameWithHighestSuffix(std::string objectName,boo
     return(highestSuffixName);
 }
 
-void CObjCont::saveScene(CSer& ar)
+void CObjCont::saveScene(CSer& ar,std::vector<int>* objectSections/*=NULL*/)
 {
     // **** Following needed to save existing calculation structures:
     App::ct->environment->setSaveExistingCalculationStructuresTemp(false);
@@ -1163,7 +1216,14 @@ void CObjCont::saveScene(CSer& ar)
     for (int i=0;i<int(objectList.size());i++)
     {
         C3DObject* it=getObject(objectList[i]);
+        if (objectSections!=NULL)
+        {
+            objectSections->push_back(it->getID());
+            objectSections->push_back(int(ar.getFileBuffer()->size()));
+        }
         store3DObject(ar,it);
+        if (objectSections!=NULL)
+            objectSections->push_back(int(ar.getFileBuffer()->size()));
     }
 
     ar.storeDataName(SER_GHOSTS);
@@ -2912,6 +2972,8 @@ bool CObjCont::addObjectToSceneWithSuffixOffset(C3DObject* newObject,bool object
     objectList.push_back(i); // Added at the end of the list --> rendered first
     // Set the object in the index list:
     _objectIndex[i]=newObject;
+    _addToNameIndex(_objectNameIndex,newObject->getName(),i);
+    _addToNameIndex(_objectAltNameIndex,newObject->getAltName(),i);
 
     if (newObject->getObjectType()==sim_object_graph_type)
     { // If the simulation is running, we have to empty the buffer!!! (otherwise we might have old and new data mixed together (e.g. old data in future, new data in present!)
@@ -3099,6 +3161,8 @@ void CObjCont::removeAllObjects(bool generateBeforeAfterDeleteCallback)
     objectList.clear();
     _objectIndex.clear();
     _objectIndex.resize(SIM_IDEND_3DOBJECT-SIM_IDSTART_3DOBJECT,NULL);
+    _objectNameIndex.clear();
+    _objectAltNameIndex.clear();
     _selectedObjectsBool.clear();
     _selectedObjectsBool.resize((SIM_IDEND_3DOBJECT-SIM_IDSTART_3DOBJECT)/8,0);
 
@@ -3241,6 +3305,8 @@ void CObjCont::actualizeObjectInformation()
             if (parent!=NULL)
                 parent->childList.push_back(it);
         }
+        C3DObject::incrementTransformationValidityNumber(); // cached cumulative transformations rely on the child lists
+        CLuaScriptContainer::incrementScriptExecutionPlanValidityNumber(); // so do the script execution plans
 
         // Actualize the light, graph, sensor & joint list
         jointList.clear();
@@ -3326,24 +3392,65 @@ void CObjCont::actualizeObjectInformation()
 
 int CObjCont::getObjectIdentifier(const std::string& objectName)
 {
-    for (size_t i=0;i<objectList.size();i++)
-    {
-        if (_objectIndex[objectList[i]]->getName().compare(objectName)==0)
-            return(objectList[i]);
-    }
-    return(-1);
+    return(_getObjectIdentifierFromNameIndex(_objectNameIndex,objectName));
 }
 
 int CObjCont::getObjectIdentifierFromAltName(const std::string& objectAltName)
 {
+    return(_getObjectIdentifierFromNameIndex(_objectAltNameIndex,objectAltName));
+}
+
+int CObjCont::_getObjectIdentifierFromNameIndex(const boost::unordered_map<std::string,std::vector<int> >& index,const std::string& name) const
+{ // If several objects have the same name, the first one in objectList is returned
+    boost::unordered_map<std::string,std::vector<int> >::const_iterator it=index.find(name);
+    if (it==index.end())
+        return(-1);
+    const std::vector<int>& ids=it->second;
+    if (ids.size()==1)
+        return(ids[0]);
     for (size_t i=0;i<objectList.size();i++)
     {
-        if (_objectIndex[objectList[i]]->getAltName().compare(objectAltName)==0)
+        if (std::find(ids.begin(),ids.end(),objectList[i])!=ids.end())
             return(objectList[i]);
     }
     return(-1);
 }
 
+void CObjCont::_addToNameIndex(boost::unordered_map<std::string,std::vector<int> >& index,const std::string& name,int objectId)
+{ // static
+    index[name].push_back(objectId);
+}
+
+void CObjCont::_removeFromNameIndex(boost::unordered_map<std::string,std::vector<int> >& index,const std::string& name,int objectId)
+{ // static
+    boost::unordered_map<std::string,std::vector<int> >::iterator it=index.find(name);
+    if (it!=index.end())
+    {
+        std::vector<int>& ids=it->second;
+        std::vector<int>::iterator idIt=std::find(ids.begin(),ids.end(),objectId);
+        if (idIt!=ids.end())
+            ids.erase(idIt);
+        if (ids.size()==0)
+            index.erase(it);
+    }
+}
+
+void CObjCont::announceObjectNameChanged(const C3DObject* object,const std::string& previousName,bool altName)
+{ // Called by C3DObject::setName and C3DObject::setAltName. Objects not (yet) in this container are ignored
+    if ( (object==NULL)||(getObject(object->getID())!=object) )
+        return;
+    if (altName)
+    {
+        _removeFromNameIndex(_objectAltNameIndex,previousName,object->getID());
+        _addToNameIndex(_objectAltNameIndex,object->getAltName(),object->getID());
+    }
+    else
+    {
+        _removeFromNameIndex(_objectNameIndex,previousName,object->getID());
+        _addToNameIndex(_objectNameIndex,object->getName(),object->getID());
+    }
+}
+
 int CObjCont::getHighestObjectID()
 {
     int highest=-1;
@@ -3465,6 +3572,8 @@ bool CObjCont::eraseObject(C3DObject* it,bool generateBeforeAfterDeleteCallback)
     objectList.erase(objectList.begin()+i);
     // Now remove the object from the index
     _objectIndex[it->getID()]=NULL;
+    _removeFromNameIndex(_objectNameIndex,it->getName(),it->getID());
+    _removeFromNameIndex(_objectAltNameIndex,it->getAltName(),it->getID());
     delete it;
     C3DObject::incrementModelPropertyValidityNumber();
     actualizeObjectInformation();
@@ -29,6 +29,7 @@
 #include "ikGroup.h"
 #include "mainCont.h"
 #include "xmlSer.h"
+#include <boost/unordered_map.hpp>
 
 class CObjCont : public CMainCont 
 {
@@ -115,7 +116,7 @@ public:
     C3DObject* load3DObject(CSer& ar,std::string theName,bool &noHit);
     void store3DObject(CSer& ar,C3DObject* it);
     bool loadScene(CSer& ar,bool forUndoRedoOperation);
-    void saveScene(CSer& ar);
+    void saveScene(CSer& ar,std::vector<int>* objectSections=NULL); // objectSections: receives object ID, start and end in ar.getFileBuffer() for each object
     void exportIkContent(CExtIkSer& ar);
     bool loadModel(CSer& ar,bool justLoadThumbnail,bool forceModelAsCopy,C7Vector* optionalModelTr,C3Vector* optionalModelBoundingBoxSize,float* optionalModelNonDefaultTranslationStepSize);
     bool loadModelOrScene(CSer& ar,bool selectLoaded,bool isScene,bool justLoadThumbnail,bool forceModelAsCopy,C7Vector* optionalModelTr,C3Vector* optionalModelBoundingBoxSize,float* optionalModelNonDefaultTranslationStepSize);
@@ -255,6 +256,7 @@ public:
     CJoint* getJoint(int identifier);
     C3DObject* getObject(const std::string& name);
     C3DObject* getObjectFromAltName(const std::string& altName);
+    void announceObjectNameChanged(const C3DObject* object,const std::string& previousName,bool altName);
 
     bool makeObjectChildOf(C3DObject* childObject,C3DObject* parentObject);
     void setAbsoluteConfiguration(int identifier,const C7Vector& v,bool keepChildrenInPlace);
@@ -301,12 +303,23 @@ public:
     C3Vector _ikManipulationCurrentPosAbs;
 
 private:
+    void _prebuildCalculationStructures(const std::vector<C3DObject*>& objects);
+    int _getObjectIdentifierFromNameIndex(const boost::unordered_map<std::string,std::vector<int> >& index,const std::string& name) const;
+    static void _addToNameIndex(boost::unordered_map<std::string,std::vector<int> >& index,const std::string& name,int objectId);
+    static void _removeFromNameIndex(boost::unordered_map<std::string,std::vector<int> >& index,const std::string& name,int objectId);
+    static void _prebuildCalculationStructureTask(void* taskData,int taskIndex);
+
     std::vector<int> _selectedObjectIDs;
     std::vector<unsigned char> _selectedObjectsBool;
 
     std::string _loadOperationIssuesToBeDisplayed;
     std::vector<int> _loadOperationIssuesToBeDisplayed_objectHandles;
 
+    // Name and alt name to handles indices, kept in sync with objectList. Names are normally unique in a
+    // scene, but all handles are kept, so that lookups return the same as a scan of objectList would:
+    boost::unordered_map<std::string,std::vector<int> > _objectNameIndex;
+    boost::unordered_map<std::string,std::vector<int> > _objectAltNameIndex;
+
     static float _defaultSceneID;
 };
 
@@ -4,6 +4,7 @@
 #include "registeredCollisions.h"
 #include "tt.h"
 #include "collisionRoutine.h"
+#include "collisionBroadPhase.h"
 #include "app.h"
 
 CRegisteredCollisions::CRegisteredCollisions()
@@ -290,6 +291,10 @@ void CRegisteredCollisions::resetAllCollisions(bool exceptExplicitHandling)
 int CRegisteredCollisions::handleAllCollisions(bool exceptExplicitHandling)
 {
     int retVal=0;
+    // The world-space boxes of all collidable objects are computed once, and shared by all collision objects:
+    bool broadPhaseBuilt=false;
+    if (collisionObjects.size()!=0)
+        broadPhaseBuilt=CCollisionBroadPhase::build();
     for (int i=0;i<int(collisionObjects.size());i++)
     {
         if ( (!collisionObjects[i]->getExplicitHandling())||(!exceptExplicitHandling) )
@@ -298,6 +303,8 @@ int CRegisteredCollisions::handleAllCollisions(bool exceptExplicitHandling)
                 retVal++;
         }
     }
+    if (broadPhaseBuilt)
+        CCollisionBroadPhase::release();
     return(retVal);
 }
 
@@ -284,19 +284,25 @@ float CRegisteredDistances::handleAllDistances(bool exceptExplicitHandling)
     if (!App::ct->mainSettings->distanceCalculationEnabled)
         return(-1.0f);
 
-    float retVal=SIM_MAX_FLOAT;
-    bool retPos=false;
+    std::vector<CRegDist*> toHandle;
     for (int i=0;i<int(distanceObjects.size());i++)
     {
         if ( (!distanceObjects[i]->getExplicitHandling())||(!exceptExplicitHandling) )
+            toHandle.push_back(distanceObjects[i]);
+    }
+    std::vector<float> distances;
+    CDistanceRoutine::handleDistances(toHandle,distances);
+
+    float retVal=SIM_MAX_FLOAT;
+    bool retPos=false;
+    for (size_t i=0;i<distances.size();i++)
+    {
+        float d=distances[i];
+        if (d>=0.0f)
         {
-            float d=distanceObjects[i]->handleDistance();
-            if (d>=0.0f)
-            {
-                retPos=true;
-                if (d<retVal)
-                    retVal=d;
-            }
+            retPos=true;
+            if (d<retVal)
+                retVal=d;
         }
     }
     if (!retPos)
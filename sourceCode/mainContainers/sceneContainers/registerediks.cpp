@@ -6,6 +6,11 @@
 #include "tt.h"
 #include "v_rep_internal.h"
 #include "vDateTime.h"
+#include "workerPool.h"
+#include "pluginContainer.h"
+#include "stepProfiler.h"
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
 
 CRegisterediks::CRegisterediks()
 {
@@ -214,18 +219,228 @@ int CRegisterediks::computeAllIkGroups(bool exceptExplicitHandling)
     int performedCount=0;
     if (App::ct->mainSettings->ikCalculationEnabled)
     {
+        std::vector<CikGroup*> groups;
         for (int i=0;i<int(ikGroups.size());i++)
         {
             if ((!exceptExplicitHandling)||(!ikGroups[i]->getExplicitHandling()))
+                groups.push_back(ikGroups[i]);
+        }
+        bool done=false;
+        if (App::userSettings->parallelIkGroups&&(groups.size()>1)&&(CWorkerPool::getEffectiveWorkerCount()>0))
+            done=_computeIkGroupsConcurrently(groups);
+        if (!done)
+        {
+            for (size_t i=0;i<groups.size();i++)
+                _computeIkGroup(groups[i]);
+        }
+        for (size_t i=0;i<groups.size();i++)
+        {
+            if (groups[i]->getCalculationResult()!=sim_ikresult_not_performed)
+                performedCount++;
+        }
+    }
+    return(performedCount);
+}
+
+void CRegisterediks::_computeIkGroup(CikGroup* group)
+{ // static
+    int stTime=VDateTime::getTimeInMs();
+    int res=0;
+    res=group->computeGroupIk(false);
+    group->setCalculationResult(res,VDateTime::getTimeDiffInMs(stTime));
+}
+
+bool CRegisterediks::_computeIkGroupsConcurrently(const std::vector<CikGroup*>& groups)
+{ // Groups are partitioned into independent sets: two groups end up in the same set if one modifies an
+  // object the other one reads or modifies, or if one is conditioned on the result of the other. Sets are
+  // computed concurrently, groups of a same set one after the other, in their original order. The results
+  // are identical to the ones of the sequential computation. Returns false if groups were not computed
+    if (!CikGroup::resetAllTemporaryParameters())
+    {
+        _reportPartitioning("IK groups are computed sequentially (spherical or not up-to-date dependent joints in the scene).");
+        return(false);
+    }
+
+    // Union-find over the groups:
+    std::vector<int> parents;
+    for (size_t i=0;i<groups.size();i++)
+        parents.push_back(int(i));
+    std::vector<std::vector<int> > readObjects(groups.size());
+    std::vector<std::vector<int> > writtenObjects(groups.size());
+    std::map<int,std::vector<int> > objectWriters; // object handle --> indices of the groups modifying it
+    int globalGroup=-1;
+    for (size_t i=0;i<groups.size();i++)
+    {
+        bool conflictsWithAll;
+        groups[i]->getConcurrencyObjects(readObjects[i],writtenObjects[i],conflictsWithAll);
+        for (size_t j=0;j<writtenObjects[i].size();j++)
+            objectWriters[writtenObjects[i][j]].push_back(int(i));
+        if (conflictsWithAll)
+        {
+            if (globalGroup==-1)
+                globalGroup=int(i);
+            else
+                _union(parents,globalGroup,int(i));
+        }
+    }
+    for (size_t i=0;i<groups.size();i++)
+    {
+        if (globalGroup!=-1)
+            _union(parents,globalGroup,int(i));
+        for (int k=0;k<2;k++)
+        {
+            std::vector<int>& objects=((k==0)?readObjects[i]:writtenObjects[i]);
+            for (size_t j=0;j<objects.size();j++)
             {
-                int stTime=VDateTime::getTimeInMs();
-                int res=0;
-                res=ikGroups[i]->computeGroupIk(false);
-                ikGroups[i]->setCalculationResult(res,VDateTime::getTimeDiffInMs(stTime));
-                if (res!=sim_ikresult_not_performed)
-                    performedCount++;
+                std::map<int,std::vector<int> >::iterator it=objectWriters.find(objects[j]);
+                if (it!=objectWriters.end())
+                {
+                    for (size_t l=0;l<it->second.size();l++)
+                        _union(parents,int(i),it->second[l]);
+                }
             }
         }
+        int other=groups[i]->getDoOnFailOrSuccessOf();
+        for (size_t j=0;j<groups.size();j++)
+        {
+            if (groups[j]->getObjectID()==other)
+                _union(parents,int(i),int(j));
+        }
     }
-    return(performedCount);
+
+    // Build the sets (ordered by their first group), and the objects each set modifies:
+    std::vector<std::vector<CikGroup*> > components;
+    std::vector<std::vector<CJoint*> > joints;
+    std::vector<std::vector<CDummy*> > dummies;
+    std::map<int,int> rootToComponent;
+    std::string partitioning;
+    for (size_t i=0;i<groups.size();i++)
+    {
+        int root=_find(parents,int(i));
+        std::map<int,int>::iterator it=rootToComponent.find(root);
+        int c;
+        if (it==rootToComponent.end())
+        {
+            c=int(components.size());
+            rootToComponent[root]=c;
+            components.push_back(std::vector<CikGroup*>());
+            joints.push_back(std::vector<CJoint*>());
+            dummies.push_back(std::vector<CDummy*>());
+        }
+        else
+            c=it->second;
+        components[c].push_back(groups[i]);
+        for (size_t j=0;j<writtenObjects[i].size();j++)
+        {
+            C3DObject* obj=App::ct->objCont->getObject(writtenObjects[i][j]);
+            if (obj->getObjectType()==sim_object_joint_type)
+            {
+                if (std::find(joints[c].begin(),joints[c].end(),(CJoint*)obj)==joints[c].end())
+                    joints[c].push_back((CJoint*)obj);
+            }
+            if (obj->getObjectType()==sim_object_dummy_type)
+            {
+                if (std::find(dummies[c].begin(),dummies[c].end(),(CDummy*)obj)==dummies[c].end())
+                    dummies[c].push_back((CDummy*)obj);
+            }
+        }
+    }
+    for (size_t c=0;c<components.size();c++)
+    {
+        partitioning+=(c==0)?" {":", {";
+        for (size_t i=0;i<components[c].size();i++)
+        {
+            if (i!=0)
+                partitioning+=", ";
+            partitioning+=components[c][i]->getObjectName();
+        }
+        partitioning+="}";
+    }
+    if (components.size()<2)
+    {
+        _reportPartitioning("IK groups are computed sequentially (no independent groups):"+partitioning);
+        return(false);
+    }
+    _reportPartitioning("IK groups are computed concurrently, in "+boost::lexical_cast<std::string>(components.size())+" independent sets:"+partitioning);
+
+    std::vector<std::vector<suint64> > startTimes(components.size());
+    std::vector<std::vector<suint64> > durations(components.size());
+    for (size_t c=0;c<components.size();c++)
+    {
+        startTimes[c].resize(components[c].size(),0);
+        durations[c].resize(components[c].size(),0);
+        for (size_t i=0;i<components[c].size();i++)
+        {
+            components[c][i]->setTemporaryParameterObjects(&joints[c],&dummies[c]);
+            components[c][i]->setComputedConcurrently(true);
+        }
+    }
+    SIkComponentTask taskData;
+    taskData.components=&components;
+    taskData.startTimes=&startTimes;
+    taskData.durations=&durations;
+
+    CPluginContainer::mesh_setConcurrentAccess(true);
+    C3DObject::setCumulativeTransformationCacheBypassed(true); // joints are modified by the worker threads
+    CWorkerPool::executeTasks(_ikComponentTask,&taskData,int(components.size()));
+    C3DObject::setCumulativeTransformationCacheBypassed(false);
+    CPluginContainer::mesh_setConcurrentAccess(false);
+
+    // Calculation info and profiler events, per group, as with the sequential computation:
+    for (size_t c=0;c<components.size();c++)
+    {
+        for (size_t i=0;i<components[c].size();i++)
+        {
+            CikGroup* group=components[c][i];
+            group->setComputedConcurrently(false);
+            group->setTemporaryParameterObjects(NULL,NULL);
+            if (group->getActive())
+                CStepProfiler::recordEvent(PROFILER_CATEGORY_IK,group->getObjectID(),startTimes[c][i],durations[c][i]);
+            if (group->getCalculationResult()!=sim_ikresult_not_performed)
+                App::ct->calcInfo->addInverseKinematicsCalculation(int(durations[c][i]/1000));
+        }
+    }
+    return(true);
+}
+
+void CRegisterediks::_ikComponentTask(void* taskData,int taskIndex)
+{ // static
+    SIkComponentTask* task=(SIkComponentTask*)taskData;
+    std::vector<CikGroup*>& component=task->components->at(taskIndex);
+    for (size_t i=0;i<component.size();i++)
+    {
+        suint64 startTime=VDateTime::getTimeInUs();
+        _computeIkGroup(component[i]);
+        task->startTimes->at(taskIndex)[i]=startTime;
+        task->durations->at(taskIndex)[i]=VDateTime::getTimeInUs()-startTime;
+    }
+}
+
+void CRegisterediks::_reportPartitioning(const std::string& partitioning)
+{ // Reported only when it changed
+    if (partitioning!=_lastReportedPartitioning)
+    {
+        _lastReportedPartitioning=partitioning;
+        App::addStatusbarMessage(partitioning);
+    }
+}
+
+int CRegisterediks::_find(std::vector<int>& parents,int index)
+{ // static
+    while (parents[index]!=index)
+    {
+        parents[index]=parents[parents[index]];
+        index=parents[index];
+    }
+    return(index);
+}
+
+void CRegisterediks::_union(std::vector<int>& parents,int index1,int index2)
+{ // static. The smaller index becomes the root
+    int r1=_find(parents,index1);
+    int r2=_find(parents,index2);
+    if (r1<r2)
+        parents[r2]=r1;
+    if (r2<r1)
+        parents[r1]=r2;
 }
@@ -5,6 +5,13 @@
 #include "ikGroup.h"
 #include "mainCont.h"
 
+struct SIkComponentTask
+{
+    std::vector<std::vector<CikGroup*> >* components; // each set is computed by one worker
+    std::vector<std::vector<suint64> >* startTimes; // in us, for each group of each set
+    std::vector<std::vector<suint64> >* durations; // in us, for each group of each set
+};
+
 class CRegisterediks : public CMainCont 
 {
 public:
@@ -34,4 +41,14 @@ public:
 
     // Variable that need to be serialized on an individual basis:
     std::vector<CikGroup*> ikGroups;
+
+private:
+    bool _computeIkGroupsConcurrently(const std::vector<CikGroup*>& groups);
+    void _reportPartitioning(const std::string& partitioning);
+    static void _computeIkGroup(CikGroup* group);
+    static void _ikComponentTask(void* taskData,int taskIndex);
+    static int _find(std::vector<int>& parents,int index);
+    static void _union(std::vector<int>& parents,int index1,int index2);
+
+    std::string _lastReportedPartitioning;
 };
@@ -6,6 +6,9 @@
 
 CSignalContainer::CSignalContainer()
 {
+    _intSignalTombstoneCount=0;
+    _floatSignalTombstoneCount=0;
+    _stringSignalTombstoneCount=0;
 }
 
 CSignalContainer::~CSignalContainer()
@@ -44,6 +47,7 @@ void CSignalContainer::setIntegerSignal(const char* signalName,int value,bool fr
     int index=_getIntegerSignalIndex(signalName);
     if (index==-1)
     {
+        _intSignalIndices[signalName]=int(_intSignalNames.size());
         _intSignalNames.push_back(signalName);
         _intSignalValues.push_back(value);
         _intSignalEmbScriptCreated.push_back(fromEmbeddedScript);
@@ -65,6 +69,8 @@ bool CSignalContainer::getIntegerSignal(const char* signalName,int& value)
 
 bool CSignalContainer::getIntegerSignalNameAtIndex(int index,std::string& signalName)
 {
+    if (_intSignalTombstoneCount>0)
+        _compactSignals(_intSignalIndices,_intSignalNames,_intSignalValues,_intSignalEmbScriptCreated,_intSignalTombstoneCount);
     if ( (index<0)||(index>=int(_intSignalNames.size())) )
         return(false);
     signalName=_intSignalNames[index];
@@ -78,9 +84,11 @@ int CSignalContainer::clearIntegerSignal(const char* signalName)
     int index=_getIntegerSignalIndex(signalName);
     if (index!=-1)
     {
-        _intSignalNames.erase(_intSignalNames.begin()+index);
-        _intSignalValues.erase(_intSignalValues.begin()+index);
-        _intSignalEmbScriptCreated.erase(_intSignalEmbScriptCreated.begin()+index);
+        _intSignalIndices.erase(_intSignalNames[index]);
+        _intSignalNames[index].clear();
+        _intSignalTombstoneCount++;
+        if (_intSignalTombstoneCount*2>=int(_intSignalNames.size()))
+            _compactSignals(_intSignalIndices,_intSignalNames,_intSignalValues,_intSignalEmbScriptCreated,_intSignalTombstoneCount);
         return(1);
     }
     return(0);
@@ -89,25 +97,18 @@ int CSignalContainer::clearIntegerSignal(const char* signalName)
 int CSignalContainer::clearAllIntegerSignals(bool onlyThoseFromEmbeddedScripts)
 {
     int retVal=0;
-    if (!onlyThoseFromEmbeddedScripts)
+    for (size_t i=0;i<_intSignalNames.size();i++)
     {
-        retVal=int(_intSignalNames.size());
-        _intSignalNames.clear();
-        _intSignalValues.clear();
-        _intSignalEmbScriptCreated.clear();
-    }
-    else
-    {
-        for (int i=0;i<int(_intSignalNames.size());i++)
+        if ( (_intSignalNames[i].length()>0)&&((!onlyThoseFromEmbeddedScripts)||_intSignalEmbScriptCreated[i]) )
         {
-            if (_intSignalEmbScriptCreated[i])
-            {
-                clearIntegerSignal(_intSignalNames[i].c_str());
-                retVal++;
-                i=-1; // ordering might have changed
-            }
+            _intSignalIndices.erase(_intSignalNames[i]);
+            _intSignalNames[i].clear();
+            _intSignalTombstoneCount++;
+            retVal++;
         }
     }
+    if (_intSignalTombstoneCount>0)
+        _compactSignals(_intSignalIndices,_intSignalNames,_intSignalValues,_intSignalEmbScriptCreated,_intSignalTombstoneCount);
     return(retVal);
 }
 
@@ -118,6 +119,7 @@ void CSignalContainer::setFloatSignal(const char* signalName,float value,bool fr
     int index=_getFloatSignalIndex(signalName);
     if (index==-1)
     {
+        _floatSignalIndices[signalName]=int(_floatSignalNames.size());
         _floatSignalNames.push_back(signalName);
         _floatSignalValues.push_back(value);
         _floatSignalEmbScriptCreated.push_back(fromEmbeddedScript);
@@ -139,6 +141,8 @@ bool CSignalContainer::getFloatSignal(const char* signalName,float& value)
 
 bool CSignalContainer::getFloatSignalNameAtIndex(int index,std::string& signalName)
 {
+    if (_floatSignalTombstoneCount>0)
+        _compactSignals(_floatSignalIndices,_floatSignalNames,_floatSignalValues,_floatSignalEmbScriptCreated,_floatSignalTombstoneCount);
     if ( (index<0)||(index>=int(_floatSignalNames.size())) )
         return(false);
     signalName=_floatSignalNames[index];
@@ -152,9 +156,11 @@ int CSignalContainer::clearFloatSignal(const char* signalName)
     int index=_getFloatSignalIndex(signalName);
     if (index!=-1)
     {
-        _floatSignalNames.erase(_floatSignalNames.begin()+index);
-        _floatSignalValues.erase(_floatSignalValues.begin()+index);
-        _floatSignalEmbScriptCreated.erase(_floatSignalEmbScriptCreated.begin()+index);
+        _floatSignalIndices.erase(_floatSignalNames[index]);
+        _floatSignalNames[index].clear();
+        _floatSignalTombstoneCount++;
+        if (_floatSignalTombstoneCount*2>=int(_floatSignalNames.size()))
+            _compactSignals(_floatSignalIndices,_floatSignalNames,_floatSignalValues,_floatSignalEmbScriptCreated,_floatSignalTombstoneCount);
         return(1);
     }
     return(0);
@@ -163,25 +169,18 @@ int CSignalContainer::clearFloatSignal(const char* signalName)
 int CSignalContainer::clearAllFloatSignals(bool onlyThoseFromEmbeddedScripts)
 {
     int retVal=0;
-    if (!onlyThoseFromEmbeddedScripts)
+    for (size_t i=0;i<_floatSignalNames.size();i++)
     {
-        retVal=int(_floatSignalNames.size());
-        _floatSignalNames.clear();
-        _floatSignalValues.clear();
-        _floatSignalEmbScriptCreated.clear();
-    }
-    else
-    {
-        for (int i=0;i<int(_floatSignalNames.size());i++)
+        if ( (_floatSignalNames[i].length()>0)&&((!onlyThoseFromEmbeddedScripts)||_floatSignalEmbScriptCreated[i]) )
         {
-            if (_floatSignalEmbScriptCreated[i])
-            {
-                clearFloatSignal(_floatSignalNames[i].c_str());
-                retVal++;
-                i=-1; // ordering might have changed
-            }
+            _floatSignalIndices.erase(_floatSignalNames[i]);
+            _floatSignalNames[i].clear();
+            _floatSignalTombstoneCount++;
+            retVal++;
         }
     }
+    if (_floatSignalTombstoneCount>0)
+        _compactSignals(_floatSignalIndices,_floatSignalNames,_floatSignalValues,_floatSignalEmbScriptCreated,_floatSignalTombstoneCount);
     return(retVal);
 }
 
@@ -192,12 +191,13 @@ void CSignalContainer::setStringSignal(const char* signalName,const std::string&
     int index=_getStringSignalIndex(signalName);
     if (index==-1)
     {
+        _stringSignalIndices[signalName]=int(_stringSignalNames.size());
         _stringSignalNames.push_back(signalName);
-        _stringSignalValues.push_back(value);
+        _stringSignalValues.push_back(new std::string(value));
         _stringSignalEmbScriptCreated.push_back(fromEmbeddedScript);
     }
     else
-        _stringSignalValues[index]=value;
+        _stringSignalValues[index]->assign(value);
 }
 
 bool CSignalContainer::getStringSignal(const char* signalName,std::string& value)
@@ -207,12 +207,24 @@ bool CSignalContainer::getStringSignal(const char* signalName,std::string& value
     int index=_getStringSignalIndex(signalName);
     if (index==-1)
         return(false);
-    value=_stringSignalValues[index];
+    value=*_stringSignalValues[index];
     return(true);
 }
 
+const std::string* CSignalContainer::getStringSignalPointer(const char* signalName)
+{
+    if ((signalName==NULL)||(strlen(signalName)==0))
+        return(NULL);
+    int index=_getStringSignalIndex(signalName);
+    if (index==-1)
+        return(NULL);
+    return(_stringSignalValues[index]);
+}
+
 bool CSignalContainer::getStringSignalNameAtIndex(int index,std::string& signalName)
 {
+    if (_stringSignalTombstoneCount>0)
+        _compactSignals(_stringSignalIndices,_stringSignalNames,_stringSignalValues,_stringSignalEmbScriptCreated,_stringSignalTombstoneCount);
     if ( (index<0)||(index>=int(_stringSignalNames.size())) )
         return(false);
     signalName=_stringSignalNames[index];
@@ -226,9 +238,13 @@ int CSignalContainer::clearStringSignal(const char* signalName)
     int index=_getStringSignalIndex(signalName);
     if (index!=-1)
     {
-        _stringSignalNames.erase(_stringSignalNames.begin()+index);
-        _stringSignalValues.erase(_stringSignalValues.begin()+index);
-        _stringSignalEmbScriptCreated.erase(_stringSignalEmbScriptCreated.begin()+index);
+        _stringSignalIndices.erase(_stringSignalNames[index]);
+        _stringSignalNames[index].clear();
+        delete _stringSignalValues[index];
+        _stringSignalValues[index]=NULL;
+        _stringSignalTombstoneCount++;
+        if (_stringSignalTombstoneCount*2>=int(_stringSignalNames.size()))
+            _compactSignals(_stringSignalIndices,_stringSignalNames,_stringSignalValues,_stringSignalEmbScriptCreated,_stringSignalTombstoneCount);
         return(1);
     }
     return(0);
@@ -237,56 +253,67 @@ int CSignalContainer::clearStringSignal(const char* signalName)
 int CSignalContainer::clearAllStringSignals(bool onlyThoseFromEmbeddedScripts)
 {
     int retVal=0;
-    if (!onlyThoseFromEmbeddedScripts)
+    for (size_t i=0;i<_stringSignalNames.size();i++)
     {
-        retVal=int(_stringSignalNames.size());
-        _stringSignalNames.clear();
-        _stringSignalValues.clear();
-        _stringSignalEmbScriptCreated.clear();
-    }
-    else
-    {
-        for (int i=0;i<int(_stringSignalNames.size());i++)
+        if ( (_stringSignalNames[i].length()>0)&&((!onlyThoseFromEmbeddedScripts)||_stringSignalEmbScriptCreated[i]) )
         {
-            if (_stringSignalEmbScriptCreated[i])
-            {
-                clearStringSignal(_stringSignalNames[i].c_str());
-                retVal++;
-                i=-1; // ordering might have changed
-            }
+            _stringSignalIndices.erase(_stringSignalNames[i]);
+            _stringSignalNames[i].clear();
+            delete _stringSignalValues[i];
+            _stringSignalValues[i]=NULL;
+            _stringSignalTombstoneCount++;
+            retVal++;
         }
     }
+    if (_stringSignalTombstoneCount>0)
+        _compactSignals(_stringSignalIndices,_stringSignalNames,_stringSignalValues,_stringSignalEmbScriptCreated,_stringSignalTombstoneCount);
     return(retVal);
-
 }
 
 int CSignalContainer::_getIntegerSignalIndex(const char* signalName)
 {
-    for (int i=0;i<int(_intSignalNames.size());i++)
-    {
-        if (_intSignalNames[i].compare(signalName)==0)
-            return(i);
-    }
-    return(-1);
+    boost::unordered_map<std::string,int>::iterator it=_intSignalIndices.find(signalName);
+    if (it==_intSignalIndices.end())
+        return(-1);
+    return(it->second);
 }
 
 int CSignalContainer::_getFloatSignalIndex(const char* signalName)
 {
-    for (int i=0;i<int(_floatSignalNames.size());i++)
-    {
-        if (_floatSignalNames[i].compare(signalName)==0)
-            return(i);
-    }
-    return(-1);
+    boost::unordered_map<std::string,int>::iterator it=_floatSignalIndices.find(signalName);
+    if (it==_floatSignalIndices.end())
+        return(-1);
+    return(it->second);
 }
 
 int CSignalContainer::_getStringSignalIndex(const char* signalName)
 {
-    for (int i=0;i<int(_stringSignalNames.size());i++)
+    boost::unordered_map<std::string,int>::iterator it=_stringSignalIndices.find(signalName);
+    if (it==_stringSignalIndices.end())
+        return(-1);
+    return(it->second);
+}
+
+template<class T>
+void CSignalContainer::_compactSignals(boost::unordered_map<std::string,int>& signalIndices,std::vector<std::string>& signalNames,std::vector<T>& signalValues,std::vector<bool>& signalEmbScriptCreated,int& tombstoneCount)
+{ // removes the tombstones and keeps the remaining signals in their order
+    size_t cnt=0;
+    for (size_t i=0;i<signalNames.size();i++)
     {
-        if (_stringSignalNames[i].compare(signalName)==0)
-            return(i);
+        if (signalNames[i].length()>0)
+        {
+            if (cnt!=i)
+            {
+                signalNames[cnt].swap(signalNames[i]);
+                signalValues[cnt]=signalValues[i];
+                signalEmbScriptCreated[cnt]=signalEmbScriptCreated[i];
+                signalIndices[signalNames[cnt]]=int(cnt);
+            }
+            cnt++;
+        }
     }
-    return(-1);
+    signalNames.resize(cnt);
+    signalValues.resize(cnt);
+    signalEmbScriptCreated.resize(cnt);
+    tombstoneCount=0;
 }
-
@@ -3,6 +3,7 @@
 
 #include "vrepMainHeader.h"
 #include "mainCont.h"
+#include <boost/unordered_map.hpp>
 
 class CSignalContainer : public CMainCont 
 {
@@ -31,6 +32,7 @@ public:
 
     void setStringSignal(const char* signalName,const std::string& value,bool fromEmbeddedScript);
     bool getStringSignal(const char* signalName,std::string& value);
+    const std::string* getStringSignalPointer(const char* signalName); // no copy. Valid until the signal is cleared (setting it again changes the content)
     bool getStringSignalNameAtIndex(int index,std::string& signalName);
     int clearStringSignal(const char* signalName);
     int clearAllStringSignals(bool onlyThoseFromEmbeddedScripts);
@@ -39,6 +41,18 @@ protected:
     int _getIntegerSignalIndex(const char* signalName);
     int _getFloatSignalIndex(const char* signalName);
     int _getStringSignalIndex(const char* signalName);
+    template<class T>
+    static void _compactSignals(boost::unordered_map<std::string,int>& signalIndices,std::vector<std::string>& signalNames,std::vector<T>& signalValues,std::vector<bool>& signalEmbScriptCreated,int& tombstoneCount);
+
+    // Signals are kept in creation order (for the get*SignalNameAtIndex functions), and looked up via following.
+    // A cleared signal leaves a tombstone (empty name) in the vectors, so that clearing is O(1). Tombstones
+    // are removed when they make up half of the vectors, or before the signals are accessed by index:
+    boost::unordered_map<std::string,int> _intSignalIndices;
+    boost::unordered_map<std::string,int> _floatSignalIndices;
+    boost::unordered_map<std::string,int> _stringSignalIndices;
+    int _intSignalTombstoneCount;
+    int _floatSignalTombstoneCount;
+    int _stringSignalTombstoneCount;
 
     std::vector<std::string> _intSignalNames;
     std::vector<int> _intSignalValues;
@@ -49,6 +63,6 @@ protected:
     std::vector<bool> _floatSignalEmbScriptCreated;
 
     std::vector<std::string> _stringSignalNames;
-    std::vector<std::string> _stringSignalValues;
+    std::vector<std::string*> _stringSignalValues; // values are not moved, see getStringSignalPointer. NULL for tombstones
     std::vector<bool> _stringSignalEmbScriptCreated;
 };
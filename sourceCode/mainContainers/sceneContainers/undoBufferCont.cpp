@@ -19,6 +19,7 @@ CUndoBufferCont::~CUndoBufferCont()
     for (int i=0;i<int(_buffers.size());i++)
         delete _buffers[i];
     undoBufferArrays.clearAll();
+    _chunkStore.clearAll();
 }
 
 int CUndoBufferCont::getNextBufferId()
@@ -50,6 +51,8 @@ void CUndoBufferCont::_commonInit()
         delete _buffers[i];
     _buffers.clear();
     undoBufferArrays.clearAll();
+    _chunkStore.clearAll();
+    _objectChunkKeys.clear();
     _announceChangeStartCalled=false;
     _announceChangeGradualCalledTime=-1;
     _sceneSaveMightBeNeeded=false;
@@ -179,12 +182,16 @@ bool CUndoBufferCont::memorizeState()
     _undoPointSavingOrRestoringUnderWay=true;
     CUndoBufferCameras* cameraBuffers=new CUndoBufferCameras();
     cameraBuffers->storeCameras();
-    App::ct->objCont->saveScene(serObj); // This takes the 90% of time of the whole routine
+    std::vector<int> objectSections;
+    App::ct->objCont->saveScene(serObj,&objectSections); // This takes the 90% of time of the whole routine
     cameraBuffers->restoreCameras();
     _undoPointSavingOrRestoringUnderWay=false;
+    int dataSize=int(serObj.getFileBuffer()->size());
     serObj.writeClose(false); // We don't wanna compression
 
-    CUndoBuffer* it=new CUndoBuffer(newBuff,_nextBufferId++,cameraBuffers);
+    std::vector<suint64> chunkKeys;
+    _addToChunkStore(newBuff,int(newBuff.size())-dataSize,objectSections,chunkKeys);
+    CUndoBuffer* it=new CUndoBuffer(chunkKeys,_nextBufferId++,cameraBuffers,&_chunkStore);
     if (_currentStateIndex==-1)
     { // first buffer, we just add it
         _buffers.push_back(it);
@@ -192,9 +199,7 @@ bool CUndoBufferCont::memorizeState()
     }
     else
     { // We check with previous buffer:
-        std::vector<char> prevBuff;
-        _getFullBuffer(_currentStateIndex,prevBuff);
-        if (it->finalize(prevBuff))
+        if (!it->isSameAs(_buffers[_currentStateIndex]))
         { // different from previous, we remove forward buffers and add this one:
             while (int(_buffers.size())>_currentStateIndex+1)
             {
@@ -213,19 +218,7 @@ bool CUndoBufferCont::memorizeState()
         }
     }
 
-    std::vector<char> fullBuff;
-    while ( (_getUsedMemory()+undoBufferArrays.getMemorySizeInBytes()>App::userSettings->undoRedoMaxBufferSize)||(int(_buffers.size())>App::userSettings->undoRedoLevelCount) )
-    { // We have to remove a few states at the beginning
-        if (int(_buffers.size())<3)
-            break; // at least 3 states!
-        _getFullBuffer(1,fullBuff);
-        CUndoBuffer* it=_buffers[1];
-        it->updateWithFullBuffer(fullBuff);
-        undoBufferArrays.removeDependenciesFromUndoBufferId(_buffers[0]->getBufferId());
-        delete _buffers[0];
-        _buffers.erase(_buffers.begin());
-        _currentStateIndex--;
-    }
+    _removeOldestStatesIfNeeded();
     if (VDateTime::getTimeDiffInMs(startTime)>App::userSettings->timeInMsForUndoRedoTooLongWarning)
         tooLongExecutionCount++;
     else
@@ -448,29 +441,54 @@ CUndoBufferCameras* CUndoBufferCont::_getFullBuffer(int index,std::vector<char>&
         fullBuff.clear();
         return(NULL);
     }
-    CUndoBufferCameras* retVal=NULL;
-    if (index==0)
-    { // the first one
-        retVal=_buffers[index]->getCameraBuffers();
-        _buffers[index]->getRestored(NULL,fullBuff);
-    }
-    else
+    _buffers[index]->getRestored(fullBuff);
+    return(_buffers[index]->getCameraBuffers());
+}
+
+void CUndoBufferCont::_addToChunkStore(const std::vector<char>& buff,int dataOffset,const std::vector<int>& objectSections,std::vector<suint64>& chunkKeys)
+{ // Each object's data gets its own chunks. If an object's data didn't change since the last memorized state, its
+  // chunks from then are referenced again, without hashing nor chunking. dataOffset: size of the header before the data
+    FUNCTION_DEBUG;
+    std::map<int,std::vector<suint64> > objectChunkKeys;
+    size_t pos=0;
+    for (size_t i=0;i+2<objectSections.size();i+=3)
     {
-        std::vector<char> prevBuff;
-        _getFullBuffer(index-1,prevBuff);
-        retVal=_buffers[index]->getCameraBuffers();
-        _buffers[index]->getRestored(&prevBuff,fullBuff);
+        size_t start=size_t(dataOffset+objectSections[i+1]);
+        size_t end=size_t(dataOffset+objectSections[i+2]);
+        if (start>pos)
+            _chunkStore.addBuffer(&buff[pos],start-pos,chunkKeys);
+        std::vector<suint64>& keys=objectChunkKeys[objectSections[i]];
+        std::map<int,std::vector<suint64> >::iterator it=_objectChunkKeys.find(objectSections[i]);
+        if ( (it!=_objectChunkKeys.end())&&_chunkStore.addBufferIfSame(it->second,&buff[start],end-start) )
+            keys.swap(it->second);
+        else
+            _chunkStore.addBuffer(&buff[start],end-start,keys);
+        chunkKeys.insert(chunkKeys.end(),keys.begin(),keys.end());
+        pos=end;
     }
-    return(retVal);
+    if (buff.size()>pos)
+        _chunkStore.addBuffer(&buff[pos],buff.size()-pos,chunkKeys);
+    _objectChunkKeys.swap(objectChunkKeys);
 }
 
 int CUndoBufferCont::_getUsedMemory()
-{
+{ // chunks shared by several states are counted once
     FUNCTION_DEBUG;
-    int retVal=0;
-    for (int i=0;i<int(_buffers.size());i++)
-        retVal+=int(_buffers[i]->buffer.size());
-    return (retVal);
+    return(_chunkStore.getMemorySizeInBytes()+undoBufferArrays.getMemorySizeInBytes());
+}
+
+void CUndoBufferCont::_removeOldestStatesIfNeeded()
+{ // Removes states at the beginning, until we are within the memory budget and the max. level count
+    FUNCTION_DEBUG;
+    while ( (_getUsedMemory()>App::userSettings->undoRedoMaxBufferSize)||(int(_buffers.size())>App::userSettings->undoRedoLevelCount) )
+    {
+        if (int(_buffers.size())<3)
+            break; // at least 3 states!
+        undoBufferArrays.removeDependenciesFromUndoBufferId(_buffers[0]->getBufferId());
+        delete _buffers[0]; // releases the chunks that are not used by other states
+        _buffers.erase(_buffers.begin());
+        _currentStateIndex--;
+    }
 }
 
 void CUndoBufferCont::_rememberSelectionState()
@@ -4,6 +4,7 @@
 #include "mainCont.h"
 #include "undoBuffer.h"
 #include "undoBufferArrays.h"
+#include "undoChunkStore.h"
 
 class CUndoBufferCont : public CMainCont
 {
@@ -38,7 +39,9 @@ public:
 private:
 
     CUndoBufferCameras* _getFullBuffer(int index,std::vector<char>& fullBuff);
+    void _addToChunkStore(const std::vector<char>& buff,int dataOffset,const std::vector<int>& objectSections,std::vector<suint64>& chunkKeys);
     int _getUsedMemory();
+    void _removeOldestStatesIfNeeded();
     bool _isGoodToMemorizeUndoOrRedo();
     void _commonInit();
 
@@ -47,6 +50,8 @@ private:
 
     int _currentStateIndex;
     std::vector<CUndoBuffer*> _buffers;
+    CUndoChunkStore _chunkStore; // content of all _buffers
+    std::map<int,std::vector<suint64> > _objectChunkKeys; // object ID --> chunks of the object's data at the last memorized state
     bool _announceChangeStartCalled;
     int _announceChangeGradualCalledTime;
     bool _sceneSaveMightBeNeeded;
@@ -2489,7 +2489,12 @@ bool CFileOperations::saveScene(const char* pathAndFilename,bool displayMessages
             serObj.writeClose(App::userSettings->compressFiles);
 
             if (displayMessages)
+            {
                 App::addStatusbarMessage(IDSNS_SCENE_WAS_SAVED);
+                std::string meshDataStats(CGeometric::getLastTempBufferStatistics());
+                if (meshDataStats.size()>0)
+                    App::addStatusbarMessage(meshDataStats);
+            }
 
             archive.close();
             myFile.close();
@@ -2584,7 +2589,12 @@ bool CFileOperations::saveModel(int modelBaseDummyID,const char* pathAndFilename
             if (displayMessages)
                 App::addStatusbarMessage(infoPrintOut.c_str());
             if (displayMessages)
+            {
                 App::addStatusbarMessage(IDSNS_MODEL_WAS_SAVED);
+                std::string meshDataStats(CGeometric::getLastTempBufferStatistics());
+                if (meshDataStats.size()>0)
+                    App::addStatusbarMessage(meshDataStats);
+            }
             return(true);
         }
     }
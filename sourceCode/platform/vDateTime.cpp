@@ -53,6 +53,45 @@ int VDateTime::getTimeDiffInMs(int oldTime,int newTime)
     return(newTime-oldTime);
 }
 
+suint64 VDateTime::getTimeInUs()
+{
+#ifdef WIN_VREP
+    static bool first=true;
+    static bool works=false;
+    static double pcFreq=0.0;
+    static __int64 cntStart=0;
+    LARGE_INTEGER highResCnt;
+    if (first)
+    {
+        first=false;
+        works=(QueryPerformanceFrequency(&highResCnt)!=0);
+        pcFreq=double(highResCnt.QuadPart)/1000000.0;
+        QueryPerformanceCounter(&highResCnt);
+        cntStart=highResCnt.QuadPart;
+    }
+    if (works)
+    {
+        QueryPerformanceCounter(&highResCnt);
+        return(suint64(double(highResCnt.QuadPart-cntStart)/pcFreq));
+    }
+    return(suint64(getTimeInMs())*1000);
+#else
+#ifdef CLOCK_MONOTONIC
+    // monotonic: not affected by system time changes (NTP, user), unlike gettimeofday
+    struct timespec now;
+    if (clock_gettime(CLOCK_MONOTONIC,&now)==0)
+    {
+        static suint64 initUs=suint64(now.tv_sec)*1000000+now.tv_nsec/1000;
+        return(suint64(now.tv_sec)*1000000+now.tv_nsec/1000-initUs);
+    }
+#endif
+    struct timeval tv;
+    gettimeofday(&tv,NULL);
+    static suint64 initUsTod=suint64(tv.tv_sec)*1000000+tv.tv_usec;
+    return(suint64(tv.tv_sec)*1000000+tv.tv_usec-initUsTod);
+#endif
+}
+
 quint64 VDateTime::getSecondsSince1970()
 {
 #ifdef SIM_WITHOUT_QT_AT_ALL
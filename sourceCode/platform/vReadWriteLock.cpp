@@ -0,0 +1,97 @@
+
+#include "vrepMainHeader.h"
+#include "vReadWriteLock.h"
+
+VReadWriteLock::VReadWriteLock()
+{
+    _waitingWriterCount=0;
+    _writerActive=false;
+    _lockCount=0;
+    _contentionCount=0;
+}
+
+VReadWriteLock::~VReadWriteLock()
+{
+}
+
+void VReadWriteLock::lockForRead()
+{ // waiting writers block new readers (so that writers cannot starve), but not threads that already read
+    VTHREAD_ID_TYPE thread=VThread::getCurrentThreadId();
+    _mutex.lock_simple();
+    _lockCount++;
+    if ( _writerActive||((_waitingWriterCount>0)&&(!_isReader(thread))) )
+    {
+        _contentionCount++;
+        while ( _writerActive||((_waitingWriterCount>0)&&(!_isReader(thread))) )
+            _mutex.wait_simple();
+    }
+    _readerThreads.push_back(thread);
+    _mutex.unlock_simple();
+}
+
+void VReadWriteLock::unlockForRead()
+{
+    VTHREAD_ID_TYPE thread=VThread::getCurrentThreadId();
+    _mutex.lock_simple();
+    for (size_t i=0;i<_readerThreads.size();i++)
+    {
+        if (VThread::areThreadIDsSame(_readerThreads[i],thread))
+        {
+            _readerThreads.erase(_readerThreads.begin()+i);
+            break;
+        }
+    }
+    if (_readerThreads.size()==0)
+        _mutex.wakeAll_simple();
+    _mutex.unlock_simple();
+}
+
+void VReadWriteLock::lockForWrite()
+{
+    _mutex.lock_simple();
+    _lockCount++;
+    if (_writerActive||(_readerThreads.size()>0))
+    {
+        _contentionCount++;
+        _waitingWriterCount++;
+        while (_writerActive||(_readerThreads.size()>0))
+            _mutex.wait_simple();
+        _waitingWriterCount--;
+    }
+    _writerActive=true;
+    _mutex.unlock_simple();
+}
+
+void VReadWriteLock::unlockForWrite()
+{
+    _mutex.lock_simple();
+    _writerActive=false;
+    _mutex.wakeAll_simple();
+    _mutex.unlock_simple();
+}
+
+bool VReadWriteLock::_isReader(VTHREAD_ID_TYPE thread) const
+{
+    for (size_t i=0;i<_readerThreads.size();i++)
+    {
+        if (VThread::areThreadIDsSame(_readerThreads[i],thread))
+            return(true);
+    }
+    return(false);
+}
+
+void VReadWriteLock::getStatistics(unsigned int& lockCount,unsigned int& contentionCount)
+{
+    _mutex.lock_simple();
+    lockCount=_lockCount;
+    contentionCount=_contentionCount;
+    _mutex.unlock_simple();
+}
+
+void VReadWriteLock::resetStatistics()
+{
+    _mutex.lock_simple();
+    _lockCount=0;
+    _contentionCount=0;
+    _mutex.unlock_simple();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "vrepMainHeader.h"
+#include "vMutex.h"
+#include "vThread.h"
+
+// Several readers or a single writer. Waiting writers have priority over new readers, except over
+// threads that already hold a read lock (read locks are recursive). Not recursive for writers
+class VReadWriteLock
+{
+public:
+    VReadWriteLock();
+    virtual ~VReadWriteLock();
+
+    void lockForRead();
+    void unlockForRead();
+    void lockForWrite();
+    void unlockForWrite();
+
+    // Contention means that the calling thread had to wait:
+    void getStatistics(unsigned int& lockCount,unsigned int& contentionCount);
+    void resetStatistics();
+
+private:
+    bool _isReader(VTHREAD_ID_TYPE thread) const;
+
+    VMutex _mutex;
+    std::vector<VTHREAD_ID_TYPE> _readerThreads; // one entry per held read lock
+    int _waitingWriterCount;
+    bool _writerActive;
+    unsigned int _lockCount;
+    unsigned int _contentionCount;
+};
@@ -2,6 +2,9 @@
 #include "drawingObjectRendering.h"
 
 #ifdef SIM_WITH_OPENGL
+#include "vDateTime.h"
+#include "tt.h"
+#include <boost/lexical_cast.hpp>
 
 const float SPHEREVERTICES[24*3]={
 -0.4142f,-1.0000f,-0.4142f,
@@ -138,6 +141,13 @@ void displayDrawingObject(CDrawingObject* drawingObject,C7Vector& tr,bool overla
 
 
     int tmp=_objectType&0x001f;
+    if (_canDrawFromBuffer(drawingObject))
+    {
+        if (tmp==sim_drawing_lines)
+            normalVectorForLinesAndPoints=cameraRTM.M.axis[2]*-1.0f; // same as in _drawLines
+        if (_drawFromBuffer(drawingObject,displayAttrib,normalVectorForLinesAndPoints.data))
+            tmp=-1; // done
+    }
     if (tmp==sim_drawing_points)
         _drawPoints(drawingObject,displayAttrib,cameraRTM,normalVectorForLinesAndPoints.data);
     if (tmp==sim_drawing_lines)
@@ -910,6 +920,577 @@ void _drawTriangles(CDrawingObject* drawingObject,int displayAttrib)
         ogl::setBlending(false); // make sure we turn blending off!
 }
 
+static bool _bufferedDrawingDisabled=false; // used by the benchmark
+static int _cubeTemplateBufferId=-1;
+static int _discTemplateBufferId=-1;
+static int _sphereTemplateBufferId=-1;
+static std::vector<float> _cubeTemplateVertices;
+static std::vector<float> _discTemplateVertices;
+static std::vector<float> _sphereTemplateVertices;
+static const quint64 MAX_BATCHED_FLOATS_PER_DRAWING_OBJECT=64*1024*1024; // i.e. 256 MB of pre-transformed cube, disc or sphere vertices
+static const int ITEMS_PER_UPLOAD=4096;
+
+bool _canDrawFromBuffer(CDrawingObject* drawingObject)
+{ // Items are drawn from vertex buffers, unless something has to be set item by item, or depends on the camera
+    if (_bufferedDrawingDisabled||(!App::userSettings->drawingObjectBuffers))
+        return(false);
+    int _objectType=drawingObject->getObjectType();
+    int tmp=_objectType&0x001f;
+    if (_objectType&sim_drawing_itemtransparency)
+        return(false);
+    if ( (_objectType&sim_drawing_facingcamera)&&((tmp==sim_drawing_trianglepoints)||(tmp==sim_drawing_quadpoints)||(tmp==sim_drawing_discpoints)||(tmp==sim_drawing_cubepoints)) )
+        return(false);
+    if ( (_objectType&sim_drawing_itemsizes)&&((tmp==sim_drawing_points)||(tmp==sim_drawing_lines)) )
+        return(false); // point size and line width cannot change within a draw call
+    if ( (_objectType&(sim_drawing_itemcolors|sim_drawing_vertexcolors))&&(_objectType&(sim_drawing_50percenttransparency|sim_drawing_25percenttransparency|sim_drawing_12percenttransparency)) )
+        return(false); // the color array would override the alpha value
+    if ( (tmp!=sim_drawing_points)&&(tmp!=sim_drawing_lines)&&(tmp!=sim_drawing_triangles)&&(tmp!=sim_drawing_trianglepoints)&&
+        (tmp!=sim_drawing_quadpoints)&&(tmp!=sim_drawing_discpoints)&&(tmp!=sim_drawing_cubepoints)&&(tmp!=sim_drawing_spherepoints) )
+        return(false);
+    return(_areRingBuffersUsable());
+}
+
+bool _isInstancedItemType(int itemType)
+{ // those items are copies of a template, with a transformation per item
+    return((itemType==sim_drawing_discpoints)||(itemType==sim_drawing_cubepoints)||(itemType==sim_drawing_spherepoints));
+}
+
+const std::vector<float>& _getTemplateVertices(int itemType,GLenum& mode)
+{ // unit cube, disc and sphere: interleaved positions and normals, as independent primitives. Built once
+    if (itemType==sim_drawing_cubepoints)
+    {
+        mode=GL_QUADS;
+        if (_cubeTemplateVertices.size()==0)
+        {
+            const float cube[6][5][3]={
+                {{1.0f,0.0f,0.0f},{1.0f,1.0f,1.0f},{1.0f,-1.0f,1.0f},{1.0f,-1.0f,-1.0f},{1.0f,1.0f,-1.0f}},
+                {{0.0f,1.0f,0.0f},{1.0f,1.0f,1.0f},{1.0f,1.0f,-1.0f},{-1.0f,1.0f,-1.0f},{-1.0f,1.0f,1.0f}},
+                {{-1.0f,0.0f,0.0f},{-1.0f,-1.0f,1.0f},{-1.0f,1.0f,1.0f},{-1.0f,1.0f,-1.0f},{-1.0f,-1.0f,-1.0f}},
+                {{0.0f,-1.0f,0.0f},{-1.0f,-1.0f,1.0f},{-1.0f,-1.0f,-1.0f},{1.0f,-1.0f,-1.0f},{1.0f,-1.0f,1.0f}},
+                {{0.0f,0.0f,1.0f},{1.0f,1.0f,1.0f},{-1.0f,1.0f,1.0f},{-1.0f,-1.0f,1.0f},{1.0f,-1.0f,1.0f}},
+                {{0.0f,0.0f,-1.0f},{-1.0f,-1.0f,-1.0f},{-1.0f,1.0f,-1.0f},{1.0f,1.0f,-1.0f},{1.0f,-1.0f,-1.0f}}
+            }; // normal, then the 4 vertices, as in _drawCubePoints
+            for (int i=0;i<6;i++)
+            {
+                for (int j=0;j<4;j++)
+                {
+                    _cubeTemplateVertices.insert(_cubeTemplateVertices.end(),cube[i][1+j],cube[i][1+j]+3);
+                    _cubeTemplateVertices.insert(_cubeTemplateVertices.end(),cube[i][0],cube[i][0]+3);
+                }
+            }
+        }
+        return(_cubeTemplateVertices);
+    }
+    if (itemType==sim_drawing_discpoints)
+    {
+        mode=GL_TRIANGLES; // not a triangle fan, so that several discs can be drawn at once
+        if (_discTemplateVertices.size()==0)
+        {
+            const float ssc=0.4142f;
+            const float disc[8][2]={{1.0f,ssc},{ssc,1.0f},{-ssc,1.0f},{-1.0f,ssc},{-1.0f,-ssc},{-ssc,-1.0f},{ssc,-1.0f},{1.0f,-ssc}};
+            for (int i=1;i<7;i++)
+            {
+                const int fan[3]={0,i,i+1};
+                for (int j=0;j<3;j++)
+                {
+                    float v[6]={disc[fan[j]][0],disc[fan[j]][1],0.0f,0.0f,0.0f,1.0f};
+                    _discTemplateVertices.insert(_discTemplateVertices.end(),v,v+6);
+                }
+            }
+        }
+        return(_discTemplateVertices);
+    }
+    mode=GL_TRIANGLES;
+    if (_sphereTemplateVertices.size()==0)
+    {
+        const int quadToTriangles[6]={0,1,2,0,2,3};
+        for (int j=0;j<18;j++)
+        {
+            for (int k=0;k<6;k++)
+            {
+                _sphereTemplateVertices.insert(_sphereTemplateVertices.end(),SPHEREVERTICES+3*SPHEREQUADINDICES[4*j+quadToTriangles[k]],SPHEREVERTICES+3*SPHEREQUADINDICES[4*j+quadToTriangles[k]]+3);
+                _sphereTemplateVertices.insert(_sphereTemplateVertices.end(),SPHEREQUADNORMALS+3*j,SPHEREQUADNORMALS+3*j+3);
+            }
+        }
+        for (int j=0;j<8;j++)
+        {
+            for (int k=0;k<3;k++)
+            {
+                _sphereTemplateVertices.insert(_sphereTemplateVertices.end(),SPHEREVERTICES+3*SPHERETRIANGLEINDICES[3*j+k],SPHEREVERTICES+3*SPHERETRIANGLEINDICES[3*j+k]+3);
+                _sphereTemplateVertices.insert(_sphereTemplateVertices.end(),SPHERETRIANGLENORMALS+3*j,SPHERETRIANGLENORMALS+3*j+3);
+            }
+        }
+    }
+    return(_sphereTemplateVertices);
+}
+
+void _getBufferLayout(CDrawingObject* drawingObject,GLenum& mode,int& verticesPerItem,int& floatsPerVertex,int& normalOffset,int& colorOffset)
+{ // Vertices are: position, [normal], [color]
+    int _objectType=drawingObject->getObjectType();
+    int tmp=_objectType&0x001f;
+    if (_isInstancedItemType(tmp))
+    { // pre-transformed copies of the template
+        verticesPerItem=int(_getTemplateVertices(tmp,mode).size())/6;
+        floatsPerVertex=6;
+        normalOffset=3;
+        colorOffset=-1;
+        if (_objectType&sim_drawing_itemcolors)
+        {
+            colorOffset=floatsPerVertex;
+            floatsPerVertex+=3;
+        }
+        return;
+    }
+    mode=GL_POINTS;
+    verticesPerItem=1;
+    if (tmp==sim_drawing_lines)
+    {
+        mode=GL_LINES;
+        verticesPerItem=2;
+    }
+    if ( (tmp==sim_drawing_triangles)||(tmp==sim_drawing_trianglepoints) )
+    {
+        mode=GL_TRIANGLES;
+        verticesPerItem=3;
+    }
+    if (tmp==sim_drawing_quadpoints)
+    {
+        mode=GL_QUADS;
+        verticesPerItem=4;
+    }
+    floatsPerVertex=3;
+    normalOffset=-1;
+    colorOffset=-1;
+    if ( (tmp!=sim_drawing_points)&&(tmp!=sim_drawing_lines) )
+    { // points and lines use a common normal vector
+        normalOffset=floatsPerVertex;
+        floatsPerVertex+=3;
+    }
+    if (_objectType&(sim_drawing_itemcolors|sim_drawing_vertexcolors))
+    {
+        colorOffset=floatsPerVertex;
+        floatsPerVertex+=3;
+    }
+}
+
+int _getBufferItemCapacity(CDrawingObject* drawingObject,int itemCnt)
+{ // with some margin, since items are typically added over time
+    return(SIM_MIN(drawingObject->getMaxItemCount(),SIM_MAX(2*itemCnt,1024)));
+}
+
+bool _canBatchItems(CDrawingObject* drawingObject,int floatsPerSlot)
+{ // Cube, disc and sphere points take many vertices. Above a certain amount, only their transformations are kept, and each item is drawn separately
+    int itemCnt=int(drawingObject->getDataPtr()->size())/drawingObject->floatsPerItem;
+    return(quint64(_getBufferItemCapacity(drawingObject,itemCnt))*quint64(floatsPerSlot)<=MAX_BATCHED_FLOATS_PER_DRAWING_OBJECT);
+}
+
+void _getItemFrame(const float* item,C3Vector& v,C3Vector& n,C3Vector& x,C3Vector& y)
+{ // same as in _drawTrianglePoints, etc.
+    v.set(item+0);
+    n.set(item+3);
+    if (n(2)<0.8f)
+        x=(n^C3Vector::unitZVector).getNormalized();
+    else
+        x=(n^C3Vector::unitXVector).getNormalized();
+    y=n^x;
+}
+
+void _addBufferVertex(C3Vector v,const float* n,const float* col,float*& out)
+{
+    v.copyTo(out);
+    out+=3;
+    if (n!=NULL)
+    {
+        out[0]=n[0];
+        out[1]=n[1];
+        out[2]=n[2];
+        out+=3;
+    }
+    if (col!=NULL)
+    {
+        out[0]=col[0];
+        out[1]=col[1];
+        out[2]=col[2];
+        out+=3;
+    }
+}
+
+void _expandItem(CDrawingObject* drawingObject,const float* item,float* out)
+{ // writes the vertices of an item that is not instanced. Item transparency and camera facing items are not handled here
+    int _objectType=drawingObject->getObjectType();
+    int tmp=_objectType&0x001f;
+    bool cols=(_objectType&(sim_drawing_itemcolors|sim_drawing_vertexcolors))!=0;
+    if (tmp==sim_drawing_points)
+        _addBufferVertex(C3Vector(item),NULL,cols?item+3:NULL,out);
+    if (tmp==sim_drawing_lines)
+    {
+        const float* col2=item+6;
+        if (_objectType&sim_drawing_vertexcolors)
+            col2=item+9;
+        _addBufferVertex(C3Vector(item+0),NULL,cols?item+6:NULL,out);
+        _addBufferVertex(C3Vector(item+3),NULL,cols?col2:NULL,out);
+    }
+    if (tmp==sim_drawing_triangles)
+    {
+        C3Vector v(item+0);
+        C3Vector w(item+3);
+        C3Vector x(item+6);
+        C3Vector n((w-v)^(x-v));
+        float l=n.getLength();
+        if (l!=0.0f)
+            n/=l;
+        const float* col2=item+9;
+        const float* col3=item+9;
+        if (_objectType&sim_drawing_vertexcolors)
+        {
+            col2=item+12;
+            col3=item+15;
+        }
+        _addBufferVertex(v,n.data,cols?item+9:NULL,out);
+        _addBufferVertex(w,n.data,cols?col2:NULL,out);
+        _addBufferVertex(x,n.data,cols?col3:NULL,out);
+    }
+    if ( (tmp==sim_drawing_trianglepoints)||(tmp==sim_drawing_quadpoints) )
+    {
+        C3Vector v,n,x,y;
+        _getItemFrame(item,v,n,x,y);
+        int off=6;
+        const float* col=NULL;
+        if (_objectType&sim_drawing_itemcolors)
+        {
+            col=item+off;
+            off+=3;
+        }
+        float s=drawingObject->getSize();
+        if (_objectType&sim_drawing_itemsizes)
+            s=item[off];
+        if (tmp==sim_drawing_trianglepoints)
+        {
+            float sxc=0.866f;
+            float syc=0.5f;
+            _addBufferVertex(v+(y*s),n.data,col,out);
+            _addBufferVertex(v-(x*(s*sxc))-(y*(s*syc)),n.data,col,out);
+            _addBufferVertex(v+(x*(s*sxc))-(y*(s*syc)),n.data,col,out);
+        }
+        else
+        {
+            _addBufferVertex(v+(y*s)+(x*s),n.data,col,out);
+            _addBufferVertex(v+(y*s)-(x*s),n.data,col,out);
+            _addBufferVertex(v-(y*s)-(x*s),n.data,col,out);
+            _addBufferVertex(v-(y*s)+(x*s),n.data,col,out);
+        }
+    }
+}
+
+void _getItemInstance(CDrawingObject* drawingObject,const float* item,float* out)
+{ // writes the OpenGL transformation matrix (column-major) of an instanced item, followed by its color if present
+    int _objectType=drawingObject->getObjectType();
+    int tmp=_objectType&0x001f;
+    float s=drawingObject->getSize();
+    int off=3;
+    C3Vector v,n,x,y;
+    if (tmp==sim_drawing_spherepoints)
+    {
+        v.set(item);
+        x=C3Vector::unitXVector;
+        y=C3Vector::unitYVector;
+        n=C3Vector::unitZVector;
+    }
+    else
+    {
+        _getItemFrame(item,v,n,x,y);
+        off+=3;
+    }
+    const float* col=NULL;
+    if (_objectType&sim_drawing_itemcolors)
+    {
+        col=item+off;
+        off+=3;
+    }
+    if (_objectType&sim_drawing_itemsizes)
+        s=item[off];
+    for (int i=0;i<3;i++)
+    {
+        out[0+i]=x(i)*s;
+        out[4+i]=y(i)*s;
+        out[8+i]=n(i)*s;
+        out[12+i]=v(i);
+    }
+    out[3]=0.0f;
+    out[7]=0.0f;
+    out[11]=0.0f;
+    out[15]=1.0f;
+    if (col!=NULL)
+    {
+        out[16]=col[0];
+        out[17]=col[1];
+        out[18]=col[2];
+    }
+}
+
+void _expandInstancedItem(CDrawingObject* drawingObject,const float* item,const std::vector<float>& templateVertices,float* out)
+{ // writes the template vertices, transformed by the item's transformation. That transformation only scales uniformly, so normals are simply rotated
+    float inst[19];
+    _getItemInstance(drawingObject,item,inst);
+    const float* col=NULL;
+    if (drawingObject->getObjectType()&sim_drawing_itemcolors)
+        col=inst+16;
+    float s=C3Vector(inst).getLength();
+    float invS=1.0f;
+    if (s>0.0f)
+        invS=1.0f/s;
+    for (int i=0;i<int(templateVertices.size())/6;i++)
+    {
+        const float* tv=&templateVertices[6*i];
+        C3Vector v,n;
+        for (int j=0;j<3;j++)
+        {
+            v.data[j]=inst[0+j]*tv[0]+inst[4+j]*tv[1]+inst[8+j]*tv[2]+inst[12+j];
+            n.data[j]=(inst[0+j]*tv[3]+inst[4+j]*tv[4]+inst[8+j]*tv[5])*invS;
+        }
+        _addBufferVertex(v,n.data,col,out);
+    }
+}
+
+int _getTemplateBuffer(int itemType,GLenum& mode,int& verticesCnt)
+{ // the template of cube, disc and sphere points, for items that are drawn separately. Built when needed
+    const std::vector<float>& vertices=_getTemplateVertices(itemType,mode);
+    verticesCnt=int(vertices.size())/6;
+    int* bufferId=&_sphereTemplateBufferId;
+    if (itemType==sim_drawing_cubepoints)
+        bufferId=&_cubeTemplateBufferId;
+    if (itemType==sim_drawing_discpoints)
+        bufferId=&_discTemplateBufferId;
+    if ( (bufferId[0]!=-1)&&_doesRingBufferExist(bufferId[0]) )
+        return(bufferId[0]);
+    bufferId[0]=_buildRingBuffer(int(vertices.size()));
+    if (!_writeRingBuffer(bufferId[0],0,&vertices[0],int(vertices.size())))
+        bufferId[0]=-1;
+    return(bufferId[0]);
+}
+
+bool _updateBuffer(CDrawingObject* drawingObject,int floatsPerSlot,bool transformationsOnly)
+{ // Brings the buffer up-to-date: only items that were added since the last call are written,
+  // unless existing items were modified, or the layout changed. Returns false if the items cannot be drawn from a buffer.
+  // transformationsOnly: cube, disc and sphere points that are drawn separately. Their transformations are kept on the CPU side
+    SDrawingObjectBuffer* buff=drawingObject->getBufferPtr();
+    std::vector<float>& _data=drawingObject->getDataPtr()[0];
+    int itemType=drawingObject->getObjectType()&0x001f;
+    int itemCnt=int(_data.size())/drawingObject->floatsPerItem;
+    int maxItemCnt=drawingObject->getMaxItemCount();
+    quint64 addedCnt=drawingObject->getAddedItemCount();
+    bool allItems=(buff->floatsPerSlot!=floatsPerSlot)||(buff->dataGeneration!=drawingObject->getDataGeneration())||(addedCnt<buff->uploadedItemCount)||(addedCnt-buff->uploadedItemCount>quint64(itemCnt));
+    if (transformationsOnly)
+    {
+        decreaseRingBufferRefCnt(buff->ringBufferId); // in case the items were batched until now
+        buff->ringBufferId=-1;
+        if ( allItems||(int(buff->instanceData.size())<itemCnt*floatsPerSlot) )
+            buff->instanceData.resize(itemCnt*floatsPerSlot);
+    }
+    else
+    {
+        std::vector<float>().swap(buff->instanceData);
+        if ( (buff->ringBufferId==-1)||(buff->floatsPerSlot!=floatsPerSlot)||(itemCnt>buff->itemCapacity)||(!_doesRingBufferExist(buff->ringBufferId)) )
+        { // we (re)build the buffer
+            decreaseRingBufferRefCnt(buff->ringBufferId);
+            buff->itemCapacity=_getBufferItemCapacity(drawingObject,itemCnt);
+            buff->ringBufferId=_buildRingBuffer(buff->itemCapacity*floatsPerSlot);
+            if (buff->ringBufferId==-1)
+                return(false);
+            allItems=true;
+        }
+    }
+
+    int ranges[2][2]={{0,itemCnt},{0,0}}; // slots to write
+    if (!allItems)
+    { // the ring wraps around at maxItemCnt
+        int newCnt=int(addedCnt-buff->uploadedItemCount);
+        int firstSlot=int(buff->uploadedItemCount%quint64(maxItemCnt));
+        ranges[0][0]=firstSlot;
+        ranges[0][1]=SIM_MIN(firstSlot+newCnt,maxItemCnt);
+        ranges[1][1]=newCnt-(ranges[0][1]-ranges[0][0]);
+    }
+    const std::vector<float>* templateVertices=NULL;
+    if ( _isInstancedItemType(itemType)&&(!transformationsOnly) )
+    {
+        GLenum mode;
+        templateVertices=&_getTemplateVertices(itemType,mode);
+    }
+    std::vector<float> vertices;
+    for (int r=0;r<2;r++)
+    {
+        if (transformationsOnly)
+        {
+            for (int i=ranges[r][0];i<ranges[r][1];i++)
+                _getItemInstance(drawingObject,&_data[drawingObject->floatsPerItem*i],&buff->instanceData[floatsPerSlot*i]);
+            continue;
+        }
+        for (int first=ranges[r][0];first<ranges[r][1];first+=ITEMS_PER_UPLOAD)
+        { // we upload in chunks, in order to keep the temporary buffer small
+            int cnt=SIM_MIN(ITEMS_PER_UPLOAD,ranges[r][1]-first);
+            vertices.resize(cnt*floatsPerSlot);
+            for (int i=0;i<cnt;i++)
+            {
+                const float* item=&_data[drawingObject->floatsPerItem*(first+i)];
+                if (templateVertices!=NULL)
+                    _expandInstancedItem(drawingObject,item,templateVertices[0],&vertices[floatsPerSlot*i]);
+                else
+                    _expandItem(drawingObject,item,&vertices[floatsPerSlot*i]);
+            }
+            if (!_writeRingBuffer(buff->ringBufferId,first*floatsPerSlot,&vertices[0],cnt*floatsPerSlot))
+                return(false);
+        }
+    }
+    buff->floatsPerSlot=floatsPerSlot;
+    buff->dataGeneration=drawingObject->getDataGeneration();
+    buff->uploadedItemCount=addedCnt;
+    return(true);
+}
+
+bool _drawFromBuffer(CDrawingObject* drawingObject,int displayAttrib,const float normalVectorForLinesAndPoints[3])
+{ // Returns false if the items have to be drawn in immediate mode
+    bool auxCmp=(displayAttrib&sim_displayattribute_useauxcomponent)!=0;
+    int _objectType=drawingObject->getObjectType();
+    int tmp=_objectType&0x001f;
+    int itemCnt=int(drawingObject->getDataPtr()->size())/drawingObject->floatsPerItem;
+    if (itemCnt==0)
+        return(true);
+    int startItem=drawingObject->getStartItem(); // the oldest item. We draw in the same order as in immediate mode
+    bool useColors=(_objectType&(sim_drawing_itemcolors|sim_drawing_vertexcolors))&&((!auxCmp)||(_objectType&sim_drawing_auxchannelcolor2));
+    GLenum colorComponent=GL_AMBIENT_AND_DIFFUSE;
+    if (_objectType&(sim_drawing_emissioncolor|sim_drawing_auxchannelcolor2))
+        colorComponent=GL_EMISSION;
+
+    GLenum mode;
+    int verticesPerItem,floatsPerVertex,normalOffset,colorOffset;
+    _getBufferLayout(drawingObject,mode,verticesPerItem,floatsPerVertex,normalOffset,colorOffset);
+
+    if ( _isInstancedItemType(tmp)&&(!_canBatchItems(drawingObject,verticesPerItem*floatsPerVertex)) )
+    { // Too many items to batch them. No instanced arrays in the fixed-function pipeline: the template stays bound, and we only change the transformation for each item (i.e. one draw call per item)
+        int floatsPerInstance=16;
+        if (_objectType&sim_drawing_itemcolors)
+            floatsPerInstance+=3;
+        int verticesCnt;
+        int templateId=_getTemplateBuffer(tmp,mode,verticesCnt);
+        if ( (templateId==-1)||(!_updateBuffer(drawingObject,floatsPerInstance,true)) )
+            return(false);
+        if (!_bindRingBuffer(templateId,6,3,-1))
+            return(false);
+        glEnable(GL_NORMALIZE); // the transformations are scaled
+        if (useColors)
+        {
+            glColorMaterial(GL_FRONT_AND_BACK,colorComponent);
+            glEnable(GL_COLOR_MATERIAL);
+        }
+        const float* instances=&drawingObject->getBufferPtr()->instanceData[0];
+        for (int i=0;i<itemCnt;i++)
+        {
+            int p=startItem+i;
+            if (p>=itemCnt)
+                p-=itemCnt;
+            const float* inst=instances+floatsPerInstance*p;
+            if (useColors)
+                glColor3fv(inst+16);
+            glPushMatrix();
+            glMultMatrixf(inst);
+            glDrawArrays(mode,0,verticesCnt);
+            glPopMatrix();
+        }
+        if (useColors)
+            glDisable(GL_COLOR_MATERIAL);
+        glDisable(GL_NORMALIZE);
+        _unbindRingBuffer(templateId);
+        return(true);
+    }
+
+    if (!_updateBuffer(drawingObject,verticesPerItem*floatsPerVertex,false))
+        return(false);
+    int bufferId=drawingObject->getBufferPtr()->ringBufferId;
+    if (!_bindRingBuffer(bufferId,floatsPerVertex,normalOffset,useColors?colorOffset:-1))
+        return(false);
+    if (normalOffset<0)
+        glNormal3fv(normalVectorForLinesAndPoints);
+    if (tmp==sim_drawing_points)
+        glPointSize(drawingObject->getSize());
+    if (tmp==sim_drawing_lines)
+        glLineWidth(drawingObject->getSize());
+    if (useColors)
+    {
+        glColorMaterial(GL_FRONT_AND_BACK,colorComponent);
+        glEnable(GL_COLOR_MATERIAL);
+    }
+    if (startItem<itemCnt)
+        glDrawArrays(mode,startItem*verticesPerItem,(itemCnt-startItem)*verticesPerItem);
+    if (startItem>0)
+        glDrawArrays(mode,0,startItem*verticesPerItem);
+    if (useColors)
+        glDisable(GL_COLOR_MATERIAL);
+    glPointSize(1.0f);
+    glLineWidth(1.0f);
+    _unbindRingBuffer(bufferId);
+    return(true);
+}
+
+void benchmarkDrawingObjectRendering()
+{ // Times each item type in immediate mode and from buffers. Enabled via the user settings. Needs a valid openGl context
+    const int itemTypes[8]={sim_drawing_points,sim_drawing_lines,sim_drawing_triangles,sim_drawing_trianglepoints,sim_drawing_quadpoints,sim_drawing_discpoints,sim_drawing_cubepoints,sim_drawing_spherepoints};
+    const char* itemTypeNames[8]={"points","lines","triangles","triangle points","quad points","disc points","cube points","sphere points"};
+    const int itemCounts[3]={10000,100000,1000000};
+    C7Vector tr;
+    tr.setIdentity();
+    C4X4Matrix cameraCTM;
+    cameraCTM.setIdentity();
+    for (int t=0;t<8;t++)
+    {
+        for (int c=0;c<3;c++)
+        {
+            CDrawingObject drawingObject(itemTypes[t]|sim_drawing_itemcolors,0.005f,0.0f,-1,itemCounts[c],false);
+            unsigned int seed=1;
+            float item[18];
+            for (int i=0;i<itemCounts[c];i++)
+            { // same items each time. Coordinates, normals and colors all in [0.1;1.0]
+                for (int j=0;j<drawingObject.floatsPerItem;j++)
+                {
+                    seed=seed*1103515245+12345;
+                    item[j]=0.1f+0.9f*float((seed>>16)&0x7fff)/32767.0f;
+                }
+                drawingObject.addItem(item);
+            }
+            std::string txt("Drawing object benchmark, ");
+            txt+=std::string(itemTypeNames[t])+" x"+boost::lexical_cast<std::string>(itemCounts[c])+": ";
+            if (!_canDrawFromBuffer(&drawingObject))
+            {
+                App::addStatusbarMessage(txt+"vertex buffers not available");
+                return;
+            }
+            suint64 durations[3];
+            for (int i=0;i<3;i++)
+            { // immediate mode, first buffered frame (with the upload), next buffered frame
+                _bufferedDrawingDisabled=(i==0);
+                glFinish();
+                suint64 startTime=VDateTime::getTimeInUs();
+                displayDrawingObject(&drawingObject,tr,false,false,0,cameraCTM);
+                glFinish();
+                durations[i]=VDateTime::getTimeInUs()-startTime;
+            }
+            _bufferedDrawingDisabled=false;
+            txt+=tt::FNb(0,float(durations[0])/1000.0f,2,false)+" ms --> "+tt::FNb(0,float(durations[2])/1000.0f,2,false)+" ms";
+            if (durations[2]>0)
+                txt+=" ("+tt::FNb(0,float(durations[0])/float(durations[2]),1,false)+"x)";
+            txt+=", first frame with upload: "+tt::FNb(0,float(durations[1])/1000.0f,2,false)+" ms";
+            if (_isInstancedItemType(itemTypes[t]))
+            {
+                GLenum mode;
+                int verticesPerItem,floatsPerVertex,normalOffset,colorOffset;
+                _getBufferLayout(&drawingObject,mode,verticesPerItem,floatsPerVertex,normalOffset,colorOffset);
+                if (!_canBatchItems(&drawingObject,verticesPerItem*floatsPerVertex))
+                    txt+=" (one draw call per item)";
+            }
+            App::addStatusbarMessage(txt);
+        }
+    }
+}
+
 #else
 
 void displayDrawingObject(CDrawingObject* drawingObject,C7Vector& tr,bool overlay,bool transparentObject,int displayAttrib,const C4X4Matrix& cameraCTM)
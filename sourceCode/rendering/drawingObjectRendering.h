@@ -11,6 +11,22 @@ void _drawCubePoints(CDrawingObject* drawingObject,int displayAttrib,const C4X4M
 void _drawSpherePoints(CDrawingObject* drawingObject,int displayAttrib);
 void _drawLines(CDrawingObject* drawingObject,int displayAttrib,const C4X4Matrix& cameraRTM,const float normalVectorForLinesAndPoints[3]);
 void _drawTriangles(CDrawingObject* drawingObject,int displayAttrib);
+
+bool _canDrawFromBuffer(CDrawingObject* drawingObject);
+bool _drawFromBuffer(CDrawingObject* drawingObject,int displayAttrib,const float normalVectorForLinesAndPoints[3]);
+bool _updateBuffer(CDrawingObject* drawingObject,int floatsPerSlot,bool transformationsOnly);
+bool _isInstancedItemType(int itemType);
+const std::vector<float>& _getTemplateVertices(int itemType,GLenum& mode);
+void _getBufferLayout(CDrawingObject* drawingObject,GLenum& mode,int& verticesPerItem,int& floatsPerVertex,int& normalOffset,int& colorOffset);
+int _getBufferItemCapacity(CDrawingObject* drawingObject,int itemCnt);
+bool _canBatchItems(CDrawingObject* drawingObject,int floatsPerSlot);
+void _getItemFrame(const float* item,C3Vector& v,C3Vector& n,C3Vector& x,C3Vector& y);
+void _addBufferVertex(C3Vector v,const float* n,const float* col,float*& out);
+void _expandItem(CDrawingObject* drawingObject,const float* item,float* out);
+void _getItemInstance(CDrawingObject* drawingObject,const float* item,float* out);
+void _expandInstancedItem(CDrawingObject* drawingObject,const float* item,const std::vector<float>& templateVertices,float* out);
+int _getTemplateBuffer(int itemType,GLenum& mode,int& verticesCnt);
+void benchmarkDrawingObjectRendering();
 #endif
 
 void displayDrawingObject(CDrawingObject* drawingObject,C7Vector& tr,bool overlay,bool transparentObject,int displayAttrib,const C4X4Matrix& cameraCTM);
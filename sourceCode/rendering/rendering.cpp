@@ -6,9 +6,12 @@
 #include "vDateTime.h"
 #include "glBufferObjects.h"
 #include "oglExt.h"
+#include "drawingObjectRendering.h"
+#include "vThread.h"
 
 CGlBufferObjects* _glBufferObjects=NULL;
 bool _glInitialized=false;
+bool _drawingObjectBenchmarkDone=false;
 
 void initializeRendering()
 {
@@ -66,6 +69,16 @@ void initGl_ifNeeded()
 //  FUNCTION_INSIDE_DEBUG(glVer.c_str());
 }
 
+void runDrawingObjectBenchmark_ifNeeded()
+{ // when calling this we need to have a valid openGl context! Runs once, from the UI thread and once the main window exists (i.e. not from a vision sensor context)
+    if (_drawingObjectBenchmarkDone||(!App::userSettings->drawingObjectRenderingBenchmark))
+        return;
+    if ( (App::mainWindow==NULL)||(!VThread::isCurrentThreadTheUiThread()) )
+        return;
+    _drawingObjectBenchmarkDone=true;
+    benchmarkDrawingObjectRendering();
+}
+
 void deinitGl_ifNeeded()
 {
     _glInitialized=false;
@@ -113,6 +126,53 @@ void decreaseTexCoordBufferRefCnt(int texCoordBufferId)
         _glBufferObjects->removeTexCoordBuffer(texCoordBufferId);
 }
 
+void decreaseRingBufferRefCnt(int ringBufferId)
+{
+    if (_glBufferObjects!=NULL)
+        _glBufferObjects->removeRingBuffer(ringBufferId);
+}
+
+bool _areRingBuffersUsable()
+{
+    if (_glBufferObjects!=NULL)
+        return(_glBufferObjects->areRingBuffersUsable());
+    return(false);
+}
+
+int _buildRingBuffer(int floatCnt)
+{
+    if (_glBufferObjects!=NULL)
+        return(_glBufferObjects->buildRingBuffer(floatCnt));
+    return(-1);
+}
+
+bool _doesRingBufferExist(int ringBufferId)
+{
+    if (_glBufferObjects!=NULL)
+        return(_glBufferObjects->doesRingBufferExist(ringBufferId));
+    return(false);
+}
+
+bool _writeRingBuffer(int ringBufferId,int floatOffset,const float* data,int floatCnt)
+{
+    if (_glBufferObjects!=NULL)
+        return(_glBufferObjects->writeRingBuffer(ringBufferId,floatOffset,data,floatCnt));
+    return(false);
+}
+
+bool _bindRingBuffer(int ringBufferId,int floatsPerVertex,int normalOffset,int colorOffset)
+{
+    if (_glBufferObjects!=NULL)
+        return(_glBufferObjects->bindRingBuffer(ringBufferId,floatsPerVertex,normalOffset,colorOffset));
+    return(false);
+}
+
+void _unbindRingBuffer(int ringBufferId)
+{
+    if (_glBufferObjects!=NULL)
+        _glBufferObjects->unbindRingBuffer(ringBufferId);
+}
+
 void _drawTriangles(const float* vertices,int verticesCnt,const int* indices,int indicesCnt,const float* normals,const float* textureCoords,int* vertexBufferId,int* normalBufferId,int* texCoordBufferId)
 {
     if (_glBufferObjects!=NULL)
@@ -712,6 +772,11 @@ void deinitGl_ifNeeded()
 
 }
 
+void runDrawingObjectBenchmark_ifNeeded()
+{
+
+}
+
 void increaseVertexBufferRefCnt(int vertexBufferId)
 {
 
@@ -747,6 +812,11 @@ void decreaseTexCoordBufferRefCnt(int texCoordBufferId)
 
 }
 
+void decreaseRingBufferRefCnt(int ringBufferId)
+{
+
+}
+
 void destroyGlTexture(unsigned int texName)
 {
 
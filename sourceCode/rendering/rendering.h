@@ -20,6 +20,13 @@ void _drawTriangles(const float* vertices,int verticesCnt,const int* indices,int
 bool _drawEdges(const float* vertices,int verticesCnt,const int* indices,int indicesCnt,const unsigned char* edges,int* edgeBufferId);
 void _drawColorCodedTriangles(const float* vertices,int verticesCnt,const int* indices,int indicesCnt,const float* normals,int* vertexBufferId,int* normalBufferId);
 
+bool _areRingBuffersUsable();
+int _buildRingBuffer(int floatCnt);
+bool _doesRingBufferExist(int ringBufferId);
+bool _writeRingBuffer(int ringBufferId,int floatOffset,const float* data,int floatCnt);
+bool _bindRingBuffer(int ringBufferId,int floatsPerVertex,int normalOffset,int colorOffset);
+void _unbindRingBuffer(int ringBufferId);
+
 bool _start3DTextureDisplay(CTextureProperty* tp);
 void _end3DTextureDisplay(CTextureProperty* tp);
 bool _start2DTextureDisplay(CTextureProperty* tp);
@@ -34,6 +41,7 @@ void initializeRendering();
 void deinitializeRendering();
 void initGl_ifNeeded();
 void deinitGl_ifNeeded();
+void runDrawingObjectBenchmark_ifNeeded();
 void increaseVertexBufferRefCnt(int vertexBufferId);
 void decreaseVertexBufferRefCnt(int vertexBufferId);
 void increaseNormalBufferRefCnt(int normalBufferId);
@@ -41,5 +49,6 @@ void decreaseNormalBufferRefCnt(int normalBufferId);
 void increaseEdgeBufferRefCnt(int edgeBufferId);
 void decreaseEdgeBufferRefCnt(int edgeBufferId);
 void decreaseTexCoordBufferRefCnt(int texCoordBufferId);
+void decreaseRingBufferRefCnt(int ringBufferId);
 void destroyGlTexture(unsigned int texName);
 void makeColorCurrent(const CVisualParam* visParam,bool forceNonTransparent,bool useAuxiliaryComponent);
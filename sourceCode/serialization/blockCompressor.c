@@ -0,0 +1,225 @@
+/*************************************************************************
+* Name:        blockCompressor.c
+* Description: Fast LZ77 block coder/decoder implementation.
+* Reentrant:   Yes
+*
+* The output follows the LZ4 block format: a sequence is made of a token
+* (4 bits literal count, 4 bits match length-4), the optional literal
+* count extension bytes, the literals, a 16-bit little endian match
+* offset, and the optional match length extension bytes. The last
+* sequence only contains literals.
+*
+* Matches are found with a single-entry hash table on 4-byte values,
+* which trades some compression ratio for speed. Each call is
+* independent, so that several blocks can be handled in parallel.
+*************************************************************************/
+
+#include "blockCompressor.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+/*************************************************************************
+* Constants used by the coder
+*************************************************************************/
+
+#define BC_MIN_MATCH        4
+#define BC_LAST_LITERALS    5   /* the last bytes are always literals */
+#define BC_MATCH_FIND_LIMIT 12  /* no match starts in the last bytes */
+#define BC_MAX_OFFSET       65535
+#define BC_HASH_BITS        14
+#define BC_SKIP_TRIGGER     6   /* speeds up on incompressible data */
+
+
+/*************************************************************************
+*                           INTERNAL FUNCTIONS                           *
+*************************************************************************/
+
+static unsigned int _BC_Read32( const unsigned char *p )
+{
+  unsigned int v;
+  memcpy( &v, p, 4 );
+  return v;
+}
+
+static unsigned int _BC_Hash( unsigned int v )
+{
+  return ( v * 2654435761U ) >> ( 32 - BC_HASH_BITS );
+}
+
+/* Writes a length extension (255, 255, ..., rest). Returns the new
+   output position, or -1 if out is too small */
+static int _BC_WriteLength( unsigned char *out, int op, int outcapacity,
+                            int len )
+{
+  while( len >= 255 )
+  {
+    if( op >= outcapacity ) return -1;
+    out[ op ++ ] = 255;
+    len -= 255;
+  }
+  if( op >= outcapacity ) return -1;
+  out[ op ++ ] = (unsigned char) len;
+  return op;
+}
+
+/* Writes a sequence. matchlen is 0 for the last sequence. Returns the new
+   output position, or -1 if out is too small */
+static int _BC_WriteSequence( const unsigned char *literals, int litlen,
+                              int offset, int matchlen, unsigned char *out,
+                              int op, int outcapacity )
+{
+  int tokenpos, ml;
+
+  if( op >= outcapacity ) return -1;
+  tokenpos = op ++;
+  out[ tokenpos ] = (unsigned char) ( ( litlen >= 15 ? 15 : litlen ) << 4 );
+  if( litlen >= 15 )
+  {
+    op = _BC_WriteLength( out, op, outcapacity, litlen - 15 );
+    if( op < 0 ) return -1;
+  }
+  if( op + litlen > outcapacity ) return -1;
+  memcpy( &out[ op ], literals, litlen );
+  op += litlen;
+
+  if( matchlen > 0 )
+  {
+    if( op + 2 > outcapacity ) return -1;
+    out[ op ++ ] = (unsigned char) ( offset & 255 );
+    out[ op ++ ] = (unsigned char) ( offset >> 8 );
+    ml = matchlen - BC_MIN_MATCH;
+    out[ tokenpos ] |= (unsigned char) ( ml >= 15 ? 15 : ml );
+    if( ml >= 15 )
+    {
+      op = _BC_WriteLength( out, op, outcapacity, ml - 15 );
+      if( op < 0 ) return -1;
+    }
+  }
+  return op;
+}
+
+
+
+/*************************************************************************
+*                            PUBLIC FUNCTIONS                            *
+*************************************************************************/
+
+int BlockCompressor_GetMaxCompressedSize( int insize )
+{
+  return insize + insize / 255 + 16;
+}
+
+int BlockCompressor_Compress( const unsigned char *in, unsigned char *out,
+                              int insize, int outcapacity )
+{
+  int *table;
+  int ip, anchor, op, i, ref, matchlen, matchlimit, searchcount;
+  unsigned int seq, h;
+
+  op = 0;
+  anchor = 0;
+  if( insize > BC_MATCH_FIND_LIMIT )
+  {
+    table = (int *) malloc( sizeof(int) << BC_HASH_BITS );
+    if( !table ) return 0;
+    for( i = 0; i < ( 1 << BC_HASH_BITS ); ++ i )
+      table[ i ] = -1;
+
+    matchlimit = insize - BC_LAST_LITERALS;
+    ip = 0;
+    searchcount = 0;
+    while( ip < insize - BC_MATCH_FIND_LIMIT )
+    {
+      seq = _BC_Read32( &in[ ip ] );
+      h = _BC_Hash( seq );
+      ref = table[ h ];
+      table[ h ] = ip;
+      if( ( ref >= 0 ) && ( ip - ref <= BC_MAX_OFFSET ) &&
+          ( _BC_Read32( &in[ ref ] ) == seq ) )
+      {
+        matchlen = BC_MIN_MATCH;
+        while( ( ip + matchlen < matchlimit ) &&
+               ( in[ ref + matchlen ] == in[ ip + matchlen ] ) )
+          ++ matchlen;
+        op = _BC_WriteSequence( &in[ anchor ], ip - anchor, ip - ref,
+                                matchlen, out, op, outcapacity );
+        if( op < 0 )
+        {
+          free( table );
+          return 0;
+        }
+        ip += matchlen;
+        anchor = ip;
+        searchcount = 0;
+      }
+      else
+        ip += 1 + ( ( searchcount ++ ) >> BC_SKIP_TRIGGER );
+    }
+    free( table );
+  }
+
+  op = _BC_WriteSequence( &in[ anchor ], insize - anchor, 0, 0, out, op,
+                          outcapacity );
+  if( op < 0 ) return 0;
+  return op;
+}
+
+int BlockCompressor_Uncompress( const unsigned char *in, unsigned char *out,
+                                int insize, int outsize )
+{
+  int ip, op, litlen, matchlen, offset, i;
+  unsigned char token, b;
+
+  ip = 0;
+  op = 0;
+  while( ip < insize )
+  {
+    token = in[ ip ++ ];
+
+    /* Literals */
+    litlen = token >> 4;
+    if( litlen == 15 )
+    {
+      do
+      {
+        if( ip >= insize ) return -1;
+        b = in[ ip ++ ];
+        litlen += b;
+      } while( b == 255 );
+    }
+    if( ( ip + litlen > insize ) || ( op + litlen > outsize ) ) return -1;
+    memcpy( &out[ op ], &in[ ip ], litlen );
+    ip += litlen;
+    op += litlen;
+    if( ip >= insize ) break; /* last sequence */
+
+    /* Match */
+    if( ip + 2 > insize ) return -1;
+    offset = in[ ip ] | ( in[ ip + 1 ] << 8 );
+    ip += 2;
+    if( ( offset == 0 ) || ( offset > op ) ) return -1;
+    matchlen = token & 15;
+    if( matchlen == 15 )
+    {
+      do
+      {
+        if( ip >= insize ) return -1;
+        b = in[ ip ++ ];
+        matchlen += b;
+      } while( b == 255 );
+    }
+    matchlen += BC_MIN_MATCH;
+    if( op + matchlen > outsize ) return -1;
+    if( offset >= matchlen )
+      memcpy( &out[ op ], &out[ op - offset ], matchlen );
+    else
+    {
+      /* Overlapping match: repeats the last offset bytes */
+      for( i = 0; i < matchlen; ++ i )
+        out[ op + i ] = out[ op - offset + i ];
+    }
+    op += matchlen;
+  }
+  return op;
+}
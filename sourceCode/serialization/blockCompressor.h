@@ -0,0 +1,35 @@
+/*************************************************************************
+* Name:        blockCompressor.h
+* Description: Fast LZ77 block coder/decoder interface (LZ4 block format).
+* Reentrant:   Yes
+*************************************************************************/
+
+#ifndef _blockCompressor_h_
+#define _blockCompressor_h_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*************************************************************************
+* Function prototypes
+*************************************************************************/
+
+/* Worst case size of the compressed data */
+int BlockCompressor_GetMaxCompressedSize( int insize );
+
+/* Returns the compressed size, or 0 if out is too small */
+int BlockCompressor_Compress( const unsigned char *in, unsigned char *out,
+                              int insize, int outcapacity );
+
+/* Returns the uncompressed size, or -1 if the data is corrupt */
+int BlockCompressor_Uncompress( const unsigned char *in, unsigned char *out,
+                                int insize, int outsize );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _blockCompressor_h_ */
@@ -2,10 +2,14 @@
 #include "vrepMainHeader.h"
 #include "ser.h"
 #include "huffman.h"
+#include "blockCompressor.h"
+#include "workerPool.h"
+#include "vDateTime.h"
 #include "v_repStrings.h"
 #include "app.h"
+#include <boost/lexical_cast.hpp>
 
-int CSer::SER_SERIALIZATION_VERSION=21; // 9 since 2008/09/01,
+int CSer::SER_SERIALIZATION_VERSION=22; // 9 since 2008/09/01,
                                         // 10 since 2009/02/14,
                                         // 11 since 2009/05/15,
                                         // 12 since 2009/07/03,
@@ -18,6 +22,7 @@ int CSer::SER_SERIALIZATION_VERSION=21; // 9 since 2008/09/01,
                                         // 19 since 2016/10/29 (Materials are now part of the shapes, and are not shared anymore. This version still supports older V-REP versions (material data is redundant for a while)
                                         // 20 since 2017/03/08 (small detail)
                                         // 21 since 2017/05/26 (New API notation)
+                                        // 22 since 2026/10/17 (compression method 2. Files written with method 1 can still be read by version 18 and later)
 
 int CSer::SER_MIN_SERIALIZATION_VERSION_THAT_CAN_READ_THIS=18; // means: files written with this can be read by older v-rep with serialization THE_NUMBER
 int CSer::SER_MIN_SERIALIZATION_VERSION_THAT_THIS_CAN_READ=15; // means: this executable can read versions >=THE_NUMBER
@@ -61,6 +66,22 @@ void CSer::writeOpen()
 
 void CSer::writeClose(bool compress)
 { // we write the whole file from the fileBuffer:
+    compress=handleVerSpecWriteClose1(compress);
+    char compressionMethod=0;
+    int minSerializationVersionThatCanReadThis=SER_MIN_SERIALIZATION_VERSION_THAT_CAN_READ_THIS;
+    if (compress)
+    {
+        if (App::userSettings->fileCompressionMethod==1)
+            compressionMethod=1; // 1 for Huffman
+        else
+        {
+            compressionMethod=2; // 2 for parallel block compression
+            minSerializationVersionThatCanReadThis=22;
+        }
+        if (App::userSettings->fileCompressionBenchmark)
+            _runCompressionBenchmark();
+    }
+
     // We write the header:
     for (int i=0;i<int(strlen(SER_VREP_HEADER));i++)
     {
@@ -88,22 +109,19 @@ void CSer::writeClose(bool compress)
     // We write the minimum sim. version that can read this:
     if (theArchive!=NULL)
     {
-        (*theArchive) << ((char*)&SER_MIN_SERIALIZATION_VERSION_THAT_CAN_READ_THIS)[0];
-        (*theArchive) << ((char*)&SER_MIN_SERIALIZATION_VERSION_THAT_CAN_READ_THIS)[1];
-        (*theArchive) << ((char*)&SER_MIN_SERIALIZATION_VERSION_THAT_CAN_READ_THIS)[2];
-        (*theArchive) << ((char*)&SER_MIN_SERIALIZATION_VERSION_THAT_CAN_READ_THIS)[3];
+        (*theArchive) << ((char*)&minSerializationVersionThatCanReadThis)[0];
+        (*theArchive) << ((char*)&minSerializationVersionThatCanReadThis)[1];
+        (*theArchive) << ((char*)&minSerializationVersionThatCanReadThis)[2];
+        (*theArchive) << ((char*)&minSerializationVersionThatCanReadThis)[3];
     }
     else
     {
-        (*_bufferArchive).push_back(((char*)&SER_MIN_SERIALIZATION_VERSION_THAT_CAN_READ_THIS)[0]);
-        (*_bufferArchive).push_back(((char*)&SER_MIN_SERIALIZATION_VERSION_THAT_CAN_READ_THIS)[1]);
-        (*_bufferArchive).push_back(((char*)&SER_MIN_SERIALIZATION_VERSION_THAT_CAN_READ_THIS)[2]);
-        (*_bufferArchive).push_back(((char*)&SER_MIN_SERIALIZATION_VERSION_THAT_CAN_READ_THIS)[3]);
+        (*_bufferArchive).push_back(((char*)&minSerializationVersionThatCanReadThis)[0]);
+        (*_bufferArchive).push_back(((char*)&minSerializationVersionThatCanReadThis)[1]);
+        (*_bufferArchive).push_back(((char*)&minSerializationVersionThatCanReadThis)[2]);
+        (*_bufferArchive).push_back(((char*)&minSerializationVersionThatCanReadThis)[3]);
     }
     // We write the compression method:
-    char compressionMethod=0; 
-    if (compress)
-        compressionMethod=1; // 1 for Huffman
     if (theArchive!=NULL)
         (*theArchive) << char(compressionMethod); 
     else
@@ -187,13 +205,25 @@ void CSer::writeClose(bool compress)
             (*_bufferArchive).push_back((char)0);
     }
 
-    compress=handleVerSpecWriteClose1(compress);
-
     // Now we write all the data:
-    if (compress)
+    if (compressionMethod==2)
     { // compressed. When changing compression method, then serialization version has to be incremented and older version won't be able to read newer versions anymore!
         handleVerSpecWriteClose2(this);
 
+        std::vector<unsigned char> writeBuff;
+        _blockCompress(_fileBuffer,writeBuff);
+        if (theArchive!=NULL)
+        {
+            for (int i=0;i<int(writeBuff.size());i++)
+                (*theArchive) << writeBuff[i];
+        }
+        else
+            (*_bufferArchive).insert((*_bufferArchive).end(),writeBuff.begin(),writeBuff.end());
+    }
+    else if (compressionMethod==1)
+    {
+        handleVerSpecWriteClose2(this);
+
         // Hufmann:
         unsigned char* writeBuff=new unsigned char[_fileBuffer.size()+400]; // actually 384
         int outSize=Huffman_Compress(&_fileBuffer[0],writeBuff,(int)_fileBuffer.size());
@@ -406,23 +436,164 @@ int CSer::readOpen(int& serializationVersion,unsigned short& vrepVersionThatWrot
 
     if (compressMethod!=0)
     { // compressed
-        if (compressMethod==1) // for now, only Huffman is supported
+        if (compressMethod==1)
         { // Huffman uncompression:
             unsigned char* uncompressedBuffer=new unsigned char[originalDataSize];
             Huffman_Uncompress(&_fileBuffer[0],uncompressedBuffer,(int)_fileBuffer.size(),originalDataSize);
-            _fileBuffer.clear();
-            for (int i=0;i<originalDataSize;i++)
-                _fileBuffer.push_back(uncompressedBuffer[i]);
+            _fileBuffer.assign(uncompressedBuffer,uncompressedBuffer+originalDataSize);
             delete[] uncompressedBuffer;
 
             handleVerSpecReadOpen(this);
 
             return(1); // everything went ok!
         }
+        if (compressMethod==2)
+        { // parallel block uncompression:
+            std::vector<unsigned char> uncompressedBuffer;
+            if (_fileBuffer.size()>0)
+            {
+                if (_blockUncompress(&_fileBuffer[0],int(_fileBuffer.size()),uncompressedBuffer,originalDataSize))
+                {
+                    _fileBuffer.swap(uncompressedBuffer);
+
+                    handleVerSpecReadOpen(this);
+
+                    return(1); // everything went ok!
+                }
+            }
+        }
     }
     else
         return(1); // everything went ok!
-    return(0); // error, unknown compressor
+    return(0); // error, unknown compressor (or corrupt compressed data)
+}
+
+void CSer::_blockCompress(const std::vector<unsigned char>& in,std::vector<unsigned char>& out)
+{ // Layout: block count, then for each block the uncompressed and compressed size (0=stored uncompressed), then the blocks
+    int blockCount=(int(in.size())+SER_COMPRESSION_BLOCK_SIZE-1)/SER_COMPRESSION_BLOCK_SIZE;
+    std::vector<SSerCompressionBlock> blocks(blockCount);
+    std::vector<unsigned char> tmpBuff(size_t(blockCount)*BlockCompressor_GetMaxCompressedSize(SER_COMPRESSION_BLOCK_SIZE));
+    for (int i=0;i<blockCount;i++)
+    {
+        blocks[i].in=&in[0]+size_t(i)*SER_COMPRESSION_BLOCK_SIZE;
+        blocks[i].inSize=SIM_MIN(SER_COMPRESSION_BLOCK_SIZE,int(in.size())-i*SER_COMPRESSION_BLOCK_SIZE);
+        blocks[i].out=&tmpBuff[0]+size_t(i)*BlockCompressor_GetMaxCompressedSize(SER_COMPRESSION_BLOCK_SIZE);
+    }
+    if (blockCount>0)
+        CWorkerPool::executeTasks(_compressBlockTask,&blocks[0],blockCount);
+
+    out.clear();
+    out.insert(out.end(),(unsigned char*)&blockCount,((unsigned char*)&blockCount)+4);
+    for (int i=0;i<blockCount;i++)
+    {
+        out.insert(out.end(),(unsigned char*)&blocks[i].inSize,((unsigned char*)&blocks[i].inSize)+4);
+        out.insert(out.end(),(unsigned char*)&blocks[i].outSize,((unsigned char*)&blocks[i].outSize)+4);
+    }
+    for (int i=0;i<blockCount;i++)
+    {
+        if (blocks[i].outSize==0)
+            out.insert(out.end(),blocks[i].in,blocks[i].in+blocks[i].inSize);
+        else
+            out.insert(out.end(),blocks[i].out,blocks[i].out+blocks[i].outSize);
+    }
+}
+
+bool CSer::_blockUncompress(const unsigned char* in,int inSize,std::vector<unsigned char>& out,int originalSize)
+{ // counterpart of _blockCompress. Returns false if the data is corrupt. The data comes from a file: all
+  // sizes are checked (without overflowing) before anything is allocated or read
+    if ( (originalSize<0)||(inSize<4) )
+        return(false);
+    int blockCount;
+    memcpy(&blockCount,in,4);
+    if ( (blockCount<0)||(blockCount>(inSize-4)/8) )
+        return(false);
+    std::vector<SSerCompressionBlock> blocks(blockCount);
+    int inPos=4+8*blockCount;
+    int outPos=0;
+    for (int i=0;i<blockCount;i++)
+    {
+        int uncompressedSize,compressedSize;
+        memcpy(&uncompressedSize,in+4+8*i,4);
+        memcpy(&compressedSize,in+4+8*i+4,4);
+        if (compressedSize==0)
+            compressedSize=uncompressedSize; // stored uncompressed
+        if ( (uncompressedSize<0)||(uncompressedSize>SER_COMPRESSION_BLOCK_SIZE)||(compressedSize<0)||(compressedSize>inSize-inPos)||(uncompressedSize>originalSize-outPos) )
+            return(false);
+        blocks[i].in=in+inPos;
+        blocks[i].inSize=compressedSize;
+        blocks[i].outSize=uncompressedSize;
+        inPos+=compressedSize;
+        outPos+=uncompressedSize;
+    }
+    if (outPos!=originalSize)
+        return(false);
+    out.resize(originalSize);
+    outPos=0;
+    for (int i=0;i<blockCount;i++)
+    {
+        blocks[i].out=(blocks[i].outSize>0)?(&out[0]+outPos):NULL;
+        outPos+=blocks[i].outSize;
+    }
+    if (blockCount>0)
+        CWorkerPool::executeTasks(_uncompressBlockTask,&blocks[0],blockCount);
+    for (int i=0;i<blockCount;i++)
+    {
+        if (!blocks[i].ok)
+            return(false);
+    }
+    return(true);
+}
+
+void CSer::_compressBlockTask(void* taskData,int taskIndex)
+{
+    SSerCompressionBlock* block=((SSerCompressionBlock*)taskData)+taskIndex;
+    block->outSize=BlockCompressor_Compress(block->in,block->out,block->inSize,BlockCompressor_GetMaxCompressedSize(block->inSize));
+    if (block->outSize>=block->inSize)
+        block->outSize=0; // not compressible, we store it as is
+    block->ok=true;
+}
+
+void CSer::_uncompressBlockTask(void* taskData,int taskIndex)
+{
+    SSerCompressionBlock* block=((SSerCompressionBlock*)taskData)+taskIndex;
+    if (block->inSize==block->outSize)
+    { // stored uncompressed
+        if (block->outSize>0)
+            memcpy(block->out,block->in,block->outSize);
+        block->ok=true;
+    }
+    else
+        block->ok=(BlockCompressor_Uncompress(block->in,block->out,block->inSize,block->outSize)==block->outSize);
+}
+
+void CSer::_runCompressionBenchmark()
+{ // Compares both compression methods on the buffer about to be written, when enabled in the user settings
+    if (_fileBuffer.size()==0)
+        return;
+    std::string txt("Compression benchmark (");
+    txt+=boost::lexical_cast<std::string>(_fileBuffer.size())+" bytes):";
+
+    suint64 t0=VDateTime::getTimeInUs();
+    std::vector<unsigned char> huffmanBuff(_fileBuffer.size()+400);
+    int huffmanSize=Huffman_Compress(&_fileBuffer[0],&huffmanBuff[0],(unsigned int)_fileBuffer.size());
+    suint64 t1=VDateTime::getTimeInUs();
+    std::vector<unsigned char> uncompressedBuff(_fileBuffer.size());
+    Huffman_Uncompress(&huffmanBuff[0],&uncompressedBuff[0],huffmanSize,(unsigned int)_fileBuffer.size());
+    suint64 t2=VDateTime::getTimeInUs();
+    txt+=" method 1: "+boost::lexical_cast<std::string>(huffmanSize)+" bytes, save "+boost::lexical_cast<std::string>((t1-t0)/1000)+" ms, load "+boost::lexical_cast<std::string>((t2-t1)/1000)+" ms.";
+
+    t0=VDateTime::getTimeInUs();
+    std::vector<unsigned char> blockBuff;
+    _blockCompress(_fileBuffer,blockBuff);
+    t1=VDateTime::getTimeInUs();
+    bool ok=_blockUncompress(&blockBuff[0],int(blockBuff.size()),uncompressedBuff,int(_fileBuffer.size()));
+    t2=VDateTime::getTimeInUs();
+    txt+=" method 2: "+boost::lexical_cast<std::string>(blockBuff.size())+" bytes, save "+boost::lexical_cast<std::string>((t1-t0)/1000)+" ms, load "+boost::lexical_cast<std::string>((t2-t1)/1000)+" ms";
+    txt+=" ("+boost::lexical_cast<std::string>(CWorkerPool::getEffectiveWorkerCount()+1)+" threads)";
+    if ( (!ok)||(uncompressedBuff!=_fileBuffer) )
+        txt+=", ROUND-TRIP FAILED";
+    txt+=".";
+    App::addStatusbarMessage(txt);
 }
 
 void CSer::readClose()
@@ -9,6 +9,16 @@
 #define SER_END_OF_OBJECT "EOO"
 #define SER_NEXT_STEP "NXT"
 #define SER_END_OF_FILE "EOF"
+#define SER_COMPRESSION_BLOCK_SIZE 1048576 // for compression method 2. Blocks are (un)compressed in parallel
+
+struct SSerCompressionBlock
+{
+    const unsigned char* in;
+    int inSize;
+    unsigned char* out;
+    int outSize; // when compressing: 0 means the block is stored uncompressed
+    bool ok;
+};
 
 class CSer : public CSerBase
 {
@@ -75,6 +85,13 @@ public:
 private:
 
     void _commonInit();
+    void _runCompressionBenchmark();
+
+    static void _blockCompress(const std::vector<unsigned char>& in,std::vector<unsigned char>& out);
+    static bool _blockUncompress(const unsigned char* in,int inSize,std::vector<unsigned char>& out,int originalSize);
+    static void _compressBlockTask(void* taskData,int taskIndex);
+    static void _uncompressBlockTask(void* taskData,int taskIndex);
+
     VArchive* theArchive;
     std::vector<char>* _bufferArchive;
 
@@ -195,6 +195,7 @@
 
 #define IDSNS_EXPORTING_SHAPES "Exporting shapes..."
 #define IDSNS_EXPORTING_GRAPH_DATA "Exporting graph data..."
+#define IDSNS_GRAPH_RECORDING_STOPPED "Graph history could not be written to the recording folder: recording was stopped."
 #define IDSNS_EXPORTING_PATH "Exporting path..."
 #define IDSNS_EXPORTING_PATHS_BEZIER_CURVE "Exporting path's Bezier curve..."
 #define IDSNS_EXPORTING_DYNAMIC_CONTENT "Exporting dynamic content..."
@@ -247,6 +248,7 @@
 #define IDSNS_SCENE_WAS_SAVED "Scene was saved."
 #define IDSNS_SAVING_MODEL "Saving model"
 #define IDSNS_MODEL_WAS_SAVED "Model was saved."
+#define IDSNS_MESH_DATA_DUPLICATES_NOT_STORED "Mesh data: duplicate buffers not stored:"
 #define IDSNS_PATH_WAS_EMPTIED "Path was emptied."
 #define IDSNS_FORWARD_ROLL_PERFORMED "Forward roll performed."
 #define IDSNS_BACKWARD_ROLL_PERFORMED "Backward roll performed."
@@ -6,12 +6,11 @@
 
 
 
-CUndoBuffer::CUndoBuffer(const std::vector<char>& fullBuffer,int bufferId,CUndoBufferCameras* camBuff)
+CUndoBuffer::CUndoBuffer(const std::vector<suint64>& chunkKeys,int bufferId,CUndoBufferCameras* camBuff,CUndoChunkStore* chunkStore)
 {
     FUNCTION_DEBUG;
-    buffer.insert(buffer.end(),fullBuffer.begin(),fullBuffer.end());
-    _sameCountFromBeginning=0;
-    _sameCountFromEnd=0;
+    _chunkStore=chunkStore;
+    _chunkKeys.assign(chunkKeys.begin(),chunkKeys.end());
     _bufferId=bufferId;
     _cameraBuffers=camBuff;
 }
@@ -19,6 +18,7 @@ CUndoBuffer::CUndoBuffer(const std::vector<char>& fullBuffer,int bufferId,CUndoB
 CUndoBuffer::~CUndoBuffer()
 {
     FUNCTION_DEBUG;
+    _chunkStore->releaseBuffer(_chunkKeys);
     delete _cameraBuffers;
 }
 
@@ -32,82 +32,14 @@ int CUndoBuffer::getBufferId()
     return(_bufferId);
 }
 
-bool CUndoBuffer::finalize(const std::vector<char>& previousFullBuffer)
-{ // Return value false means: this buffer is exactly the same as "previousFullBuffer"
+bool CUndoBuffer::isSameAs(const CUndoBuffer* otherBuffer) const
+{ // same chunks means same content
     FUNCTION_DEBUG;
-    _sameCountFromBeginning=0;
-    _sameCountFromEnd=0;
-    int minBufferLength=SIM_MIN(int(previousFullBuffer.size()),int(buffer.size()));
-    for (int i=0;i<minBufferLength;i++)
-    {
-        if (previousFullBuffer[i]!=buffer[i])
-            break;
-        _sameCountFromBeginning++;
-    }
-    if ( (previousFullBuffer.size()==buffer.size())&&(_sameCountFromBeginning==int(buffer.size())) )
-    { // Buffer content is same!
-        return(false); // buffer content is same!
-    }
-    if (_sameCountFromBeginning==int(buffer.size()))
-    { // Previous buffer's beginning is same as this buffer entirely!
-        buffer.clear();
-        {
-            std::vector<char> ttmmpp(buffer);
-            buffer.swap(ttmmpp); // release the reserved memory that is not used!
-        }
-        return(true);
-    }
-    // We release what is not needed anymore:
-    buffer.erase(buffer.begin(),buffer.begin()+_sameCountFromBeginning);
-    {
-        std::vector<char> ttmmpp(buffer);
-        buffer.swap(ttmmpp); // release the reserved memory that is not used!
-    }
-    if (_sameCountFromBeginning==int(previousFullBuffer.size()))
-    { // Previous buffer is entirely same as this buffer's beginning!
-        return(true);
-    }
-
-    // Now we check from the end:
-    while (true)
-    {
-        int j=(int)previousFullBuffer.size()-1-_sameCountFromEnd;
-        int k=(int)buffer.size()-1-_sameCountFromEnd;
-        if ((j<0)||(k<0))
-            break;
-        if (previousFullBuffer[j]!=buffer[k])
-            break;
-        _sameCountFromEnd++;
-    }
-    // We release what is not needed anymore:
-    buffer.erase(buffer.end()-_sameCountFromEnd,buffer.end());
-    {
-        std::vector<char> ttmmpp(buffer);
-        buffer.swap(ttmmpp); // release the reserved memory that is not used!
-    }
-    return(true);
-}
-
-void CUndoBuffer::getRestored(const std::vector<char>* previousFullBuffer,std::vector<char>& restoredBuffer)
-{ // previousFullBuffer can be NULL. In that case _sameCountFromBeginning and _sameCountFromEnd should be 0
-    FUNCTION_DEBUG;
-    restoredBuffer.clear();
-    if (previousFullBuffer!=NULL)
-        restoredBuffer.insert(restoredBuffer.end(),previousFullBuffer->begin(),previousFullBuffer->begin()+_sameCountFromBeginning);
-    restoredBuffer.insert(restoredBuffer.end(),buffer.begin(),buffer.end());
-    if (previousFullBuffer!=NULL)
-        restoredBuffer.insert(restoredBuffer.end(),previousFullBuffer->end()-_sameCountFromEnd,previousFullBuffer->end());
+    return(_chunkKeys==otherBuffer->_chunkKeys);
 }
 
-void CUndoBuffer::updateWithFullBuffer(const std::vector<char>& fullBuffer)
+void CUndoBuffer::getRestored(std::vector<char>& restoredBuffer)
 {
     FUNCTION_DEBUG;
-    _sameCountFromBeginning=0;
-    _sameCountFromEnd=0;
-    buffer.clear();
-    buffer.insert(buffer.end(),fullBuffer.begin(),fullBuffer.end());
-    {
-        std::vector<char> ttmmpp(buffer);
-        buffer.swap(ttmmpp); // release the reserved memory that is not used!
-    }
+    _chunkStore->getBuffer(_chunkKeys,restoredBuffer);
 }
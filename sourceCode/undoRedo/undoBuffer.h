@@ -3,24 +3,22 @@
 
 #include "vrepMainHeader.h"
 #include "undoBufferCameras.h"
+#include "undoChunkStore.h"
 
 class CUndoBuffer
 {
 public:
-    CUndoBuffer(const std::vector<char>& fullBuffer,int bufferId,CUndoBufferCameras* camBuff);
+    CUndoBuffer(const std::vector<suint64>& chunkKeys,int bufferId,CUndoBufferCameras* camBuff,CUndoChunkStore* chunkStore); // chunkKeys: already referenced in chunkStore
     virtual ~CUndoBuffer();
-    bool finalize(const std::vector<char>& previousFullBuffer);
-    void updateWithFullBuffer(const std::vector<char>& fullBuffer);
-    void getRestored(const std::vector<char>* previousFullBuffer,std::vector<char>& restoredBuffer);
+    bool isSameAs(const CUndoBuffer* otherBuffer) const;
+    void getRestored(std::vector<char>& restoredBuffer);
     CUndoBufferCameras* getCameraBuffers();
     int getBufferId();
 
-    std::vector<char> buffer;
-
 private:
     CUndoBufferCameras* _cameraBuffers;
+    CUndoChunkStore* _chunkStore;
 
-    int _sameCountFromBeginning;
-    int _sameCountFromEnd;
+    std::vector<suint64> _chunkKeys; // the buffer content is in _chunkStore
     int _bufferId;
 };
@@ -1,6 +1,7 @@
 
 #include "vrepMainHeader.h"
 #include "undoBufferArrays.h"
+#include "undoChunkStore.h"
 
 CUndoBufferArrays::CUndoBufferArrays()
 {
@@ -80,9 +81,12 @@ bool CUndoBufferArrays::_areUCharBuffersSame(const std::vector<unsigned char>& b
 int CUndoBufferArrays::addVertexBuffer(const std::vector<float>& buff,int undoBufferId)
 {
     //1. search for a same buffer:
+    suint64 hash=0;
+    if (buff.size()>0)
+        hash=CUndoChunkStore::getHash(&buff[0],buff.size()*sizeof(float));
     for (int i=0;i<int(_vertexBuffers.size());i++)
     {
-        if (_areFloatBuffersSame(buff,_vertexBuffers[i]._buffer))
+        if ( (_vertexBuffers[i]._hash==hash)&&_areFloatBuffersSame(buff,_vertexBuffers[i]._buffer) )
         {
             _vertexBuffers[i]._undoBufferDependencyIds.push_back(undoBufferId);
             return(_vertexBuffers[i]._identifier);
@@ -93,6 +97,7 @@ int CUndoBufferArrays::addVertexBuffer(const std::vector<float>& buff,int undoBu
     theBuff._identifier=_nextId++;
     theBuff._undoBufferDependencyIds.push_back(undoBufferId);
     theBuff._buffer.assign(buff.begin(),buff.end());
+    theBuff._hash=hash;
     _vertexBuffers.push_back(theBuff);
     return(_nextId-1);
 }
@@ -100,9 +105,12 @@ int CUndoBufferArrays::addVertexBuffer(const std::vector<float>& buff,int undoBu
 int CUndoBufferArrays::addIndexBuffer(const std::vector<int>& buff,int undoBufferId)
 {
     //1. search for a same buffer:
+    suint64 hash=0;
+    if (buff.size()>0)
+        hash=CUndoChunkStore::getHash(&buff[0],buff.size()*sizeof(int));
     for (int i=0;i<int(_indexBuffers.size());i++)
     {
-        if (_areIntBuffersSame(buff,_indexBuffers[i]._buffer))
+        if ( (_indexBuffers[i]._hash==hash)&&_areIntBuffersSame(buff,_indexBuffers[i]._buffer) )
         {
             _indexBuffers[i]._undoBufferDependencyIds.push_back(undoBufferId);
             return(_indexBuffers[i]._identifier);
@@ -113,6 +121,7 @@ int CUndoBufferArrays::addIndexBuffer(const std::vector<int>& buff,int undoBuffe
     theBuff._identifier=_nextId++;
     theBuff._undoBufferDependencyIds.push_back(undoBufferId);
     theBuff._buffer.assign(buff.begin(),buff.end());
+    theBuff._hash=hash;
     _indexBuffers.push_back(theBuff);
     return(_nextId-1);
 }
@@ -120,9 +129,12 @@ int CUndoBufferArrays::addIndexBuffer(const std::vector<int>& buff,int undoBuffe
 int CUndoBufferArrays::addNormalsBuffer(const std::vector<float>& buff,int undoBufferId)
 {
     //1. search for a same buffer:
+    suint64 hash=0;
+    if (buff.size()>0)
+        hash=CUndoChunkStore::getHash(&buff[0],buff.size()*sizeof(float));
     for (int i=0;i<int(_normalsBuffers.size());i++)
     {
-        if (_areFloatBuffersSame(buff,_normalsBuffers[i]._buffer))
+        if ( (_normalsBuffers[i]._hash==hash)&&_areFloatBuffersSame(buff,_normalsBuffers[i]._buffer) )
         {
             _normalsBuffers[i]._undoBufferDependencyIds.push_back(undoBufferId);
             return(_normalsBuffers[i]._identifier);
@@ -133,6 +145,7 @@ int CUndoBufferArrays::addNormalsBuffer(const std::vector<float>& buff,int undoB
     theBuff._identifier=_nextId++;
     theBuff._undoBufferDependencyIds.push_back(undoBufferId);
     theBuff._buffer.assign(buff.begin(),buff.end());
+    theBuff._hash=hash;
     _normalsBuffers.push_back(theBuff);
     return(_nextId-1);
 }
@@ -140,9 +153,12 @@ int CUndoBufferArrays::addNormalsBuffer(const std::vector<float>& buff,int undoB
 int CUndoBufferArrays::addTextureBuffer(const std::vector<unsigned char>& buff,int undoBufferId)
 {
     //1. search for a same buffer:
+    suint64 hash=0;
+    if (buff.size()>0)
+        hash=CUndoChunkStore::getHash(&buff[0],buff.size()*sizeof(unsigned char));
     for (int i=0;i<int(_textureBuffers.size());i++)
     {
-        if (_areUCharBuffersSame(buff,_textureBuffers[i]._buffer))
+        if ( (_textureBuffers[i]._hash==hash)&&_areUCharBuffersSame(buff,_textureBuffers[i]._buffer) )
         {
             _textureBuffers[i]._undoBufferDependencyIds.push_back(undoBufferId);
             return(_textureBuffers[i]._identifier);
@@ -153,10 +169,48 @@ int CUndoBufferArrays::addTextureBuffer(const std::vector<unsigned char>& buff,i
     theBuff._identifier=_nextId++;
     theBuff._undoBufferDependencyIds.push_back(undoBufferId);
     theBuff._buffer.assign(buff.begin(),buff.end());
+    theBuff._hash=hash;
     _textureBuffers.push_back(theBuff);
     return(_nextId-1);
 }
 
+bool CUndoBufferArrays::addDependency(int id,int undoBufferId)
+{ // for buffers that didn't change since they were added: saves searching for a same buffer
+    for (int i=0;i<int(_vertexBuffers.size());i++)
+    {
+        if (_vertexBuffers[i]._identifier==id)
+        {
+            _vertexBuffers[i]._undoBufferDependencyIds.push_back(undoBufferId);
+            return(true);
+        }
+    }
+    for (int i=0;i<int(_indexBuffers.size());i++)
+    {
+        if (_indexBuffers[i]._identifier==id)
+        {
+            _indexBuffers[i]._undoBufferDependencyIds.push_back(undoBufferId);
+            return(true);
+        }
+    }
+    for (int i=0;i<int(_normalsBuffers.size());i++)
+    {
+        if (_normalsBuffers[i]._identifier==id)
+        {
+            _normalsBuffers[i]._undoBufferDependencyIds.push_back(undoBufferId);
+            return(true);
+        }
+    }
+    for (int i=0;i<int(_textureBuffers.size());i++)
+    {
+        if (_textureBuffers[i]._identifier==id)
+        {
+            _textureBuffers[i]._undoBufferDependencyIds.push_back(undoBufferId);
+            return(true);
+        }
+    }
+    return(false);
+}
+
 void CUndoBufferArrays::getVertexBuffer(int id,std::vector<float>& buff)
 {
     bool found=false;
@@ -7,6 +7,7 @@ struct SUndoBufferIntArray
 {
     int _identifier;
     std::vector<int> _buffer;
+    suint64 _hash; // content hash, to quickly discard different buffers
     std::vector<int> _undoBufferDependencyIds;
 };
 
@@ -14,6 +15,7 @@ struct SUndoBufferFloatArray
 {
     int _identifier;
     std::vector<float> _buffer;
+    suint64 _hash; // content hash, to quickly discard different buffers
     std::vector<int> _undoBufferDependencyIds;
 };
 
@@ -21,6 +23,7 @@ struct SUndoBufferUCharArray
 {
     int _identifier;
     std::vector<unsigned char> _buffer;
+    suint64 _hash; // content hash, to quickly discard different buffers
     std::vector<int> _undoBufferDependencyIds;
 };
 
@@ -34,6 +37,7 @@ public:
     int addIndexBuffer(const std::vector<int>& buff,int undoBufferId);
     int addNormalsBuffer(const std::vector<float>& buff,int undoBufferId);
     int addTextureBuffer(const std::vector<unsigned char>& buff,int undoBufferId);
+    bool addDependency(int id,int undoBufferId); // false if buffer id doesn't exist anymore
 
     void getVertexBuffer(int id,std::vector<float>& buff);
     void getIndexBuffer(int id,std::vector<int>& buff);
@@ -0,0 +1,176 @@
+#include "vrepMainHeader.h"
+#include "undoChunkStore.h"
+#include <string.h>
+
+#define UNDO_CHUNK_MIN_SIZE 2048
+#define UNDO_CHUNK_MAX_SIZE 65536
+#define UNDO_CHUNK_BOUNDARY_BITS 13 // i.e. chunks of about 8KB
+
+CUndoChunkStore::CUndoChunkStore()
+{
+    _nextChunkKey=0;
+    _memorySize=0;
+}
+
+CUndoChunkStore::~CUndoChunkStore()
+{
+}
+
+void CUndoChunkStore::addBuffer(const char* buff,size_t size,std::vector<suint64>& chunkKeys)
+{ // the keys of the chunks that make up buff are appended to chunkKeys. Each key is referenced until releaseBuffer is called
+    size_t pos=0;
+    while (pos<size)
+    {
+        size_t chunkSize=_getChunkSize(buff+pos,size-pos);
+        suint64 hash=getHash(buff+pos,chunkSize);
+        std::map<suint64,SUndoChunk>::iterator chunkIt=_chunks.end();
+        std::pair<std::multimap<suint64,suint64>::iterator,std::multimap<suint64,suint64>::iterator> range=_chunkKeysFromHash.equal_range(hash);
+        for (std::multimap<suint64,suint64>::iterator it=range.first;it!=range.second;it++)
+        {
+            std::map<suint64,SUndoChunk>::iterator it2=_chunks.find(it->second);
+            if ( (it2->second.data.size()==chunkSize)&&(memcmp(&it2->second.data[0],buff+pos,chunkSize)==0) )
+            { // same chunk already stored
+                chunkIt=it2;
+                break;
+            }
+        }
+        if (chunkIt==_chunks.end())
+        { // new chunk (or hash collision with a different chunk)
+            suint64 key=_nextChunkKey++;
+            chunkIt=_chunks.insert(std::make_pair(key,SUndoChunk())).first;
+            chunkIt->second.data.assign(buff+pos,buff+pos+chunkSize);
+            chunkIt->second.hash=hash;
+            chunkIt->second.refCount=0;
+            _chunkKeysFromHash.insert(std::make_pair(hash,key));
+            _memorySize+=int(chunkSize);
+        }
+        chunkIt->second.refCount++;
+        chunkKeys.push_back(chunkIt->first);
+        pos+=chunkSize;
+    }
+}
+
+bool CUndoChunkStore::addBufferIfSame(const std::vector<suint64>& chunkKeys,const char* buff,size_t size)
+{ // if chunkKeys are still stored and make up buff, they are referenced once more (no hashing nor chunking needed)
+    size_t pos=0;
+    for (size_t i=0;i<chunkKeys.size();i++)
+    {
+        std::map<suint64,SUndoChunk>::iterator it=_chunks.find(chunkKeys[i]);
+        if (it==_chunks.end())
+            return(false);
+        size_t chunkSize=it->second.data.size();
+        if ( (chunkSize>size-pos)||(memcmp(&it->second.data[0],buff+pos,chunkSize)!=0) )
+            return(false);
+        pos+=chunkSize;
+    }
+    if (pos!=size)
+        return(false);
+    for (size_t i=0;i<chunkKeys.size();i++)
+        _chunks[chunkKeys[i]].refCount++;
+    return(true);
+}
+
+void CUndoChunkStore::getBuffer(const std::vector<suint64>& chunkKeys,std::vector<char>& buff)
+{
+    buff.clear();
+    std::vector<const SUndoChunk*> chunks;
+    size_t totalSize=0;
+    for (size_t i=0;i<chunkKeys.size();i++)
+    {
+        std::map<suint64,SUndoChunk>::iterator it=_chunks.find(chunkKeys[i]);
+        if (it!=_chunks.end())
+        {
+            chunks.push_back(&it->second);
+            totalSize+=it->second.data.size();
+        }
+    }
+    buff.reserve(totalSize);
+    for (size_t i=0;i<chunks.size();i++)
+        buff.insert(buff.end(),chunks[i]->data.begin(),chunks[i]->data.end());
+}
+
+void CUndoChunkStore::releaseBuffer(const std::vector<suint64>& chunkKeys)
+{
+    for (size_t i=0;i<chunkKeys.size();i++)
+    {
+        std::map<suint64,SUndoChunk>::iterator it=_chunks.find(chunkKeys[i]);
+        if (it!=_chunks.end())
+        {
+            it->second.refCount--;
+            if (it->second.refCount<=0)
+            {
+                std::pair<std::multimap<suint64,suint64>::iterator,std::multimap<suint64,suint64>::iterator> range=_chunkKeysFromHash.equal_range(it->second.hash);
+                for (std::multimap<suint64,suint64>::iterator it2=range.first;it2!=range.second;it2++)
+                {
+                    if (it2->second==it->first)
+                    {
+                        _chunkKeysFromHash.erase(it2);
+                        break;
+                    }
+                }
+                _memorySize-=int(it->second.data.size());
+                _chunks.erase(it);
+            }
+        }
+    }
+}
+
+void CUndoChunkStore::clearAll()
+{
+    _chunks.clear();
+    _chunkKeysFromHash.clear();
+    _memorySize=0;
+}
+
+int CUndoChunkStore::getMemorySizeInBytes()
+{
+    return(_memorySize);
+}
+
+int CUndoChunkStore::getChunkCount()
+{
+    return(int(_chunks.size()));
+}
+
+suint64 CUndoChunkStore::getHash(const void* data,size_t size)
+{ // 64-bit FNV-1a
+    const unsigned char* d=(const unsigned char*)data;
+    suint64 retVal=14695981039346656037ULL;
+    for (size_t i=0;i<size;i++)
+    {
+        retVal^=d[i];
+        retVal*=1099511628211ULL;
+    }
+    return(retVal);
+}
+
+size_t CUndoChunkStore::_getChunkSize(const char* data,size_t size)
+{ // Chunk boundaries depend on the content only (gear rolling hash), so that data inserted or
+  // removed somewhere does not shift the chunks that follow
+    static suint64 gear[256];
+    static bool gearInitialized=false;
+    if (!gearInitialized)
+    {
+        suint64 x=0x9e3779b97f4a7c15ULL;
+        for (size_t i=0;i<256;i++)
+        { // splitmix64
+            x+=0x9e3779b97f4a7c15ULL;
+            suint64 z=x;
+            z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+            z=(z^(z>>27))*0x94d049bb133111ebULL;
+            gear[i]=z^(z>>31);
+        }
+        gearInitialized=true;
+    }
+    if (size<=UNDO_CHUNK_MIN_SIZE)
+        return(size);
+    size_t maxSize=SIM_MIN(size,size_t(UNDO_CHUNK_MAX_SIZE));
+    suint64 h=0;
+    for (size_t i=0;i<maxSize;i++)
+    {
+        h=(h<<1)+gear[(unsigned char)data[i]];
+        if ( (i>=UNDO_CHUNK_MIN_SIZE)&&((h>>(64-UNDO_CHUNK_BOUNDARY_BITS))==0) ) // high bits depend on the last 64 bytes
+            return(i+1);
+    }
+    return(maxSize);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "vrepMainHeader.h"
+
+struct SUndoChunk
+{
+    std::vector<char> data;
+    suint64 hash;
+    int refCount;
+};
+
+// Undo buffers are split into content-defined chunks. Identical chunks (e.g. data of objects that
+// did not change) are stored only once, whatever undo level they belong to
+class CUndoChunkStore
+{
+public:
+    CUndoChunkStore();
+    virtual ~CUndoChunkStore();
+
+    void addBuffer(const char* buff,size_t size,std::vector<suint64>& chunkKeys);
+    bool addBufferIfSame(const std::vector<suint64>& chunkKeys,const char* buff,size_t size);
+    void getBuffer(const std::vector<suint64>& chunkKeys,std::vector<char>& buff);
+    void releaseBuffer(const std::vector<suint64>& chunkKeys);
+    void clearAll();
+    int getMemorySizeInBytes();
+    int getChunkCount();
+
+    static suint64 getHash(const void* data,size_t size);
+
+private:
+    static size_t _getChunkSize(const char* data,size_t size);
+
+    // Each stored content has a single key while it is stored, so that same keys means same content. Keys are never reused:
+    std::map<suint64,SUndoChunk> _chunks; // key --> chunk
+    std::multimap<suint64,suint64> _chunkKeysFromHash; // content hash --> keys of the chunks with that hash
+    suint64 _nextChunkKey;
+    int _memorySize;
+};
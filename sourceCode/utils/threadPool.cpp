@@ -5,6 +5,7 @@
 #include "app.h"
 #include "vDateTime.h"
 #include "debugLogFile.h"
+#include "tt.h"
 #include <boost/lexical_cast.hpp>
 
 #ifdef MAC_VREP
@@ -27,6 +28,9 @@ int CThreadPool::_simulationStopRequestTime;
 bool CThreadPool::_simulationEmergencyStopRequest=false;
 VTHREAD_START_ADDRESS CThreadPool::_threadStartAdd=NULL;
 VMutex CThreadPool::_threadPoolMutex;
+VMutex CThreadPool::_threadLaunchMutex;
+bool CThreadPool::_eventDrivenSwitches=true;
+int CThreadPool::_benchmarkStepCount=0;
 
 bool CThreadPool::_showThreadSwitches=false;
 
@@ -62,9 +66,11 @@ VTHREAD_ID_TYPE CThreadPool::createNewThread(VTHREAD_START_ADDRESS threadStartAd
         CDebugLogFile::addDebugText(false,tmp.c_str());
 //      printf("Launching thread (from threadID: %lu)\n",(unsigned long)VThread::getCurrentThreadId());
     }
+    _threadLaunchMutex.lock_simple();
     VThread::launchThread(_intermediateThreadStartPoint,true);
     while (_threadStartAdd!=NULL)
-        VThread::sleep(1); // We wait until the thread could set its thread ID ************* TODO: don't use sleep!!!
+        _threadLaunchMutex.wait_simple(); // We wait until the thread could set its thread ID
+    _threadLaunchMutex.unlock_simple();
     VTHREAD_ID_TYPE newID=(VTHREAD_ID_TYPE)_allThreadData[_allThreadData.size()-1]->threadID;
     if (_showThreadSwitches)
     {
@@ -256,7 +262,7 @@ void CThreadPool::switchToThread(VTHREAD_ID_TYPE threadID)
                         CDebugLogFile::addDebugText(false,tmp.c_str());
 //                      printf("Switching backward from threadID: %lu to threadID: %lu\n",(unsigned long)oldFiberID,(unsigned long)_allThreadData[i]->threadID);
                     }
-                    _allThreadData[i]->threadWantsResumeFromYield=true; // We mark the next thread for resuming
+                    _resumeThread(_allThreadData[i]); // We mark the next thread for resuming
                 }
                 else
                 { // Happens when a thread that used to be free running (or that still is) comes through here
@@ -287,20 +293,7 @@ void CThreadPool::switchToThread(VTHREAD_ID_TYPE threadID)
                         CDebugLogFile::addDebugText(false,tmp.c_str());
 //                      printf("Backward switch part, threadID %lu (%lu) is waiting...\n",(unsigned long)it->threadID,(unsigned long)VThread::getCurrentThreadId());
                     }
-                    while (!it->threadWantsResumeFromYield)
-                    {
-                        if (_threadToIntercept!=0)
-                        {
-                            if (VThread::areThreadIDsSame(_threadToIntercept,VThread::getCurrentThreadId()))
-                            {
-                                _threadToIntercept=0;
-                                _threadInterceptCallback(NULL);
-                                _threadInterceptCallback=NULL;
-                                _threadInterceptIndex--;
-                            }
-                        }
-                        VThread::switchThread();
-                    }
+                    _waitForResume(it,true);
                     if (_showThreadSwitches)
                     {
                         std::string tmp("==< Backward switch part, threadID ");
@@ -331,7 +324,7 @@ void CThreadPool::switchToThread(VTHREAD_ID_TYPE threadID)
                     CDebugLogFile::addDebugText(false,tmp.c_str());
 //                  printf("Switching forward from threadID: %lu to threadID: %lu\n",(unsigned long)_threadQueue[_threadQueue.size()-2],(unsigned long)threadID);
                 }
-                _allThreadData[i]->threadWantsResumeFromYield=true; // We mark the next thread for resuming
+                _resumeThread(_allThreadData[i]); // We mark the next thread for resuming
                 // We do not need to idle this thread since it is already flagged as such
                 CVThreadData* it=NULL;
                 for (int j=0;j<int(_allThreadData.size());j++)
@@ -354,8 +347,7 @@ void CThreadPool::switchToThread(VTHREAD_ID_TYPE threadID)
                     CDebugLogFile::addDebugText(false,tmp.c_str());
 //                  printf("Forward switch part, threadID %lu (%lu) is waiting...\n",(unsigned long)it->threadID,(unsigned long)VThread::getCurrentThreadId());
                 }
-                while (!it->threadWantsResumeFromYield)
-                    VThread::switchThread();
+                _waitForResume(it,false);
                 if (_showThreadSwitches)
                 {
                     std::string tmp("==> Forward switch part, threadID ");
@@ -514,13 +506,14 @@ void CThreadPool::_cleanupTerminatedThreads()
 VTHREAD_RETURN_TYPE CThreadPool::_intermediateThreadStartPoint(VTHREAD_ARGUMENT_TYPE lpData)
 {
     srand(VDateTime::getTimeInMs()+ (((unsigned long)(VThread::getCurrentThreadId()))&0xffffffff) ); // Important: each thread starts with a same seed!!!
+    _threadLaunchMutex.lock_simple();
     VTHREAD_START_ADDRESS startAdd=_threadStartAdd;
     CVThreadData* it=new CVThreadData(NULL,VThread::getCurrentThreadId());
     _allThreadData.push_back(it);
     _threadStartAdd=NULL; // To indicate we could set the thread iD (in case of threads)
-    it->threadWantsResumeFromYield=false;
-    while (!it->threadWantsResumeFromYield)
-        VThread::switchThread();
+    _threadLaunchMutex.wakeAll_simple(); // createNewThread waits for this
+    _threadLaunchMutex.unlock_simple();
+    _waitForResume(it,false);
 
     // If we arrived here, it is because CThreadPool::switchToFiberOrThread was called for this thread from another thread
     it->threadWantsResumeFromYield=false; // We reset it
@@ -816,7 +809,7 @@ bool CThreadPool::setThreadFreeMode(bool freeMode)
             _threadStartTime.pop_back();
             thisThreadData->threadShouldRunFreely=true;
             thisThreadData->threadSwitchShouldTriggerNoOtherThread=true;
-            nextThreadData->threadWantsResumeFromYield=true;
+            _resumeThread(nextThreadData);
             _unlock(17);
             if (_showThreadSwitches)
             {
@@ -925,6 +918,118 @@ void CThreadPool::setShowThreadSwitches(bool show)
     _showThreadSwitches=show;
 }
 
+bool CThreadPool::getEventDrivenSwitches()
+{
+    return(_eventDrivenSwitches);
+}
+
+void CThreadPool::setEventDrivenSwitches(bool eventDriven)
+{ // Can be changed anytime: a resumed thread is always also woken up
+    _eventDrivenSwitches=eventDriven;
+}
+
+void CThreadPool::_resumeThread(CVThreadData* threadData)
+{
+    threadData->resumeMutex.lock_simple();
+    threadData->threadWantsResumeFromYield=true;
+    threadData->resumeMutex.wakeAll_simple();
+    threadData->resumeMutex.unlock_simple();
+}
+
+void CThreadPool::_wakeThread(CVThreadData* threadData)
+{ // Wakes the thread up without resuming it, e.g. to have it handle an interception
+    if (threadData!=NULL)
+    {
+        threadData->resumeMutex.lock_simple();
+        threadData->resumeMutex.wakeAll_simple();
+        threadData->resumeMutex.unlock_simple();
+    }
+}
+
+void CThreadPool::_waitForResume(CVThreadData* threadData,bool handleInterceptions)
+{ // Returns once _resumeThread was called for this thread. The caller resets threadWantsResumeFromYield
+    if (!_eventDrivenSwitches)
+    { // we poll
+        while (!threadData->threadWantsResumeFromYield)
+        {
+            if (handleInterceptions)
+                _handleInterception();
+            VThread::switchThread();
+        }
+        return;
+    }
+    while (true)
+    {
+        threadData->resumeMutex.lock_simple();
+        while ( (!threadData->threadWantsResumeFromYield)&&((!handleInterceptions)||(!_isInterceptionPending())) )
+            threadData->resumeMutex.wait_simple();
+        bool resume=threadData->threadWantsResumeFromYield;
+        threadData->resumeMutex.unlock_simple();
+        if (resume)
+            break;
+        _handleInterception(); // the callback might itself switch threads, so we do not hold the mutex here
+    }
+}
+
+bool CThreadPool::_isInterceptionPending()
+{
+    return( (_threadToIntercept!=0)&&VThread::areThreadIDsSame(_threadToIntercept,VThread::getCurrentThreadId()) );
+}
+
+void CThreadPool::_handleInterception()
+{
+    if (_isInterceptionPending())
+    {
+        _threadToIntercept=0;
+        _threadInterceptCallback(NULL);
+        _threadInterceptCallback=NULL;
+        _threadInterceptIndex--;
+    }
+}
+
+void CThreadPool::runSwitchBenchmark()
+{ // Threads that only yield, like threaded scripts that call sim.switchThread in a loop, are
+  // handled in passes, like in a simulation step. Both switch modes are timed
+    const int threadCounts[3]={1,10,100};
+    const int passCount=20;
+    bool eventDrivenSwitches=_eventDrivenSwitches;
+    for (int mode=0;mode<2;mode++)
+    {
+        _eventDrivenSwitches=(mode==1);
+        for (int c=0;c<3;c++)
+        {
+            _benchmarkStepCount=passCount;
+            std::vector<VTHREAD_ID_TYPE> threads;
+            for (int i=0;i<threadCounts[c];i++)
+                threads.push_back(createNewThread(_benchmarkThreadStartPoint));
+            suint64 startTime=VDateTime::getTimeInUs();
+            for (int pass=0;pass<=passCount;pass++)
+            { // the last pass lets the threads end
+                for (size_t i=0;i<threads.size();i++)
+                    switchToThread(threads[i]);
+            }
+            float totalTime=float(VDateTime::getTimeInUs()-startTime);
+            std::string txt("Thread switch benchmark (");
+            if (_eventDrivenSwitches)
+                txt+="event-driven, ";
+            else
+                txt+="polling, ";
+            txt+=tt::FNb(threadCounts[c])+" threads): ";
+            txt+=tt::FNb(0,totalTime/float(2*threadCounts[c]*(passCount+1)),2,false)+" us per switch, ";
+            txt+=tt::FNb(0,totalTime/float(1000*(passCount+1)),3,false)+" ms per step";
+            App::addStatusbarMessage(txt);
+        }
+    }
+    _eventDrivenSwitches=eventDrivenSwitches;
+}
+
+VTHREAD_RETURN_TYPE CThreadPool::_benchmarkThreadStartPoint(VTHREAD_ARGUMENT_TYPE lpData)
+{
+    for (int i=0;i<_benchmarkStepCount;i++)
+        switchBackToPreviousThread();
+    return(VTHREAD_RETURN_VAL);
+}
+
 VTHREAD_RETURN_TYPE CThreadPool::_tmpCallback(VTHREAD_ARGUMENT_TYPE lpData)
 { // This callback is used to execute some functions via a specific thread
     void** valPtr=(void**)_tmpData;
@@ -965,12 +1070,14 @@ bool CThreadPool::_interceptThread(VTHREAD_ID_TYPE theThreadToIntercept,VTHREAD_
 {
     _lock(1);
     bool retVal=false;
+    CVThreadData* threadData=NULL;
     VTHREAD_ID_TYPE fID=theThreadToIntercept;
     for (size_t i=0;i<_allThreadData.size();i++)
     {
         if (VThread::areThreadIDsSame(_allThreadData[i]->threadID,fID))
         {
             retVal=!_allThreadData[i]->threadShouldRunFreely;
+            threadData=_allThreadData[i];
             break;
         }
     }
@@ -981,6 +1088,7 @@ bool CThreadPool::_interceptThread(VTHREAD_ID_TYPE theThreadToIntercept,VTHREAD_
         int v=_threadInterceptIndex;
         _threadInterceptCallback=theCallback;
         _threadToIntercept=theThreadToIntercept;
+        _wakeThread(threadData); // the thread might be blocked in _waitForResume
 
         while (v<=_threadInterceptIndex)
 //        while (_threadInterceptCallback!=NULL)
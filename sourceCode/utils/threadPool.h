@@ -38,6 +38,7 @@ public:
     volatile unsigned char threadResumeLocationAndOrder;
     volatile bool threadShouldNotSwitch;
     volatile bool allowToExecuteAgainInThisSimulationStep;
+    VMutex resumeMutex; // protects threadWantsResumeFromYield with event-driven switches. Also used as wait condition
 };
 
 // FULLY STATIC CLASS
@@ -92,6 +93,10 @@ public:
     static bool getShowThreadSwitches();
     static void setShowThreadSwitches(bool show);
 
+    static bool getEventDrivenSwitches();
+    static void setEventDrivenSwitches(bool eventDriven); // true: waiting threads block on a wait condition. false: waiting threads poll
+    static void runSwitchBenchmark(); // call only from the simulation thread, when no threaded script is running
+
 private:
     static void _lock(unsigned char debugInfo);
     static void _unlock(unsigned char debugInfo);
@@ -106,6 +111,12 @@ private:
     static VTHREAD_RETURN_TYPE _intermediateThreadStartPoint(VTHREAD_ARGUMENT_TYPE lpData);
     static void _cleanupTerminatedThreads();
     static void _terminateThread();
+    static void _resumeThread(CVThreadData* threadData);
+    static void _wakeThread(CVThreadData* threadData);
+    static void _waitForResume(CVThreadData* threadData,bool handleInterceptions);
+    static bool _isInterceptionPending();
+    static void _handleInterception();
+    static VTHREAD_RETURN_TYPE _benchmarkThreadStartPoint(VTHREAD_ARGUMENT_TYPE lpData);
     static VTHREAD_START_ADDRESS _threadStartAdd;
 
     static std::vector<CVThreadData*> _allThreadData;
@@ -118,6 +129,9 @@ private:
     static bool _simulationEmergencyStopRequest;
 
     static VMutex _threadPoolMutex;
+    static VMutex _threadLaunchMutex;
+    static bool _eventDrivenSwitches;
+    static int _benchmarkStepCount;
 
     static int _processorCoreAffinity; // -1: os default, 0: all on same core, but any core, >0: affinity mask
     static int _lockStage;
@@ -0,0 +1,174 @@
+
+#include "vrepMainHeader.h"
+#include "workerPool.h"
+
+VMutex CWorkerPool::_taskMutex;
+WORKER_TASK_FUNCTION CWorkerPool::_taskFunction=NULL;
+VTHREAD_ID_TYPE CWorkerPool::_taskOwnerThreadId=VTHREAD_ID_DEAD;
+void* CWorkerPool::_taskData=NULL;
+int CWorkerPool::_taskCount=0;
+int CWorkerPool::_nextTaskIndex=0;
+int CWorkerPool::_completedTaskCount=0;
+int CWorkerPool::_workerCount=0;
+int CWorkerPool::_launchedWorkerCount=0;
+int CWorkerPool::_runningWorkerCount=0;
+bool CWorkerPool::_workersShouldEnd=false;
+std::vector<VTHREAD_ID_TYPE> CWorkerPool::_workerThreadIds;
+
+void CWorkerPool::executeTasks(WORKER_TASK_FUNCTION taskFunction,void* taskData,int taskCount)
+{ // Calls taskFunction(taskData,i) for i=0..taskCount-1, in any order and possibly concurrently.
+  // Returns once all tasks were executed. The calling thread also executes tasks.
+    if (taskCount<=0)
+        return;
+    bool serial=(taskCount==1)||(getEffectiveWorkerCount()==0);
+    if (!serial)
+    {
+        _launchWorkersIfNeeded();
+        _taskMutex.lock_simple();
+        if (_taskFunction!=NULL)
+        { // The pool is busy (e.g. call from within a task, or from another thread)
+            _taskMutex.unlock_simple();
+            serial=true;
+        }
+    }
+    if (serial)
+    {
+        for (int i=0;i<taskCount;i++)
+            taskFunction(taskData,i);
+        return;
+    }
+
+    _taskFunction=taskFunction;
+    _taskOwnerThreadId=VThread::getCurrentThreadId();
+    _taskData=taskData;
+    _taskCount=taskCount;
+    _nextTaskIndex=0;
+    _completedTaskCount=0;
+    _taskMutex.wakeAll_simple();
+    while (_nextTaskIndex<_taskCount)
+    {
+        int index=_nextTaskIndex++;
+        _taskMutex.unlock_simple();
+        taskFunction(taskData,index);
+        _taskMutex.lock_simple();
+        _completedTaskCount++;
+    }
+    while (_completedTaskCount<_taskCount)
+        _taskMutex.wait_simple();
+    _taskFunction=NULL;
+    _taskOwnerThreadId=VTHREAD_ID_DEAD;
+    _taskData=NULL;
+    _taskCount=0;
+    _taskMutex.unlock_simple();
+}
+
+void CWorkerPool::setWorkerCount(int cnt)
+{
+    if (cnt<-1)
+        cnt=-1;
+    _taskMutex.lock_simple();
+    _workerCount=cnt;
+    bool tooManyWorkers=(_launchedWorkerCount>getEffectiveWorkerCount());
+    _taskMutex.unlock_simple();
+    if (tooManyWorkers)
+        cleanUp(); // workers will be relaunched when needed
+}
+
+int CWorkerPool::getWorkerCount()
+{
+    return(_workerCount);
+}
+
+int CWorkerPool::getEffectiveWorkerCount()
+{
+    if (_workerCount>=0)
+        return(_workerCount);
+    int cnt=VThread::getCoreCount()-1;
+    if (cnt<0)
+        cnt=0;
+    return(cnt);
+}
+
+void CWorkerPool::cleanUp()
+{
+    _taskMutex.lock_simple();
+    _workersShouldEnd=true;
+    _taskMutex.wakeAll_simple();
+    while (_runningWorkerCount>0)
+        _taskMutex.wait_simple();
+    _workersShouldEnd=false;
+    _launchedWorkerCount=0;
+    _taskMutex.unlock_simple();
+}
+
+bool CWorkerPool::isCurrentThreadWorkingFor(VTHREAD_ID_TYPE threadId)
+{ // Tasks executed serially run in the calling thread, tasks of a nested executeTasks call run in the thread of the outer task
+    VTHREAD_ID_TYPE currentThreadId=VThread::getCurrentThreadId();
+    if (VThread::areThreadIDsSame(currentThreadId,threadId))
+        return(true);
+    bool retVal=false;
+    _taskMutex.lock_simple();
+    if ( (_taskFunction!=NULL)&&VThread::areThreadIDsSame(_taskOwnerThreadId,threadId) )
+    {
+        for (size_t i=0;i<_workerThreadIds.size();i++)
+        {
+            if (VThread::areThreadIDsSame(_workerThreadIds[i],currentThreadId))
+            {
+                retVal=true;
+                break;
+            }
+        }
+    }
+    _taskMutex.unlock_simple();
+    return(retVal);
+}
+
+void CWorkerPool::_launchWorkersIfNeeded()
+{
+    _taskMutex.lock_simple();
+    int toLaunch=getEffectiveWorkerCount()-_launchedWorkerCount;
+    for (int i=0;i<toLaunch;i++)
+    {
+        _launchedWorkerCount++;
+        _runningWorkerCount++; // decremented by the worker itself when it ends
+        VThread::launchThread(_workerThreadStartPoint,false);
+    }
+    _taskMutex.unlock_simple();
+}
+
+VTHREAD_RETURN_TYPE CWorkerPool::_workerThreadStartPoint(VTHREAD_ARGUMENT_TYPE lpData)
+{
+    _taskMutex.lock_simple();
+    VTHREAD_ID_TYPE threadId=VThread::getCurrentThreadId();
+    _workerThreadIds.push_back(threadId);
+    while (!_workersShouldEnd)
+    {
+        if ( (_taskFunction!=NULL)&&(_nextTaskIndex<_taskCount) )
+        {
+            int index=_nextTaskIndex++;
+            WORKER_TASK_FUNCTION taskFunction=_taskFunction;
+            void* taskData=_taskData;
+            _taskMutex.unlock_simple();
+            taskFunction(taskData,index);
+            _taskMutex.lock_simple();
+            _completedTaskCount++;
+            if (_completedTaskCount>=_taskCount)
+                _taskMutex.wakeAll_simple(); // the caller waits for this
+        }
+        else
+            _taskMutex.wait_simple();
+    }
+    for (size_t i=0;i<_workerThreadIds.size();i++)
+    {
+        if (VThread::areThreadIDsSame(_workerThreadIds[i],threadId))
+        {
+            _workerThreadIds.erase(_workerThreadIds.begin()+i);
+            break;
+        }
+    }
+    _runningWorkerCount--;
+    _taskMutex.wakeAll_simple(); // cleanUp waits for this
+    _taskMutex.unlock_simple();
+    VThread::endThread();
+    return(VTHREAD_RETURN_VAL);
+}
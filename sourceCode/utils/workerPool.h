@@ -0,0 +1,36 @@
+#pragma once
+
+#include "vrepMainHeader.h"
+#include "vMutex.h"
+#include "vThread.h"
+
+typedef void (*WORKER_TASK_FUNCTION)(void* taskData,int taskIndex);
+
+// FULLY STATIC CLASS
+class CWorkerPool
+{
+public:
+    static void executeTasks(WORKER_TASK_FUNCTION taskFunction,void* taskData,int taskCount);
+    static void setWorkerCount(int cnt); // -1=core count-1, 0=no worker (tasks are executed by the calling thread)
+    static int getWorkerCount();
+    static int getEffectiveWorkerCount();
+    static void cleanUp();
+    static bool isCurrentThreadWorkingFor(VTHREAD_ID_TYPE threadId); // true if the current thread is threadId, or a worker executing tasks launched by threadId
+
+private:
+    static void _launchWorkersIfNeeded();
+    static VTHREAD_RETURN_TYPE _workerThreadStartPoint(VTHREAD_ARGUMENT_TYPE lpData);
+
+    static VMutex _taskMutex; // protects all variables below. Also used as wait condition
+    static WORKER_TASK_FUNCTION _taskFunction;
+    static VTHREAD_ID_TYPE _taskOwnerThreadId; // thread that called executeTasks
+    static void* _taskData;
+    static int _taskCount;
+    static int _nextTaskIndex;
+    static int _completedTaskCount;
+    static int _workerCount;
+    static int _launchedWorkerCount;
+    static int _runningWorkerCount;
+    static bool _workersShouldEnd;
+    static std::vector<VTHREAD_ID_TYPE> _workerThreadIds;
+};
@@ -16,6 +16,9 @@
 #include "geometric.h"
 #include "rendering.h"
 #include "miscBase.h"
+#include "simpleFilter.h"
+#include "threadPool.h"
+#include "ikSolver.h"
 #ifdef SIM_WITH_GUI
     #include "auxLibVideo.h"
     #include "vMessageBox.h"
@@ -67,6 +70,12 @@ SIMPLE_VTHREAD_RETURN_TYPE _workThread(SIMPLE_VTHREAD_ARGUMENT_TYPE lpData)
     #endif
 
     App::ct->sandboxScript=new CLuaScriptObject(sim_scripttype_sandboxscript);
+    if (App::userSettings->threadSwitchBenchmark)
+        CThreadPool::runSwitchBenchmark();
+    if (App::userSettings->luaHookBenchmark)
+        CLuaScriptObject::runHookBenchmark();
+    if (App::userSettings->ikSolverBenchmark)
+        CIkSolver::runBenchmark();
 
     while (!App::getExitRequest())
     {
@@ -483,6 +492,8 @@ void App::run(void(*initCallBack)(),void(*loopCallBack)(),void(*deinitCallBack)(
 #endif
 
     addStatusbarMessage(IDSNS_SIMULATOR_LAUNCHED);
+    if (userSettings->imageProcessingBenchmark)
+        CSimpleFilter::runBenchmark();
     _simulatorIsRunning=true;
 
     // Load the plugins via callback mechanism
@@ -147,6 +147,9 @@ void CUiThread::__executeCommandViaUiThread(SUIThreadCommand* cmdIn,SUIThreadCom
     if (cmdIn->cmdId==DETECT_VISION_SENSOR_ENTITY_UITHREADCMD)
         cmdOut->boolParams.push_back(((CVisionSensor*)cmdIn->objectParams[0])->detectVisionSensorEntity_executedViaUiThread(cmdIn->intParams[0],cmdIn->boolParams[0],cmdIn->boolParams[1],cmdIn->boolParams[2],cmdIn->boolParams[3],cmdIn->boolParams[4]));
 
+    if (cmdIn->cmdId==FETCH_VISION_SENSOR_READBACK_UITHREADCMD)
+        cmdOut->boolParams.push_back(((CVisionSensor*)cmdIn->objectParams[0])->fetchVisionSensorReadback_executedViaUiThread());
+
 
 #ifdef SIM_WITH_GUI
     if ( (App::mainWindow!=NULL)&&(cmdIn->cmdId==MENUBAR_COLOR_UITHREADCMD) )
@@ -116,6 +116,7 @@ enum {  OPEN_OR_CLOSE_UITHREADCMD=0,
         DISPLAY_MSG_WITH_CHECKBOX_UITHREADCMD,
         DISPLAY_MSGBOX_UITHREADCMD,
         DETECT_VISION_SENSOR_ENTITY_UITHREADCMD,
+        FETCH_VISION_SENSOR_READBACK_UITHREADCMD,
         DISPLAY_SAVE_DLG_UITHREADCMD,
         DISPLAY_OPEN_DLG_UITHREADCMD,
         DISPLAY_OPEN_DLG_MULTIFILE_UITHREADCMD,
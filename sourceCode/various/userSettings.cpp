@@ -5,6 +5,7 @@
 #include "userSettings.h"
 #include "global.h"
 #include "threadPool.h"
+#include "workerPool.h"
 #include "debugLogFile.h"
 #include "tt.h"
 #include "easyLock.h"
@@ -23,6 +24,8 @@
 #define _USR_DISPLAY_WORLD_REF "displayWorldRef"
 #define _USR_USE_GLFINISH "useGlFinish"
 #define _USR_USE_GLFINISH_VISION_SENSORS "useGlFinish_visionSensors"
+#define _USR_VISION_SENSORS_ASYNC_READBACK "visionSensorsAsyncReadback"
+#define _USR_VISION_SENSORS_ASYNC_READBACK_CHECK "visionSensorsAsyncReadbackCheck"
 #define _USR_OGL_COMPATIBILITY_TWEAK_1 "oglCompatibilityTweak1"
 
 #define _USR_STEREO_DIST "stereoDist"
@@ -34,6 +37,21 @@
 #define _USR_REMOVE_IDENTICAL_TRIANGLES "removeIdenticalTriangles"
 #define _USR_TRIANGLE_WINDING_CHECK "triangleWindingCheck"
 #define _USR_PROCESSOR_CORE_AFFINITY "processorCoreAffinity"
+#define _USR_WORKER_THREAD_COUNT "workerThreadCount"
+#define _USR_EVENT_DRIVEN_THREAD_SWITCHES "eventDrivenThreadSwitches"
+#define _USR_THREAD_SWITCH_BENCHMARK "threadSwitchBenchmark"
+#define _USR_LUA_WATCHDOG_HOOK "luaWatchdogHook"
+#define _USR_LUA_HOOK_BENCHMARK "luaHookBenchmark"
+#define _USR_PARALLEL_COLLISION_CHECKING "parallelCollisionChecking"
+#define _USR_PARALLEL_PROXIMITY_SENSING "parallelProximitySensing"
+#define _USR_PARALLEL_DISTANCE_CALCULATION "parallelDistanceCalculation"
+#define _USR_PARALLEL_IK_GROUPS "parallelIkGroups"
+#define _USR_IK_SOLVER_BENCHMARK "ikSolverBenchmark"
+#define _USR_PARALLEL_IMAGE_PROCESSING "parallelImageProcessing"
+#define _USR_IMAGE_PROCESSING_BENCHMARK "imageProcessingBenchmark"
+#define _USR_STEP_PROFILER_ENABLED "stepProfilerEnabled"
+#define _USR_STEP_PROFILER_STEP_COUNT "stepProfilerStepCount"
+#define _USR_STEP_PROFILER_TRACE_FILE "stepProfilerTraceFile"
 #define _USR_DYNAMIC_ACTIVITY_RANGE "dynamicActivityRange"
 #define _USR_FREE_SERVER_PORT_START "freeServerPortStart"
 #define _USR_FREE_SERVER_PORT_RANGE "freeServerPortRange"
@@ -43,7 +61,15 @@
 #define _USR_TRANSLATION_STEP_SIZE "objectTranslationStepSize"
 #define _USR_ROTATION_STEP_SIZE "objectRotationStepSize"
 #define _USR_COMPRESS_FILES "compressFiles"
+#define _USR_FILE_COMPRESSION_METHOD "fileCompressionMethod"
+#define _USR_FILE_COMPRESSION_BENCHMARK "fileCompressionBenchmark"
 #define _USR_TRIANGLE_COUNT_IN_OBB "triCountInOBB"
+#define _USR_COLLISION_STRUCTURE_CACHE "collisionStructureCache"
+#define _USR_COLLISION_STRUCTURE_CACHE_FOLDER "collisionStructureCacheFolder"
+#define _USR_PREBUILD_COLLISION_STRUCTURES "prebuildCollisionStructures"
+#define _USR_GRAPH_RECORDER "graphRecorder"
+#define _USR_GRAPH_RECORDER_FOLDER "graphRecorderFolder"
+#define _USR_GRAPH_RECORDER_COMPRESSION "graphRecorderCompression"
 #define _USR_APPROXIMATED_NORMALS "saveApproxNormals"
 #define _USR_PACK_INDICES "packIndices"
 #define _USR_UNDO_REDO_ENABLED "undoRedoEnabled"
@@ -114,6 +140,8 @@
 #define _USR_FORCE_FBO_VIA_EXT "forceFboViaExt"
 #define _USR_VBO_OPERATION "vboOperation"
 #define _USR_VBO_PERSISTENCE_IN_MS "vboPersistenceInMs"
+#define _USR_DRAWING_OBJECT_BUFFERS "drawingObjectBuffers"
+#define _USR_DRAWING_OBJECT_RENDERING_BENCHMARK "drawingObjectRenderingBenchmark"
 #define _USR_DESIRED_OPENGL_MAJOR "desiredOpenGlMajor"
 #define _USR_DESIRED_OPENGL_MINOR "desiredOpenGlMinor"
 #define _USR_HIGH_RES_DISPLAY "highResDisplay"
@@ -273,11 +301,15 @@ CUserSettings::CUserSettings()
     forceFboViaExt=false; // default
     vboOperation=-1; // default
     vboPersistenceInMs=5000; // default
+    drawingObjectBuffers=true;
+    drawingObjectRenderingBenchmark=false;
     oglCompatibilityTweak1=false;
     visionSensorsUseGuiThread_windowed=-1; // default
     visionSensorsUseGuiThread_headless=-1; // default
     useGlFinish=false;
     useGlFinish_visionSensors=false;
+    visionSensorsAsyncReadback=false;
+    visionSensorsAsyncReadbackCheck=false;
     vsync=0;
     debugOpenGl=false;
     stereoDist=0.0f; // default, no stereo!
@@ -438,6 +470,8 @@ CUserSettings::CUserSettings()
     autoSaveDelay=2; // 2 minutes for an auto-save by default. set to 0 for no auto-save
     doNotWritePersistentData=false;
     compressFiles=true;
+    fileCompressionMethod=1; // method 2 produces files older versions cannot read
+    fileCompressionBenchmark=false;
     saveApproxNormals=true;
     packIndices=true;
     fileDialogs=-1; // default
@@ -500,6 +534,25 @@ CUserSettings::CUserSettings()
     externalScriptEditorToSave=externalScriptEditor;
     abortScriptExecutionButton=3;
     triCountInOBB=8; // gave best results in 2009/07/21
+    collisionStructureCache=false;
+    collisionStructureCacheFolder="";
+    prebuildCollisionStructures=false;
+    graphRecorder=false;
+    graphRecorderFolder="";
+    graphRecorderCompression=true;
+    parallelCollisionChecking=false;
+    parallelProximitySensing=false;
+    parallelDistanceCalculation=false;
+    parallelIkGroups=false;
+    ikSolverBenchmark=false;
+    parallelImageProcessing=false;
+    imageProcessingBenchmark=false;
+    threadSwitchBenchmark=false;
+    luaWatchdogHook=false;
+    luaHookBenchmark=false;
+    stepProfilerEnabled=false;
+    stepProfilerStepCount=200;
+    stepProfilerTraceFile="";
     identicalVerticesCheck=true;
     identicalVerticesTolerance=0.0001f;
     identicalTrianglesCheck=true;
@@ -702,11 +755,15 @@ void CUserSettings::saveUserSettings()
     c.addBoolean(_USR_FORCE_FBO_VIA_EXT,forceFboViaExt,"recommended to keep false.");
     c.addInteger(_USR_VBO_OPERATION,vboOperation,"recommended to keep -1 (-1=default, 0=always off, 1=on when available).");
     c.addInteger(_USR_VBO_PERSISTENCE_IN_MS,vboPersistenceInMs,"recommended to keep 5000.");
+    c.addBoolean(_USR_DRAWING_OBJECT_BUFFERS,drawingObjectBuffers,"drawing object items are drawn from VBOs when possible (only new items are uploaded)");
+    c.addBoolean(_USR_DRAWING_OBJECT_RENDERING_BENCHMARK,drawingObjectRenderingBenchmark,"times drawing object items at startup (immediate mode and VBOs, with 10k, 100k and 1M items)");
     c.addBoolean(_USR_OGL_COMPATIBILITY_TWEAK_1,oglCompatibilityTweak1,"recommended to keep false since it causes small memory leaks.");
     c.addInteger(_USR_VISION_SENSORS_USE_GUI_WINDOWED,visionSensorsUseGuiThread_windowed,"recommended to keep -1 (-1=default, 0=GUI when not otherwise possible, 1=always GUI).");
     c.addInteger(_USR_VISION_SENSORS_USE_GUI_HEADLESS,visionSensorsUseGuiThread_headless,"recommended to keep -1 (-1=default, 0=GUI when not otherwise possible, 1=always GUI).");
     c.addBoolean(_USR_USE_GLFINISH,useGlFinish,"recommended to keep false. Graphic card dependent.");
     c.addBoolean(_USR_USE_GLFINISH_VISION_SENSORS,useGlFinish_visionSensors,"recommended to keep false. Graphic card dependent.");
+    c.addBoolean(_USR_VISION_SENSORS_ASYNC_READBACK,visionSensorsAsyncReadback,"if true, images are read back asynchronously: a vision sensor then returns the image rendered during the previous handling.");
+    c.addBoolean(_USR_VISION_SENSORS_ASYNC_READBACK_CHECK,visionSensorsAsyncReadbackCheck,"if true, asynchronously read images are compared with synchronously read ones (slow, for testing only).");
     c.addInteger(_USR_VSYNC,vsync,"recommended to keep at 0. Graphic card dependent.");
     c.addBoolean(_USR_DEBUG_OPENGL,debugOpenGl,"");
     c.addFloat(_USR_STEREO_DIST,stereoDist,"0=no stereo, otherwise the intra occular distance (0.0635 for the human eyes).");
@@ -878,6 +935,8 @@ void CUserSettings::saveUserSettings()
     c.addInteger(_USR_AUTO_SAVE_DELAY,autoSaveDelay,"in minutes. 0 to disable.");
     c.addBoolean(_USR_DO_NOT_WRITE_PERSISTENT_DATA,doNotWritePersistentData,"");
     c.addBoolean(_USR_COMPRESS_FILES,compressFiles,"");
+    c.addInteger(_USR_FILE_COMPRESSION_METHOD,fileCompressionMethod,"1=Huffman (default, readable by older versions), 2=parallel block compression (faster, not readable by older versions).");
+    c.addBoolean(_USR_FILE_COMPRESSION_BENCHMARK,fileCompressionBenchmark,"compares both compression methods when saving.");
     c.addBoolean(_USR_APPROXIMATED_NORMALS,saveApproxNormals,"");
     c.addBoolean(_USR_PACK_INDICES,packIndices,"");
     c.addInteger(_USR_FILE_DIALOGS_NATIVE,fileDialogs,"recommended to keep -1 (-1=default, 0=native dialogs, 1=Qt dialogs).");
@@ -942,12 +1001,33 @@ void CUserSettings::saveUserSettings()
     c.addFloat(_USR_TRANSLATION_STEP_SIZE,_translationStepSize,"");
     c.addFloat(_USR_ROTATION_STEP_SIZE,_rotationStepSize*radToDeg_f,"");
     c.addInteger(_USR_PROCESSOR_CORE_AFFINITY,CThreadPool::getProcessorCoreAffinity(),"recommended to keep 0 (-1:os default, 0:all threads on same core, m: affinity mask (bit1=core1, bit2=core2, etc.))");
+    c.addInteger(_USR_WORKER_THREAD_COUNT,CWorkerPool::getWorkerCount(),"worker threads for parallel calculations (-1:core count-1, 0:none)");
+    c.addBoolean(_USR_EVENT_DRIVEN_THREAD_SWITCHES,CThreadPool::getEventDrivenSwitches(),"threaded scripts wait on wait conditions instead of polling when switching");
+    c.addBoolean(_USR_THREAD_SWITCH_BENCHMARK,threadSwitchBenchmark,"times thread switches at startup (polling and event-driven, with several thread counts)");
+    c.addBoolean(_USR_LUA_WATCHDOG_HOOK,luaWatchdogHook,"Lua hook checks emergency stop and thread switches about once per millisecond only");
+    c.addBoolean(_USR_LUA_HOOK_BENCHMARK,luaHookBenchmark,"times a tight Lua loop at startup (without hook, regular hook and watchdog hook)");
+    c.addBoolean(_USR_PARALLEL_COLLISION_CHECKING,parallelCollisionChecking,"collection collision pairs are checked via the worker threads");
+    c.addBoolean(_USR_PARALLEL_PROXIMITY_SENSING,parallelProximitySensing,"proximity sensors handled together are distributed to the worker threads");
+    c.addBoolean(_USR_PARALLEL_DISTANCE_CALCULATION,parallelDistanceCalculation,"registered distance objects are distributed to the worker threads");
+    c.addBoolean(_USR_PARALLEL_IK_GROUPS,parallelIkGroups,"independent IK groups are computed via the worker threads");
+    c.addBoolean(_USR_IK_SOLVER_BENCHMARK,ikSolverBenchmark,"times IK steps at startup (previous and current solver)");
+    c.addBoolean(_USR_PARALLEL_IMAGE_PROCESSING,parallelImageProcessing,"vision sensor filters process image rows via the worker threads");
+    c.addBoolean(_USR_IMAGE_PROCESSING_BENCHMARK,imageProcessingBenchmark,"times vision sensor filters at startup (with and without optimizations)");
+    c.addBoolean(_USR_STEP_PROFILER_ENABLED,stepProfilerEnabled,"times scripts, sensors, collisions, etc. in each simulation step");
+    c.addInteger(_USR_STEP_PROFILER_STEP_COUNT,stepProfilerStepCount,"number of last steps kept by the step profiler");
+    c.addString(_USR_STEP_PROFILER_TRACE_FILE,stepProfilerTraceFile,"Chrome trace file written by the step profiler when simulation ends (empty=none)");
     c.addInteger(_USR_FREE_SERVER_PORT_START,freeServerPortStart,"");
     c.addInteger(_USR_FREE_SERVER_PORT_RANGE,freeServerPortRange,"");
     c.addBoolean(_USR_USE_EXTERNAL_SCRIPT_EDITOR,_useExternalScriptEditorToSave,"");
     c.addString(_USR_EXTERNAL_SCRIPT_EDITOR,externalScriptEditorToSave,"");
     c.addInteger(_USR_ABORT_SCRIPT_EXECUTION_BUTTON,abortScriptExecutionButton,"in seconds. Zero to disable.");
     c.addInteger(_USR_TRIANGLE_COUNT_IN_OBB,triCountInOBB,"");
+    c.addBoolean(_USR_COLLISION_STRUCTURE_CACHE,collisionStructureCache,"keeps computed collision structures in a cache folder, shared by all scenes and V-REP instances");
+    c.addString(_USR_COLLISION_STRUCTURE_CACHE_FOLDER,collisionStructureCacheFolder,"empty for the 'collisionStructureCache' folder next to the executable");
+    c.addBoolean(_USR_PREBUILD_COLLISION_STRUCTURES,prebuildCollisionStructures,"builds the collision structures of loaded shapes at load time, via the worker threads");
+    c.addBoolean(_USR_GRAPH_RECORDER,graphRecorder,"graphs record their complete history during simulation, spilled to a file (the buffer is then a sliding window)");
+    c.addString(_USR_GRAPH_RECORDER_FOLDER,graphRecorderFolder,"empty for the 'graphRecordings' folder next to the executable");
+    c.addBoolean(_USR_GRAPH_RECORDER_COMPRESSION,graphRecorderCompression,"lossless compression of the recorded graph data");
     c.addBoolean(_USR_REMOVE_IDENTICAL_VERTICES,identicalVerticesCheck,"");
     c.addFloat(_USR_IDENTICAL_VERTICES_TOLERANCE,identicalVerticesTolerance,"");
     c.addBoolean(_USR_REMOVE_IDENTICAL_TRIANGLES,identicalTrianglesCheck,"");
@@ -1056,11 +1136,15 @@ void CUserSettings::loadUserSettings()
     c.getBoolean(_USR_FORCE_FBO_VIA_EXT,forceFboViaExt);
     c.getInteger(_USR_VBO_OPERATION,vboOperation);
     c.getInteger(_USR_VBO_PERSISTENCE_IN_MS,vboPersistenceInMs);
+    c.getBoolean(_USR_DRAWING_OBJECT_BUFFERS,drawingObjectBuffers);
+    c.getBoolean(_USR_DRAWING_OBJECT_RENDERING_BENCHMARK,drawingObjectRenderingBenchmark);
     c.getBoolean(_USR_OGL_COMPATIBILITY_TWEAK_1,oglCompatibilityTweak1);
     c.getInteger(_USR_VISION_SENSORS_USE_GUI_WINDOWED,visionSensorsUseGuiThread_windowed);
     c.getInteger(_USR_VISION_SENSORS_USE_GUI_HEADLESS,visionSensorsUseGuiThread_headless);
     c.getBoolean(_USR_USE_GLFINISH,useGlFinish);
     c.getBoolean(_USR_USE_GLFINISH_VISION_SENSORS,useGlFinish_visionSensors);
+    c.getBoolean(_USR_VISION_SENSORS_ASYNC_READBACK,visionSensorsAsyncReadback);
+    c.getBoolean(_USR_VISION_SENSORS_ASYNC_READBACK_CHECK,visionSensorsAsyncReadbackCheck);
     c.getInteger(_USR_VSYNC,vsync);
     c.getBoolean(_USR_DEBUG_OPENGL,debugOpenGl);
     c.getFloat(_USR_STEREO_DIST,stereoDist);
@@ -1225,6 +1309,8 @@ void CUserSettings::loadUserSettings()
     c.getInteger(_USR_AUTO_SAVE_DELAY,autoSaveDelay);
     c.getBoolean(_USR_DO_NOT_WRITE_PERSISTENT_DATA,doNotWritePersistentData);
     c.getBoolean(_USR_COMPRESS_FILES,compressFiles);
+    c.getInteger(_USR_FILE_COMPRESSION_METHOD,fileCompressionMethod);
+    c.getBoolean(_USR_FILE_COMPRESSION_BENCHMARK,fileCompressionBenchmark);
     c.getBoolean(_USR_APPROXIMATED_NORMALS,saveApproxNormals);
     c.getBoolean(_USR_PACK_INDICES,packIndices);
     c.getInteger(_USR_FILE_DIALOGS_NATIVE,fileDialogs);
@@ -1281,6 +1367,25 @@ void CUserSettings::loadUserSettings()
     int processorCoreAffinity=0;
     if (c.getInteger(_USR_PROCESSOR_CORE_AFFINITY,processorCoreAffinity))
         CThreadPool::setProcessorCoreAffinity(processorCoreAffinity);
+    int workerThreadCount=0;
+    if (c.getInteger(_USR_WORKER_THREAD_COUNT,workerThreadCount))
+        CWorkerPool::setWorkerCount(workerThreadCount);
+    bool eventDrivenThreadSwitches=true;
+    if (c.getBoolean(_USR_EVENT_DRIVEN_THREAD_SWITCHES,eventDrivenThreadSwitches))
+        CThreadPool::setEventDrivenSwitches(eventDrivenThreadSwitches);
+    c.getBoolean(_USR_THREAD_SWITCH_BENCHMARK,threadSwitchBenchmark);
+    c.getBoolean(_USR_LUA_WATCHDOG_HOOK,luaWatchdogHook);
+    c.getBoolean(_USR_LUA_HOOK_BENCHMARK,luaHookBenchmark);
+    c.getBoolean(_USR_PARALLEL_COLLISION_CHECKING,parallelCollisionChecking);
+    c.getBoolean(_USR_PARALLEL_PROXIMITY_SENSING,parallelProximitySensing);
+    c.getBoolean(_USR_PARALLEL_DISTANCE_CALCULATION,parallelDistanceCalculation);
+    c.getBoolean(_USR_PARALLEL_IK_GROUPS,parallelIkGroups);
+    c.getBoolean(_USR_IK_SOLVER_BENCHMARK,ikSolverBenchmark);
+    c.getBoolean(_USR_PARALLEL_IMAGE_PROCESSING,parallelImageProcessing);
+    c.getBoolean(_USR_IMAGE_PROCESSING_BENCHMARK,imageProcessingBenchmark);
+    c.getBoolean(_USR_STEP_PROFILER_ENABLED,stepProfilerEnabled);
+    c.getInteger(_USR_STEP_PROFILER_STEP_COUNT,stepProfilerStepCount);
+    c.getString(_USR_STEP_PROFILER_TRACE_FILE,stepProfilerTraceFile);
     c.getInteger(_USR_FREE_SERVER_PORT_START,freeServerPortStart);
     _nextfreeServerPortToUse=freeServerPortStart;
     c.getInteger(_USR_FREE_SERVER_PORT_RANGE,freeServerPortRange);
@@ -1290,6 +1395,12 @@ void CUserSettings::loadUserSettings()
     externalScriptEditorToSave=externalScriptEditor;
     c.getInteger(_USR_ABORT_SCRIPT_EXECUTION_BUTTON,abortScriptExecutionButton);
     c.getInteger(_USR_TRIANGLE_COUNT_IN_OBB,triCountInOBB);
+    c.getBoolean(_USR_COLLISION_STRUCTURE_CACHE,collisionStructureCache);
+    c.getString(_USR_COLLISION_STRUCTURE_CACHE_FOLDER,collisionStructureCacheFolder);
+    c.getBoolean(_USR_PREBUILD_COLLISION_STRUCTURES,prebuildCollisionStructures);
+    c.getBoolean(_USR_GRAPH_RECORDER,graphRecorder);
+    c.getString(_USR_GRAPH_RECORDER_FOLDER,graphRecorderFolder);
+    c.getBoolean(_USR_GRAPH_RECORDER_COMPRESSION,graphRecorderCompression);
     c.getBoolean(_USR_REMOVE_IDENTICAL_VERTICES,identicalVerticesCheck);
     c.getFloat(_USR_IDENTICAL_VERTICES_TOLERANCE,identicalVerticesTolerance);
     c.getBoolean(_USR_REMOVE_IDENTICAL_TRIANGLES,identicalTrianglesCheck);
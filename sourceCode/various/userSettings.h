@@ -42,6 +42,8 @@ public:
     bool displayWorldReference;
     bool useGlFinish;
     bool useGlFinish_visionSensors;
+    bool visionSensorsAsyncReadback;
+    bool visionSensorsAsyncReadbackCheck;
     bool oglCompatibilityTweak1;
     float stereoDist;
     int vsync;
@@ -51,7 +53,28 @@ public:
     bool identicalTrianglesCheck;
     bool identicalTrianglesWindingCheck;
     bool compressFiles;
+    int fileCompressionMethod;
+    bool fileCompressionBenchmark;
     int triCountInOBB;
+    bool collisionStructureCache;
+    std::string collisionStructureCacheFolder;
+    bool prebuildCollisionStructures;
+    bool graphRecorder;
+    std::string graphRecorderFolder;
+    bool graphRecorderCompression;
+    bool parallelCollisionChecking;
+    bool parallelProximitySensing;
+    bool parallelDistanceCalculation;
+    bool parallelIkGroups;
+    bool ikSolverBenchmark;
+    bool parallelImageProcessing;
+    bool imageProcessingBenchmark;
+    bool threadSwitchBenchmark;
+    bool luaWatchdogHook;
+    bool luaHookBenchmark;
+    bool stepProfilerEnabled;
+    int stepProfilerStepCount;
+    std::string stepProfilerTraceFile;
     bool saveApproxNormals;
     bool packIndices;
     bool runCustomizationScripts;
@@ -102,6 +125,8 @@ public:
     bool forceFboViaExt;
     int vboOperation;
     int vboPersistenceInMs;
+    bool drawingObjectBuffers;
+    bool drawingObjectRenderingBenchmark;
     int desiredOpenGlMajor;
     int desiredOpenGlMinor;
     int visionSensorsUseGuiThread_windowed;
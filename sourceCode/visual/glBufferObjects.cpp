@@ -51,10 +51,15 @@ void CGlBufferObjects::_deleteAllBuffers()
     }
     _edgeBuffers.clear();
 
+    for (std::map<int,SRingBuffwid>::iterator it=_ringBuffers.begin();it!=_ringBuffers.end();it++)
+        delete it->second.buffer;
+    _ringBuffers.clear();
+
     _vertexBuffersToRemove.clear();
     _normalBuffersToRemove.clear();
     _texCoordBuffersToRemove.clear();
     _edgeBuffersToRemove.clear();
+    _ringBuffersToRemove.clear();
 }
 
 bool CGlBufferObjects::_checkIfBuffersAreSupported()
@@ -621,6 +626,10 @@ void CGlBufferObjects::_deleteBuffersThatNeedDestruction()
     for (size_t i=0;i<_edgeBuffersToRemove.size();i++)
         _removeEdgeBuffer(_edgeBuffersToRemove[i]);
     _edgeBuffersToRemove.clear();
+
+    for (size_t i=0;i<_ringBuffersToRemove.size();i++)
+        _removeRingBuffer(_ringBuffersToRemove[i]);
+    _ringBuffersToRemove.clear();
 }
 
 void CGlBufferObjects::removeVertexBuffer(int vertexBufferId)
@@ -749,6 +758,15 @@ void CGlBufferObjects::_deleteBuffersNotUsedSinceAWhile(int currentTimeInMs,int
     }
     for (int i=0;i<int(toRemove.size());i++)
         _removeEdgeBuffer(toRemove[i]);
+
+    toRemove.clear();
+    for (std::map<int,SRingBuffwid>::iterator it=_ringBuffers.begin();it!=_ringBuffers.end();it++)
+    {
+        if (VDateTime::getTimeDiffInMs(it->second.lastTimeUsedInMs,currentTimeInMs)>maxTimeInMs)
+            toRemove.push_back(it->first);
+    }
+    for (int i=0;i<int(toRemove.size());i++)
+        _removeRingBuffer(toRemove[i]);
 }
 
 void CGlBufferObjects::_updateAllBufferLastTimeUsed(int currentTimeInMs)
@@ -764,6 +782,9 @@ void CGlBufferObjects::_updateAllBufferLastTimeUsed(int currentTimeInMs)
 
     for (std::map<int,SBuffwid>::iterator it=_edgeBuffers.begin();it!=_edgeBuffers.end();it++)
         it->second.lastTimeUsedInMs=currentTimeInMs;
+
+    for (std::map<int,SRingBuffwid>::iterator it=_ringBuffers.begin();it!=_ringBuffers.end();it++)
+        it->second.lastTimeUsedInMs=currentTimeInMs;
 }
 
 void CGlBufferObjects::increaseVertexBufferRefCnt(int vertexBufferId)
@@ -793,3 +814,104 @@ void CGlBufferObjects::increaseEdgeBufferRefCnt(int edgeBufferId)
     if (it!=_edgeBuffers.end())
         it->second.refCnt++;
 }
+
+bool CGlBufferObjects::areRingBuffersUsable()
+{ // Can only be called by the GUI thread!
+    _buffersAreSupported=_checkIfBuffersAreSupported();
+    bool forceNotUsingBuffers=true;
+#ifdef SIM_WITH_GUI
+    forceNotUsingBuffers=(App::userSettings->vboOperation==0)||(App::mainWindow==NULL); // in headless mode: we don't use VBO's for now (crash)
+#endif
+    return(_buffersAreSupported&&(!forceNotUsingBuffers));
+}
+
+int CGlBufferObjects::buildRingBuffer(int floatCnt)
+{ // Can only be called by the GUI thread! Content is undefined until written
+    _deleteBuffersThatNeedDestruction();
+    if (!areRingBuffersUsable())
+        return(-1);
+    SRingBuffwid buff;
+    buff.buffer=new QGLBuffer(QGLBuffer::VertexBuffer);
+    buff.buffer->setUsagePattern(QGLBuffer::DynamicDraw);
+    if ( (!buff.buffer->create())||(!buff.buffer->bind()) )
+    {
+        delete buff.buffer;
+        return(-1);
+    }
+    buff.buffer->allocate(floatCnt*sizeof(float));
+    buff.buffer->release();
+    buff.floatCnt=floatCnt;
+    buff.lastTimeUsedInMs=VDateTime::getTimeInMs();
+    _ringBuffers[_nextId]=buff;
+    return(_nextId++);
+}
+
+bool CGlBufferObjects::doesRingBufferExist(int ringBufferId) const
+{
+    return(_ringBuffers.find(ringBufferId)!=_ringBuffers.end());
+}
+
+bool CGlBufferObjects::writeRingBuffer(int ringBufferId,int floatOffset,const float* data,int floatCnt)
+{ // Can only be called by the GUI thread!
+    std::map<int,SRingBuffwid>::iterator it=_ringBuffers.find(ringBufferId);
+    if ( (it==_ringBuffers.end())||(floatOffset<0)||(floatOffset+floatCnt>it->second.floatCnt) )
+        return(false);
+    if (floatCnt>0)
+    {
+        it->second.buffer->bind();
+        it->second.buffer->write(floatOffset*sizeof(float),data,floatCnt*sizeof(float));
+        it->second.buffer->release();
+    }
+    return(true);
+}
+
+bool CGlBufferObjects::bindRingBuffer(int ringBufferId,int floatsPerVertex,int normalOffset,int colorOffset)
+{ // Can only be called by the GUI thread! Vertices are interleaved. normalOffset and colorOffset are in floats, -1 if not used
+    std::map<int,SRingBuffwid>::iterator it=_ringBuffers.find(ringBufferId);
+    if (it==_ringBuffers.end())
+        return(false);
+    it->second.buffer->bind();
+    int stride=floatsPerVertex*sizeof(float);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3,GL_FLOAT,stride,0);
+    if (normalOffset>=0)
+    {
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glNormalPointer(GL_FLOAT,stride,(const char*)0+normalOffset*sizeof(float));
+    }
+    if (colorOffset>=0)
+    {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(3,GL_FLOAT,stride,(const char*)0+colorOffset*sizeof(float));
+    }
+    it->second.lastTimeUsedInMs=VDateTime::getTimeInMs();
+    return(true);
+}
+
+void CGlBufferObjects::unbindRingBuffer(int ringBufferId)
+{ // Can only be called by the GUI thread!
+    std::map<int,SRingBuffwid>::iterator it=_ringBuffers.find(ringBufferId);
+    if (it!=_ringBuffers.end())
+    {
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_COLOR_ARRAY);
+        it->second.buffer->release();
+    }
+}
+
+void CGlBufferObjects::removeRingBuffer(int ringBufferId)
+{ // can be called by any thread!
+    if (ringBufferId<0)
+        return;
+    _ringBuffersToRemove.push_back(ringBufferId);
+}
+
+void CGlBufferObjects::_removeRingBuffer(int ringBufferId)
+{ // should only be called by the GUI thread!!
+    std::map<int,SRingBuffwid>::iterator it=_ringBuffers.find(ringBufferId);
+    if (it==_ringBuffers.end())
+        return;
+    delete it->second.buffer;
+    _ringBuffers.erase(it);
+}
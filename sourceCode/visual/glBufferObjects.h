@@ -14,6 +14,13 @@ struct SBuffwid
     bool qglBufferInitialized;
 };
 
+struct SRingBuffwid
+{
+    QGLBuffer* buffer;
+    int floatCnt;
+    int lastTimeUsedInMs;
+};
+
 
 class CGlBufferObjects
 {
@@ -36,6 +43,16 @@ public:
     void increaseTexCoordBufferRefCnt(int texCoordBufferId);
     void increaseEdgeBufferRefCnt(int edgeBufferId);
 
+    // Ring buffers are dynamic vertex buffers that are written piecewise (e.g. only the items that were
+    // appended to a drawing object). They only exist when VBOs can be used:
+    bool areRingBuffersUsable();
+    int buildRingBuffer(int floatCnt);
+    bool doesRingBufferExist(int ringBufferId) const;
+    bool writeRingBuffer(int ringBufferId,int floatOffset,const float* data,int floatCnt);
+    bool bindRingBuffer(int ringBufferId,int floatsPerVertex,int normalOffset,int colorOffset);
+    void unbindRingBuffer(int ringBufferId);
+    void removeRingBuffer(int ringBufferId);
+
 protected:
     bool _checkIfBuffersAreSupported();
     void _deleteAllBuffers();
@@ -63,6 +80,7 @@ protected:
     void _removeNormalBuffer(int normalBufferId);
     void _removeTexCoordBuffer(int texCoordBufferId);
     void _removeEdgeBuffer(int edgeBufferId);
+    void _removeRingBuffer(int ringBufferId);
 
     void _fromSharedToIndividualVertices(const float* sharedVertices,int sharedVerticesCnt,const int* sharedIndices,int sharedIndicesCnt,std::vector<float>& individualVertices);
     void _fromSharedToIndividualEdges(const float* sharedVertices,int sharedVerticesCnt,const int* sharedIndices,int sharedIndicesCnt,const unsigned char* edges,std::vector<float>& individualVertices);
@@ -76,9 +94,11 @@ protected:
     std::map<int,SBuffwid> _normalBuffers;
     std::map<int,SBuffwid> _texCoordBuffers;
     std::map<int,SBuffwid> _edgeBuffers;
+    std::map<int,SRingBuffwid> _ringBuffers;
 
     std::vector<int> _vertexBuffersToRemove;
     std::vector<int> _normalBuffersToRemove;
     std::vector<int> _texCoordBuffersToRemove;
     std::vector<int> _edgeBuffersToRemove;
+    std::vector<int> _ringBuffersToRemove;
 };
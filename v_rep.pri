@@ -363,6 +363,7 @@ HEADERS += $$PWD/sourceCode/inverseKinematics/geomConstraintSolver/iKObject.h \
 HEADERS += $$PWD/sourceCode/inverseKinematics/ik/ikRoutine.h \
     $$PWD/sourceCode/inverseKinematics/ik/ikGroup.h \
     $$PWD/sourceCode/inverseKinematics/ik/ikEl.h \
+    $$PWD/sourceCode/inverseKinematics/ik/ikSolver.h \
 
 HEADERS += $$PWD/sourceCode/shared/sharedBufferFunctions/sharedFloatVector.h \
     $$PWD/sourceCode/shared/sharedBufferFunctions/sharedIntVector.h \
@@ -377,6 +378,7 @@ HEADERS += $$PWD/sourceCode/drawingObjects/bannerObject.h \
 HEADERS += $$PWD/sourceCode/platform/vVarious.h \
     $$PWD/sourceCode/platform/vThread.h \
     $$PWD/sourceCode/platform/vMutex.h \
+    $$PWD/sourceCode/platform/vReadWriteLock.h \
     $$PWD/sourceCode/platform/vFileFinder.h \
     $$PWD/sourceCode/platform/vFile.h \
     $$PWD/sourceCode/platform/vDateTime.h \
@@ -387,6 +389,7 @@ HEADERS += $$PWD/sourceCode/collections/regCollectionEl.h \
 
 HEADERS += $$PWD/sourceCode/collisions/regCollision.h \
     $$PWD/sourceCode/collisions/collisionRoutine.h \
+    $$PWD/sourceCode/collisions/collisionBroadPhase.h \
 
 HEADERS += $$PWD/sourceCode/distances/regDist.h \
     $$PWD/sourceCode/distances/distanceRoutine.h \
@@ -413,6 +416,7 @@ HEADERS += $$PWD/sourceCode/3dObjects/jointObject.h \
 
 HEADERS += $$PWD/sourceCode/3dObjects/graphObjectRelated/graphingRoutines.h \
     $$PWD/sourceCode/3dObjects/graphObjectRelated/graphDataComb.h \
+    $$PWD/sourceCode/3dObjects/graphObjectRelated/graphRecorder.h \
     $$PWD/sourceCode/3dObjects/graphObjectRelated/graphData.h \
     $$PWD/sourceCode/3dObjects/graphObjectRelated/staticGraphCurve.h \
 
@@ -426,6 +430,7 @@ HEADERS += $$PWD/sourceCode/3dObjects/pathObjectRelated/bezierPathPoint.h \
 HEADERS += $$PWD/sourceCode/3dObjects/shapeObjectRelated/geometric.h \
     $$PWD/sourceCode/3dObjects/shapeObjectRelated/geomWrap.h \
     $$PWD/sourceCode/3dObjects/shapeObjectRelated/geomProxy.h \
+    $$PWD/sourceCode/3dObjects/shapeObjectRelated/collisionStructureCache.h \
     $$PWD/sourceCode/3dObjects/shapeObjectRelated/volInt.h \
 
 HEADERS += $$PWD/sourceCode/backwardCompatibility/geomObject.h \
@@ -480,6 +485,7 @@ HEADERS += $$PWD/sourceCode/mainContainers/applicationContainers/copyBuffer.h \
     $$PWD/sourceCode/mainContainers/applicationContainers/persistentDataContainer.h \
     $$PWD/sourceCode/mainContainers/applicationContainers/simulatorMessageQueue.h \
     $$PWD/sourceCode/mainContainers/applicationContainers/calculationInfo.h \
+    $$PWD/sourceCode/mainContainers/applicationContainers/stepProfiler.h \
     $$PWD/sourceCode/mainContainers/applicationContainers/interfaceStackContainer.h \
     $$PWD/sourceCode/mainContainers/applicationContainers/addOnScriptContainer.h \
 
@@ -519,6 +525,7 @@ HEADERS += $$PWD/sourceCode/serialization/ser.h \
     $$PWD/sourceCode/serialization/xmlSer.h \
     $$PWD/sourceCode/serialization/extIkSer.h \
     $$PWD/sourceCode/serialization/huffman.h \
+    $$PWD/sourceCode/serialization/blockCompressor.h \
     $$PWD/sourceCode/serialization/tinyxml2.cpp \
 
 HEADERS += $$PWD/sourceCode/strings/v_repStringTable.h \
@@ -572,6 +579,7 @@ HEADERS += $$PWD/sourceCode/various/vrepConfig.h \
 HEADERS += $$PWD/sourceCode/undoRedo/undoBufferArrays.h \
     $$PWD/sourceCode/undoRedo/undoBuffer.h \
     $$PWD/sourceCode/undoRedo/undoBufferCameras.h \
+    $$PWD/sourceCode/undoRedo/undoChunkStore.h \
 
 HEADERS += $$PWD/sourceCode/rendering/rendering.h \
     $$PWD/sourceCode/rendering/cameraRendering.h \
@@ -610,6 +618,7 @@ HEADERS += $$PWD/sourceCode/visual/visualParam.h \
     $$PWD/sourceCode/visual/thumbnail.h \
 
 HEADERS += $$PWD/sourceCode/utils/threadPool.h \
+    $$PWD/sourceCode/utils/workerPool.h \
     $$PWD/sourceCode/utils/tt.h \
     $$PWD/sourceCode/utils/ttUtil.h \
     $$PWD/sourceCode/utils/confReaderAndWriter.h \
@@ -637,6 +646,7 @@ WITH_SERIAL {
 WITH_OPENGL {
     HEADERS += $$PWD/sourceCode/3dObjects/visionSensorObjectRelated/offscreenGlContext.h \
         $$PWD/sourceCode/3dObjects/visionSensorObjectRelated/frameBufferObject.h \
+        $$PWD/sourceCode/3dObjects/visionSensorObjectRelated/pixelReadback.h \
         $$PWD/sourceCode/3dObjects/visionSensorObjectRelated/visionSensorGlStuff.h
 
     HEADERS += $$PWD/sourceCode/visual/oGL.h \
@@ -865,6 +875,7 @@ SOURCES += $$PWD/sourceCode/inverseKinematics/geomConstraintSolver/iKObject.cpp
 SOURCES += $$PWD/sourceCode/inverseKinematics/ik/ikRoutine.cpp \
     $$PWD/sourceCode/inverseKinematics/ik/ikGroup.cpp \
     $$PWD/sourceCode/inverseKinematics/ik/ikEl.cpp \
+    $$PWD/sourceCode/inverseKinematics/ik/ikSolver.cpp \
 
 SOURCES += $$PWD/sourceCode/shared/sharedBufferFunctions/sharedFloatVector.cpp \
     $$PWD/sourceCode/shared/sharedBufferFunctions/sharedIntVector.cpp \
@@ -879,6 +890,7 @@ SOURCES += $$PWD/sourceCode/drawingObjects/bannerObject.cpp \
 SOURCES += $$PWD/sourceCode/platform/vVarious.cpp \
     $$PWD/sourceCode/platform/vThread.cpp \
     $$PWD/sourceCode/platform/vMutex.cpp \
+    $$PWD/sourceCode/platform/vReadWriteLock.cpp \
     $$PWD/sourceCode/platform/vFileFinder.cpp \
     $$PWD/sourceCode/platform/vFile.cpp \
     $$PWD/sourceCode/platform/vDateTime.cpp \
@@ -889,6 +901,7 @@ SOURCES += $$PWD/sourceCode/collections/regCollectionEl.cpp \
 
 SOURCES += $$PWD/sourceCode/collisions/regCollision.cpp \
     $$PWD/sourceCode/collisions/collisionRoutine.cpp \
+    $$PWD/sourceCode/collisions/collisionBroadPhase.cpp \
 
 SOURCES += $$PWD/sourceCode/distances/regDist.cpp \
     $$PWD/sourceCode/distances/distanceRoutine.cpp \
@@ -915,6 +928,7 @@ SOURCES += $$PWD/sourceCode/3dObjects/jointObject.cpp \
 
 SOURCES += $$PWD/sourceCode/3dObjects/graphObjectRelated/graphingRoutines.cpp \
     $$PWD/sourceCode/3dObjects/graphObjectRelated/graphDataComb.cpp \
+    $$PWD/sourceCode/3dObjects/graphObjectRelated/graphRecorder.cpp \
     $$PWD/sourceCode/3dObjects/graphObjectRelated/graphData.cpp \
     $$PWD/sourceCode/3dObjects/graphObjectRelated/staticGraphCurve.cpp \
 
@@ -930,6 +944,7 @@ SOURCES += $$PWD/sourceCode/3dObjects/proximitySensorObjectRelated/proxSensorRou
 SOURCES += $$PWD/sourceCode/3dObjects/shapeObjectRelated/geometric.cpp \
     $$PWD/sourceCode/3dObjects/shapeObjectRelated/geomWrap.cpp \
     $$PWD/sourceCode/3dObjects/shapeObjectRelated/geomProxy.cpp \
+    $$PWD/sourceCode/3dObjects/shapeObjectRelated/collisionStructureCache.cpp \
     $$PWD/sourceCode/3dObjects/shapeObjectRelated/volInt.cpp \
 
 
@@ -985,6 +1000,7 @@ SOURCES += $$PWD/sourceCode/mainContainers/applicationContainers/copyBuffer.cpp
     $$PWD/sourceCode/mainContainers/applicationContainers/persistentDataContainer.cpp \
     $$PWD/sourceCode/mainContainers/applicationContainers/simulatorMessageQueue.cpp \
     $$PWD/sourceCode/mainContainers/applicationContainers/calculationInfo.cpp \
+    $$PWD/sourceCode/mainContainers/applicationContainers/stepProfiler.cpp \
     $$PWD/sourceCode/mainContainers/applicationContainers/interfaceStackContainer.cpp \
     $$PWD/sourceCode/mainContainers/applicationContainers/addOnScriptContainer.cpp \
 
@@ -1024,6 +1040,7 @@ SOURCES += $$PWD/sourceCode/serialization/ser.cpp \
     $$PWD/sourceCode/serialization/xmlSer.cpp \
     $$PWD/sourceCode/serialization/extIkSer.cpp \
     $$PWD/sourceCode/serialization/huffman.c \
+    $$PWD/sourceCode/serialization/blockCompressor.c \
     $$PWD/sourceCode/serialization/tinyxml2.cpp \
 
 SOURCES += $$PWD/sourceCode/interfaces/v_rep.cpp \
@@ -1068,6 +1085,7 @@ SOURCES += $$PWD/sourceCode/various/gV.cpp \
 SOURCES += $$PWD/sourceCode/undoRedo/undoBufferArrays.cpp \
     $$PWD/sourceCode/undoRedo/undoBuffer.cpp \
     $$PWD/sourceCode/undoRedo/undoBufferCameras.cpp \
+    $$PWD/sourceCode/undoRedo/undoChunkStore.cpp \
 
 SOURCES += $$PWD/sourceCode/rendering/rendering.cpp \
     $$PWD/sourceCode/rendering/cameraRendering.cpp \
@@ -1106,6 +1124,7 @@ SOURCES += $$PWD/sourceCode/visual/visualParam.cpp \
     $$PWD/sourceCode/visual/thumbnail.cpp \
 
 SOURCES += $$PWD/sourceCode/utils/threadPool.cpp \
+    $$PWD/sourceCode/utils/workerPool.cpp \
     $$PWD/sourceCode/utils/ttUtil.cpp \
     $$PWD/sourceCode/utils/tt.cpp \
     $$PWD/sourceCode/utils/confReaderAndWriter.cpp \
@@ -1133,6 +1152,7 @@ WITH_SERIAL {
 WITH_OPENGL {
     SOURCES += $$PWD/sourceCode/3dObjects/visionSensorObjectRelated/offscreenGlContext.cpp \
         $$PWD/sourceCode/3dObjects/visionSensorObjectRelated/frameBufferObject.cpp \
+        $$PWD/sourceCode/3dObjects/visionSensorObjectRelated/pixelReadback.cpp \
         $$PWD/sourceCode/3dObjects/visionSensorObjectRelated/visionSensorGlStuff.cpp \
 
     SOURCES += $$PWD/sourceCode/visual/oGL.cpp \